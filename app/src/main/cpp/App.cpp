@@ -7,7 +7,10 @@
 //==============================================================================
 
 #include <inttypes.h>
+#include <signal.h>
+#include <unistd.h>
 
+#include <algorithm>
 #include <cstring>
 #include <fstream>
 #include <iostream>
@@ -17,6 +20,29 @@
 using namespace qnn;
 using namespace qnn::tools;
 
+namespace {
+
+metrics::Counter& g_graphExecutions = metrics::getRegistry().addCounter(
+    "qnn_graph_executions_total", "Calls to graphExecute, successful or not.");
+metrics::Counter& g_graphExecutionFailures = metrics::getRegistry().addCounter(
+    "qnn_graph_execution_failures_total", "Calls to graphExecute that returned an error.");
+metrics::Histogram& g_graphExecuteSeconds = metrics::getRegistry().addLatencyHistogram(
+    "qnn_graph_execute_seconds", "Time spent in graphExecute.");
+metrics::Counter& g_samplesExecuted = metrics::getRegistry().addCounter(
+    "qnn_samples_total", "Samples run through populate, execute and output handling.");
+metrics::Gauge& g_inputListQueued = metrics::getRegistry().addGauge(
+    "qnn_input_list_queued_samples", "Samples parsed from the input list, not yet executed.");
+
+uint64_t getClientBufBytes(const Qnn_Tensor_t* tensors, uint32_t numTensors) {
+  uint64_t bytes = 0;
+  for (uint32_t idx = 0; nullptr != tensors && idx < numTensors; idx++) {
+    bytes += QNN_TENSOR_GET_CLIENT_BUF(tensors[idx]).dataSize;
+  }
+  return bytes;
+}
+
+}  // namespace
+
 void app::split(std::vector<std::string> &splitString,
                        const std::string &tokenizedString,
                        const char separator) {
@@ -61,37 +87,26 @@ app::ReadInputListsRetType_t app::readInputLists(
   return std::make_tuple(filePathsLists, true);
 }
 
+app::ProfilingLevel app::parseProfilingLevel(std::string levelString) {
+  std::transform(levelString.begin(), levelString.end(), levelString.begin(), ::tolower);
+  ProfilingLevel parsedLevel = ProfilingLevel::INVALID;
+  if (levelString == "off") {
+    parsedLevel = ProfilingLevel::OFF;
+  } else if (levelString == "basic") {
+    parsedLevel = ProfilingLevel::BASIC;
+  } else if (levelString == "detailed") {
+    parsedLevel = ProfilingLevel::DETAILED;
+  }
+  return parsedLevel;
+}
+
 app::ReadInputListRetType_t app::readInputList(const std::string inputFileListPath) {
-  std::queue<std::string> lines;
-  std::ifstream fileListStream(inputFileListPath);
-  if (!fileListStream) {
-    QNN_ERROR("Failed to open input file: %s", inputFileListPath.c_str());
-    std::vector<std::queue<std::string>> result;
-    return std::make_tuple(result, false);
-  }
-  std::string fileLine;
-  while (std::getline(fileListStream, fileLine)) {
-    if (fileLine.empty()) continue;
-    lines.push(fileLine);
-  }
-  if (!lines.empty() && lines.front().compare(0, 1, "#") == 0) {
-    lines.pop();
-  }
-  std::string separator = ":=";
   std::vector<std::queue<std::string>> filePathsList;
-  while (!lines.empty()) {
-    std::vector<std::string> paths{};
-    std::vector<std::string> inputFilePaths;
-    split(inputFilePaths, lines.front(), ' ');
-    parseInputFilePaths(inputFilePaths, paths, separator);
-    filePathsList.reserve(paths.size());
-    for (size_t idx = 0; idx < paths.size(); idx++) {
-      if (idx >= filePathsList.size()) {
-        filePathsList.push_back(std::queue<std::string>());
-      }
-      filePathsList[idx].push(paths[idx]);
-    }
-    lines.pop();
+  inputlist::Reader inputListReader;
+  if (inputlist::StatusCode::SUCCESS != inputListReader.open(inputFileListPath)) {
+    return std::make_tuple(filePathsList, false);
+  }
+  while (inputListReader.readSamples(filePathsList, SIZE_MAX) > 0) {
   }
   return std::make_tuple(filePathsList, true);
 }
@@ -100,6 +115,15 @@ app::ReadInputListRetType_t app::readInputList(const std::string inputFileListPa
 // not supplied.
 const std::string app::QnnApplication::s_defaultOutputPath = "./output/";
 
+// Number of samples parsed ahead of execution from a streamed input list.
+const size_t app::QnnApplication::s_inputListWindow = 1024;
+
+// Amount of container data written between two write-behind requests.
+const size_t app::QnnApplication::s_outputWriteBehindBytes = 16 * 1024 * 1024;
+// Amount of container data an interrupted run can lose.
+const size_t app::QnnApplication::s_outputCheckpointBytes = 64 * 1024 * 1024;
+const std::string app::QnnApplication::s_outputHashFileName = "output_hashes.txt";
+
 app::QnnApplication::QnnApplication(func::QnnFunctionPointers qnnFunctionPointers,
                                        std::string inputListPaths,
                                        std::string opPackagePaths,
@@ -123,6 +147,15 @@ app::QnnApplication::QnnApplication(func::QnnFunctionPointers qnnFunctionPointer
 }
 
 app::QnnApplication::~QnnApplication() {
+  if (nullptr != m_traceEvents) {
+    m_traceEvents->close();
+  }
+  if (m_memoryReport) {
+    memaccount::getAccountant().writeReport(STDERR_FILENO);
+  }
+  if (m_perfCounters) {
+    perfcounters::getCollector().writeReport(STDERR_FILENO);
+  }
   // Free Profiling object if it was created
   if (nullptr != m_profileBackendHandle) {
     QNN_DEBUG("Freeing backend profile object.");
@@ -154,26 +187,205 @@ app::QnnApplication::~QnnApplication() {
       QNN_WARN("Unable to terminate logging in the backend.");
     }
   }
+  if (m_apiTiming) {
+    apitiming::writeReport(STDERR_FILENO);
+  }
   return;
 }
 
 // Initialize QnnApplication. Things it does:
 //  1. Create output directory
-//  2. Read all input list paths provided
-//      during creation.
+//  2. Open all input list paths provided
+//      during creation. Text lists are parsed lazily
+//      during execution; packed dataset containers
+//      are mapped instead. An input stream replaces
+//      the input lists.
+//  3. Open the reference outputs to compare with, or
+//      the output stream, or create the output
+//      container or hash file, if one was requested.
+//      Requesting more than one of them fails
+//  4. Create the flight recorder trace and the trace
+//      JSON timeline, start the metrics export,
+//      install the memory report signal and enable
+//      performance counters, if requested
 app::StatusCode app::QnnApplication::initialize() {
+  // Outputs go to a single sink; the Result_N directories are the default.
+  std::vector<std::string> outputSinks;
+  if (!m_compareWithPath.empty()) {
+    outputSinks.push_back("reference outputs to compare with");
+  }
+  if (!m_outputStreamPath.empty()) {
+    outputSinks.push_back("an output stream");
+  }
+  if (iotensor::OutputHash::NONE != m_outputHash) {
+    outputSinks.push_back("output hashes");
+  }
+  if (!m_outputContainerPath.empty()) {
+    outputSinks.push_back("an output container");
+  }
+  if (outputSinks.size() > 1) {
+    std::string sinks = outputSinks[0];
+    for (size_t idx = 1; idx < outputSinks.size(); idx++) {
+      sinks += (idx + 1 == outputSinks.size() ? " and " : ", ") + outputSinks[idx];
+    }
+    std::cerr << "Only one output sink can be used, got " + sinks;
+    return StatusCode::FAILURE;
+  }
+  if (!m_metricsPath.empty()) {
+    if (metrics::StatusCode::SUCCESS !=
+        m_metricsExporter.start(m_metricsPath, m_metricsInterval)) {
+      std::cerr << "Could not write metrics file: " + m_metricsPath;
+      return StatusCode::FAILURE;
+    }
+    QNN_INFO("Writing metrics to: %s", m_metricsPath.c_str());
+  }
+  if (m_memoryReport) {
+    memaccount::getAccountant().enable();
+    if (!memaccount::installReportHandler(SIGUSR1)) {
+      QNN_WARN("Unable to install the memory report signal handler.");
+    }
+  }
+  if (m_perfCounters &&
+      perfcounters::StatusCode::SUCCESS != perfcounters::getCollector().enable()) {
+    QNN_WARN("Performance counters are not available, check perf_event_paranoid.");
+  }
+  if (m_flightRecorderEnabled && !m_flightRecorderPath.empty()) {
+    if (flightrecorder::StatusCode::SUCCESS != m_flightRecorder->open(m_flightRecorderPath)) {
+      std::cerr << "Could not create flight recorder trace: " + m_flightRecorderPath;
+      return StatusCode::FAILURE;
+    }
+  } else if (m_flightRecorderEnabled) {
+    // Not asked for, so a default trace that cannot be created only warns.
+    std::string tracePath =
+        m_outputPath + pal::Path::getSeparator() + flightrecorder::g_defaultTraceFileName;
+    if ((!::pal::FileOp::checkFileExists(m_outputPath) &&
+         !pal::Directory::makePath(m_outputPath)) ||
+        flightrecorder::StatusCode::SUCCESS != m_flightRecorder->open(tracePath)) {
+      QNN_WARN("Could not create flight recorder trace: %s", tracePath.c_str());
+    }
+  }
+  if (!m_traceJsonPath.empty()) {
+    m_traceEvents = std::make_shared<traceevent::Writer>();
+    if (traceevent::StatusCode::SUCCESS != m_traceEvents->open(m_traceJsonPath)) {
+      std::cerr << "Could not create trace JSON: " + m_traceJsonPath;
+      return StatusCode::FAILURE;
+    }
+    m_traceEvents->setThreadName(traceevent::g_profileThreadId, "QNN profile");
+    m_flightRecorder->setTraceEvents(m_traceEvents);
+    QNN_INFO("Writing trace JSON to: %s", m_traceJsonPath.c_str());
+  } else if (ProfilingLevel::OFF != m_profilingLevel) {
+    QNN_WARN("Profile events are only reported in the trace JSON, not profiling.");
+    m_profilingLevel = ProfilingLevel::OFF;
+  }
+  if (m_flightRecorder->isEnabled()) {
+    m_ioTensor.setFlightRecorder(m_flightRecorder);
+  }
+  flightrecorder::Scope traceScope(m_flightRecorder.get(), flightrecorder::Phase::INITIALIZE);
   // Create Output Directory
-  if (m_dumpOutputs && !::pal::FileOp::checkFileExists(m_outputPath) &&
-      !pal::Directory::makePath(m_outputPath)) {
+  bool writesOutputDir =
+      m_compareWithPath.empty() && m_outputStreamPath.empty() && m_outputContainerPath.empty();
+  if (m_dumpOutputs && writesOutputDir &&
+      !::pal::FileOp::checkFileExists(m_outputPath) && !pal::Directory::makePath(m_outputPath)) {
     std::cerr << "Could not create output directory: " + m_outputPath;
     return StatusCode::FAILURE;
   }
+  if (!m_compareWithPath.empty()) {
+    m_outputComparator = std::make_shared<outputcompare::Comparator>();
+    m_outputComparator->setTolerance(m_compareTolerance);
+    m_outputComparator->setFailFast(m_compareFailFast);
+    if (outputcompare::StatusCode::SUCCESS != m_outputComparator->open(m_compareWithPath)) {
+      std::cerr << "Could not open reference outputs: " + m_compareWithPath;
+      return StatusCode::FAILURE;
+    }
+    m_ioTensor.setOutputComparator(m_outputComparator);
+    QNN_INFO("Comparing outputs with: %s", m_compareWithPath.c_str());
+  } else if (!m_outputStreamPath.empty()) {
+    auto outputStream = std::make_shared<framestream::Writer>();
+    if (framestream::StatusCode::SUCCESS !=
+        outputStream->open(m_outputStreamPath, m_streamFraming)) {
+      std::cerr << "Could not open output stream: " + m_outputStreamPath;
+      return StatusCode::FAILURE;
+    }
+    m_ioTensor.setOutputStream(outputStream);
+    QNN_INFO("Writing output frames to: %s", m_outputStreamPath.c_str());
+  } else if (iotensor::OutputHash::NONE != m_outputHash) {
+    std::string hashPath = m_outputPath + pal::Path::getSeparator() + s_outputHashFileName;
+    std::shared_ptr<std::ofstream> hashStream = std::make_shared<std::ofstream>(hashPath);
+    if (!*hashStream) {
+      std::cerr << "Could not create output hash file: " + hashPath;
+      return StatusCode::FAILURE;
+    }
+    m_ioTensor.setOutputHash(m_outputHash, m_outputHashWithStats, hashStream);
+    QNN_INFO("Writing output hashes to: %s", hashPath.c_str());
+  } else if (!m_outputContainerPath.empty()) {
+    m_outputContainer = std::make_shared<packedcontainer::Writer>();
+    m_outputContainer->setPreallocation(m_outputPreallocateBytes);
+    m_outputContainer->setWriteBehind(s_outputWriteBehindBytes);
+    m_outputContainer->setCheckpointInterval(s_outputCheckpointBytes);
+    if (packedcontainer::StatusCode::SUCCESS !=
+        m_outputContainer->create(m_outputContainerPath,
+                                  packedcontainer::Kind::OUTPUT_RESULTS,
+                                  packedcontainer::g_outputAlignment)) {
+      std::cerr << "Could not create output container: " + m_outputContainerPath;
+      return StatusCode::FAILURE;
+    }
+    m_ioTensor.setOutputContainer(m_outputContainer);
+    QNN_INFO("Writing outputs to container: %s", m_outputContainerPath.c_str());
+  } else if (m_dumpOutputs) {
+    auto outputLayout = std::make_shared<outputlayout::Planner>();
+    if (outputlayout::StatusCode::SUCCESS != outputLayout->open(m_outputPath)) {
+      std::cerr << "Could not open output directory: " + m_outputPath;
+      return StatusCode::FAILURE;
+    }
+    m_ioTensor.setOutputLayout(outputLayout);
+  }
+  if (m_inputReadahead && m_inputDirectIo) {
+    QNN_WARN("Input readahead has no effect on direct reads, disabling it");
+    m_inputReadahead = false;
+  }
+  if (!m_inputStreamPath.empty()) {
+    if (!m_inputListPaths.empty()) {
+      std::cerr << "An input stream cannot be combined with input lists";
+      return StatusCode::FAILURE;
+    }
+    m_inputStream = std::make_shared<framestream::Reader>();
+    if (framestream::StatusCode::SUCCESS !=
+        m_inputStream->open(m_inputStreamPath, m_streamFraming)) {
+      std::cerr << "Could not open input stream: " + m_inputStreamPath;
+      return StatusCode::FAILURE;
+    }
+    QNN_INFO("Reading input frames from: %s", m_inputStreamPath.c_str());
+    // The stream feeds the first graph only.
+    m_inputFileLists.push_back(std::vector<std::queue<std::string>>());
+    m_inputListReaders.push_back(nullptr);
+    m_inputDatasets.push_back(nullptr);
+  }
   // Read Input File List
-  bool readSuccess;
-  std::tie(m_inputFileLists, readSuccess) = readInputLists(m_inputListPaths);
-  if (!readSuccess) {
-    std::cerr << "Could not read input lists";
-    return StatusCode::FAILURE;
+  for (auto const& inputListPath : m_inputListPaths) {
+    std::shared_ptr<inputlist::Reader> inputListReader;
+    std::shared_ptr<packedcontainer::Reader> inputDataset;
+    if (packedcontainer::Reader::isContainer(inputListPath)) {
+      inputDataset = std::make_shared<packedcontainer::Reader>();
+      if (packedcontainer::StatusCode::SUCCESS != inputDataset->open(inputListPath)) {
+        std::cerr << "Could not read input dataset: " + inputListPath;
+        return StatusCode::FAILURE;
+      }
+      if (packedcontainer::Kind::INPUT_DATASET != inputDataset->getKind()) {
+        std::cerr << "Not an input dataset container: " + inputListPath;
+        return StatusCode::FAILURE;
+      }
+      inputDataset->advise(pal::MappedFile::Advice::SEQUENTIAL);
+      QNN_INFO("Using packed input dataset: %s", inputListPath.c_str());
+    } else {
+      inputListReader = std::make_shared<inputlist::Reader>();
+      if (inputlist::StatusCode::SUCCESS != inputListReader->open(inputListPath)) {
+        std::cerr << "Could not read input lists";
+        return StatusCode::FAILURE;
+      }
+    }
+    m_inputFileLists.push_back(std::vector<std::queue<std::string>>());
+    m_inputListReaders.push_back(inputListReader);
+    m_inputDatasets.push_back(inputDataset);
   }
   // initialize logging in the backend
   if (log::isLogInitialized()) {
@@ -200,6 +412,8 @@ int32_t app::QnnApplication::reportError(const std::string& err) {
 
 // Initialize a QnnBackend.
 app::StatusCode app::QnnApplication::initializeBackend() {
+  flightrecorder::Scope traceScope(m_flightRecorder.get(),
+                                   flightrecorder::Phase::INITIALIZE_BACKEND);
   auto qnnStatus = m_qnnFunctionPointers.qnnInterface.backendCreate(
       m_logHandle, (const QnnBackend_Config_t**)m_backendConfig, &m_backendHandle);
   if (QNN_BACKEND_NO_ERROR != qnnStatus) {
@@ -208,6 +422,17 @@ app::StatusCode app::QnnApplication::initializeBackend() {
   }
   QNN_INFO("Initialize Backend Returned Status = %d", qnnStatus);
   m_isBackendInitialized = true;
+  if (ProfilingLevel::OFF != m_profilingLevel) {
+    QnnProfile_Level_t level = ProfilingLevel::DETAILED == m_profilingLevel
+                                   ? QNN_PROFILE_LEVEL_DETAILED
+                                   : QNN_PROFILE_LEVEL_BASIC;
+    if (nullptr == m_qnnFunctionPointers.qnnInterface.profileCreate ||
+        QNN_PROFILE_NO_ERROR != m_qnnFunctionPointers.qnnInterface.profileCreate(
+                                    m_backendHandle, level, &m_profileBackendHandle)) {
+      QNN_WARN("Unable to create profile handle in the backend.");
+      m_profileBackendHandle = nullptr;
+    }
+  }
   return StatusCode::SUCCESS;
 }
 
@@ -215,6 +440,8 @@ app::StatusCode app::QnnApplication::initializeBackend() {
 // object creation. If there are multiple op packages, register
 // them sequentially in the order provided.
 app::StatusCode app::QnnApplication::registerOpPackages() {
+  flightrecorder::Scope traceScope(m_flightRecorder.get(),
+                                   flightrecorder::Phase::REGISTER_OP_PACKAGES);
   const size_t pathIdx              = 0;
   const size_t interfaceProviderIdx = 1;
   for (auto const& opPackagePath : m_opPackagePaths) {
@@ -253,6 +480,7 @@ app::StatusCode app::QnnApplication::registerOpPackages() {
 
 // Create a Context in a backend.
 app::StatusCode app::QnnApplication::createContext() {
+  flightrecorder::Scope traceScope(m_flightRecorder.get(), flightrecorder::Phase::CREATE_CONTEXT);
   if (QNN_CONTEXT_NO_ERROR != m_qnnFunctionPointers.qnnInterface.contextCreate(
                                   m_backendHandle,
                                   m_deviceHandle,
@@ -283,6 +511,7 @@ app::StatusCode app::QnnApplication::freeContext() {
 // say that all intermediate tensors including output tensors
 // are expected to be read by the app.
 app::StatusCode app::QnnApplication::composeGraphs() {
+  flightrecorder::Scope traceScope(m_flightRecorder.get(), flightrecorder::Phase::COMPOSE_GRAPHS);
   auto returnStatus = StatusCode::SUCCESS;
   if (qnn_wrapper_api::ModelError_t::MODEL_NO_ERROR !=
       m_qnnFunctionPointers.composeGraphsFnHandle(
@@ -304,11 +533,19 @@ app::StatusCode app::QnnApplication::composeGraphs() {
 
 app::StatusCode app::QnnApplication::finalizeGraphs() {
   for (size_t graphIdx = 0; graphIdx < m_graphsCount; graphIdx++) {
+    m_flightRecorder->setSample(graphIdx, 0);
+    flightrecorder::Scope traceScope(m_flightRecorder.get(),
+                                     flightrecorder::Phase::FINALIZE_GRAPHS);
+    uint64_t finalizeStartNs = flightrecorder::Recorder::now();
     if (QNN_GRAPH_NO_ERROR !=
         m_qnnFunctionPointers.qnnInterface.graphFinalize(
             (*m_graphsInfo)[graphIdx].graph, m_profileBackendHandle, nullptr)) {
       return StatusCode::FAILURE;
     }
+    if (nullptr != m_profileBackendHandle) {
+      traceProfileEvents(
+          "graphFinalize", finalizeStartNs, flightrecorder::Recorder::now(), graphIdx, -1);
+    }
   }
 
   auto returnStatus = StatusCode::SUCCESS;
@@ -350,6 +587,7 @@ app::StatusCode app::QnnApplication::isDevicePropertySupported() {
 }
 
 app::StatusCode app::QnnApplication::createDevice() {
+  flightrecorder::Scope traceScope(m_flightRecorder.get(), flightrecorder::Phase::CREATE_DEVICE);
   if (nullptr != m_qnnFunctionPointers.qnnInterface.deviceCreate) {
     auto qnnStatus =
         m_qnnFunctionPointers.qnnInterface.deviceCreate(m_logHandle, nullptr, &m_deviceHandle);
@@ -372,6 +610,161 @@ app::StatusCode app::QnnApplication::freeDevice() {
   return StatusCode::SUCCESS;
 }
 
+// QNN only reports the duration of profile events, and the events of the
+// last call that took the profile handle. Events measured in time are laid
+// out one after another from the start of the call, and clipped to it, so
+// they nest under it on the profile track; other events become args.
+void app::QnnApplication::traceProfileEvents(const char* apiName,
+                                             uint64_t startNs,
+                                             uint64_t endNs,
+                                             int64_t graphIdx,
+                                             int64_t sampleIdx) {
+  const QnnProfile_EventId_t* eventIds = nullptr;
+  uint32_t numEvents                   = 0;
+  if (QNN_PROFILE_NO_ERROR != m_qnnFunctionPointers.qnnInterface.profileGetEvents(
+                                  m_profileBackendHandle, &eventIds, &numEvents)) {
+    QNN_WARN("Failure in profile get events.");
+    return;
+  }
+  traceevent::Event event;
+  event.name       = apiName;
+  event.category   = "qnn_profile";
+  event.startNs    = startNs;
+  event.durationNs = endNs - startNs;
+  event.threadId   = traceevent::g_profileThreadId;
+  event.graphIdx   = graphIdx;
+  event.sampleIdx  = sampleIdx;
+  traceProfileEvents(eventIds, numEvents, event);
+  m_traceEvents->add(std::move(event));
+}
+
+void app::QnnApplication::traceProfileEvents(const QnnProfile_EventId_t* eventIds,
+                                             uint32_t numEvents,
+                                             traceevent::Event& parent) {
+  uint64_t cursorNs = parent.startNs;
+  uint64_t endNs    = parent.startNs + parent.durationNs;
+  for (uint32_t eventIdx = 0; eventIdx < numEvents; eventIdx++) {
+    QnnProfile_EventData_t eventData = QNN_PROFILE_EVENT_DATA_INIT;
+    if (QNN_PROFILE_NO_ERROR != m_qnnFunctionPointers.qnnInterface.profileGetEventData(
+                                    eventIds[eventIdx], &eventData)) {
+      QNN_WARN("Failure in profile get event data.");
+      continue;
+    }
+    std::string name  = nullptr != eventData.identifier ? eventData.identifier : "unnamed";
+    std::string value = std::to_string(eventData.value);
+    if (QNN_PROFILE_EVENTUNIT_MICROSEC != eventData.unit) {
+      const char* unit = "";
+      switch (eventData.unit) {
+        case QNN_PROFILE_EVENTUNIT_BYTES:
+          unit = " (bytes)";
+          break;
+        case QNN_PROFILE_EVENTUNIT_CYCLES:
+          unit = " (cycles)";
+          break;
+        case QNN_PROFILE_EVENTUNIT_COUNT:
+          unit = " (count)";
+          break;
+        default:
+          break;
+      }
+      parent.args.emplace_back(name + unit, value);
+      continue;
+    }
+    traceevent::Event event;
+    event.name       = name;
+    event.category   = "qnn_profile";
+    event.startNs    = cursorNs;
+    event.durationNs = std::min(eventData.value * 1000, endNs - cursorNs);
+    event.threadId   = parent.threadId;
+    event.graphIdx   = parent.graphIdx;
+    event.sampleIdx  = parent.sampleIdx;
+    event.args.emplace_back("us", value);
+    const QnnProfile_EventId_t* subEventIds = nullptr;
+    uint32_t numSubEvents                   = 0;
+    if (nullptr != m_qnnFunctionPointers.qnnInterface.profileGetSubEvents &&
+        QNN_PROFILE_NO_ERROR != m_qnnFunctionPointers.qnnInterface.profileGetSubEvents(
+                                    eventIds[eventIdx], &subEventIds, &numSubEvents)) {
+      numSubEvents = 0;
+    }
+    traceProfileEvents(subEventIds, numSubEvents, event);
+    cursorNs += event.durationNs;
+    m_traceEvents->add(std::move(event));
+  }
+}
+
+// Execute one graph on already populated inputs and write out its outputs.
+app::StatusCode app::QnnApplication::executeAndWriteOutputs(
+    size_t graphIdx,
+    size_t startIdx,
+    Qnn_Tensor_t* inputs,
+    Qnn_Tensor_t* outputs,
+    qnn_wrapper_api::GraphInfo_t& graphInfo) {
+  QNN_DEBUG("Successfully populated input tensors for graphIdx: %d", graphIdx);
+  {
+    flightrecorder::Scope traceScope(m_flightRecorder.get(), flightrecorder::Phase::MAP_OUTPUTS);
+    if (iotensor::StatusCode::SUCCESS != m_ioTensor.mapOutputTensors(graphIdx,
+                                                                     startIdx,
+                                                                     graphInfo.graphName,
+                                                                     outputs,
+                                                                     graphInfo.numOutputTensors,
+                                                                     m_outputDataType,
+                                                                     m_graphsCount,
+                                                                     m_outputPath)) {
+      return StatusCode::FAILURE;
+    }
+  }
+  // The previous sample's outputs are written from the output buffers, which
+  // execution is about to overwrite.
+  if (iotensor::StatusCode::SUCCESS != m_ioTensor.flushOutputs()) {
+    return StatusCode::FAILURE;
+  }
+  Qnn_ErrorHandle_t executeStatus = QNN_GRAPH_NO_ERROR;
+  uint64_t executeStartNs =
+      nullptr != m_profileBackendHandle ? flightrecorder::Recorder::now() : 0;
+  {
+    flightrecorder::Scope traceScope(m_flightRecorder.get(), flightrecorder::Phase::EXECUTE);
+    metrics::ScopedTimer executeTimer(g_graphExecuteSeconds);
+    perfcounters::Scope perfScope(perfcounters::Stage::EXECUTE);
+    if (perfScope.isActive()) {
+      perfScope.addBytes(getClientBufBytes(inputs, graphInfo.numInputTensors) +
+                         getClientBufBytes(outputs, graphInfo.numOutputTensors));
+    }
+    executeStatus = m_qnnFunctionPointers.qnnInterface.graphExecute(graphInfo.graph,
+                                                                    inputs,
+                                                                    graphInfo.numInputTensors,
+                                                                    outputs,
+                                                                    graphInfo.numOutputTensors,
+                                                                    m_profileBackendHandle,
+                                                                    nullptr);
+  }
+  g_graphExecutions.add();
+  if (QNN_GRAPH_NO_ERROR != executeStatus) {
+    g_graphExecutionFailures.add();
+    return StatusCode::FAILURE;
+  }
+  if (nullptr != m_profileBackendHandle) {
+    traceProfileEvents("graphExecute",
+                       executeStartNs,
+                       flightrecorder::Recorder::now(),
+                       graphIdx,
+                       static_cast<int64_t>(startIdx));
+  }
+  QNN_DEBUG("Successfully executed graphIdx: %d ", graphIdx);
+  flightrecorder::Scope traceScope(m_flightRecorder.get(), flightrecorder::Phase::WRITE_OUTPUTS);
+  if (iotensor::StatusCode::SUCCESS != m_ioTensor.writeOutputTensors(graphIdx,
+                                                                     startIdx,
+                                                                     graphInfo.graphName,
+                                                                     outputs,
+                                                                     graphInfo.numOutputTensors,
+                                                                     m_outputDataType,
+                                                                     m_graphsCount,
+                                                                     m_outputPath)) {
+    return StatusCode::FAILURE;
+  }
+  g_samplesExecuted.add();
+  return StatusCode::SUCCESS;
+}
+
 // executeGraphs() that is currently used by qnn-mobile-app's main.cpp.
 // This function runs all the graphs present in model.so by reading
 // inputs from input_list based files and writes output to .raw files.
@@ -386,60 +779,159 @@ app::StatusCode app::QnnApplication::executeGraphs() {
     }
     Qnn_Tensor_t* inputs  = nullptr;
     Qnn_Tensor_t* outputs = nullptr;
-    if (iotensor::StatusCode::SUCCESS !=
-        m_ioTensor.setupInputAndOutputTensors(&inputs, &outputs, (*m_graphsInfo)[graphIdx])) {
-      QNN_ERROR("Error in setting up Input and output Tensors for graphIdx: %d", graphIdx);
-      returnStatus = StatusCode::FAILURE;
-      break;
+    m_flightRecorder->setSample(graphIdx, 0);
+    memaccount::getAccountant().setGraph(static_cast<uint32_t>(graphIdx));
+    {
+      flightrecorder::Scope traceScope(m_flightRecorder.get(),
+                                       flightrecorder::Phase::SETUP_TENSORS);
+      if (iotensor::StatusCode::SUCCESS !=
+          m_ioTensor.setupInputAndOutputTensors(&inputs, &outputs, (*m_graphsInfo)[graphIdx])) {
+        QNN_ERROR("Error in setting up Input and output Tensors for graphIdx: %d", graphIdx);
+        returnStatus = StatusCode::FAILURE;
+        break;
+      }
     }
-    auto inputFileList = m_inputFileLists[graphIdx];
-    auto graphInfo     = (*m_graphsInfo)[graphIdx];
-    if (!inputFileList.empty()) {
-      size_t totalCount = inputFileList[0].size();
-      while (!inputFileList[0].empty()) {
-        size_t startIdx = (totalCount - inputFileList[0].size());
-        if (iotensor::StatusCode::SUCCESS !=
-            m_ioTensor.populateInputTensors(
-                graphIdx, inputFileList, inputs, graphInfo, m_inputDataType)) {
-          returnStatus = StatusCode::FAILURE;
+    auto& inputFileList  = m_inputFileLists[graphIdx];
+    auto graphInfo       = (*m_graphsInfo)[graphIdx];
+    auto inputListReader = m_inputListReaders[graphIdx];
+    auto inputDataset    = m_inputDatasets[graphIdx];
+    if (nullptr != m_inputStream) {
+      // Samples are numbered in arrival order until the producer closes the
+      // stream.
+      for (size_t startIdx = 0;; startIdx++) {
+        m_flightRecorder->setSample(graphIdx, startIdx);
+        flightrecorder::Scope sampleScope(m_flightRecorder.get(), flightrecorder::Phase::SAMPLE);
+        bool endOfStream = false;
+        {
+          flightrecorder::Scope traceScope(m_flightRecorder.get(),
+                                           flightrecorder::Phase::POPULATE_INPUTS);
+          if (iotensor::StatusCode::SUCCESS !=
+              m_ioTensor.populateInputTensors(
+                  graphIdx, *m_inputStream, inputs, graphInfo, m_inputDataType, endOfStream)) {
+            returnStatus = StatusCode::FAILURE;
+          }
+        }
+        if (StatusCode::SUCCESS == returnStatus && endOfStream) {
+          QNN_INFO("Input stream ended after %zu samples", startIdx);
+          break;
         }
         if (StatusCode::SUCCESS == returnStatus) {
-          QNN_DEBUG("Successfully populated input tensors for graphIdx: %d", graphIdx);
-          Qnn_ErrorHandle_t executeStatus = QNN_GRAPH_NO_ERROR;
-          executeStatus =
-              m_qnnFunctionPointers.qnnInterface.graphExecute(graphInfo.graph,
-                                                              inputs,
-                                                              graphInfo.numInputTensors,
-                                                              outputs,
-                                                              graphInfo.numOutputTensors,
-                                                              m_profileBackendHandle,
-                                                              nullptr);
-          if (QNN_GRAPH_NO_ERROR != executeStatus) {
+          returnStatus = executeAndWriteOutputs(graphIdx, startIdx, inputs, outputs, graphInfo);
+        }
+        if (StatusCode::SUCCESS != returnStatus) {
+          QNN_ERROR("Execution of Graph: %d failed!", graphIdx);
+          break;
+        }
+      }
+    } else if (nullptr != inputDataset && inputDataset->getNumTensors() > 0) {
+      std::vector<size_t> recordCursors(inputDataset->getNumTensors(), 0);
+      size_t totalCount = inputDataset->getTensorRecords(0).size();
+      if (iotensor::StatusCode::SUCCESS !=
+          m_ioTensor.prepareOutputDirs(
+              graphIdx, graphInfo.graphName, m_graphsCount, 0, totalCount)) {
+        returnStatus = StatusCode::FAILURE;
+      }
+      while (StatusCode::SUCCESS == returnStatus && recordCursors[0] < totalCount) {
+        size_t startIdx = recordCursors[0];
+        m_flightRecorder->setSample(graphIdx, startIdx);
+        flightrecorder::Scope sampleScope(m_flightRecorder.get(), flightrecorder::Phase::SAMPLE);
+        {
+          flightrecorder::Scope traceScope(m_flightRecorder.get(),
+                                           flightrecorder::Phase::POPULATE_INPUTS);
+          if (iotensor::StatusCode::SUCCESS !=
+              m_ioTensor.populateInputTensors(
+                  graphIdx, *inputDataset, recordCursors, inputs, graphInfo, m_inputDataType)) {
             returnStatus = StatusCode::FAILURE;
           }
-          if (StatusCode::SUCCESS == returnStatus) {
-            QNN_DEBUG("Successfully executed graphIdx: %d ", graphIdx);
-            if (iotensor::StatusCode::SUCCESS !=
-                m_ioTensor.writeOutputTensors(graphIdx,
-                                              startIdx,
-                                              graphInfo.graphName,
-                                              outputs,
-                                              graphInfo.numOutputTensors,
-                                              m_outputDataType,
-                                              m_graphsCount,
-                                              m_outputPath)) {
-              returnStatus = StatusCode::FAILURE;
-            }
+        }
+        if (StatusCode::SUCCESS == returnStatus) {
+          returnStatus = executeAndWriteOutputs(graphIdx, startIdx, inputs, outputs, graphInfo);
+        }
+        if (StatusCode::SUCCESS != returnStatus) {
+          QNN_ERROR("Execution of Graph: %d failed!", graphIdx);
+          break;
+        }
+      }
+    } else if (nullptr != inputListReader) {
+      // Result directories are created a window at a time, as samples are
+      // parsed.
+      std::unique_ptr<readahead::Scheduler> inputReadahead;
+      if (m_inputReadahead) {
+        inputReadahead.reset(new readahead::Scheduler());
+      }
+      datautil::AsyncInputReader* asyncInputReader = m_ioTensor.getAsyncInputReader();
+      size_t numRead = inputListReader->readSamples(
+          inputFileList, s_inputListWindow, inputReadahead.get(), asyncInputReader);
+      if (nullptr != inputReadahead) {
+        inputReadahead->consume(0);
+      }
+      if (iotensor::StatusCode::SUCCESS !=
+          m_ioTensor.prepareOutputDirs(graphIdx, graphInfo.graphName, m_graphsCount, 0, numRead)) {
+        returnStatus = StatusCode::FAILURE;
+      }
+      while (StatusCode::SUCCESS == returnStatus && !inputFileList.empty() &&
+             !inputFileList[0].empty()) {
+        size_t numQueued = inputFileList[0].size();
+        size_t startIdx  = (inputListReader->getNumSamplesRead() - numQueued);
+        m_flightRecorder->setSample(graphIdx, startIdx);
+        flightrecorder::Scope sampleScope(m_flightRecorder.get(), flightrecorder::Phase::SAMPLE);
+        {
+          flightrecorder::Scope traceScope(m_flightRecorder.get(),
+                                           flightrecorder::Phase::POPULATE_INPUTS);
+          if (iotensor::StatusCode::SUCCESS !=
+              m_ioTensor.populateInputTensors(
+                  graphIdx, inputFileList, inputs, graphInfo, m_inputDataType)) {
+            returnStatus = StatusCode::FAILURE;
           }
         }
+        if (StatusCode::SUCCESS == returnStatus) {
+          returnStatus = executeAndWriteOutputs(graphIdx, startIdx, inputs, outputs, graphInfo);
+        }
         if (StatusCode::SUCCESS != returnStatus) {
           QNN_ERROR("Execution of Graph: %d failed!", graphIdx);
           break;
         }
+        if (nullptr != inputReadahead) {
+          inputReadahead->consume(numQueued - inputFileList[0].size());
+        }
+        g_inputListQueued.set(static_cast<int64_t>(inputFileList[0].size()));
+        // Keep a bounded window of parsed samples ahead of execution.
+        if (inputFileList[0].size() < s_inputListWindow) {
+          flightrecorder::Scope traceScope(m_flightRecorder.get(),
+                                           flightrecorder::Phase::READ_INPUT_LIST);
+          numRead = inputListReader->readSamples(inputFileList,
+                                                 s_inputListWindow - inputFileList[0].size(),
+                                                 inputReadahead.get(),
+                                                 asyncInputReader);
+          if (iotensor::StatusCode::SUCCESS !=
+              m_ioTensor.prepareOutputDirs(graphIdx,
+                                           graphInfo.graphName,
+                                           m_graphsCount,
+                                           inputListReader->getNumSamplesRead() - numRead,
+                                           numRead)) {
+            returnStatus = StatusCode::FAILURE;
+            break;
+          }
+        }
       }
+      if (nullptr != inputReadahead) {
+        inputReadahead->logSummary();
+      }
+      if (nullptr != asyncInputReader) {
+        asyncInputReader->logSummary();
+      }
+    }
+    // Outputs written behind execution must be on disk before the graph's
+    // run counts as done.
+    if (iotensor::StatusCode::SUCCESS != m_ioTensor.flushOutputs()) {
+      returnStatus = StatusCode::FAILURE;
+    }
+    {
+      flightrecorder::Scope traceScope(m_flightRecorder.get(),
+                                       flightrecorder::Phase::TEAR_DOWN_TENSORS);
+      m_ioTensor.tearDownInputAndOutputTensors(
+          inputs, outputs, graphInfo.numInputTensors, graphInfo.numOutputTensors);
     }
-    m_ioTensor.tearDownInputAndOutputTensors(
-        inputs, outputs, graphInfo.numInputTensors, graphInfo.numOutputTensors);
     inputs  = nullptr;
     outputs = nullptr;
     if (StatusCode::SUCCESS != returnStatus) {
@@ -447,6 +939,24 @@ app::StatusCode app::QnnApplication::executeGraphs() {
     }
   }
 
+  // A container is only readable once finalized, so finalize it even when
+  // execution stopped early to keep the outputs written so far.
+  if (nullptr != m_outputContainer && m_outputContainer->isOpen() &&
+      packedcontainer::StatusCode::SUCCESS != m_outputContainer->finalize()) {
+    QNN_ERROR("Failed to finalize output container: %s", m_outputContainerPath.c_str());
+    returnStatus = StatusCode::FAILURE;
+  }
+
+  if (nullptr != m_outputComparator) {
+    m_outputComparator->logSummary();
+    if (m_outputComparator->getNumFailed() > 0) {
+      QNN_ERROR("%zu of %zu outputs differ from the reference outputs",
+                m_outputComparator->getNumFailed(),
+                m_outputComparator->getNumCompared());
+      returnStatus = StatusCode::FAILURE;
+    }
+  }
+
   qnn_wrapper_api::freeGraphsInfo(&m_graphsInfo, m_graphsCount);
   m_graphsInfo = nullptr;
   return returnStatus;
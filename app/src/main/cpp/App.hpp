@@ -13,7 +13,19 @@
 #include "IOTensor.hpp"
 
 #include "DataUtil.hpp"
+#include "FlightRecorder.hpp"
+#include "FrameStream.hpp"
+#include "InputListReader.hpp"
 #include "Logger.hpp"
+#include "ApiTiming.hpp"
+#include "MemoryAccounting.hpp"
+#include "Metrics.hpp"
+#include "OutputCompare.hpp"
+#include "OutputLayout.hpp"
+#include "PackedContainer.hpp"
+#include "PerfCounters.hpp"
+#include "Readahead.hpp"
+#include "TraceEvent.hpp"
 #include "PAL/Directory.hpp"
 #include "PAL/FileOp.hpp"
 #include "PAL/Path.hpp"
@@ -51,6 +63,10 @@ enum class StatusCode {
   QNN_FEATURE_UNSUPPORTED
 };
 
+enum class ProfilingLevel { OFF, BASIC, DETAILED, INVALID };
+
+ProfilingLevel parseProfilingLevel(std::string levelString);
+
 class QnnApplication {
  public:
   QnnApplication(func::QnnFunctionPointers qnnFunctionPointers,
@@ -89,16 +105,182 @@ class QnnApplication {
 
   StatusCode verifyFailReturnStatus(Qnn_ErrorHandle_t errCode);
 
+  // Bind native input files to file mappings instead of copying them.
+  void setInputMapping(iotensor::InputMapping inputMapping) {
+    m_ioTensor.setInputMapping(inputMapping);
+  }
+
+  // Read input files with O_DIRECT, bypassing the page cache.
+  void setInputDirectIo(bool inputDirectIo) {
+    m_inputDirectIo = inputDirectIo;
+    m_ioTensor.setInputDirectIo(inputDirectIo);
+  }
+
+  // Prefetch the input files of upcoming input list samples into the page
+  // cache and drop them once executed.
+  void setInputReadahead(bool inputReadahead) { m_inputReadahead = inputReadahead; }
+
+  // Let the graph write native outputs straight into mapped output files.
+  void setOutputMapping(bool outputMapping) { m_ioTensor.setOutputMapping(outputMapping); }
+
+  // Read inputs and write outputs through an asynchronous I/O backend.
+  void setIoBackend(asyncio::Backend ioBackend) {
+    auto ioEngine = asyncio::createEngine(ioBackend);
+    if (nullptr != ioEngine) {
+      QNN_INFO("Using %s I/O backend", asyncio::getBackendName(ioEngine->getBackend()).c_str());
+    }
+    m_ioTensor.setIoEngine(ioEngine);
+  }
+
+  // Append all outputs to a single packed container at containerPath instead
+  // of writing Result_N directories. preallocateBytes is the fallocate()
+  // step used while the container grows, zero to disable. The container is
+  // checkpointed every 64 MiB of outputs; a run that dies before finishing
+  // leaves a container holding the outputs up to its last checkpoint.
+  void setOutputContainer(const std::string &containerPath, size_t preallocateBytes) {
+    m_outputContainerPath    = containerPath;
+    m_outputPreallocateBytes = preallocateBytes;
+  }
+
+  // Write a line of output hashes per sample to output_hashes.txt in the
+  // output directory instead of writing the outputs themselves.
+  void setOutputHash(iotensor::OutputHash outputHash, bool withStats) {
+    m_outputHash          = outputHash;
+    m_outputHashWithStats = withStats;
+  }
+
+  // Compare outputs against the reference outputs at referencePath, an output
+  // directory or output container, instead of writing them.
+  void setCompareWith(const std::string &referencePath,
+                      const outputcompare::Tolerance &tolerance,
+                      bool failFast) {
+    m_compareWithPath  = referencePath;
+    m_compareTolerance = tolerance;
+    m_compareFailFast  = failFast;
+  }
+
+  // Read input frames from inputStreamPath instead of an input list, and/or
+  // write output frames to outputStreamPath instead of files. "-" selects
+  // stdin or stdout; anything else is typically a FIFO.
+  void setFrameStreams(const std::string &inputStreamPath,
+                       const std::string &outputStreamPath,
+                       framestream::Framing framing) {
+    m_inputStreamPath  = inputStreamPath;
+    m_outputStreamPath = outputStreamPath;
+    m_streamFraming    = framing;
+  }
+
+  // Record the timing of each phase and sample into a binary ring at
+  // tracePath, decoded with qnn-flight-decode. Enabled by default; an empty
+  // tracePath puts the ring in the output directory.
+  void setFlightRecorder(bool enabled, const std::string &tracePath) {
+    m_flightRecorderEnabled = enabled;
+    m_flightRecorderPath    = tracePath;
+  }
+
+  // Write runtime metrics in Prometheus text format to metricsPath every
+  // interval and at exit.
+  void setMetricsExport(const std::string &metricsPath, std::chrono::milliseconds interval) {
+    m_metricsPath     = metricsPath;
+    m_metricsInterval = interval;
+  }
+
+  // Write a Chrome trace event JSON timeline of all phases to tracePath as
+  // the run goes, opened with chrome://tracing or ui.perfetto.dev.
+  void setTraceJson(const std::string &tracePath) { m_traceJsonPath = tracePath; }
+
+  // Collect QNN profile events from the backend into the trace JSON
+  // timeline.
+  void setProfilingLevel(ProfilingLevel profilingLevel) { m_profilingLevel = profilingLevel; }
+
+  // Print current and peak tensor memory per graph and category to stderr
+  // at exit and whenever SIGUSR1 is received.
+  void setMemoryReport(bool memoryReport) { m_memoryReport = memoryReport; }
+
+  // Count cycles, instructions, cache and branch misses and context switches
+  // per stage with perf_event_open and print them to stderr at exit.
+  void setPerfCounters(bool perfCounters) { m_perfCounters = perfCounters; }
+
+  // Time every QNN API call, including the ones the model makes while
+  // composing graphs, and print calls, latency and bytes per API to stderr
+  // at exit. Must be set before any QNN API is called.
+  void setApiTiming(bool apiTiming) {
+    m_apiTiming = apiTiming;
+    if (m_apiTiming) {
+      apitiming::interpose(m_qnnFunctionPointers);
+    }
+  }
+
   virtual ~QnnApplication();
 
  private:
   static const std::string s_defaultOutputPath;
+  static const size_t s_inputListWindow;
+  static const size_t s_outputWriteBehindBytes;
+  static const size_t s_outputCheckpointBytes;
+  static const std::string s_outputHashFileName;
+
+  StatusCode executeAndWriteOutputs(size_t graphIdx,
+                                    size_t startIdx,
+                                    Qnn_Tensor_t* inputs,
+                                    Qnn_Tensor_t* outputs,
+                                    qnn_wrapper_api::GraphInfo_t& graphInfo);
+
+  // Adds the profile events of the QNN API call apiName, which ran from
+  // startNs to endNs, to the trace JSON timeline. sampleIdx is -1 outside
+  // execution.
+  void traceProfileEvents(const char* apiName,
+                          uint64_t startNs,
+                          uint64_t endNs,
+                          int64_t graphIdx,
+                          int64_t sampleIdx);
+
+  // Adds eventIds, and their sub-events, as children of parent.
+  void traceProfileEvents(const QnnProfile_EventId_t* eventIds,
+                          uint32_t numEvents,
+                          traceevent::Event& parent);
 
   func::QnnFunctionPointers m_qnnFunctionPointers;
   std::vector<std::string> m_inputListPaths;
+  // Per graph, the parsed window of the input list and the reader it is
+  // refilled from during execution.
   std::vector<std::vector<std::queue<std::string>>> m_inputFileLists;
+  std::vector<std::shared_ptr<inputlist::Reader>> m_inputListReaders;
+  // Per graph, set instead of m_inputFileLists when the input list is a
+  // packed dataset container.
+  std::vector<std::shared_ptr<packedcontainer::Reader>> m_inputDatasets;
+  bool m_inputReadahead = false;
+  bool m_inputDirectIo  = false;
   std::vector<std::string> m_opPackagePaths;
   std::string m_outputPath;
+  std::string m_outputContainerPath;
+  size_t m_outputPreallocateBytes = 0;
+  std::shared_ptr<packedcontainer::Writer> m_outputContainer;
+  iotensor::OutputHash m_outputHash = iotensor::OutputHash::NONE;
+  bool m_outputHashWithStats        = false;
+  std::string m_compareWithPath;
+  outputcompare::Tolerance m_compareTolerance;
+  bool m_compareFailFast = false;
+  std::shared_ptr<outputcompare::Comparator> m_outputComparator;
+  std::string m_inputStreamPath;
+  std::string m_outputStreamPath;
+  framestream::Framing m_streamFraming = framestream::Framing::LENGTH_PREFIXED;
+  std::shared_ptr<framestream::Reader> m_inputStream;
+  bool m_flightRecorderEnabled = true;
+  std::string m_flightRecorderPath;
+  // Always set; records nothing unless opened.
+  std::shared_ptr<flightrecorder::Recorder> m_flightRecorder =
+      std::make_shared<flightrecorder::Recorder>();
+  std::string m_metricsPath;
+  std::chrono::milliseconds m_metricsInterval{0};
+  // Writes the last snapshot when destroyed with the application.
+  metrics::Exporter m_metricsExporter;
+  std::string m_traceJsonPath;
+  std::shared_ptr<traceevent::Writer> m_traceEvents;
+  ProfilingLevel m_profilingLevel = ProfilingLevel::OFF;
+  bool m_memoryReport             = false;
+  bool m_perfCounters             = false;
+  bool m_apiTiming                = false;
   QnnBackend_Config_t **m_backendConfig = nullptr;
   Qnn_ContextHandle_t m_context         = nullptr;
   QnnContext_Config_t **m_contextConfig = nullptr;
@@ -0,0 +1,664 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cwchar>
+#include <system_error>
+
+#include <sys/types.h>
+
+#include "AsyncLogger.hpp"
+#include "LogUtils.hpp"
+
+using namespace qnn::log::utils;
+
+namespace {
+
+// Formatted output is written once this much is pending or the ring is empty.
+const size_t g_outputCapacity = 64 * 1024;
+
+// Room kept free in the output buffer for the next message.
+const size_t g_outputReserve = 8 * 1024;
+
+// Longest pause of the background thread while nothing is logged.
+const std::chrono::milliseconds g_maxIdle(50);
+
+// Argument types of printf conversions, after default promotions.
+enum class ArgType {
+  NONE,
+  INT,
+  LONG,
+  LONG_LONG,
+  INTMAX,
+  SSIZE,
+  PTRDIFF,
+  UINT,
+  ULONG,
+  ULONG_LONG,
+  UINTMAX,
+  SIZE,
+  WINT,
+  DOUBLE,
+  LONG_DOUBLE,
+  STRING,
+  POINTER,
+  UNSUPPORTED,
+};
+
+struct Conversion {
+  // From the '%' to one past the conversion character.
+  const char* begin;
+  const char* end;
+  // Width and precision given as '*', each taking an int argument.
+  int numStars;
+  ArgType type;
+};
+
+ArgType getArgType(char conversion, const char* length) {
+  bool hasL  = ('l' == length[0] && 'l' != length[1]);
+  bool hasLL = ('l' == length[0] && 'l' == length[1]) || 'q' == length[0];
+  switch (conversion) {
+    case '%':
+      return ArgType::NONE;
+    case 'd':
+    case 'i':
+      if (hasLL) {
+        return ArgType::LONG_LONG;
+      }
+      if (hasL) {
+        return ArgType::LONG;
+      }
+      if ('j' == length[0]) {
+        return ArgType::INTMAX;
+      }
+      if ('z' == length[0]) {
+        return ArgType::SSIZE;
+      }
+      if ('t' == length[0]) {
+        return ArgType::PTRDIFF;
+      }
+      return ArgType::INT;
+    case 'u':
+    case 'o':
+    case 'x':
+    case 'X':
+      if (hasLL) {
+        return ArgType::ULONG_LONG;
+      }
+      if (hasL) {
+        return ArgType::ULONG;
+      }
+      if ('j' == length[0]) {
+        return ArgType::UINTMAX;
+      }
+      if ('z' == length[0]) {
+        return ArgType::SIZE;
+      }
+      if ('t' == length[0]) {
+        return ArgType::PTRDIFF;
+      }
+      return ArgType::UINT;
+    case 'c':
+      return hasL ? ArgType::WINT : ArgType::INT;
+    case 'e':
+    case 'E':
+    case 'f':
+    case 'F':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+      return ('L' == length[0]) ? ArgType::LONG_DOUBLE : ArgType::DOUBLE;
+    case 's':
+      return hasL ? ArgType::UNSUPPORTED : ArgType::STRING;
+    case 'p':
+      return ArgType::POINTER;
+    default:
+      // %n, %ls, positional arguments and anything unknown.
+      return ArgType::UNSUPPORTED;
+  }
+}
+
+// Finds the next conversion at or after p. Returns false if there is none.
+bool nextConversion(const char* p, Conversion& conversion) {
+  p = strchr(p, '%');
+  if (nullptr == p) {
+    return false;
+  }
+  conversion.begin    = p++;
+  conversion.numStars = 0;
+  while ('\0' != *p && nullptr != strchr("-+ #0'", *p)) {
+    p++;
+  }
+  bool positional = false;
+  if ('*' == *p) {
+    conversion.numStars++;
+    p++;
+  } else {
+    while (*p >= '0' && *p <= '9') {
+      p++;
+    }
+    positional = ('$' == *p);
+  }
+  if ('.' == *p) {
+    p++;
+    if ('*' == *p) {
+      conversion.numStars++;
+      p++;
+    } else {
+      while (*p >= '0' && *p <= '9') {
+        p++;
+      }
+    }
+  }
+  const char* length = p;
+  while ('\0' != *p && nullptr != strchr("hljztLq", *p)) {
+    p++;
+  }
+  char lengthChars[3] = {'\0', '\0', '\0'};
+  memcpy(lengthChars, length, std::min<size_t>(static_cast<size_t>(p - length), 2));
+  conversion.type = positional ? ArgType::UNSUPPORTED : getArgType(*p, lengthChars);
+  if ('\0' != *p) {
+    p++;
+  }
+  conversion.end = p;
+  return true;
+}
+
+class Packer {
+ public:
+  Packer(uint8_t* data, size_t capacity) : m_data(data), m_capacity(capacity), m_size(0) {}
+
+  template <typename T>
+  bool put(T value) {
+    if (m_size + sizeof(T) > m_capacity) {
+      return false;
+    }
+    memcpy(m_data + m_size, &value, sizeof(T));
+    m_size += sizeof(T);
+    return true;
+  }
+
+  // Stores the string with its terminator.
+  bool putString(const char* value) {
+    size_t length = strlen(value) + 1;
+    if (m_size + length > m_capacity) {
+      return false;
+    }
+    memcpy(m_data + m_size, value, length);
+    m_size += length;
+    return true;
+  }
+
+  size_t size() const { return m_size; }
+
+ private:
+  uint8_t* m_data;
+  size_t m_capacity;
+  size_t m_size;
+};
+
+class Unpacker {
+ public:
+  explicit Unpacker(const uint8_t* data) : m_data(data), m_offset(0) {}
+
+  template <typename T>
+  T get() {
+    T value;
+    memcpy(&value, m_data + m_offset, sizeof(T));
+    m_offset += sizeof(T);
+    return value;
+  }
+
+  const char* getString() {
+    const char* value = reinterpret_cast<const char*>(m_data + m_offset);
+    m_offset += strlen(value) + 1;
+    return value;
+  }
+
+ private:
+  const uint8_t* m_data;
+  size_t m_offset;
+};
+
+bool packArguments(const char* fmt, va_list argp, Packer& packer) {
+  Conversion conversion;
+  for (const char* p = fmt; nextConversion(p, conversion); p = conversion.end) {
+    for (int star = 0; star < conversion.numStars; star++) {
+      if (!packer.put(va_arg(argp, int))) {
+        return false;
+      }
+    }
+    bool packed = true;
+    switch (conversion.type) {
+      case ArgType::NONE:
+        break;
+      case ArgType::INT:
+        packed = packer.put(va_arg(argp, int));
+        break;
+      case ArgType::LONG:
+        packed = packer.put(va_arg(argp, long));
+        break;
+      case ArgType::LONG_LONG:
+        packed = packer.put(va_arg(argp, long long));
+        break;
+      case ArgType::INTMAX:
+        packed = packer.put(va_arg(argp, intmax_t));
+        break;
+      case ArgType::SSIZE:
+        packed = packer.put(va_arg(argp, ssize_t));
+        break;
+      case ArgType::PTRDIFF:
+        packed = packer.put(va_arg(argp, ptrdiff_t));
+        break;
+      case ArgType::UINT:
+        packed = packer.put(va_arg(argp, unsigned int));
+        break;
+      case ArgType::ULONG:
+        packed = packer.put(va_arg(argp, unsigned long));
+        break;
+      case ArgType::ULONG_LONG:
+        packed = packer.put(va_arg(argp, unsigned long long));
+        break;
+      case ArgType::UINTMAX:
+        packed = packer.put(va_arg(argp, uintmax_t));
+        break;
+      case ArgType::SIZE:
+        packed = packer.put(va_arg(argp, size_t));
+        break;
+      case ArgType::WINT:
+        packed = packer.put(va_arg(argp, wint_t));
+        break;
+      case ArgType::DOUBLE:
+        packed = packer.put(va_arg(argp, double));
+        break;
+      case ArgType::LONG_DOUBLE:
+        packed = packer.put(va_arg(argp, long double));
+        break;
+      case ArgType::STRING: {
+        const char* value = va_arg(argp, const char*);
+        packed            = packer.putString(nullptr != value ? value : "(null)");
+        break;
+      }
+      case ArgType::POINTER:
+        packed = packer.put(va_arg(argp, void*));
+        break;
+      case ArgType::UNSUPPORTED:
+        packed = false;
+        break;
+    }
+    if (!packed) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename T>
+int formatValue(char* out, size_t size, const char* spec, const int* stars, int numStars, T value) {
+  switch (numStars) {
+    case 0:
+      return snprintf(out, size, spec, value);
+    case 1:
+      return snprintf(out, size, spec, stars[0], value);
+    default:
+      return snprintf(out, size, spec, stars[0], stars[1], value);
+  }
+}
+
+// Formats one conversion into out, reading its arguments from unpacker.
+// Returns the number of characters written.
+size_t formatConversion(char* out, size_t size, const Conversion& conversion, Unpacker& unpacker) {
+  int stars[2] = {0, 0};
+  for (int star = 0; star < conversion.numStars; star++) {
+    stars[star] = unpacker.get<int>();
+  }
+  char spec[32];
+  size_t specLength = static_cast<size_t>(conversion.end - conversion.begin);
+  if (specLength >= sizeof(spec)) {
+    specLength = sizeof(spec) - 1;
+  }
+  memcpy(spec, conversion.begin, specLength);
+  spec[specLength] = '\0';
+  int n            = 0;
+  switch (conversion.type) {
+    case ArgType::NONE:
+      n = snprintf(out, size, "%%");
+      break;
+    case ArgType::INT:
+      n = formatValue(out, size, spec, stars, conversion.numStars, unpacker.get<int>());
+      break;
+    case ArgType::LONG:
+      n = formatValue(out, size, spec, stars, conversion.numStars, unpacker.get<long>());
+      break;
+    case ArgType::LONG_LONG:
+      n = formatValue(out, size, spec, stars, conversion.numStars, unpacker.get<long long>());
+      break;
+    case ArgType::INTMAX:
+      n = formatValue(out, size, spec, stars, conversion.numStars, unpacker.get<intmax_t>());
+      break;
+    case ArgType::SSIZE:
+      n = formatValue(out, size, spec, stars, conversion.numStars, unpacker.get<ssize_t>());
+      break;
+    case ArgType::PTRDIFF:
+      n = formatValue(out, size, spec, stars, conversion.numStars, unpacker.get<ptrdiff_t>());
+      break;
+    case ArgType::UINT:
+      n = formatValue(out, size, spec, stars, conversion.numStars, unpacker.get<unsigned int>());
+      break;
+    case ArgType::ULONG:
+      n = formatValue(out, size, spec, stars, conversion.numStars, unpacker.get<unsigned long>());
+      break;
+    case ArgType::ULONG_LONG:
+      n = formatValue(
+          out, size, spec, stars, conversion.numStars, unpacker.get<unsigned long long>());
+      break;
+    case ArgType::UINTMAX:
+      n = formatValue(out, size, spec, stars, conversion.numStars, unpacker.get<uintmax_t>());
+      break;
+    case ArgType::SIZE:
+      n = formatValue(out, size, spec, stars, conversion.numStars, unpacker.get<size_t>());
+      break;
+    case ArgType::WINT:
+      n = formatValue(out, size, spec, stars, conversion.numStars, unpacker.get<wint_t>());
+      break;
+    case ArgType::DOUBLE:
+      n = formatValue(out, size, spec, stars, conversion.numStars, unpacker.get<double>());
+      break;
+    case ArgType::LONG_DOUBLE:
+      n = formatValue(out, size, spec, stars, conversion.numStars, unpacker.get<long double>());
+      break;
+    case ArgType::STRING:
+      n = formatValue(out, size, spec, stars, conversion.numStars, unpacker.getString());
+      break;
+    case ArgType::POINTER:
+      n = formatValue(out, size, spec, stars, conversion.numStars, unpacker.get<void*>());
+      break;
+    case ArgType::UNSUPPORTED:
+      break;
+  }
+  if (n < 0) {
+    return 0;
+  }
+  return std::min(static_cast<size_t>(n), size > 0 ? size - 1 : 0);
+}
+
+}  // namespace
+
+AsyncLogger::AsyncLogger()
+    : m_slots(new Slot[s_numSlots]),
+      m_enqueuePosition(0),
+      m_dequeuePosition(0),
+      m_numDropped(0),
+      m_numDroppedReported(0),
+      m_flushRequested(false),
+      m_stopRequested(false),
+      m_running(false),
+      m_accepting(false),
+      m_numProducers(0),
+      m_output(new char[g_outputCapacity]),
+      m_outputSize(0) {
+  for (size_t idx = 0; idx < s_numSlots; idx++) {
+    m_slots[idx].sequence.store(idx, std::memory_order_relaxed);
+  }
+}
+
+AsyncLogger::~AsyncLogger() {
+  stop();
+  delete[] m_slots;
+  delete[] m_output;
+}
+
+bool AsyncLogger::start() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_running) {
+    return true;
+  }
+  try {
+    m_thread = std::thread(&AsyncLogger::run, this);
+  } catch (const std::system_error&) {
+    return false;
+  }
+  m_stopRequested = false;
+  m_running       = true;
+  m_accepting.store(true);
+  return true;
+}
+
+void AsyncLogger::stop() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_running) {
+      return;
+    }
+  }
+  // Producers that missed the flag publish their messages, or fall back from
+  // waiting on a full ring, before the final drain.
+  m_accepting.store(false);
+  while (m_numProducers.load() > 0) {
+    m_wake.notify_one();
+    std::this_thread::yield();
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopRequested = true;
+  }
+  m_wake.notify_one();
+  m_thread.join();
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_running = false;
+  m_drained.notify_all();
+}
+
+AsyncLogger::Slot* AsyncLogger::claim(size_t& position) {
+  position = m_enqueuePosition.load(std::memory_order_relaxed);
+  while (true) {
+    Slot* slot        = &m_slots[position % s_numSlots];
+    size_t sequence   = slot->sequence.load(std::memory_order_acquire);
+    intptr_t distance = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+    if (0 == distance) {
+      if (m_enqueuePosition.compare_exchange_weak(
+              position, position + 1, std::memory_order_relaxed)) {
+        return slot;
+      }
+    } else if (distance < 0) {
+      return nullptr;
+    } else {
+      position = m_enqueuePosition.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+void AsyncLogger::log(const char* fmt,
+                      QnnLog_Level_t level,
+                      uint64_t timestamp,
+                      va_list argp,
+                      bool copyFormat) {
+  // Sequentially consistent with stop(): either it waits for this producer,
+  // or this producer sees that it has stopped accepting.
+  m_numProducers.fetch_add(1);
+  if (!m_accepting.load()) {
+    m_numProducers.fetch_sub(1);
+    logStdoutCallback(fmt, level, timestamp, argp);
+    return;
+  }
+  size_t position;
+  Slot* slot = claim(position);
+  while (nullptr == slot) {
+    if (level > QNN_LOG_LEVEL_WARN) {
+      m_numDropped.fetch_add(1, std::memory_order_relaxed);
+      m_numProducers.fetch_sub(1);
+      return;
+    }
+    if (!m_accepting.load()) {
+      m_numProducers.fetch_sub(1);
+      logStdoutCallback(fmt, level, timestamp, argp);
+      return;
+    }
+    m_wake.notify_one();
+    std::this_thread::yield();
+    slot = claim(position);
+  }
+  slot->timestamp = timestamp;
+  slot->level     = level;
+  slot->fmt       = fmt;
+  size_t offset   = 0;
+  if (copyFormat) {
+    size_t length = strlen(fmt) + 1;
+    if (length <= s_dataSize) {
+      memcpy(slot->data, fmt, length);
+      slot->fmt = reinterpret_cast<const char*>(slot->data);
+      offset    = length;
+    } else {
+      slot->fmt = nullptr;
+    }
+  }
+  va_list packArgp;
+  va_copy(packArgp, argp);
+  Packer packer(slot->data + offset, s_dataSize - offset);
+  if (nullptr != slot->fmt && packArguments(fmt, packArgp, packer)) {
+    slot->kind = Kind::PACKED;
+    slot->size = static_cast<uint16_t>(offset + packer.size());
+  } else {
+    int n      = vsnprintf(reinterpret_cast<char*>(slot->data), s_dataSize, fmt, argp);
+    slot->kind = Kind::PREFORMATTED;
+    slot->size = static_cast<uint16_t>(std::max(0, std::min(n, static_cast<int>(s_dataSize) - 1)));
+  }
+  va_end(packArgp);
+  slot->sequence.store(position + 1, std::memory_order_release);
+  m_numProducers.fetch_sub(1);
+  if (QNN_LOG_LEVEL_ERROR == level) {
+    flush();
+  } else if (position - m_dequeuePosition.load(std::memory_order_relaxed) == s_numSlots / 2) {
+    // Wake the background thread early rather than let a burst fill the ring.
+    m_wake.notify_one();
+  }
+}
+
+void AsyncLogger::flush() {
+  size_t target = m_enqueuePosition.load(std::memory_order_acquire);
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (!m_running) {
+    return;
+  }
+  m_flushRequested = true;
+  m_wake.notify_one();
+  m_drained.wait(lock, [&] {
+    return !m_running || m_dequeuePosition.load(std::memory_order_acquire) >= target;
+  });
+}
+
+void AsyncLogger::format(const Slot& slot) {
+  if (g_outputCapacity - m_outputSize < g_outputReserve) {
+    fwrite(m_output, 1, m_outputSize, stdout);
+    m_outputSize = 0;
+  }
+  char* out   = m_output + m_outputSize;
+  size_t room = g_outputReserve - 1;
+  size_t used = static_cast<size_t>(snprintf(out,
+                                             room,
+                                             "%8.1fms [%-7s] ",
+                                             static_cast<double>(slot.timestamp) / 1000000.0,
+                                             getLevelName(slot.level)));
+  used        = std::min(used, room - 1);
+  if (Kind::PREFORMATTED == slot.kind) {
+    size_t length = std::min(static_cast<size_t>(slot.size), room - 1 - used);
+    memcpy(out + used, slot.data, length);
+    used += length;
+  } else {
+    const uint8_t* args = slot.data;
+    if (slot.fmt == reinterpret_cast<const char*>(slot.data)) {
+      args += strlen(slot.fmt) + 1;
+    }
+    Unpacker unpacker(args);
+    Conversion conversion;
+    const char* p = slot.fmt;
+    while (used < room - 1) {
+      bool found         = nextConversion(p, conversion);
+      const char* textEnd = found ? conversion.begin : p + strlen(p);
+      size_t length      = std::min(static_cast<size_t>(textEnd - p), room - 1 - used);
+      memcpy(out + used, p, length);
+      used += length;
+      if (!found) {
+        break;
+      }
+      used += formatConversion(out + used, room - used, conversion, unpacker);
+      p = conversion.end;
+    }
+  }
+  out[used++] = '\n';
+  m_outputSize += used;
+}
+
+size_t AsyncLogger::drain() {
+  size_t position    = m_dequeuePosition.load(std::memory_order_relaxed);
+  size_t numWritten  = 0;
+  uint64_t timestamp = 0;
+  while (true) {
+    Slot& slot = m_slots[position % s_numSlots];
+    if (slot.sequence.load(std::memory_order_acquire) != position + 1) {
+      break;
+    }
+    format(slot);
+    timestamp = slot.timestamp;
+    slot.sequence.store(position + s_numSlots, std::memory_order_release);
+    position++;
+    numWritten++;
+    m_dequeuePosition.store(position, std::memory_order_release);
+  }
+  size_t numDropped = m_numDropped.load(std::memory_order_relaxed);
+  if (numDropped != m_numDroppedReported) {
+    int n = snprintf(m_output + m_outputSize,
+                     g_outputCapacity - m_outputSize,
+                     "%8.1fms [%-7s] %zu log messages dropped\n",
+                     static_cast<double>(timestamp) / 1000000.0,
+                     getLevelName(QNN_LOG_LEVEL_WARN),
+                     numDropped - m_numDroppedReported);
+    m_outputSize += std::min(static_cast<size_t>(std::max(n, 0)),
+                             g_outputCapacity - m_outputSize - 1);
+    m_numDroppedReported = numDropped;
+  }
+  if (m_outputSize > 0) {
+    fwrite(m_output, 1, m_outputSize, stdout);
+    fflush(stdout);
+    m_outputSize = 0;
+  }
+  return numWritten;
+}
+
+void AsyncLogger::run() {
+  std::chrono::milliseconds idle(1);
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true) {
+    lock.unlock();
+    size_t numWritten = drain();
+    lock.lock();
+    if (m_flushRequested) {
+      idle = std::chrono::milliseconds(1);
+      m_drained.notify_all();
+      if (m_dequeuePosition.load(std::memory_order_relaxed) ==
+          m_enqueuePosition.load(std::memory_order_acquire)) {
+        m_flushRequested = false;
+      }
+    }
+    if (numWritten > 0) {
+      idle = std::chrono::milliseconds(1);
+      continue;
+    }
+    if (m_stopRequested) {
+      break;
+    }
+    m_wake.wait_for(lock, idle);
+    idle = std::min(idle * 2, g_maxIdle);
+  }
+}
@@ -0,0 +1,122 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "QnnLog.h"
+
+namespace qnn {
+namespace log {
+namespace utils {
+
+/*
+ * Formats and writes log messages on a background thread.
+ *
+ * A producer claims a slot of a bounded lock-free multi-producer ring and
+ * stores the timestamp, level, format pointer and its arguments packed by
+ * type, then returns: no lock is taken, nothing is formatted and no I/O is
+ * done on the logging thread. The background thread walks the format again,
+ * formats each conversion with the packed argument and writes the messages
+ * to stdout in batches.
+ *
+ * Strings are copied, as are formats whose lifetime is not known, such as
+ * those coming from the backend. A message whose arguments do not fit a
+ * slot, or that uses conversions that cannot be packed, is formatted by the
+ * producer instead.
+ *
+ * Errors are flushed before log() returns, so they are written before a
+ * failing caller can exit. When the ring is full, warnings and errors wait
+ * for room; other messages are dropped, and the number dropped is reported.
+ * Once stop() has begun, log() writes directly to stdout, so a producer that
+ * raced with stopping neither waits for a thread that is gone nor loses its
+ * message.
+ */
+class AsyncLogger {
+ public:
+  AsyncLogger();
+
+  ~AsyncLogger();
+
+  AsyncLogger(const AsyncLogger&) = delete;
+  AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+  // Starts the background thread. Returns false if it cannot be started.
+  bool start();
+
+  // Writes what is queued and stops the background thread.
+  void stop();
+
+  // copyFormat must be set unless fmt outlives the process, e.g. a literal.
+  void log(const char* fmt,
+           QnnLog_Level_t level,
+           uint64_t timestamp,
+           va_list argp,
+           bool copyFormat);
+
+  // Blocks until every message logged before the call has been written.
+  void flush();
+
+ private:
+  static const size_t s_numSlots = 1024;
+  static const size_t s_dataSize = 448;
+
+  enum class Kind : uint8_t { PACKED, PREFORMATTED };
+
+  struct Slot {
+    std::atomic<size_t> sequence;
+    uint64_t timestamp;
+    QnnLog_Level_t level;
+    const char* fmt;
+    Kind kind;
+    uint16_t size;
+    uint8_t data[s_dataSize];
+  };
+
+  // Returns the claimed slot and its position, or nullptr if the ring is full.
+  Slot* claim(size_t& position);
+
+  void run();
+
+  // Formats and writes the messages published so far. Returns how many.
+  size_t drain();
+
+  void format(const Slot& slot);
+
+  Slot* m_slots;
+  std::atomic<size_t> m_enqueuePosition;
+  // Only written by the background thread.
+  std::atomic<size_t> m_dequeuePosition;
+  std::atomic<size_t> m_numDropped;
+  size_t m_numDroppedReported;
+  std::thread m_thread;
+  std::mutex m_mutex;
+  std::condition_variable m_wake;
+  std::condition_variable m_drained;
+  bool m_flushRequested;
+  bool m_stopRequested;
+  bool m_running;
+  // Cleared first thing in stop(); log() only uses the ring while it is set.
+  std::atomic<bool> m_accepting;
+  // Producers inside log(), which stop() waits out before stopping the
+  // background thread.
+  std::atomic<size_t> m_numProducers;
+  // Formatted messages waiting to be written.
+  char* m_output;
+  size_t m_outputSize;
+};
+
+}  // namespace utils
+}  // namespace log
+}  // namespace qnn
@@ -6,33 +6,50 @@
 //
 //==============================================================================
 
+#include <atomic>
+#include <cstdlib>
+
+#include "AsyncLogger.hpp"
 #include "LogUtils.hpp"
 
-void qnn::log::utils::logStdoutCallback(const char* fmt,
-                                        QnnLog_Level_t level,
-                                        uint64_t timestamp,
-                                        va_list argp) {
-  const char* levelStr = "";
+namespace {
+
+// Set while the background log thread is running. The logger itself is never
+// freed, so a thread still logging during exit cannot touch freed memory.
+std::atomic<qnn::log::utils::AsyncLogger*> sg_asyncLogger{nullptr};
+
+void stopAsyncLogging() {
+  auto asyncLogger = sg_asyncLogger.exchange(nullptr);
+  if (nullptr != asyncLogger) {
+    asyncLogger->stop();
+  }
+}
+
+}  // namespace
+
+const char* qnn::log::utils::getLevelName(QnnLog_Level_t level) {
   switch (level) {
     case QNN_LOG_LEVEL_ERROR:
-      levelStr = " ERROR ";
-      break;
+      return " ERROR ";
     case QNN_LOG_LEVEL_WARN:
-      levelStr = "WARNING";
-      break;
+      return "WARNING";
     case QNN_LOG_LEVEL_INFO:
-      levelStr = "  INFO ";
-      break;
+      return "  INFO ";
     case QNN_LOG_LEVEL_DEBUG:
-      levelStr = " DEBUG ";
-      break;
+      return " DEBUG ";
     case QNN_LOG_LEVEL_VERBOSE:
-      levelStr = "VERBOSE";
-      break;
+      return "VERBOSE";
     case QNN_LOG_LEVEL_MAX:
-      levelStr = "UNKNOWN";
-      break;
+      return "UNKNOWN";
   }
+  return "";
+}
+
+void qnn::log::utils::logStdoutCallback(const char* fmt,
+                                        QnnLog_Level_t level,
+                                        uint64_t timestamp,
+                                        va_list argp) {
+  const char* levelStr = getLevelName(level);
 
   double ms = (double)timestamp / 1000000.0;
   // To avoid interleaved messages
@@ -43,3 +60,43 @@ void qnn::log::utils::logStdoutCallback(const char* fmt,
     fprintf(stdout, "\n");
   }
 }
+
+void qnn::log::utils::logAsyncCallback(const char* fmt,
+                                       QnnLog_Level_t level,
+                                       uint64_t timestamp,
+                                       va_list argp) {
+  auto asyncLogger = sg_asyncLogger.load(std::memory_order_acquire);
+  if (nullptr == asyncLogger) {
+    logStdoutCallback(fmt, level, timestamp, argp);
+    return;
+  }
+  asyncLogger->log(fmt, level, timestamp, argp, true);
+}
+
+void qnn::log::utils::logAsync(const char* fmt,
+                               QnnLog_Level_t level,
+                               uint64_t timestamp,
+                               va_list argp) {
+  auto asyncLogger = sg_asyncLogger.load(std::memory_order_acquire);
+  if (nullptr == asyncLogger) {
+    logStdoutCallback(fmt, level, timestamp, argp);
+    return;
+  }
+  asyncLogger->log(fmt, level, timestamp, argp, false);
+}
+
+bool qnn::log::utils::startAsyncLogging() {
+  static AsyncLogger* s_asyncLogger = new AsyncLogger();
+  static bool s_started             = s_asyncLogger->start() && 0 == std::atexit(stopAsyncLogging);
+  if (s_started) {
+    sg_asyncLogger.store(s_asyncLogger, std::memory_order_release);
+  }
+  return s_started;
+}
+
+void qnn::log::utils::flushAsyncLogging() {
+  auto asyncLogger = sg_asyncLogger.load(std::memory_order_acquire);
+  if (nullptr != asyncLogger) {
+    asyncLogger->flush();
+  }
+}
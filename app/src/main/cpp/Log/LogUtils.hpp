@@ -22,6 +22,24 @@ namespace utils {
 void logStdoutCallback(const char* fmt, QnnLog_Level_t level, uint64_t timestamp, va_list argp);
 static std::mutex sg_logUtilMutex;
 
+// Same output as logStdoutCallback, formatted and written by the background
+// thread started with startAsyncLogging(). Falls back to logStdoutCallback
+// when that thread is not running.
+void logAsyncCallback(const char* fmt, QnnLog_Level_t level, uint64_t timestamp, va_list argp);
+
+// Like logAsyncCallback, for formats known to outlive the process, which are
+// then not copied.
+void logAsync(const char* fmt, QnnLog_Level_t level, uint64_t timestamp, va_list argp);
+
+// Starts the background log thread, which is stopped at exit after writing
+// what is queued. Returns false if it cannot be started.
+bool startAsyncLogging();
+
+// Blocks until every message logged so far has been written.
+void flushAsyncLogging();
+
+const char* getLevelName(QnnLog_Level_t level);
+
 }  // namespace utils
 }  // namespace log
 }  // namespace qnn
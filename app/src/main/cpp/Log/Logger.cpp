@@ -40,7 +40,8 @@ std::shared_ptr<Logger> Logger::createLogger(QnnLog_Callback_t callback,
 Logger::Logger(QnnLog_Callback_t callback, QnnLog_Level_t maxLevel, QnnLog_Error_t* status)
     : m_callback(callback), m_maxLevel(maxLevel), m_epoch(getTimestamp()) {
   if (!callback) {
-    m_callback = utils::logStdoutCallback;
+    m_callback =
+        utils::startAsyncLogging() ? utils::logAsyncCallback : utils::logStdoutCallback;
   }
 }
 
@@ -51,10 +52,14 @@ void Logger::log(QnnLog_Level_t level, const char* file, long line, const char*
     }
     va_list argp;
     va_start(argp, fmt);
-    std::string logString(fmt);
     std::ignore = file;
     std::ignore = line;
-    (*m_callback)(logString.c_str(), level, getTimestamp() - m_epoch, argp);
+    if (utils::logAsyncCallback == m_callback) {
+      // The macros pass format literals, which need not be copied.
+      utils::logAsync(fmt, level, getTimestamp() - m_epoch, argp);
+    } else {
+      (*m_callback)(fmt, level, getTimestamp() - m_epoch, argp);
+    }
     va_end(argp);
   }
 }
@@ -94,6 +99,8 @@ bool qnn::log::isLogInitialized() {
   return true;
 }
 
+void qnn::log::flushLogging() { utils::flushAsyncLogging(); }
+
 bool qnn::log::setLogLevel(QnnLog_Level_t maxLevel) {
   if (!::qnn::log::Logger::isValid() ||
       !(maxLevel >= QNN_LOG_LEVEL_ERROR && maxLevel <= QNN_LOG_LEVEL_DEBUG)) {
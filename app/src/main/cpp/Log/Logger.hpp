@@ -25,12 +25,28 @@
 
 #define QNN_LOG_LEVEL(level, fmt, ...)                                \
   do {                                                                \
-    auto logger = ::qnn::log::Logger::getLogger();                    \
-    if (logger) {                                                     \
+    auto logger = ::qnn::log::Logger::getLoggerPointer();             \
+    if (logger && logger->isEnabled(level)) {                         \
       logger->log(level, __FILENAME__, __LINE__, fmt, ##__VA_ARGS__); \
     }                                                                 \
   } while (0)
 
+// Levels more verbose than QNN_LOG_COMPILE_LEVEL, a QnnLog_Level_t value, are
+// compiled out: with 3 (INFO), QNN_VERBOSE and QNN_DEBUG expand to nothing.
+// Errors are always compiled in. The default keeps every level.
+#ifndef QNN_LOG_COMPILE_LEVEL
+#define QNN_LOG_COMPILE_LEVEL 5
+#endif
+
+// A compiled out log call. The arguments stay referenced, so variables only
+// used for logging do not trigger unused variable warnings.
+#define QNN_LOG_DISCARD(fmt, ...)                 \
+  do {                                            \
+    if (false) {                                  \
+      ::qnn::log::discardLog(fmt, ##__VA_ARGS__); \
+    }                                             \
+  } while (0)
+
 #define QNN_ERROR(fmt, ...) QNN_LOG_LEVEL(QNN_LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
 
 #define QNN_ERROR_EXIT(fmt, ...)   \
@@ -39,17 +55,33 @@
     exit(EXIT_FAILURE);            \
   }
 
+#if QNN_LOG_COMPILE_LEVEL >= 2
 #define QNN_WARN(fmt, ...) QNN_LOG_LEVEL(QNN_LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#else
+#define QNN_WARN(fmt, ...) QNN_LOG_DISCARD(fmt, ##__VA_ARGS__)
+#endif
 
+#if QNN_LOG_COMPILE_LEVEL >= 3
 #define QNN_INFO(fmt, ...) QNN_LOG_LEVEL(QNN_LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#else
+#define QNN_INFO(fmt, ...) QNN_LOG_DISCARD(fmt, ##__VA_ARGS__)
+#endif
 
+#if QNN_LOG_COMPILE_LEVEL >= 5
 #define QNN_DEBUG(fmt, ...) QNN_LOG_LEVEL(QNN_LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#else
+#define QNN_DEBUG(fmt, ...) QNN_LOG_DISCARD(fmt, ##__VA_ARGS__)
+#endif
 
+#if QNN_LOG_COMPILE_LEVEL >= 4
 #define QNN_VERBOSE(fmt, ...) QNN_LOG_LEVEL(QNN_LOG_LEVEL_VERBOSE, fmt, ##__VA_ARGS__)
+#else
+#define QNN_VERBOSE(fmt, ...) QNN_LOG_DISCARD(fmt, ##__VA_ARGS__)
+#endif
 
-#define QNN_FUNCTION_ENTRY_LOG QNN_LOG_LEVEL(QNN_LOG_LEVEL_VERBOSE, "Entering %s", __func__)
+#define QNN_FUNCTION_ENTRY_LOG QNN_VERBOSE("Entering %s", __func__)
 
-#define QNN_FUNCTION_EXIT_LOG QNN_LOG_LEVEL(QNN_LOG_LEVEL_VERBOSE, "Returning from %s", __func__)
+#define QNN_FUNCTION_EXIT_LOG QNN_VERBOSE("Returning from %s", __func__)
 
 namespace qnn {
 namespace log {
@@ -64,6 +96,11 @@ bool isLogInitialized();
 
 bool setLogLevel(QnnLog_Level_t maxLevel);
 
+// Blocks until every message logged so far has been written.
+void flushLogging();
+
+inline void discardLog(const char*, ...) {}
+
 class Logger final {
  public:
   Logger(const Logger&) = delete;
@@ -77,6 +114,10 @@ class Logger final {
 
   QnnLog_Level_t getMaxLevel() { return m_maxLevel.load(std::memory_order_seq_cst); }
 
+  bool isEnabled(QnnLog_Level_t level) const {
+    return level <= m_maxLevel.load(std::memory_order_relaxed);
+  }
+
   QnnLog_Callback_t getLogCallback() { return m_callback; }
 
   void log(QnnLog_Level_t level, const char* file, long line, const char* fmt, ...);
@@ -89,6 +130,9 @@ class Logger final {
 
   static std::shared_ptr<Logger> getLogger() { return s_logger; }
 
+  // Used by the logging macros, which do not need to copy the shared_ptr.
+  static Logger* getLoggerPointer() { return s_logger.get(); }
+
   static void reset() { s_logger = nullptr; }
 
  private:
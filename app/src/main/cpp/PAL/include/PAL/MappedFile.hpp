@@ -0,0 +1,121 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+
+//------------------------------------------------------------------------------
+/// @file
+///   This file includes APIs for memory mapping files on supported platforms
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+namespace pal {
+class MappedFile;
+}
+
+//------------------------------------------------------------------------------
+/// @brief
+///   MappedFile owns a read-only mapping of a file (or of a byte range of a
+///   file), or a writable shared mapping of a file it created. The mapping is
+///   released when the object is destroyed or closed.
+//------------------------------------------------------------------------------
+class pal::MappedFile {
+ public:
+  //---------------------------------------------------------------------------
+  /// @brief
+  ///   Access pattern hints forwarded to the kernel, strictly following
+  ///   linux madvise usage.
+  //---------------------------------------------------------------------------
+  enum class Advice { NORMAL, SEQUENTIAL, RANDOM, WILLNEED, DONTNEED };
+
+  MappedFile();
+
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  MappedFile(MappedFile &&other);
+  MappedFile &operator=(MappedFile &&other);
+
+  //---------------------------------------------------------------------------
+  /// @brief
+  ///   Maps length bytes of a file starting at offset. Any mapping already
+  ///   held by this object is released first.
+  /// @param path
+  ///   File to map.
+  /// @param offset
+  ///   Byte offset of the first mapped byte. Need not be page aligned.
+  /// @param length
+  ///   Number of bytes to map. Zero maps up to the end of the file.
+  /// @return
+  ///   True on success, otherwise false.
+  //---------------------------------------------------------------------------
+  bool open(const std::string &path, size_t offset = 0, size_t length = 0);
+
+  //---------------------------------------------------------------------------
+  /// @brief
+  ///   Creates, or truncates, the file at path to length bytes and maps it
+  ///   writable and shared, so that stores through data() land in the file.
+  ///   Any mapping already held by this object is released first.
+  /// @return
+  ///   True on success, otherwise false.
+  //---------------------------------------------------------------------------
+  bool create(const std::string &path, size_t length);
+
+  //---------------------------------------------------------------------------
+  /// @brief
+  ///   Releases the mapping. Safe to call on a closed object. Stores to a
+  ///   created file are already in the page cache, so no msync is needed for
+  ///   other readers to see them.
+  //---------------------------------------------------------------------------
+  void close();
+
+  //---------------------------------------------------------------------------
+  /// @brief
+  ///   Applies an access pattern hint to the whole mapping.
+  /// @return
+  ///   True on success, otherwise false.
+  //---------------------------------------------------------------------------
+  bool advise(Advice advice);
+
+  //---------------------------------------------------------------------------
+  /// @brief
+  ///   Applies an access pattern hint to the pages covering length bytes
+  ///   starting at offset, relative to data(). The range is widened to page
+  ///   boundaries except for DONTNEED, which is narrowed so that pages still
+  ///   partly in use are kept.
+  /// @return
+  ///   True on success, otherwise false.
+  //---------------------------------------------------------------------------
+  bool advise(Advice advice, size_t offset, size_t length);
+
+  bool isOpen() const { return nullptr != m_data; }
+
+  //---------------------------------------------------------------------------
+  /// @brief Returns the first requested byte (not the page aligned base).
+  //---------------------------------------------------------------------------
+  uint8_t *data() const { return m_data; }
+
+  size_t size() const { return m_size; }
+
+  //---------------------------------------------------------------------------
+  /// @brief Returns the system page size in bytes.
+  //---------------------------------------------------------------------------
+  static size_t getPageSize();
+
+ private:
+  void *m_base;
+  size_t m_mappedSize;
+  uint8_t *m_data;
+  size_t m_size;
+};
@@ -0,0 +1,173 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "PAL/MappedFile.hpp"
+
+pal::MappedFile::MappedFile() : m_base(nullptr), m_mappedSize(0), m_data(nullptr), m_size(0) {}
+
+pal::MappedFile::~MappedFile() { close(); }
+
+pal::MappedFile::MappedFile(MappedFile &&other)
+    : m_base(other.m_base),
+      m_mappedSize(other.m_mappedSize),
+      m_data(other.m_data),
+      m_size(other.m_size) {
+  other.m_base       = nullptr;
+  other.m_mappedSize = 0;
+  other.m_data       = nullptr;
+  other.m_size       = 0;
+}
+
+pal::MappedFile &pal::MappedFile::operator=(MappedFile &&other) {
+  if (this != &other) {
+    close();
+    m_base             = other.m_base;
+    m_mappedSize       = other.m_mappedSize;
+    m_data             = other.m_data;
+    m_size             = other.m_size;
+    other.m_base       = nullptr;
+    other.m_mappedSize = 0;
+    other.m_data       = nullptr;
+    other.m_size       = 0;
+  }
+  return *this;
+}
+
+size_t pal::MappedFile::getPageSize() {
+  static const size_t s_pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  return s_pageSize;
+}
+
+bool pal::MappedFile::open(const std::string &path, size_t offset, size_t length) {
+  close();
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < offset) {
+    ::close(fd);
+    return false;
+  }
+  if (0 == length) {
+    length = static_cast<size_t>(st.st_size) - offset;
+  }
+  if (0 == length || offset + length > static_cast<size_t>(st.st_size)) {
+    ::close(fd);
+    return false;
+  }
+  // mmap() requires a page aligned file offset, so map from the enclosing
+  // page and hand out a pointer to the first requested byte.
+  size_t alignedOffset = offset - (offset % getPageSize());
+  size_t mappedSize    = length + (offset - alignedOffset);
+  void *base =
+      mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, fd, static_cast<off_t>(alignedOffset));
+  // The mapping keeps its own reference to the file.
+  ::close(fd);
+  if (MAP_FAILED == base) {
+    return false;
+  }
+  m_base       = base;
+  m_mappedSize = mappedSize;
+  m_data       = static_cast<uint8_t *>(base) + (offset - alignedOffset);
+  m_size       = length;
+  return true;
+}
+
+bool pal::MappedFile::create(const std::string &path, size_t length) {
+  close();
+  if (0 == length) {
+    return false;
+  }
+  int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+  if (fd < 0) {
+    return false;
+  }
+  // Reserve the blocks up front so that faulting in the mapping cannot run
+  // out of space, which would raise SIGBUS instead of an error. Filesystems
+  // without fallocate get a sparse file instead.
+  if (fallocate(fd, 0, 0, static_cast<off_t>(length)) != 0 &&
+      ftruncate(fd, static_cast<off_t>(length)) != 0) {
+    ::close(fd);
+    return false;
+  }
+  void *base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (MAP_FAILED == base) {
+    return false;
+  }
+  m_base       = base;
+  m_mappedSize = length;
+  m_data       = static_cast<uint8_t *>(base);
+  m_size       = length;
+  return true;
+}
+
+void pal::MappedFile::close() {
+  if (nullptr != m_base) {
+    munmap(m_base, m_mappedSize);
+  }
+  m_base       = nullptr;
+  m_mappedSize = 0;
+  m_data       = nullptr;
+  m_size       = 0;
+}
+
+bool pal::MappedFile::advise(Advice advice) {
+  if (nullptr == m_base) {
+    return false;
+  }
+  return advise(advice, 0, m_size);
+}
+
+bool pal::MappedFile::advise(Advice advice, size_t offset, size_t length) {
+  if (nullptr == m_base || offset > m_size) {
+    return false;
+  }
+  length = std::min(length, m_size - offset);
+  // Offsets relative to the page aligned base.
+  size_t pageSize = getPageSize();
+  size_t begin    = static_cast<size_t>(m_data - static_cast<uint8_t *>(m_base)) + offset;
+  size_t end      = begin + length;
+  if (Advice::DONTNEED == advice) {
+    begin = (0 == offset) ? 0 : (begin + pageSize - 1) / pageSize * pageSize;
+    end   = (end == m_mappedSize) ? m_mappedSize : end / pageSize * pageSize;
+  } else {
+    begin = begin / pageSize * pageSize;
+  }
+  if (end <= begin) {
+    return true;
+  }
+  int flag = MADV_NORMAL;
+  switch (advice) {
+    case Advice::NORMAL:
+      flag = MADV_NORMAL;
+      break;
+    case Advice::SEQUENTIAL:
+      flag = MADV_SEQUENTIAL;
+      break;
+    case Advice::RANDOM:
+      flag = MADV_RANDOM;
+      break;
+    case Advice::WILLNEED:
+      flag = MADV_WILLNEED;
+      break;
+    case Advice::DONTNEED:
+      flag = MADV_DONTNEED;
+      break;
+  }
+  return (madvise(static_cast<uint8_t *>(m_base) + begin, end - begin, flag) == 0);
+}
@@ -0,0 +1,537 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+
+// Compares qnn-mobile-app-bench results against a stored baseline and exits
+// with a failure when a benchmark got slower. Each benchmark's time per call
+// samples, pooled over all files given for a side, are compared with a one
+// sided Mann-Whitney U test and a bootstrap confidence interval of the ratio
+// of medians. A benchmark regressed when the test is significant, the change
+// of the medians exceeds the threshold and the whole interval lies above 1.
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "PAL/GetOpt.hpp"
+
+namespace {
+
+struct Options {
+  std::vector<std::string> baselinePaths;
+  std::vector<std::string> candidatePaths;
+  double threshold = 0.05;
+  double alpha     = 0.01;
+  size_t resamples = 2000;
+  // Whether baseline benchmarks missing from the candidate pass.
+  bool allowMissing = false;
+};
+
+void showHelp() {
+  std::cout
+      << "Usage: qnn-bench-compare --baseline <files> --candidate <files> [options]\n\n"
+      << "  --baseline <files>    Comma separated qnn-mobile-app-bench JSON results of\n"
+      << "                        the baseline. Samples of repeated runs are pooled.\n"
+      << "  --candidate <files>   Comma separated results to check, as --baseline.\n"
+      << "  --threshold <pct>     Smallest slowdown of the median time per call that\n"
+      << "                        fails, default 5.\n"
+      << "  --alpha <p>           Significance level of the test and the interval,\n"
+      << "                        default 0.01.\n"
+      << "  --resamples <n>       Bootstrap resamples, default 2000.\n"
+      << "  --allow_missing       Do not fail for baseline benchmarks missing from the\n"
+      << "                        candidate, e.g. after removing a benchmark.\n\n"
+      << "Exits with 1 when a benchmark regressed, a baseline benchmark is missing from\n"
+      << "the candidate or an input could not be read.\n"
+      << "Benchmarks with fewer than 3 samples on a side are reported but never fail.\n";
+}
+
+/*
+ * Just enough JSON for benchmark results: objects, arrays, strings without
+ * unicode escapes, numbers and literals.
+ */
+struct JsonValue {
+  enum Type { NIL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+  Type type     = NIL;
+  double number = 0.0;
+  std::string string;
+  std::vector<JsonValue> items;
+  std::vector<std::pair<std::string, JsonValue>> members;
+
+  const JsonValue *get(const std::string &key) const {
+    for (const auto &member : members) {
+      if (member.first == key) {
+        return &member.second;
+      }
+    }
+    return nullptr;
+  }
+};
+
+class JsonParser {
+ public:
+  explicit JsonParser(const std::string &text) : m_text(text) {}
+
+  bool parse(JsonValue &value) {
+    if (!parseValue(value)) {
+      return false;
+    }
+    skipSpace();
+    return m_pos == m_text.size();
+  }
+
+  size_t getPosition() const { return m_pos; }
+
+ private:
+  void skipSpace() {
+    while (m_pos < m_text.size() && isspace(static_cast<unsigned char>(m_text[m_pos]))) {
+      m_pos++;
+    }
+  }
+
+  bool consume(char c) {
+    skipSpace();
+    if (m_pos < m_text.size() && c == m_text[m_pos]) {
+      m_pos++;
+      return true;
+    }
+    return false;
+  }
+
+  bool parseString(std::string &string) {
+    if (!consume('"')) {
+      return false;
+    }
+    while (m_pos < m_text.size() && '"' != m_text[m_pos]) {
+      char c = m_text[m_pos++];
+      if ('\\' == c) {
+        if (m_pos >= m_text.size()) {
+          return false;
+        }
+        c = m_text[m_pos++];
+        switch (c) {
+          case 'n':
+            c = '\n';
+            break;
+          case 't':
+            c = '\t';
+            break;
+          case '"':
+          case '\\':
+          case '/':
+            break;
+          default:
+            return false;
+        }
+      }
+      string.push_back(c);
+    }
+    return consume('"');
+  }
+
+  bool parseValue(JsonValue &value) {
+    skipSpace();
+    if (m_pos >= m_text.size()) {
+      return false;
+    }
+    char c = m_text[m_pos];
+    if ('{' == c) {
+      m_pos++;
+      value.type = JsonValue::OBJECT;
+      if (consume('}')) {
+        return true;
+      }
+      do {
+        std::pair<std::string, JsonValue> member;
+        if (!parseString(member.first) || !consume(':') || !parseValue(member.second)) {
+          return false;
+        }
+        value.members.push_back(member);
+      } while (consume(','));
+      return consume('}');
+    }
+    if ('[' == c) {
+      m_pos++;
+      value.type = JsonValue::ARRAY;
+      if (consume(']')) {
+        return true;
+      }
+      do {
+        value.items.push_back(JsonValue());
+        if (!parseValue(value.items.back())) {
+          return false;
+        }
+      } while (consume(','));
+      return consume(']');
+    }
+    if ('"' == c) {
+      value.type = JsonValue::STRING;
+      return parseString(value.string);
+    }
+    const char *literals[] = {"null", "true", "false"};
+    for (const char *literal : literals) {
+      if (0 == m_text.compare(m_pos, strlen(literal), literal)) {
+        m_pos += strlen(literal);
+        value.type   = 'n' == literal[0] ? JsonValue::NIL : JsonValue::BOOLEAN;
+        value.number = 't' == literal[0] ? 1.0 : 0.0;
+        return true;
+      }
+    }
+    char *end    = nullptr;
+    value.type   = JsonValue::NUMBER;
+    value.number = strtod(m_text.c_str() + m_pos, &end);
+    if (end == m_text.c_str() + m_pos) {
+      return false;
+    }
+    m_pos = end - m_text.c_str();
+    return true;
+  }
+
+  const std::string &m_text;
+  size_t m_pos = 0;
+};
+
+// Time per call samples by benchmark, named "<name> <type> <bytes>", in the
+// order the benchmarks first appear.
+struct Samples {
+  std::vector<std::string> names;
+  std::map<std::string, std::vector<double>> byName;
+};
+
+bool readResults(const std::string &path, Samples &samples) {
+  std::ifstream file(path);
+  if (!file) {
+    std::cerr << "ERROR: Could not open " << path << "\n";
+    return false;
+  }
+  std::stringstream text;
+  text << file.rdbuf();
+  std::string content = text.str();
+  JsonParser parser(content);
+  JsonValue root;
+  if (!parser.parse(root)) {
+    std::cerr << "ERROR: Invalid JSON in " << path << " near byte " << parser.getPosition()
+              << "\n";
+    return false;
+  }
+  const JsonValue *benchmarks = root.get("benchmarks");
+  if (nullptr == benchmarks || JsonValue::ARRAY != benchmarks->type) {
+    std::cerr << "ERROR: No benchmarks array in " << path << "\n";
+    return false;
+  }
+  for (const JsonValue &benchmark : benchmarks->items) {
+    const JsonValue *name      = benchmark.get("name");
+    const JsonValue *type      = benchmark.get("type");
+    const JsonValue *bytes     = benchmark.get("bytes");
+    const JsonValue *nsPerCall = benchmark.get("ns_per_call");
+    if (nullptr == name || nullptr == type || nullptr == bytes || nullptr == nsPerCall) {
+      std::cerr << "ERROR: Incomplete benchmark in " << path << "\n";
+      return false;
+    }
+    std::string key = name->string + " " + type->string + " " +
+                      std::to_string(static_cast<unsigned long long>(bytes->number));
+    if (0 == samples.byName.count(key)) {
+      samples.names.push_back(key);
+    }
+    std::vector<double> &values = samples.byName[key];
+    // Results written before samples_ns existed give one sample per run.
+    const JsonValue *samplesNs = benchmark.get("samples_ns");
+    if (nullptr != samplesNs && JsonValue::ARRAY == samplesNs->type &&
+        !samplesNs->items.empty()) {
+      for (const JsonValue &sample : samplesNs->items) {
+        values.push_back(sample.number);
+      }
+    } else {
+      values.push_back(nsPerCall->number);
+    }
+  }
+  return true;
+}
+
+double median(std::vector<double> values) {
+  std::sort(values.begin(), values.end());
+  size_t half = values.size() / 2;
+  return 0 == values.size() % 2 ? (values[half - 1] + values[half]) / 2.0 : values[half];
+}
+
+/*
+ * One sided p-value of the Mann-Whitney U test that candidate samples tend
+ * to be larger than baseline samples, from the normal approximation with tie
+ * and continuity corrections.
+ */
+double mannWhitneyGreater(const std::vector<double> &baseline,
+                          const std::vector<double> &candidate) {
+  std::vector<std::pair<double, bool>> all;
+  for (double value : baseline) {
+    all.push_back(std::make_pair(value, false));
+  }
+  for (double value : candidate) {
+    all.push_back(std::make_pair(value, true));
+  }
+  std::sort(all.begin(), all.end());
+  double n            = static_cast<double>(all.size());
+  double candidateSum = 0.0;
+  double tieSum       = 0.0;
+  for (size_t first = 0; first < all.size();) {
+    size_t last = first;
+    while (last + 1 < all.size() && all[last + 1].first == all[first].first) {
+      last++;
+    }
+    // Tied values share the average of their ranks, which start at 1.
+    double rank = (first + last) / 2.0 + 1.0;
+    double ties = static_cast<double>(last - first + 1);
+    tieSum += ties * ties * ties - ties;
+    for (size_t idx = first; idx <= last; idx++) {
+      candidateSum += all[idx].second ? rank : 0.0;
+    }
+    first = last + 1;
+  }
+  double nBaseline  = static_cast<double>(baseline.size());
+  double nCandidate = static_cast<double>(candidate.size());
+  double u          = candidateSum - nCandidate * (nCandidate + 1.0) / 2.0;
+  double mean       = nBaseline * nCandidate / 2.0;
+  double variance   = nBaseline * nCandidate / 12.0 * ((n + 1.0) - tieSum / (n * (n - 1.0)));
+  if (variance <= 0.0) {
+    return 1.0;
+  }
+  double z = (u - mean - 0.5) / std::sqrt(variance);
+  return 0.5 * std::erfc(z / std::sqrt(2.0));
+}
+
+/*
+ * Percentile bootstrap interval, at confidence 1 - alpha, of the ratio of
+ * the candidate median to the baseline median. The generator is seeded with
+ * a constant so that reruns over the same files agree.
+ */
+std::pair<double, double> bootstrapRatio(const std::vector<double> &baseline,
+                                         const std::vector<double> &candidate,
+                                         const Options &options) {
+  std::mt19937_64 random(0x9e3779b97f4a7c15ull);
+  std::vector<double> ratios;
+  std::vector<double> resample;
+  for (size_t idx = 0; idx < options.resamples; idx++) {
+    double medians[2];
+    const std::vector<double> *sides[2] = {&baseline, &candidate};
+    for (int side = 0; side < 2; side++) {
+      const std::vector<double> &values = *sides[side];
+      std::uniform_int_distribution<size_t> pick(0, values.size() - 1);
+      resample.resize(values.size());
+      for (double &value : resample) {
+        value = values[pick(random)];
+      }
+      medians[side] = median(resample);
+    }
+    if (medians[0] > 0.0) {
+      ratios.push_back(medians[1] / medians[0]);
+    }
+  }
+  if (ratios.empty()) {
+    return std::make_pair(NAN, NAN);
+  }
+  std::sort(ratios.begin(), ratios.end());
+  double last  = static_cast<double>(ratios.size() - 1);
+  size_t lower = static_cast<size_t>(std::floor(last * options.alpha / 2.0));
+  size_t upper = static_cast<size_t>(std::ceil(last * (1.0 - options.alpha / 2.0)));
+  return std::make_pair(ratios[lower], ratios[upper]);
+}
+
+std::vector<std::string> splitPaths(const std::string &text) {
+  std::vector<std::string> paths;
+  std::istringstream stream(text);
+  std::string path;
+  while (std::getline(stream, path, ',')) {
+    if (!path.empty()) {
+      paths.push_back(path);
+    }
+  }
+  return paths;
+}
+
+bool parsePositive(const char *text, double &value) {
+  char *end = nullptr;
+  value     = strtod(text, &end);
+  return end != text && '\0' == *end && value > 0.0;
+}
+
+// Returns the number of regressions, and sets missing to the number of
+// baseline benchmarks the candidate lacks.
+size_t compare(const Samples &baseline,
+               const Samples &candidate,
+               const Options &options,
+               size_t &missing) {
+  const size_t minSamples = 3;
+  size_t regressions      = 0;
+  missing                 = 0;
+  printf("%-52s %12s %12s %8s %19s %9s\n",
+         "benchmark",
+         "base ns",
+         "cand ns",
+         "change",
+         "interval",
+         "p");
+  for (const std::string &name : baseline.names) {
+    auto found = candidate.byName.find(name);
+    if (candidate.byName.end() == found) {
+      printf("%-52s missing from the candidate%s\n",
+             name.c_str(),
+             options.allowMissing ? "" : "  MISSING");
+      missing++;
+      continue;
+    }
+    const std::vector<double> &before = baseline.byName.at(name);
+    const std::vector<double> &after  = found->second;
+
+    double baseMedian = median(before);
+    double candMedian = median(after);
+    double change     = baseMedian > 0.0 ? candMedian / baseMedian - 1.0 : 0.0;
+    if (before.size() < minSamples || after.size() < minSamples) {
+      printf("%-52s %12.1f %12.1f %+7.1f%% %19s %9s  too few samples\n",
+             name.c_str(),
+             baseMedian,
+             candMedian,
+             change * 100.0,
+             "-",
+             "-");
+      continue;
+    }
+    double p                           = mannWhitneyGreater(before, after);
+    std::pair<double, double> interval = bootstrapRatio(before, after, options);
+    bool regressed = p < options.alpha && change > options.threshold && interval.first > 1.0;
+    char intervalText[32];
+    snprintf(intervalText,
+             sizeof(intervalText),
+             "[%+.1f%%, %+.1f%%]",
+             (interval.first - 1.0) * 100.0,
+             (interval.second - 1.0) * 100.0);
+    printf("%-52s %12.1f %12.1f %+7.1f%% %19s %9.2g%s\n",
+           name.c_str(),
+           baseMedian,
+           candMedian,
+           change * 100.0,
+           intervalText,
+           p,
+           regressed ? "  REGRESSION" : "");
+    regressions += regressed ? 1 : 0;
+  }
+  for (const std::string &name : candidate.names) {
+    if (0 == baseline.byName.count(name)) {
+      printf("%-52s not in the baseline\n", name.c_str());
+    }
+  }
+  return regressions;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  enum OPTIONS {
+    OPT_BASELINE      = 0,
+    OPT_CANDIDATE     = 1,
+    OPT_THRESHOLD     = 2,
+    OPT_ALPHA         = 3,
+    OPT_RESAMPLES     = 4,
+    OPT_HELP          = 5,
+    OPT_ALLOW_MISSING = 6,
+  };
+
+  static struct pal::Option s_longOptions[] = {
+      {"baseline", pal::required_argument, NULL, OPT_BASELINE},
+      {"candidate", pal::required_argument, NULL, OPT_CANDIDATE},
+      {"threshold", pal::required_argument, NULL, OPT_THRESHOLD},
+      {"alpha", pal::required_argument, NULL, OPT_ALPHA},
+      {"resamples", pal::required_argument, NULL, OPT_RESAMPLES},
+      {"allow_missing", pal::no_argument, NULL, OPT_ALLOW_MISSING},
+      {"help", pal::no_argument, NULL, OPT_HELP},
+      {NULL, 0, NULL, 0}};
+
+  Options options;
+  int longIndex = 0;
+  int opt       = 0;
+  double value  = 0.0;
+  while ((opt = pal::getOptLongOnly(argc, argv, "", s_longOptions, &longIndex)) != -1) {
+    switch (opt) {
+      case OPT_BASELINE:
+        options.baselinePaths = splitPaths(pal::g_optArg);
+        break;
+      case OPT_CANDIDATE:
+        options.candidatePaths = splitPaths(pal::g_optArg);
+        break;
+      case OPT_THRESHOLD:
+        if (!parsePositive(pal::g_optArg, value)) {
+          std::cerr << "ERROR: Invalid --threshold: " << pal::g_optArg << "\n";
+          return EXIT_FAILURE;
+        }
+        options.threshold = value / 100.0;
+        break;
+      case OPT_ALPHA:
+        if (!parsePositive(pal::g_optArg, value) || value >= 1.0) {
+          std::cerr << "ERROR: Invalid --alpha: " << pal::g_optArg << "\n";
+          return EXIT_FAILURE;
+        }
+        options.alpha = value;
+        break;
+      case OPT_RESAMPLES:
+        if (!parsePositive(pal::g_optArg, value)) {
+          std::cerr << "ERROR: Invalid --resamples: " << pal::g_optArg << "\n";
+          return EXIT_FAILURE;
+        }
+        options.resamples = static_cast<size_t>(value);
+        break;
+      case OPT_ALLOW_MISSING:
+        options.allowMissing = true;
+        break;
+      case OPT_HELP:
+        showHelp();
+        return EXIT_SUCCESS;
+      default:
+        std::cerr << "ERROR: Invalid argument passed: " << argv[pal::g_optInd - 1] << "\n";
+        showHelp();
+        return EXIT_FAILURE;
+    }
+  }
+  if (options.baselinePaths.empty() || options.candidatePaths.empty()) {
+    showHelp();
+    return EXIT_FAILURE;
+  }
+
+  Samples baseline;
+  Samples candidate;
+  for (const std::string &path : options.baselinePaths) {
+    if (!readResults(path, baseline)) {
+      return EXIT_FAILURE;
+    }
+  }
+  for (const std::string &path : options.candidatePaths) {
+    if (!readResults(path, candidate)) {
+      return EXIT_FAILURE;
+    }
+  }
+  size_t missing     = 0;
+  size_t regressions = compare(baseline, candidate, options, missing);
+  bool failed        = false;
+  if (regressions > 0) {
+    std::cerr << regressions << " benchmark(s) regressed by more than "
+              << options.threshold * 100.0 << "%\n";
+    failed = true;
+  }
+  if (missing > 0 && !options.allowMissing) {
+    std::cerr << missing << " baseline benchmark(s) missing from the candidate, "
+              << "pass --allow_missing if they were removed on purpose\n";
+    failed = true;
+  }
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,279 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+
+// Converts a text input list and the .raw files it references into a single
+// packed dataset container that qnn-mobile-app accepts as --input_list.
+// Every file is stored byte for byte, so the conversion is lossless.
+
+#include <errno.h>
+#include <stdint.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "DataUtil.hpp"
+#include "Logger.hpp"
+#include "PAL/GetOpt.hpp"
+#include "PackedContainer.hpp"
+
+using namespace qnn::tools;
+
+namespace {
+
+struct TensorSpec {
+  Qnn_DataType_t dataType = QNN_DATATYPE_UNDEFINED;
+  std::vector<size_t> dims;
+};
+
+void showHelp() {
+  std::cout
+      << "Usage: qnn-dataset-pack --input_list <file> --output <file> [options]\n\n"
+      << "  --input_list <file>   Input list in qnn-mobile-app format.\n"
+      << "  --output <file>       Container file to create.\n"
+      << "  --tensor <spec>       Optional metadata for a tensor, repeatable:\n"
+      << "                        <name>:<data type>:<d0,d1,...>, e.g. input:float32:1,224,224,3\n"
+      << "  --alignment <bytes>   Blob alignment, power of two. Default: 4096.\n"
+      << "  --verify              Re-read every source file and compare it with the container.\n";
+}
+
+bool parseTensorSpec(const std::string &spec, std::map<std::string, TensorSpec> &tensorSpecs) {
+  size_t nameEnd = spec.find(':');
+  size_t typeEnd = spec.find(':', nameEnd + 1);
+  if (nameEnd == std::string::npos || typeEnd == std::string::npos) {
+    return false;
+  }
+  TensorSpec tensorSpec;
+  datautil::StatusCode status;
+  std::tie(status, tensorSpec.dataType) =
+      datautil::parseDataType(spec.substr(nameEnd + 1, typeEnd - nameEnd - 1));
+  if (datautil::StatusCode::SUCCESS != status) {
+    return false;
+  }
+  std::istringstream dimsStream(spec.substr(typeEnd + 1));
+  std::string dim;
+  while (std::getline(dimsStream, dim, ',')) {
+    if (dim.empty() || dim.find_first_not_of("0123456789") != std::string::npos) {
+      return false;
+    }
+    tensorSpec.dims.push_back(std::stoul(dim));
+  }
+  tensorSpecs[spec.substr(0, nameEnd)] = tensorSpec;
+  return true;
+}
+
+// Splits an input list line the same way qnn-mobile-app does: space separated
+// entries, each either a path or name:=path.
+void splitLine(const std::string &line,
+               std::vector<std::string> &names,
+               std::vector<std::string> &paths) {
+  const std::string separator = ":=";
+  std::istringstream lineStream(line);
+  std::string entry;
+  while (std::getline(lineStream, entry, ' ')) {
+    if (entry.empty()) {
+      continue;
+    }
+    auto position = entry.find(separator);
+    if (position != std::string::npos) {
+      names.push_back(entry.substr(0, position));
+      paths.push_back(entry.substr(position + separator.size()));
+    } else {
+      names.push_back(std::string());
+      paths.push_back(entry);
+    }
+  }
+}
+
+bool verifyContainer(const std::string &containerPath) {
+  packedcontainer::Reader reader;
+  if (packedcontainer::StatusCode::SUCCESS != reader.open(containerPath)) {
+    return false;
+  }
+  for (uint64_t recordIdx = 0; recordIdx < reader.getNumRecords(); recordIdx++) {
+    std::string sourcePath = reader.getRecordSourcePath(recordIdx);
+    size_t length          = static_cast<size_t>(reader.getRecord(recordIdx).length);
+    std::vector<uint8_t> source(length);
+    size_t sourceLength{0};
+    datautil::StatusCode status;
+    std::tie(status, sourceLength) = datautil::getFileSize(sourcePath);
+    if (datautil::StatusCode::SUCCESS != status || sourceLength != length ||
+        (length > 0 &&
+         datautil::StatusCode::SUCCESS !=
+             datautil::readBinaryFromFile(sourcePath, source.data(), length)) ||
+        memcmp(source.data(), reader.getRecordData(recordIdx), length) != 0) {
+      std::cerr << "Verification failed for record " << recordIdx << ": " << sourcePath << "\n";
+      return false;
+    }
+  }
+  std::cout << "Verified " << reader.getNumRecords() << " records\n";
+  return true;
+}
+
+// Accepts powers of two from 8, the smallest alignment a container allows.
+bool parseAlignment(const char *value, uint32_t &alignment) {
+  char *end                 = nullptr;
+  errno                     = 0;
+  unsigned long long parsed = std::strtoull(value, &end, 10);
+  if (end == value || '\0' != *end || ERANGE == errno || nullptr != strchr(value, '-') ||
+      parsed < sizeof(uint64_t) || parsed > UINT32_MAX || (parsed & (parsed - 1)) != 0) {
+    return false;
+  }
+  alignment = static_cast<uint32_t>(parsed);
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  enum OPTIONS {
+    OPT_INPUT_LIST = 0,
+    OPT_OUTPUT     = 1,
+    OPT_TENSOR     = 2,
+    OPT_ALIGNMENT  = 3,
+    OPT_VERIFY     = 4,
+    OPT_HELP       = 5,
+  };
+
+  static struct pal::Option s_longOptions[] = {
+      {"input_list", pal::required_argument, NULL, OPT_INPUT_LIST},
+      {"output", pal::required_argument, NULL, OPT_OUTPUT},
+      {"tensor", pal::required_argument, NULL, OPT_TENSOR},
+      {"alignment", pal::required_argument, NULL, OPT_ALIGNMENT},
+      {"verify", pal::no_argument, NULL, OPT_VERIFY},
+      {"help", pal::no_argument, NULL, OPT_HELP},
+      {NULL, 0, NULL, 0}};
+
+  int longIndex = 0;
+  int opt       = 0;
+  std::string inputListPath;
+  std::string outputPath;
+  std::map<std::string, TensorSpec> tensorSpecs;
+  uint32_t alignment = packedcontainer::g_defaultAlignment;
+  bool verify        = false;
+  while ((opt = pal::getOptLongOnly(argc, argv, "", s_longOptions, &longIndex)) != -1) {
+    switch (opt) {
+      case OPT_INPUT_LIST:
+        inputListPath = pal::g_optArg;
+        break;
+      case OPT_OUTPUT:
+        outputPath = pal::g_optArg;
+        break;
+      case OPT_TENSOR:
+        if (!parseTensorSpec(pal::g_optArg, tensorSpecs)) {
+          std::cerr << "ERROR: Invalid tensor spec: " << pal::g_optArg << "\n";
+          return EXIT_FAILURE;
+        }
+        break;
+      case OPT_ALIGNMENT:
+        if (!parseAlignment(pal::g_optArg, alignment)) {
+          std::cerr << "ERROR: Invalid alignment, expected a power of two >= 8: " << pal::g_optArg
+                    << "\n";
+          return EXIT_FAILURE;
+        }
+        break;
+      case OPT_VERIFY:
+        verify = true;
+        break;
+      case OPT_HELP:
+        showHelp();
+        return EXIT_SUCCESS;
+      default:
+        std::cerr << "ERROR: Invalid argument passed: " << argv[pal::g_optInd - 1] << "\n";
+        showHelp();
+        return EXIT_FAILURE;
+    }
+  }
+  if (inputListPath.empty() || outputPath.empty()) {
+    showHelp();
+    return EXIT_FAILURE;
+  }
+  if (!qnn::log::initializeLogging()) {
+    std::cerr << "ERROR: Unable to initialize logging!\n";
+    return EXIT_FAILURE;
+  }
+
+  std::ifstream inputListStream(inputListPath);
+  if (!inputListStream) {
+    std::cerr << "ERROR: Failed to open input list: " << inputListPath << "\n";
+    return EXIT_FAILURE;
+  }
+  packedcontainer::Writer writer;
+  if (packedcontainer::StatusCode::SUCCESS !=
+      writer.create(outputPath, packedcontainer::Kind::INPUT_DATASET, alignment)) {
+    return EXIT_FAILURE;
+  }
+
+  std::string line;
+  bool firstLine     = true;
+  uint64_t sampleIdx = 0;
+  uint32_t numTensors{0};
+  std::vector<uint8_t> buffer;
+  while (std::getline(inputListStream, line)) {
+    if (line.empty()) {
+      continue;
+    }
+    // Like qnn-mobile-app, only a leading comment line is skipped.
+    if (firstLine && line.compare(0, 1, "#") == 0) {
+      firstLine = false;
+      continue;
+    }
+    firstLine = false;
+    std::vector<std::string> names;
+    std::vector<std::string> paths;
+    splitLine(line, names, paths);
+    for (size_t idx = 0; idx < paths.size(); idx++) {
+      if (idx >= numTensors) {
+        std::string name =
+            names[idx].empty() ? std::string("input_") + std::to_string(idx) : names[idx];
+        TensorSpec spec;
+        if (tensorSpecs.find(name) != tensorSpecs.end()) {
+          spec = tensorSpecs[name];
+        }
+        uint32_t tensorIdx{0};
+        if (packedcontainer::StatusCode::SUCCESS !=
+            writer.addTensor(name, spec.dataType, spec.dims, tensorIdx)) {
+          return EXIT_FAILURE;
+        }
+        numTensors = tensorIdx + 1;
+      }
+      size_t length{0};
+      datautil::StatusCode status;
+      std::tie(status, length) = datautil::getFileSize(paths[idx]);
+      if (datautil::StatusCode::SUCCESS != status) {
+        return EXIT_FAILURE;
+      }
+      buffer.resize(length);
+      if (length > 0 && datautil::StatusCode::SUCCESS !=
+                            datautil::readBinaryFromFile(paths[idx], buffer.data(), length)) {
+        return EXIT_FAILURE;
+      }
+      if (packedcontainer::StatusCode::SUCCESS !=
+          writer.appendRecord(
+              static_cast<uint32_t>(idx), sampleIdx, buffer.data(), length, paths[idx])) {
+        return EXIT_FAILURE;
+      }
+    }
+    sampleIdx++;
+  }
+  if (packedcontainer::StatusCode::SUCCESS != writer.finalize()) {
+    std::cerr << "ERROR: Failed to finalize container: " << outputPath << "\n";
+    return EXIT_FAILURE;
+  }
+  std::cout << "Packed " << sampleIdx << " samples of " << numTensors << " tensors into "
+            << outputPath << "\n";
+  if (verify && !verifyContainer(outputPath)) {
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,304 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+
+// Decodes a trace written by qnn-mobile-app, by default flight_recorder.bin in
+// its output directory, including one left behind by a crashed run, into a
+// time ordered event list or a latency summary per phase.
+
+#include <errno.h>
+#include <time.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "FlightRecorder.hpp"
+#include "PAL/GetOpt.hpp"
+#include "PAL/MappedFile.hpp"
+
+using namespace qnn::tools;
+
+namespace {
+
+struct Event {
+  uint64_t startNs;
+  uint64_t endNs;
+  uint32_t sampleIdx;
+  uint32_t threadId;
+  uint16_t graphIdx;
+  uint16_t tensorIdx;
+  flightrecorder::Phase phase;
+};
+
+void showHelp() {
+  std::cout << "Usage: qnn-flight-decode --trace <file> [options]\n\n"
+            << "  --trace <file>          Trace written by qnn-mobile-app, by default\n"
+            << "                          <output_dir>/flight_recorder.bin.\n"
+            << "  --last_seconds <s>      Only events that ended in the last s seconds of\n"
+            << "                          the trace.\n"
+            << "  --summary               Print count and latency percentiles per phase\n"
+            << "                          instead of the events.\n"
+            << "  --csv                   Print events as CSV.\n";
+}
+
+bool readTrace(const pal::MappedFile &mappedFile,
+               flightrecorder::FileHeader &header,
+               std::vector<Event> &events) {
+  if (mappedFile.size() < sizeof(flightrecorder::FileHeader)) {
+    std::cerr << "ERROR: Trace is too small\n";
+    return false;
+  }
+  const auto *fileHeader = reinterpret_cast<const flightrecorder::FileHeader *>(mappedFile.data());
+  if (0 != memcmp(fileHeader->magic, flightrecorder::g_magic, sizeof(flightrecorder::g_magic)) ||
+      flightrecorder::g_version != fileHeader->version ||
+      sizeof(flightrecorder::Record) != fileHeader->recordSize) {
+    std::cerr << "ERROR: Not a flight recorder trace, or an unsupported version\n";
+    return false;
+  }
+  if (mappedFile.size() <
+      sizeof(flightrecorder::FileHeader) + fileHeader->numRecords * fileHeader->recordSize) {
+    std::cerr << "ERROR: Trace is truncated\n";
+    return false;
+  }
+  memcpy(header.magic, fileHeader->magic, sizeof(header.magic));
+  header.version          = fileHeader->version;
+  header.recordSize       = fileHeader->recordSize;
+  header.numRecords       = fileHeader->numRecords;
+  header.realtimeOffsetNs = fileHeader->realtimeOffsetNs;
+  header.pid              = fileHeader->pid;
+  header.writeIndex.store(fileHeader->writeIndex.load());
+
+  const auto *records = reinterpret_cast<const flightrecorder::Record *>(
+      mappedFile.data() + sizeof(flightrecorder::FileHeader));
+  for (uint64_t idx = 0; idx < header.numRecords; idx++) {
+    const flightrecorder::Record &record = records[idx];
+    auto phase = static_cast<flightrecorder::Phase>(record.phase.load());
+    // Never written, or torn by a crash.
+    if (flightrecorder::Phase::NONE == phase) {
+      continue;
+    }
+    Event event;
+    event.startNs   = record.startNs;
+    event.endNs     = record.endNs;
+    event.sampleIdx = record.sampleIdx;
+    event.threadId  = record.threadId;
+    event.graphIdx  = record.graphIdx;
+    event.tensorIdx = record.tensorIdx;
+    event.phase     = phase;
+    events.push_back(event);
+  }
+  std::sort(events.begin(), events.end(), [](const Event &lhs, const Event &rhs) {
+    return lhs.startNs != rhs.startNs ? lhs.startNs < rhs.startNs : lhs.endNs > rhs.endNs;
+  });
+  return true;
+}
+
+// Formats a monotonic time as local wall clock time with microseconds.
+std::string formatTime(uint64_t timeNs, int64_t realtimeOffsetNs) {
+  int64_t realtimeNs = static_cast<int64_t>(timeNs) + realtimeOffsetNs;
+  time_t seconds     = static_cast<time_t>(realtimeNs / 1000000000ll);
+  struct tm localTime;
+  localtime_r(&seconds, &localTime);
+  char buffer[32];
+  size_t length = strftime(buffer, sizeof(buffer), "%H:%M:%S", &localTime);
+  snprintf(buffer + length,
+           sizeof(buffer) - length,
+           ".%06lld",
+           static_cast<long long>((realtimeNs % 1000000000ll) / 1000));
+  return std::string(buffer);
+}
+
+void printEvents(const std::vector<Event> &events, int64_t realtimeOffsetNs, bool csv) {
+  if (csv) {
+    printf("start_ns,end_ns,duration_us,phase,graph,sample,tensor,thread\n");
+  } else {
+    printf("%-15s %12s  %-18s %5s %8s %6s %7s\n",
+           "time",
+           "duration_us",
+           "phase",
+           "graph",
+           "sample",
+           "tensor",
+           "thread");
+  }
+  for (auto const &event : events) {
+    double durationUs = static_cast<double>(event.endNs - event.startNs) / 1e3;
+    std::string tensor;
+    if (flightrecorder::g_noTensor != event.tensorIdx) {
+      tensor = std::to_string(event.tensorIdx);
+    }
+    if (csv) {
+      printf("%" PRIu64 ",%" PRIu64 ",%.3f,%s,%u,%u,%s,%u\n",
+             event.startNs,
+             event.endNs,
+             durationUs,
+             flightrecorder::getPhaseName(event.phase),
+             event.graphIdx,
+             event.sampleIdx,
+             tensor.c_str(),
+             event.threadId);
+    } else {
+      printf("%-15s %12.3f  %-18s %5u %8u %6s %7u\n",
+             formatTime(event.startNs, realtimeOffsetNs).c_str(),
+             durationUs,
+             flightrecorder::getPhaseName(event.phase),
+             event.graphIdx,
+             event.sampleIdx,
+             tensor.empty() ? "-" : tensor.c_str(),
+             event.threadId);
+    }
+  }
+}
+
+void printSummary(const std::vector<Event> &events) {
+  // Phases are small integers, so index durations by phase directly.
+  std::vector<std::vector<uint64_t>> durations(256);
+  for (auto const &event : events) {
+    durations[static_cast<uint8_t>(event.phase)].push_back(event.endNs - event.startNs);
+  }
+  printf("%-18s %8s %12s %10s %10s %10s %10s\n",
+         "phase",
+         "count",
+         "total_ms",
+         "mean_us",
+         "p50_us",
+         "p99_us",
+         "max_us");
+  for (size_t phaseIdx = 0; phaseIdx < durations.size(); phaseIdx++) {
+    std::vector<uint64_t> &phaseDurations = durations[phaseIdx];
+    if (phaseDurations.empty()) {
+      continue;
+    }
+    std::sort(phaseDurations.begin(), phaseDurations.end());
+    uint64_t totalNs = 0;
+    for (auto duration : phaseDurations) {
+      totalNs += duration;
+    }
+    size_t count = phaseDurations.size();
+    printf("%-18s %8zu %12.3f %10.3f %10.3f %10.3f %10.3f\n",
+           flightrecorder::getPhaseName(static_cast<flightrecorder::Phase>(phaseIdx)),
+           count,
+           static_cast<double>(totalNs) / 1e6,
+           static_cast<double>(totalNs) / 1e3 / static_cast<double>(count),
+           static_cast<double>(phaseDurations[(count - 1) / 2]) / 1e3,
+           static_cast<double>(phaseDurations[(count - 1) * 99 / 100]) / 1e3,
+           static_cast<double>(phaseDurations.back()) / 1e3);
+  }
+}
+
+// Accepts a finite, non-negative number of seconds.
+bool parseSeconds(const char *value, double &seconds) {
+  char *end     = nullptr;
+  errno         = 0;
+  double parsed = std::strtod(value, &end);
+  if (end == value || '\0' != *end || ERANGE == errno || !std::isfinite(parsed) || parsed < 0.0) {
+    return false;
+  }
+  seconds = parsed;
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  enum OPTIONS {
+    OPT_TRACE        = 0,
+    OPT_LAST_SECONDS = 1,
+    OPT_SUMMARY      = 2,
+    OPT_CSV          = 3,
+    OPT_HELP         = 4,
+  };
+
+  static struct pal::Option s_longOptions[] = {
+      {"trace", pal::required_argument, NULL, OPT_TRACE},
+      {"last_seconds", pal::required_argument, NULL, OPT_LAST_SECONDS},
+      {"summary", pal::no_argument, NULL, OPT_SUMMARY},
+      {"csv", pal::no_argument, NULL, OPT_CSV},
+      {"help", pal::no_argument, NULL, OPT_HELP},
+      {NULL, 0, NULL, 0}};
+
+  std::string tracePath;
+  double lastSeconds = 0.0;
+  bool summary       = false;
+  bool csv           = false;
+  int longIndex      = 0;
+  int opt            = 0;
+  while ((opt = pal::getOptLongOnly(argc, argv, "", s_longOptions, &longIndex)) != -1) {
+    switch (opt) {
+      case OPT_TRACE:
+        tracePath = pal::g_optArg;
+        break;
+      case OPT_LAST_SECONDS:
+        if (!parseSeconds(pal::g_optArg, lastSeconds)) {
+          std::cerr << "ERROR: Invalid value passed to --last_seconds: " << pal::g_optArg << "\n";
+          return EXIT_FAILURE;
+        }
+        break;
+      case OPT_SUMMARY:
+        summary = true;
+        break;
+      case OPT_CSV:
+        csv = true;
+        break;
+      case OPT_HELP:
+        showHelp();
+        return EXIT_SUCCESS;
+      default:
+        showHelp();
+        return EXIT_FAILURE;
+    }
+  }
+  if (tracePath.empty()) {
+    showHelp();
+    return EXIT_FAILURE;
+  }
+
+  pal::MappedFile mappedFile;
+  if (!mappedFile.open(tracePath)) {
+    std::cerr << "ERROR: Could not open trace: " << tracePath << "\n";
+    return EXIT_FAILURE;
+  }
+  flightrecorder::FileHeader header;
+  std::vector<Event> events;
+  if (!readTrace(mappedFile, header, events)) {
+    return EXIT_FAILURE;
+  }
+  uint64_t numWritten = header.writeIndex.load();
+  if (lastSeconds > 0.0 && !events.empty()) {
+    uint64_t lastEndNs = 0;
+    for (auto const &event : events) {
+      lastEndNs = std::max(lastEndNs, event.endNs);
+    }
+    // Windows longer than the clock's range keep every event.
+    uint64_t windowNs = lastSeconds * 1e9 >= 18446744073709551615.0
+                            ? UINT64_MAX
+                            : static_cast<uint64_t>(lastSeconds * 1e9);
+    events.erase(std::remove_if(events.begin(),
+                                events.end(),
+                                [&](const Event &event) {
+                                  return lastEndNs - event.endNs > windowNs;
+                                }),
+                 events.end());
+  }
+  std::cerr << "pid " << header.pid << ": " << numWritten << " events recorded, "
+            << (numWritten > header.numRecords ? numWritten - header.numRecords : 0)
+            << " overwritten, " << events.size() << " shown\n";
+
+  if (summary) {
+    printSummary(events);
+  } else {
+    printEvents(events, header.realtimeOffsetNs, csv);
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,154 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+
+// Measures the cost of a QNN_INFO, QNN_VERBOSE and QNN_DEBUG call, as made in
+// the per-inference loops, for every compile-time level (QNN_LOG_COMPILE_LEVEL)
+// and runtime level (setLogLevel). Messages that pass both levels are logged
+// to /dev/null; only the time spent in the calling thread is counted.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "Logger.hpp"
+#include "PAL/GetOpt.hpp"
+
+double benchLogCallsERROR(size_t numBatches, size_t batchSize);
+double benchLogCallsWARN(size_t numBatches, size_t batchSize);
+double benchLogCallsINFO(size_t numBatches, size_t batchSize);
+double benchLogCallsVERBOSE(size_t numBatches, size_t batchSize);
+double benchLogCallsDEBUG(size_t numBatches, size_t batchSize);
+
+namespace {
+
+// Calls per batch of each of the three macros; three times this stays below
+// half the log ring.
+const size_t g_batchSize = 128;
+
+// Three calls per iteration of the loop.
+const size_t g_callsPerIteration = 3;
+
+struct Level {
+  const char *name;
+  QnnLog_Level_t level;
+  double (*loop)(size_t, size_t);
+};
+
+const Level g_levels[] = {
+    {"ERROR", QNN_LOG_LEVEL_ERROR, benchLogCallsERROR},
+    {"WARN", QNN_LOG_LEVEL_WARN, benchLogCallsWARN},
+    {"INFO", QNN_LOG_LEVEL_INFO, benchLogCallsINFO},
+    {"VERBOSE", QNN_LOG_LEVEL_VERBOSE, benchLogCallsVERBOSE},
+    {"DEBUG", QNN_LOG_LEVEL_DEBUG, benchLogCallsDEBUG},
+};
+
+void showHelp() {
+  std::cout << "Usage: qnn-log-bench [options]\n\n"
+            << "  --iterations <n>    Loop iterations per measurement, default 1048576.\n";
+}
+
+// Accepts a positive count; strtoull alone would wrap negative values.
+bool parseIterations(const char *value, size_t &iterations) {
+  char *end                 = nullptr;
+  errno                     = 0;
+  unsigned long long parsed = std::strtoull(value, &end, 10);
+  if (end == value || '\0' != *end || ERANGE == errno || nullptr != strchr(value, '-') ||
+      0 == parsed || parsed > SIZE_MAX) {
+    return false;
+  }
+  iterations = static_cast<size_t>(parsed);
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  enum OPTIONS {
+    OPT_ITERATIONS = 0,
+    OPT_HELP       = 1,
+  };
+
+  static struct pal::Option s_longOptions[] = {
+      {"iterations", pal::required_argument, NULL, OPT_ITERATIONS},
+      {"help", pal::no_argument, NULL, OPT_HELP},
+      {NULL, 0, NULL, 0}};
+
+  size_t iterations = 1 << 20;
+  int longIndex     = 0;
+  int opt           = 0;
+  while ((opt = pal::getOptLongOnly(argc, argv, "", s_longOptions, &longIndex)) != -1) {
+    switch (opt) {
+      case OPT_ITERATIONS:
+        if (!parseIterations(pal::g_optArg, iterations)) {
+          std::cerr << "ERROR: Invalid value passed to --iterations: " << pal::g_optArg << "\n";
+          return EXIT_FAILURE;
+        }
+        break;
+      case OPT_HELP:
+        showHelp();
+        return EXIT_SUCCESS;
+      default:
+        showHelp();
+        return EXIT_FAILURE;
+    }
+  }
+
+  if (!qnn::log::initializeLogging()) {
+    std::cerr << "ERROR: Unable to initialize logging!\n";
+    return EXIT_FAILURE;
+  }
+  // Log output goes to /dev/null while measuring; the table goes to the
+  // original stdout.
+  fflush(stdout);
+  int stdoutFd  = dup(STDOUT_FILENO);
+  int devNullFd = open("/dev/null", O_WRONLY);
+  if (stdoutFd < 0 || devNullFd < 0 || dup2(devNullFd, STDOUT_FILENO) < 0) {
+    std::cerr << "ERROR: Unable to redirect stdout\n";
+    return EXIT_FAILURE;
+  }
+  close(devNullFd);
+
+  size_t numBatches = std::max<size_t>(iterations / g_batchSize, 1);
+  double results[5][5];
+  for (size_t runtimeIdx = 0; runtimeIdx < 5; runtimeIdx++) {
+    qnn::log::Logger::getLogger()->setMaxLevel(g_levels[runtimeIdx].level);
+    for (size_t compileIdx = 0; compileIdx < 5; compileIdx++) {
+      double seconds = g_levels[compileIdx].loop(numBatches, g_batchSize);
+      results[compileIdx][runtimeIdx] =
+          seconds * 1e9 / static_cast<double>(numBatches * g_batchSize * g_callsPerIteration);
+    }
+  }
+
+  qnn::log::flushLogging();
+  fflush(stdout);
+  dup2(stdoutFd, STDOUT_FILENO);
+  close(stdoutFd);
+  printf("ns per log call (INFO, VERBOSE and DEBUG calls), %zu iterations\n",
+         numBatches * g_batchSize);
+  printf("%-16s", "compile \\ run");
+  for (auto const &runtimeLevel : g_levels) {
+    printf("%10s", runtimeLevel.name);
+  }
+  printf("\n");
+  for (size_t compileIdx = 0; compileIdx < 5; compileIdx++) {
+    printf("%-16s", g_levels[compileIdx].name);
+    for (size_t runtimeIdx = 0; runtimeIdx < 5; runtimeIdx++) {
+      printf("%10.2f", results[compileIdx][runtimeIdx]);
+    }
+    printf("\n");
+  }
+  return EXIT_SUCCESS;
+}
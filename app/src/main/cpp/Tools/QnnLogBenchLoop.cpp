@@ -0,0 +1,34 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+
+// The timed loop of qnn-log-bench. It is compiled once per compile-time log
+// level, with QNN_LOG_COMPILE_LEVEL and the function name QNN_LOG_BENCH_LOOP
+// set by the build.
+
+#include <chrono>
+#include <cstddef>
+
+#include "Logger.hpp"
+
+double QNN_LOG_BENCH_LOOP(size_t numBatches, size_t batchSize) {
+  std::chrono::duration<double> elapsed(0);
+  volatile double value = 0.5;
+  for (size_t batch = 0; batch < numBatches; batch++) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t idx = 0; idx < batchSize; idx++) {
+      QNN_INFO("Populated input tensor %zu, scale %f", idx, value);
+      QNN_VERBOSE("Returning from %s", __func__);
+      QNN_DEBUG("allocating buffer of %zu bytes for tensor %zu", batchSize, idx);
+    }
+    elapsed += std::chrono::steady_clock::now() - start;
+    // Enabled messages are written outside the timed part, and a batch never
+    // fills the log ring, so no message is dropped.
+    qnn::log::flushLogging();
+  }
+  return elapsed.count();
+}
@@ -0,0 +1,549 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+
+// Microbenchmarks the per-inference kernels of DataUtil and IOTensor, the
+// input list parser and tensor info copies, over tensor sizes from 1 KiB to
+// 64 MiB, and prints the results as JSON. File benchmarks read and write a
+// scratch directory, so reads come from the page cache.
+
+#include <sys/utsname.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <queue>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "App.hpp"
+#include "DataUtil.hpp"
+#include "IOTensor.hpp"
+#include "MemoryAccounting.hpp"
+#include "PAL/Directory.hpp"
+#include "PAL/FileOp.hpp"
+#include "PAL/GetOpt.hpp"
+#include "PerfCounters.hpp"
+#include "TraceEvent.hpp"
+
+using namespace qnn::tools;
+
+namespace {
+
+struct Result {
+  std::string name;
+  std::string dataType;
+  size_t bytes;
+  size_t elements;
+  size_t iterations;
+  double medianNs;
+  double minNs;
+  // Time per call of every batch, for qnn-bench-compare.
+  std::vector<double> samplesNs;
+  // Counts over all batches, with --perf_counters.
+  bool hasCounters = false;
+  perfcounters::Reading counters;
+};
+
+struct Options {
+  size_t minBytes = 1024;
+  size_t maxBytes = 64 * 1024 * 1024;
+  double minSeconds = 0.2;
+  std::string filter;
+  std::string workDir;
+  bool perfCounters = false;
+};
+
+void showHelp() {
+  std::cout << "Usage: qnn-mobile-app-bench [options]\n\n"
+            << "  --min_bytes <n>       Smallest tensor size, default 1024.\n"
+            << "  --max_bytes <n>       Largest tensor size, default 67108864. Sizes grow\n"
+            << "                        by a factor of 4.\n"
+            << "  --min_time_ms <n>     Time spent on each measurement, default 200.\n"
+            << "  --filter <text>       Only run benchmarks whose name contains text.\n"
+            << "  --work_dir <dir>      Directory for scratch files, default the current\n"
+            << "                        directory.\n"
+            << "  --output <file>       Write the JSON to file instead of stdout.\n"
+            << "  --perf_counters       Add instructions per cycle, clock rate, misses per\n"
+            << "                        KiB and context switches from perf_event_open.\n";
+}
+
+/*
+ * Runs fn repeatedly for at least minSeconds, in batches of at least 10 ms
+ * once calibrated, and keeps the time per call of each batch with their
+ * median and minimum. Stops and returns false as soon as fn returns false.
+ */
+bool measure(const Options &options, const std::function<bool()> &fn, Result &result) {
+  typedef std::chrono::steady_clock Clock;
+  const double minBatchSeconds = 0.01;
+  // Warm up caches and first touch page faults.
+  if (!fn()) {
+    return false;
+  }
+  size_t batchSize = 1;
+  while (true) {
+    auto start = Clock::now();
+    for (size_t idx = 0; idx < batchSize; idx++) {
+      if (!fn()) {
+        return false;
+      }
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    if (seconds >= minBatchSeconds || batchSize >= (1u << 30)) {
+      break;
+    }
+    batchSize *= seconds > 0.0 ? std::min<size_t>(
+                                     static_cast<size_t>(minBatchSeconds / seconds) + 1, 16)
+                               : 16;
+  }
+  std::vector<double> batchNs;
+  double totalSeconds = 0.0;
+  perfcounters::Reading countersBefore;
+  bool hasCounters =
+      options.perfCounters && perfcounters::getCollector().read(countersBefore);
+  while (totalSeconds < options.minSeconds || batchNs.size() < 3) {
+    auto start = Clock::now();
+    for (size_t idx = 0; idx < batchSize; idx++) {
+      if (!fn()) {
+        return false;
+      }
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    totalSeconds += seconds;
+    batchNs.push_back(seconds * 1e9 / static_cast<double>(batchSize));
+  }
+  perfcounters::Reading countersAfter;
+  if (hasCounters && perfcounters::getCollector().read(countersAfter)) {
+    result.hasCounters = true;
+    result.counters.ns = countersAfter.ns - countersBefore.ns;
+    for (size_t idx = 0; idx < perfcounters::g_numCounters; idx++) {
+      result.counters.counts[idx] = countersAfter.counts[idx] - countersBefore.counts[idx];
+    }
+  }
+  result.samplesNs = batchNs;
+  std::sort(batchNs.begin(), batchNs.end());
+  result.iterations = batchNs.size() * batchSize;
+  result.medianNs   = batchNs[batchNs.size() / 2];
+  result.minNs      = batchNs.front();
+  return true;
+}
+
+class Runner {
+ public:
+  explicit Runner(const Options &options) : m_options(options) {}
+
+  // bytes is what one call reads plus what it writes.
+  void run(const std::string &name,
+           const std::string &dataType,
+           size_t bytes,
+           size_t elements,
+           const std::function<void()> &fn) {
+    runChecked(name, dataType, bytes, elements, [&fn]() {
+      fn();
+      return true;
+    });
+  }
+
+  // As run(), for fn that returns false when a call failed. Returns false,
+  // keeping no result, if so.
+  bool runChecked(const std::string &name,
+                  const std::string &dataType,
+                  size_t bytes,
+                  size_t elements,
+                  const std::function<bool()> &fn) {
+    if (!wants(name)) {
+      return true;
+    }
+    std::cerr << name << " " << dataType << " " << bytes << " bytes\n";
+    Result result;
+    if (!measure(m_options, fn, result)) {
+      return false;
+    }
+    result.name     = name;
+    result.dataType = dataType;
+    result.bytes    = bytes;
+    result.elements = elements;
+    m_results.push_back(result);
+    return true;
+  }
+
+  bool wants(const std::string &name) const {
+    return m_options.filter.empty() || std::string::npos != name.find(m_options.filter);
+  }
+
+  const std::vector<Result> &getResults() const { return m_results; }
+
+ private:
+  const Options &m_options;
+  std::vector<Result> m_results;
+};
+
+std::vector<size_t> getSizes(const Options &options) {
+  std::vector<size_t> sizes;
+  for (size_t size = options.minBytes; size <= options.maxBytes; size *= 4) {
+    sizes.push_back(size);
+  }
+  return sizes;
+}
+
+std::vector<float> makeFloats(size_t numElements) {
+  std::vector<float> values(numElements);
+  for (size_t idx = 0; idx < numElements; idx++) {
+    values[idx] = static_cast<float>(idx % 251) / 251.0f;
+  }
+  return values;
+}
+
+template <typename T>
+void benchQuantize(Runner &runner, const char *dataType, const std::vector<size_t> &sizes) {
+  for (size_t bytes : sizes) {
+    size_t numElements = bytes / sizeof(T);
+    std::vector<float> floats = makeFloats(numElements);
+    std::vector<T> quantized(numElements);
+    float scale = 1.0f / static_cast<float>((1ull << (8 * sizeof(T))) - 1);
+    runner.run("floatToTfN", dataType, bytes + numElements * sizeof(float), numElements, [&]() {
+      datautil::floatToTfN<T>(quantized.data(), floats.data(), 0, scale, numElements);
+    });
+    runner.run("tfNToFloat", dataType, bytes + numElements * sizeof(float), numElements, [&]() {
+      datautil::tfNToFloat<T>(floats.data(), quantized.data(), 0, scale, numElements);
+    });
+  }
+}
+
+template <typename T>
+void benchCast(Runner &runner, const char *dataType, const std::vector<size_t> &sizes) {
+  for (size_t bytes : sizes) {
+    size_t numElements = bytes / sizeof(T);
+    std::vector<float> floats = makeFloats(numElements);
+    std::vector<T> values(numElements);
+    runner.run("castFromFloat", dataType, bytes + numElements * sizeof(float), numElements, [&]() {
+      datautil::castFromFloat<T>(values.data(), floats.data(), numElements);
+    });
+    runner.run("castToFloat", dataType, bytes + numElements * sizeof(float), numElements, [&]() {
+      datautil::castToFloat<T>(floats.data(), values.data(), numElements);
+    });
+  }
+}
+
+bool writeFile(const std::string &path, size_t bytes) {
+  std::ofstream file(path, std::ios::binary);
+  std::vector<char> data(std::min<size_t>(bytes, 1 << 20), 0x5a);
+  for (size_t written = 0; written < bytes; written += data.size()) {
+    file.write(data.data(), static_cast<std::streamsize>(std::min(data.size(), bytes - written)));
+  }
+  return static_cast<bool>(file);
+}
+
+bool benchFiles(Runner &runner, const std::string &workDir, const std::vector<size_t> &sizes) {
+  for (size_t bytes : sizes) {
+    std::vector<size_t> dims = {1, bytes};
+    std::vector<uint8_t> buffer(bytes);
+    if (runner.wants("readBatchDataAndUpdateQueue")) {
+      std::string inputPath = workDir + "/input.raw";
+      if (!writeFile(inputPath, bytes)) {
+        std::cerr << "ERROR: Could not write " << inputPath << "\n";
+        return false;
+      }
+      // Without a cache, the file is opened and closed by every call.
+      datautil::InputFileCache fileCache;
+      auto read = [&](datautil::InputFileCache *cache) {
+        std::queue<std::string> filePaths;
+        filePaths.push(inputPath);
+        return datautil::StatusCode::SUCCESS ==
+               std::get<0>(datautil::readBatchDataAndUpdateQueue(
+                   filePaths, dims, QNN_DATATYPE_UINT_8, buffer.data(), cache));
+      };
+      if (!runner.runChecked("readBatchDataAndUpdateQueue", "uint8", bytes, bytes, [&]() {
+            return read(nullptr);
+          }) ||
+          !runner.runChecked("readBatchDataAndUpdateQueue/cached", "uint8", bytes, bytes, [&]() {
+            return read(&fileCache);
+          })) {
+        std::cerr << "ERROR: Could not read " << inputPath << "\n";
+        return false;
+      }
+    }
+    std::vector<std::string> outputDirs = {workDir};
+    if (!runner.runChecked("writeBatchDataToFile", "uint8", bytes, bytes, [&]() {
+          return datautil::StatusCode::SUCCESS ==
+                 datautil::writeBatchDataToFile(
+                     outputDirs, "output.raw", dims, QNN_DATATYPE_UINT_8, buffer.data(), 1);
+        })) {
+      std::cerr << "ERROR: Could not write " << workDir << "/output.raw\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+bool benchInputList(Runner &runner, const std::string &workDir, const std::vector<size_t> &sizes) {
+  if (!runner.wants("readInputList")) {
+    return true;
+  }
+  // Two inputs per line, as for a typical multi input model.
+  const std::string line = "input_0:=data/sample_0000000.raw input_1:=data/sample_0000000.raw\n";
+  std::string listPath   = workDir + "/input_list.txt";
+  for (size_t bytes : sizes) {
+    size_t numLines = std::max<size_t>(bytes / line.size(), 1);
+    {
+      std::ofstream list(listPath);
+      for (size_t idx = 0; idx < numLines; idx++) {
+        list << line;
+      }
+      if (!list) {
+        std::cerr << "ERROR: Could not write " << listPath << "\n";
+        return false;
+      }
+    }
+    runner.run("readInputList", "text", numLines * line.size(), numLines, [&]() {
+      app::readInputList(listPath);
+    });
+  }
+  return true;
+}
+
+void benchTensorInfo(Runner &runner) {
+  iotensor::IOTensor ioTensor;
+  uint32_t dims[] = {1, 224, 224, 256};
+  std::vector<Qnn_ScaleOffset_t> scaleOffsets(256, Qnn_ScaleOffset_t{0.1f, 0});
+  Qnn_Tensor_t src = QNN_TENSOR_INIT;
+  QNN_TENSOR_SET_NAME(&src, "model/backbone/stage_3/conv_2/output_0");
+  QNN_TENSOR_SET_DATA_TYPE(&src, QNN_DATATYPE_UFIXED_POINT_8);
+  QNN_TENSOR_SET_RANK(&src, 4);
+  QNN_TENSOR_SET_DIMENSIONS(&src, dims);
+  // Per channel quantization is the expensive case.
+  Qnn_QuantizeParams_t qParams                    = QNN_QUANTIZE_PARAMS_INIT;
+  qParams.encodingDefinition                      = QNN_DEFINITION_DEFINED;
+  qParams.quantizationEncoding                    = QNN_QUANTIZATION_ENCODING_AXIS_SCALE_OFFSET;
+  qParams.axisScaleOffsetEncoding.axis            = 3;
+  qParams.axisScaleOffsetEncoding.numScaleOffsets = static_cast<uint32_t>(scaleOffsets.size());
+  qParams.axisScaleOffsetEncoding.scaleOffset     = scaleOffsets.data();
+  QNN_TENSOR_SET_QUANT_PARAMS(&src, qParams);
+  size_t bytes = sizeof(Qnn_Tensor_t) + sizeof(dims) + scaleOffsets.size() * sizeof(Qnn_ScaleOffset_t);
+  runner.run("deepCopyQnnTensorInfo", "axis_scale_offset", bytes, 1, [&]() {
+    Qnn_Tensor_t dst = QNN_TENSOR_INIT;
+    ioTensor.deepCopyQnnTensorInfo(&dst, &src);
+    memaccount::Accountant &accountant = memaccount::getAccountant();
+    accountant.release(const_cast<char *>(QNN_TENSOR_GET_NAME(dst)));
+    accountant.release(QNN_TENSOR_GET_DIMENSIONS(dst));
+    accountant.release(QNN_TENSOR_GET_QUANT_PARAMS(dst).axisScaleOffsetEncoding.scaleOffset);
+  });
+}
+
+// Counters that could not be opened are left out. Misses are per KiB read
+// plus written, over all timed calls.
+void printCounters(FILE *out, const Result &result) {
+  perfcounters::Collector &collector = perfcounters::getCollector();
+  const double *counts               = result.counters.counts;
+
+  double cycles = counts[static_cast<size_t>(perfcounters::Counter::CYCLES)];
+  double calls  = static_cast<double>(result.iterations);
+  double kib    = static_cast<double>(result.bytes) * calls / 1024.0;
+  if (collector.isAvailable(perfcounters::Counter::CYCLES) && cycles > 0.0) {
+    fprintf(out, ", \"ghz\": %.3f", cycles / static_cast<double>(result.counters.ns));
+    if (collector.isAvailable(perfcounters::Counter::INSTRUCTIONS)) {
+      fprintf(out,
+              ", \"ipc\": %.3f",
+              counts[static_cast<size_t>(perfcounters::Counter::INSTRUCTIONS)] / cycles);
+    }
+  }
+  const perfcounters::Counter misses[] = {perfcounters::Counter::L1D_MISSES,
+                                          perfcounters::Counter::LLC_MISSES,
+                                          perfcounters::Counter::BRANCH_MISSES};
+  for (perfcounters::Counter counter : misses) {
+    if (collector.isAvailable(counter) && kib > 0.0) {
+      fprintf(out,
+              ", \"%s_per_kib\": %.3f",
+              perfcounters::getCounterName(counter),
+              counts[static_cast<size_t>(counter)] / kib);
+    }
+  }
+  if (collector.isAvailable(perfcounters::Counter::CONTEXT_SWITCHES)) {
+    fprintf(out,
+            ", \"context_switches\": %.0f",
+            counts[static_cast<size_t>(perfcounters::Counter::CONTEXT_SWITCHES)]);
+  }
+}
+
+void printJson(FILE *out, const std::vector<Result> &results) {
+  struct utsname host;
+  memset(&host, 0, sizeof(host));
+  uname(&host);
+  fprintf(out,
+          "{\n  \"context\": {\"host\": %s, \"system\": %s, \"machine\": %s, "
+          "\"cpus\": %ld},\n  \"benchmarks\": [",
+          traceevent::quote(host.nodename).c_str(),
+          traceevent::quote(std::string(host.sysname) + " " + host.release).c_str(),
+          traceevent::quote(host.machine).c_str(),
+          sysconf(_SC_NPROCESSORS_ONLN));
+  for (size_t idx = 0; idx < results.size(); idx++) {
+    const Result &result = results[idx];
+    fprintf(out,
+            "%s\n    {\"name\": \"%s\", \"type\": \"%s\", \"bytes\": %zu, \"elements\": %zu, "
+            "\"iterations\": %zu, \"ns_per_call\": %.1f, \"min_ns_per_call\": %.1f, "
+            "\"ns_per_element\": %.4f, \"gb_per_s\": %.3f, \"samples_ns\": [",
+            0 == idx ? "" : ",",
+            result.name.c_str(),
+            result.dataType.c_str(),
+            result.bytes,
+            result.elements,
+            result.iterations,
+            result.medianNs,
+            result.minNs,
+            result.medianNs / static_cast<double>(result.elements),
+            static_cast<double>(result.bytes) / result.medianNs);
+    for (size_t sampleIdx = 0; sampleIdx < result.samplesNs.size(); sampleIdx++) {
+      fprintf(out, "%s%.1f", 0 == sampleIdx ? "" : ", ", result.samplesNs[sampleIdx]);
+    }
+    fprintf(out, "]");
+    if (result.hasCounters) {
+      printCounters(out, result);
+    }
+    fprintf(out, "}");
+  }
+  fprintf(out, "\n  ]\n}\n");
+}
+
+// Sizes and times must be whole, non negative numbers.
+bool parseSize(const char *text, size_t &value) {
+  char *end = nullptr;
+  errno     = 0;
+  value     = strtoul(text, &end, 10);
+  return end != text && '\0' == *end && '-' != text[0] && 0 == errno;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  enum OPTIONS {
+    OPT_MIN_BYTES     = 0,
+    OPT_MAX_BYTES     = 1,
+    OPT_MIN_TIME_MS   = 2,
+    OPT_FILTER        = 3,
+    OPT_WORK_DIR      = 4,
+    OPT_OUTPUT        = 5,
+    OPT_PERF_COUNTERS = 6,
+    OPT_HELP          = 7,
+  };
+
+  static struct pal::Option s_longOptions[] = {
+      {"min_bytes", pal::required_argument, NULL, OPT_MIN_BYTES},
+      {"max_bytes", pal::required_argument, NULL, OPT_MAX_BYTES},
+      {"min_time_ms", pal::required_argument, NULL, OPT_MIN_TIME_MS},
+      {"filter", pal::required_argument, NULL, OPT_FILTER},
+      {"work_dir", pal::required_argument, NULL, OPT_WORK_DIR},
+      {"output", pal::required_argument, NULL, OPT_OUTPUT},
+      {"perf_counters", pal::no_argument, NULL, OPT_PERF_COUNTERS},
+      {"help", pal::no_argument, NULL, OPT_HELP},
+      {NULL, 0, NULL, 0}};
+
+  Options options;
+  std::string outputPath;
+  std::string workDir = ".";
+  size_t minTimeMs    = 0;
+  int longIndex       = 0;
+  int opt             = 0;
+  while ((opt = pal::getOptLongOnly(argc, argv, "", s_longOptions, &longIndex)) != -1) {
+    switch (opt) {
+      case OPT_MIN_BYTES:
+        if (!parseSize(pal::g_optArg, options.minBytes)) {
+          std::cerr << "ERROR: Invalid --min_bytes: " << pal::g_optArg << "\n";
+          return EXIT_FAILURE;
+        }
+        break;
+      case OPT_MAX_BYTES:
+        if (!parseSize(pal::g_optArg, options.maxBytes)) {
+          std::cerr << "ERROR: Invalid --max_bytes: " << pal::g_optArg << "\n";
+          return EXIT_FAILURE;
+        }
+        break;
+      case OPT_MIN_TIME_MS:
+        if (!parseSize(pal::g_optArg, minTimeMs)) {
+          std::cerr << "ERROR: Invalid --min_time_ms: " << pal::g_optArg << "\n";
+          return EXIT_FAILURE;
+        }
+        options.minSeconds = static_cast<double>(minTimeMs) / 1e3;
+        break;
+      case OPT_FILTER:
+        options.filter = pal::g_optArg;
+        break;
+      case OPT_WORK_DIR:
+        workDir = pal::g_optArg;
+        break;
+      case OPT_OUTPUT:
+        outputPath = pal::g_optArg;
+        break;
+      case OPT_PERF_COUNTERS:
+        options.perfCounters = true;
+        break;
+      case OPT_HELP:
+        showHelp();
+        return EXIT_SUCCESS;
+      default:
+        showHelp();
+        return EXIT_FAILURE;
+    }
+  }
+  if (options.minBytes < 64 || options.minBytes > options.maxBytes) {
+    std::cerr << "ERROR: --min_bytes must be at least 64 and at most --max_bytes\n";
+    return EXIT_FAILURE;
+  }
+
+  options.workDir = workDir + "/qnn-mobile-app-bench-" + std::to_string(getpid());
+  if (!pal::Directory::makePath(options.workDir)) {
+    std::cerr << "ERROR: Could not create " << options.workDir << "\n";
+    return EXIT_FAILURE;
+  }
+
+  if (options.perfCounters &&
+      perfcounters::StatusCode::SUCCESS != perfcounters::getCollector().enable()) {
+    std::cerr << "ERROR: Performance counters are not available, check perf_event_paranoid\n";
+    return EXIT_FAILURE;
+  }
+
+  std::vector<size_t> sizes = getSizes(options);
+  Runner runner(options);
+  benchQuantize<uint8_t>(runner, "uint8", sizes);
+  benchQuantize<uint16_t>(runner, "uint16", sizes);
+  // The cast kernels datautil has. Bool tensors go through the uint8 one and
+  // there are none for float16 or 64 bit types.
+  benchCast<uint8_t>(runner, "uint8", sizes);
+  benchCast<uint16_t>(runner, "uint16", sizes);
+  benchCast<uint32_t>(runner, "uint32", sizes);
+  benchCast<int8_t>(runner, "int8", sizes);
+  benchCast<int16_t>(runner, "int16", sizes);
+  benchCast<int32_t>(runner, "int32", sizes);
+  bool filesWritten = benchFiles(runner, options.workDir, sizes) &&
+                      benchInputList(runner, options.workDir, sizes);
+  benchTensorInfo(runner);
+  pal::Directory::remove(options.workDir);
+  if (!filesWritten) {
+    return EXIT_FAILURE;
+  }
+
+  FILE *out = stdout;
+  if (!outputPath.empty()) {
+    out = fopen(outputPath.c_str(), "w");
+    if (nullptr == out) {
+      std::cerr << "ERROR: Could not create " << outputPath << "\n";
+      return EXIT_FAILURE;
+    }
+  }
+  printJson(out, runner.getResults());
+  if (stdout != out) {
+    fclose(out);
+  }
+  return EXIT_SUCCESS;
+}
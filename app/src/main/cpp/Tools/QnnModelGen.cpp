@@ -0,0 +1,394 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+
+// Generates the tensor tables of a synthetic model library from a spec, as
+// C++ source to be compiled with Tools/QnnSyntheticModel.cpp. CMake's
+// qnn_add_synthetic_model() runs it and builds the library.
+//
+// A spec has one statement per line; # starts a comment:
+//   graph <name> [count=<n>]
+//   input <name> <data type> <d0,d1,...> [count=<n>] [scale=<s>,...]
+//         [offset=<o>,...] [axis=<a>]
+//   output ... as input
+// Tensors belong to the graph above them. count=n repeats a graph or tensor
+// n times, named <name>_0 to <name>_<n-1>. Fixed point tensors need scale and
+// offset; with axis, every index of that axis gets an encoding, cycling
+// through the scales and offsets given.
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "DataUtil.hpp"
+#include "PAL/GetOpt.hpp"
+
+using namespace qnn::tools;
+
+namespace {
+
+struct TensorSpec {
+  std::string name;
+  bool isInput;
+  Qnn_DataType_t dataType;
+  std::vector<uint32_t> dims;
+  std::vector<float> scales;
+  std::vector<int32_t> offsets;
+  int32_t axis = -1;
+};
+
+struct GraphSpec {
+  std::string name;
+  std::vector<TensorSpec> tensors;
+};
+
+void showHelp() {
+  std::cout << "Usage: qnn-model-gen --spec <file> --output <file>\n\n"
+            << "  --spec <file>     Synthetic model spec, see Tools/QnnModelGen.cpp.\n"
+            << "  --output <file>   C++ source to write.\n";
+}
+
+bool isFixedPoint(Qnn_DataType_t dataType) {
+  switch (dataType) {
+    case QNN_DATATYPE_SFIXED_POINT_8:
+    case QNN_DATATYPE_SFIXED_POINT_16:
+    case QNN_DATATYPE_SFIXED_POINT_32:
+    case QNN_DATATYPE_UFIXED_POINT_8:
+    case QNN_DATATYPE_UFIXED_POINT_16:
+    case QNN_DATATYPE_UFIXED_POINT_32:
+      return true;
+    default:
+      return false;
+  }
+}
+
+template <typename T>
+bool parseList(const std::string &text, std::vector<T> &values) {
+  std::istringstream stream(text);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    std::istringstream itemStream(item);
+    T value;
+    if (!(itemStream >> value) || !itemStream.eof()) {
+      return false;
+    }
+    values.push_back(value);
+  }
+  return !values.empty();
+}
+
+// Names are written into C++ string literals as they are.
+bool isValidName(const std::string &name) {
+  for (char c : name) {
+    if (!isalnum(static_cast<unsigned char>(c)) && nullptr == strchr("_.:/-", c)) {
+      return false;
+    }
+  }
+  return !name.empty();
+}
+
+bool parseCount(const std::string &text, uint32_t &count) {
+  std::vector<uint32_t> values;
+  if (!parseList(text, values) || 1 != values.size() || 0 == values[0]) {
+    return false;
+  }
+  count = values[0];
+  return true;
+}
+
+// Appends the tensor, or count copies of it, to graph. Returns an error
+// message, empty on success.
+std::string parseTensor(std::istringstream &words, bool isInput, GraphSpec &graph) {
+  TensorSpec tensor;
+  tensor.isInput = isInput;
+  std::string dataTypeName;
+  std::string dims;
+  if (!(words >> tensor.name >> dataTypeName >> dims)) {
+    return "expected <name> <data type> <dims>";
+  }
+  if (!isValidName(tensor.name)) {
+    return "invalid tensor name " + tensor.name;
+  }
+  datautil::StatusCode status;
+  std::tie(status, tensor.dataType) = datautil::parseDataType(dataTypeName);
+  if (datautil::StatusCode::SUCCESS != status) {
+    return "unknown data type " + dataTypeName;
+  }
+  if (!parseList(dims, tensor.dims)) {
+    return "invalid dims " + dims;
+  }
+  for (uint32_t dim : tensor.dims) {
+    if (0 == dim) {
+      return "dims must not be 0";
+    }
+  }
+  uint32_t count = 0;
+  std::string option;
+  while (words >> option) {
+    size_t equals     = option.find('=');
+    std::string key   = option.substr(0, equals);
+    std::string value = std::string::npos == equals ? "" : option.substr(equals + 1);
+    bool valid        = false;
+    if ("count" == key) {
+      valid = parseCount(value, count);
+    } else if ("scale" == key) {
+      valid = parseList(value, tensor.scales);
+    } else if ("offset" == key) {
+      valid = parseList(value, tensor.offsets);
+    } else if ("axis" == key) {
+      std::vector<int32_t> axis;
+      valid = parseList(value, axis) && 1 == axis.size() && axis[0] >= 0 &&
+              axis[0] < static_cast<int32_t>(tensor.dims.size());
+      if (valid) {
+        tensor.axis = axis[0];
+      }
+    }
+    if (!valid) {
+      return "invalid option " + option;
+    }
+  }
+  if (isFixedPoint(tensor.dataType) != !tensor.scales.empty() ||
+      tensor.scales.empty() != tensor.offsets.empty()) {
+    return "fixed point tensors, and only those, need scale and offset";
+  }
+  if (tensor.axis < 0 && (tensor.scales.size() > 1 || tensor.offsets.size() > 1)) {
+    return "several scales or offsets need an axis";
+  }
+  if (tensor.axis >= 0 && tensor.scales.empty()) {
+    return "axis needs scale and offset";
+  }
+  if (0 == count) {
+    graph.tensors.push_back(tensor);
+    return "";
+  }
+  for (uint32_t idx = 0; idx < count; idx++) {
+    graph.tensors.push_back(tensor);
+    graph.tensors.back().name = tensor.name + "_" + std::to_string(idx);
+  }
+  return "";
+}
+
+bool parseSpec(const std::string &path, std::vector<GraphSpec> &graphs) {
+  std::ifstream spec(path);
+  if (!spec) {
+    std::cerr << "ERROR: Failed to open spec: " << path << "\n";
+    return false;
+  }
+  // Graphs are repeated once their tensors are known.
+  std::vector<uint32_t> graphCounts;
+  std::string line;
+  size_t lineNumber = 0;
+  while (std::getline(spec, line)) {
+    lineNumber++;
+    line = line.substr(0, line.find('#'));
+    std::istringstream words(line);
+    std::string keyword;
+    if (!(words >> keyword)) {
+      continue;
+    }
+    std::string error;
+    if ("graph" == keyword) {
+      GraphSpec graph;
+      uint32_t count = 0;
+      std::string option;
+      if (!(words >> graph.name)) {
+        error = "expected a graph name";
+      } else if (!isValidName(graph.name)) {
+        error = "invalid graph name " + graph.name;
+      } else if (words >> option && (0 != option.compare(0, 6, "count=") ||
+                                     !parseCount(option.substr(6), count) || words >> option)) {
+        error = "invalid option " + option;
+      }
+      graphs.push_back(graph);
+      graphCounts.push_back(count);
+    } else if ("input" == keyword || "output" == keyword) {
+      if (graphs.empty()) {
+        error = "tensor before the first graph";
+      } else {
+        error = parseTensor(words, "input" == keyword, graphs.back());
+      }
+    } else {
+      error = "unknown statement " + keyword;
+    }
+    if (!error.empty()) {
+      std::cerr << "ERROR: " << path << ":" << lineNumber << ": " << error << "\n";
+      return false;
+    }
+  }
+  if (graphs.empty()) {
+    std::cerr << "ERROR: " << path << ": no graphs\n";
+    return false;
+  }
+  std::vector<GraphSpec> expanded;
+  for (size_t idx = 0; idx < graphs.size(); idx++) {
+    if (0 == graphCounts[idx]) {
+      expanded.push_back(graphs[idx]);
+      continue;
+    }
+    for (uint32_t copy = 0; copy < graphCounts[idx]; copy++) {
+      expanded.push_back(graphs[idx]);
+      expanded.back().name = graphs[idx].name + "_" + std::to_string(copy);
+    }
+  }
+  graphs.swap(expanded);
+  return true;
+}
+
+// Floats are written with enough digits to read back exactly.
+std::string formatFloat(float value) {
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%.9gf", value);
+  std::string text = buffer;
+  if (std::string::npos == text.find_first_of(".e")) {
+    text.insert(text.size() - 1, ".0");
+  }
+  return text;
+}
+
+std::string formatScaleOffset(float scale, int32_t offset) {
+  return "{" + formatFloat(scale) + ", " + std::to_string(offset) + "}";
+}
+
+bool writeSource(const std::string &path,
+                 const std::string &specPath,
+                 const std::vector<GraphSpec> &graphs) {
+  std::ofstream source(path);
+  source << "// Generated by qnn-model-gen from " << specPath << ". Do not edit.\n\n"
+         << "#include \"QnnSyntheticModel.hpp\"\n\n"
+         << "using namespace qnn::tools;\n\n"
+         << "namespace {\n\n";
+  // Dimensions and per axis encodings first, as the tensor tables refer to
+  // them.
+  for (size_t graphIdx = 0; graphIdx < graphs.size(); graphIdx++) {
+    const std::vector<TensorSpec> &tensors = graphs[graphIdx].tensors;
+    for (size_t tensorIdx = 0; tensorIdx < tensors.size(); tensorIdx++) {
+      const TensorSpec &tensor = tensors[tensorIdx];
+      std::string suffix       = std::to_string(graphIdx) + "_" + std::to_string(tensorIdx);
+      source << "const uint32_t g_dims" << suffix << "[] = {";
+      for (size_t dimIdx = 0; dimIdx < tensor.dims.size(); dimIdx++) {
+        source << (0 == dimIdx ? "" : ", ") << tensor.dims[dimIdx];
+      }
+      source << "};\n";
+      if (tensor.axis >= 0) {
+        source << "const Qnn_ScaleOffset_t g_scaleOffsets" << suffix << "[] = {\n";
+        for (uint32_t idx = 0; idx < tensor.dims[tensor.axis]; idx++) {
+          source << "    "
+                 << formatScaleOffset(tensor.scales[idx % tensor.scales.size()],
+                                      tensor.offsets[idx % tensor.offsets.size()])
+                 << ",\n";
+        }
+        source << "};\n";
+      }
+    }
+  }
+  source << "\n";
+  for (size_t graphIdx = 0; graphIdx < graphs.size(); graphIdx++) {
+    const std::vector<TensorSpec> &tensors = graphs[graphIdx].tensors;
+    source << "const synthetic::TensorSpec g_tensors" << graphIdx << "[] = {\n";
+    for (size_t tensorIdx = 0; tensorIdx < tensors.size(); tensorIdx++) {
+      const TensorSpec &tensor = tensors[tensorIdx];
+      std::string suffix       = std::to_string(graphIdx) + "_" + std::to_string(tensorIdx);
+      std::string encoding     = "QNN_QUANTIZATION_ENCODING_UNDEFINED";
+      std::string scaleOffset  = "{0.0f, 0}";
+      std::string scaleOffsets = "nullptr";
+      uint32_t numScaleOffsets = 0;
+      if (tensor.axis >= 0) {
+        encoding        = "QNN_QUANTIZATION_ENCODING_AXIS_SCALE_OFFSET";
+        scaleOffsets    = "g_scaleOffsets" + suffix;
+        numScaleOffsets = tensor.dims[tensor.axis];
+      } else if (!tensor.scales.empty()) {
+        encoding    = "QNN_QUANTIZATION_ENCODING_SCALE_OFFSET";
+        scaleOffset = formatScaleOffset(tensor.scales[0], tensor.offsets[0]);
+      }
+      const char *type = tensor.isInput ? "QNN_TENSOR_TYPE_APP_WRITE" : "QNN_TENSOR_TYPE_APP_READ";
+      char dataType[16];
+      snprintf(dataType, sizeof(dataType), "0x%04x", static_cast<unsigned>(tensor.dataType));
+      source << "    {\"" << tensor.name << "\",\n"
+             << "     " << type << ",\n"
+             << "     static_cast<Qnn_DataType_t>(" << dataType << "),  // "
+             << datautil::getDataTypeName(tensor.dataType) << "\n"
+             << "     " << tensor.dims.size() << ",\n"
+             << "     g_dims" << suffix << ",\n"
+             << "     " << encoding << ",\n"
+             << "     " << scaleOffset << ",\n"
+             << "     " << tensor.axis << ",\n"
+             << "     " << numScaleOffsets << ",\n"
+             << "     " << scaleOffsets << "},\n";
+    }
+    source << "};\n";
+  }
+  source << "\nconst synthetic::GraphSpec g_graphs[] = {\n";
+  for (size_t graphIdx = 0; graphIdx < graphs.size(); graphIdx++) {
+    source << "    {\"" << graphs[graphIdx].name << "\", " << graphs[graphIdx].tensors.size()
+           << ", g_tensors" << graphIdx << "},\n";
+  }
+  source << "};\n\n"
+         << "}  // namespace\n\n"
+         << "const synthetic::ModelSpec synthetic::g_modelSpec = {" << graphs.size()
+         << ", g_graphs};\n";
+  source.close();
+  if (!source) {
+    std::cerr << "ERROR: Failed to write " << path << "\n";
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  enum OPTIONS {
+    OPT_SPEC   = 0,
+    OPT_OUTPUT = 1,
+    OPT_HELP   = 2,
+  };
+
+  static struct pal::Option s_longOptions[] = {
+      {"spec", pal::required_argument, NULL, OPT_SPEC},
+      {"output", pal::required_argument, NULL, OPT_OUTPUT},
+      {"help", pal::no_argument, NULL, OPT_HELP},
+      {NULL, 0, NULL, 0}};
+
+  std::string specPath;
+  std::string outputPath;
+  int longIndex = 0;
+  int opt       = 0;
+  while ((opt = pal::getOptLongOnly(argc, argv, "", s_longOptions, &longIndex)) != -1) {
+    switch (opt) {
+      case OPT_SPEC:
+        specPath = pal::g_optArg;
+        break;
+      case OPT_OUTPUT:
+        outputPath = pal::g_optArg;
+        break;
+      case OPT_HELP:
+        showHelp();
+        return EXIT_SUCCESS;
+      default:
+        std::cerr << "ERROR: Invalid argument passed: " << argv[pal::g_optInd - 1] << "\n";
+        showHelp();
+        return EXIT_FAILURE;
+    }
+  }
+  if (specPath.empty() || outputPath.empty()) {
+    showHelp();
+    return EXIT_FAILURE;
+  }
+
+  std::vector<GraphSpec> graphs;
+  if (!parseSpec(specPath, graphs) || !writeSource(outputPath, specPath, graphs)) {
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,132 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+
+// Expands an output container written by qnn-mobile-app --output_container
+// back into the usual output tree, <dir>/[graph/]Result_<sample>/<file>.raw,
+// so existing comparison scripts keep working.
+
+#include <iostream>
+#include <string>
+
+#include "DataUtil.hpp"
+#include "Logger.hpp"
+#include "PAL/GetOpt.hpp"
+#include "PAL/Path.hpp"
+#include "PackedContainer.hpp"
+
+using namespace qnn::tools;
+
+namespace {
+
+void showHelp() {
+  std::cout << "Usage: qnn-output-extract --container <file> --output_dir <dir> [options]\n\n"
+            << "  --container <file>    Output container written by qnn-mobile-app.\n"
+            << "  --output_dir <dir>    Directory to recreate the Result_N tree in.\n"
+            << "  --list                Print the container contents instead of extracting.\n";
+}
+
+void listContainer(const packedcontainer::Reader &reader) {
+  for (uint32_t tensorIdx = 0; tensorIdx < reader.getNumTensors(); tensorIdx++) {
+    const packedcontainer::TensorInfo &info = reader.getTensorInfo(tensorIdx);
+    std::cout << info.name << " " << datautil::getDataTypeName(info.dataType) << " [";
+    for (size_t r = 0; r < info.dims.size(); r++) {
+      std::cout << (r > 0 ? "," : "") << info.dims[r];
+    }
+    std::cout << "] " << reader.getTensorRecords(tensorIdx).size() << " records\n";
+  }
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  enum OPTIONS {
+    OPT_CONTAINER  = 0,
+    OPT_OUTPUT_DIR = 1,
+    OPT_LIST       = 2,
+    OPT_HELP       = 3,
+  };
+
+  static struct pal::Option s_longOptions[] = {
+      {"container", pal::required_argument, NULL, OPT_CONTAINER},
+      {"output_dir", pal::required_argument, NULL, OPT_OUTPUT_DIR},
+      {"list", pal::no_argument, NULL, OPT_LIST},
+      {"help", pal::no_argument, NULL, OPT_HELP},
+      {NULL, 0, NULL, 0}};
+
+  int longIndex = 0;
+  int opt       = 0;
+  std::string containerPath;
+  std::string outputDir;
+  bool listOnly = false;
+  while ((opt = pal::getOptLongOnly(argc, argv, "", s_longOptions, &longIndex)) != -1) {
+    switch (opt) {
+      case OPT_CONTAINER:
+        containerPath = pal::g_optArg;
+        break;
+      case OPT_OUTPUT_DIR:
+        outputDir = pal::g_optArg;
+        break;
+      case OPT_LIST:
+        listOnly = true;
+        break;
+      case OPT_HELP:
+        showHelp();
+        return EXIT_SUCCESS;
+      default:
+        std::cerr << "ERROR: Invalid argument passed: " << argv[pal::g_optInd - 1] << "\n";
+        showHelp();
+        return EXIT_FAILURE;
+    }
+  }
+  if (containerPath.empty() || (outputDir.empty() && !listOnly)) {
+    showHelp();
+    return EXIT_FAILURE;
+  }
+  if (!qnn::log::initializeLogging()) {
+    std::cerr << "ERROR: Unable to initialize logging!\n";
+    return EXIT_FAILURE;
+  }
+
+  packedcontainer::Reader reader;
+  if (packedcontainer::StatusCode::SUCCESS != reader.open(containerPath)) {
+    return EXIT_FAILURE;
+  }
+  if (packedcontainer::Kind::OUTPUT_RESULTS != reader.getKind()) {
+    std::cerr << "ERROR: " << containerPath << " is not an output container\n";
+    return EXIT_FAILURE;
+  }
+  if (listOnly) {
+    listContainer(reader);
+    return EXIT_SUCCESS;
+  }
+  reader.advise(pal::MappedFile::Advice::SEQUENTIAL);
+  const std::string separator(1, pal::Path::getSeparator());
+  for (uint64_t recordIdx = 0; recordIdx < reader.getNumRecords(); recordIdx++) {
+    const packedcontainer::RecordEntry &record = reader.getRecord(recordIdx);
+    // Tensor names are "[graph/]file", matching the directory layout the app
+    // writes without a container.
+    std::string name     = reader.getTensorInfo(record.tensorIdx).name;
+    std::string graphDir = outputDir;
+    size_t slash         = name.rfind('/');
+    if (slash != std::string::npos) {
+      graphDir += separator + name.substr(0, slash);
+      name = name.substr(slash + 1);
+    }
+    std::string resultDir = graphDir + separator + "Result_" + std::to_string(record.sampleIdx);
+    if (datautil::StatusCode::SUCCESS !=
+        datautil::writeBinaryToFile(resultDir,
+                                    name,
+                                    const_cast<uint8_t *>(reader.getRecordData(recordIdx)),
+                                    static_cast<size_t>(record.length))) {
+      std::cerr << "ERROR: Failed to write " << resultDir << separator << name << "\n";
+      return EXIT_FAILURE;
+    }
+  }
+  std::cout << "Extracted " << reader.getNumRecords() << " records to " << outputDir << "\n";
+  return EXIT_SUCCESS;
+}
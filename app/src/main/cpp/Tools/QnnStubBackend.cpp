@@ -0,0 +1,1047 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+
+// A stand-in QNN backend, libQnnStub.so, for measuring the app's own host
+// side cost without hardware. It accepts any graph a model library composes,
+// and graphExecute() waits out a configured latency and fills the outputs
+// with values derived from a hash of the inputs, so the same inputs always
+// give the same outputs. No ops are computed.
+//
+// Configured through environment variables, as the app passes no backend
+// config:
+//   QNN_STUB_LATENCY  Device time of each execution:
+//                       fixed:<us>                 always us (default fixed:0)
+//                       uniform:<min_us>:<max_us>  uniformly distributed
+//                       normal:<mean_us>:<sd_us>   normally distributed, >= 0
+//                       copy:<mb_per_s>            input and output bytes moved
+//                                                  at mb_per_s
+//   QNN_STUB_SEED     Seed of the distributed latencies, default 1.
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Only the interface provider is exported; everything else is hidden.
+#define QNN_INTERFACE __attribute__((visibility("default")))
+
+#include "QnnInterface.h"
+#include "QnnTypeMacros.hpp"
+#include "SysUtil.hpp"
+
+namespace {
+
+const uint32_t g_backendMagic = 0x51534231;  // "QSB1"
+const uint32_t g_contextMagic = 0x51534331;
+const uint32_t g_graphMagic   = 0x51534731;
+const uint32_t g_profileMagic = 0x51535031;
+const uint32_t g_memMagic     = 0x51534d31;
+
+typedef std::chrono::steady_clock Clock;
+
+uint64_t nowUs() { return qnn::tools::sysutil::nowNs() / 1000; }
+
+// The stub supports a single logger, the one the backend was created with.
+// Timestamps are nanoseconds since it was created.
+QnnLog_Callback_t g_logCallback = nullptr;
+QnnLog_Level_t g_logLevel       = QNN_LOG_LEVEL_ERROR;
+Clock::time_point g_logEpoch;
+
+void log(QnnLog_Level_t level, const char *fmt, ...) {
+  if (nullptr == g_logCallback || level > g_logLevel) {
+    return;
+  }
+  va_list args;
+  va_start(args, fmt);
+  uint64_t timestamp =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - g_logEpoch).count();
+  g_logCallback(fmt, level, timestamp, args);
+  va_end(args);
+}
+
+size_t getDataTypeSize(Qnn_DataType_t dataType) {
+  switch (dataType) {
+    case QNN_DATATYPE_INT_8:
+    case QNN_DATATYPE_UINT_8:
+    case QNN_DATATYPE_SFIXED_POINT_8:
+    case QNN_DATATYPE_UFIXED_POINT_8:
+    case QNN_DATATYPE_BOOL_8:
+      return 1;
+    case QNN_DATATYPE_INT_16:
+    case QNN_DATATYPE_UINT_16:
+    case QNN_DATATYPE_FLOAT_16:
+    case QNN_DATATYPE_SFIXED_POINT_16:
+    case QNN_DATATYPE_UFIXED_POINT_16:
+      return 2;
+    case QNN_DATATYPE_INT_32:
+    case QNN_DATATYPE_UINT_32:
+    case QNN_DATATYPE_FLOAT_32:
+    case QNN_DATATYPE_SFIXED_POINT_32:
+    case QNN_DATATYPE_UFIXED_POINT_32:
+      return 4;
+    case QNN_DATATYPE_INT_64:
+    case QNN_DATATYPE_UINT_64:
+    case QNN_DATATYPE_FLOAT_64:
+      return 8;
+    default:
+      return 0;
+  }
+}
+
+// Bytes the tensor's dimensions and data type call for, 0 if unknown.
+size_t getTensorSize(const Qnn_Tensor_t &tensor) {
+  size_t size          = getDataTypeSize(QNN_TENSOR_GET_DATA_TYPE(tensor));
+  const uint32_t *dims = QNN_TENSOR_GET_DIMENSIONS(tensor);
+  for (uint32_t idx = 0; nullptr != dims && idx < QNN_TENSOR_GET_RANK(tensor); idx++) {
+    size *= dims[idx];
+  }
+  return size;
+}
+
+//------------------------------------------------------------------------------
+// Latency model
+//------------------------------------------------------------------------------
+
+struct LatencyModel {
+  enum class Kind { FIXED, UNIFORM, NORMAL, COPY };
+
+  Kind kind     = Kind::FIXED;
+  double first  = 0.0;
+  double second = 0.0;
+};
+
+bool parseLatencyModel(const std::string &spec, LatencyModel &model) {
+  size_t colon = spec.find(':');
+  if (std::string::npos == colon) {
+    return false;
+  }
+  std::string kind = spec.substr(0, colon);
+  std::vector<double> values;
+  const char *cursor = spec.c_str() + colon + 1;
+  while (true) {
+    char *end    = nullptr;
+    double value = strtod(cursor, &end);
+    if (end == cursor || value < 0.0) {
+      return false;
+    }
+    values.push_back(value);
+    if ('\0' == *end) {
+      break;
+    }
+    if (':' != *end) {
+      return false;
+    }
+    cursor = end + 1;
+  }
+  if ("fixed" == kind && 1 == values.size()) {
+    model.kind = LatencyModel::Kind::FIXED;
+  } else if ("uniform" == kind && 2 == values.size() && values[0] <= values[1]) {
+    model.kind = LatencyModel::Kind::UNIFORM;
+  } else if ("normal" == kind && 2 == values.size()) {
+    model.kind = LatencyModel::Kind::NORMAL;
+  } else if ("copy" == kind && 1 == values.size() && values[0] > 0.0) {
+    model.kind = LatencyModel::Kind::COPY;
+  } else {
+    return false;
+  }
+  model.first  = values[0];
+  model.second = values.size() > 1 ? values[1] : 0.0;
+  return true;
+}
+
+// Sleeps until shortly before deadline and spins for the rest, as sleeping
+// alone overshoots by tens of microseconds.
+void waitUntil(Clock::time_point deadline) {
+  const auto spinTime = std::chrono::microseconds(100);
+  while (true) {
+    auto now = Clock::now();
+    if (now >= deadline) {
+      return;
+    }
+    if (deadline - now > 2 * spinTime) {
+      std::this_thread::sleep_for(deadline - now - spinTime);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Handles
+//------------------------------------------------------------------------------
+
+struct Backend;
+struct Context;
+
+struct ProfileEvent {
+  std::string identifier;
+  QnnProfile_EventData_t data;
+  std::vector<QnnProfile_EventId_t> subEventIds;
+};
+
+struct Profile {
+  uint32_t magic = g_profileMagic;
+  QnnProfile_Level_t level;
+  std::mutex mutex;
+  // A deque, so the ids handed out (event addresses) stay valid as events
+  // are added.
+  std::deque<ProfileEvent> events;
+  std::vector<QnnProfile_EventId_t> topLevelIds;
+
+  // Events only ever describe the last call that took the profile.
+  void clear() {
+    events.clear();
+    topLevelIds.clear();
+  }
+
+  ProfileEvent &add(ProfileEvent *parent,
+                    QnnProfile_EventType_t type,
+                    QnnProfile_EventUnit_t unit,
+                    uint64_t value,
+                    const std::string &identifier) {
+    events.emplace_back();
+    ProfileEvent &event = events.back();
+    event.identifier    = identifier;
+    event.data.type     = type;
+    event.data.unit     = unit;
+    event.data.value    = value;
+    // Points into the event, which the deque never moves.
+    event.data.identifier   = event.identifier.c_str();
+    QnnProfile_EventId_t id = reinterpret_cast<uintptr_t>(&event);
+    (nullptr == parent ? topLevelIds : parent->subEventIds).push_back(id);
+    return event;
+  }
+};
+
+struct MemRegion {
+  uint32_t magic = g_memMagic;
+  Context *context;
+  void *data;
+  size_t size;
+};
+
+struct Graph {
+  uint32_t magic = g_graphMagic;
+  Context *context;
+  std::string name;
+  bool finalized      = false;
+  uint32_t numInputs  = 0;
+  uint32_t numOutputs = 0;
+  std::vector<std::string> nodeNames;
+  std::unordered_map<std::string, uint32_t> tensorIds;
+};
+
+struct Context {
+  uint32_t magic = g_contextMagic;
+  Backend *backend;
+  std::vector<Graph *> graphs;
+};
+
+struct AsyncExecution {
+  Graph *graph;
+  std::vector<Qnn_Tensor_t> inputs;
+  std::vector<Qnn_Tensor_t> outputs;
+  Profile *profile;
+  Qnn_NotifyFn_t notifyFn;
+  void *notifyParam;
+};
+
+struct Backend {
+  uint32_t magic = g_backendMagic;
+  LatencyModel latencyModel;
+  std::mutex mutex;
+  std::mt19937_64 random;
+  std::unordered_map<Qnn_MemHandle_t, MemRegion *> memRegions;
+  // graphExecuteAsync() queue, run in FIFO order by one worker thread.
+  std::deque<AsyncExecution> asyncQueue;
+  std::condition_variable asyncCondition;
+  std::thread asyncWorker;
+  bool stopping = false;
+};
+
+// A single backend at a time, as with the real backend libraries.
+Backend *g_backend = nullptr;
+
+template <typename T>
+T *getObject(Qnn_Handle_t handle, uint32_t magic) {
+  T *object = static_cast<T *>(handle);
+  return nullptr != object && magic == object->magic ? object : nullptr;
+}
+
+//------------------------------------------------------------------------------
+// Execution
+//------------------------------------------------------------------------------
+
+struct Buffer {
+  uint8_t *data;
+  size_t size;
+};
+
+bool getBuffer(Backend *backend, const Qnn_Tensor_t &tensor, Buffer &buffer) {
+  if (QNN_TENSORMEMTYPE_RAW == QNN_TENSOR_GET_MEM_TYPE(tensor)) {
+    buffer.data = static_cast<uint8_t *>(QNN_TENSOR_GET_CLIENT_BUF(tensor).data);
+    buffer.size = QNN_TENSOR_GET_CLIENT_BUF(tensor).dataSize;
+  } else if (QNN_TENSORMEMTYPE_MEMHANDLE == QNN_TENSOR_GET_MEM_TYPE(tensor)) {
+    std::lock_guard<std::mutex> lock(backend->mutex);
+    auto found = backend->memRegions.find(QNN_TENSOR_GET_MEM_HANDLE(tensor));
+    if (found == backend->memRegions.end()) {
+      return false;
+    }
+    buffer.data = static_cast<uint8_t *>(found->second->data);
+    buffer.size = found->second->size;
+  } else {
+    return false;
+  }
+  return nullptr != buffer.data && buffer.size >= getTensorSize(tensor);
+}
+
+// FNV-1a over 8 byte words rather than bytes, so hashing stays well below
+// the cost of the app's own input handling.
+uint64_t hashBytes(uint64_t hash, const uint8_t *data, size_t size) {
+  size_t idx = 0;
+  for (; idx + sizeof(uint64_t) <= size; idx += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, data + idx, sizeof(word));
+    hash = (hash ^ word) * 0x100000001b3ull;
+  }
+  for (; idx < size; idx++) {
+    hash = (hash ^ data[idx]) * 0x100000001b3ull;
+  }
+  return hash;
+}
+
+uint64_t splitMix64(uint64_t &state) {
+  uint64_t value = (state += 0x9e3779b97f4a7c15ull);
+  value          = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+  value          = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+  return value ^ (value >> 31);
+}
+
+// Fills an output from seed. Floating point outputs get values in [0.5, 1)
+// rather than arbitrary bit patterns, which may be NaN.
+void fillOutput(const Qnn_Tensor_t &tensor, Buffer &buffer, uint64_t seed) {
+  size_t size = getTensorSize(tensor);
+  switch (QNN_TENSOR_GET_DATA_TYPE(tensor)) {
+    case QNN_DATATYPE_FLOAT_32: {
+      float *values = reinterpret_cast<float *>(buffer.data);
+      for (size_t idx = 0; idx < size / sizeof(float); idx++) {
+        values[idx] = 0.5f + static_cast<float>(splitMix64(seed) >> 40) / (1 << 25);
+      }
+      break;
+    }
+    case QNN_DATATYPE_FLOAT_16: {
+      uint16_t *values = reinterpret_cast<uint16_t *>(buffer.data);
+      for (size_t idx = 0; idx < size / sizeof(uint16_t); idx++) {
+        values[idx] = static_cast<uint16_t>(0x3800 | (splitMix64(seed) & 0x3ff));
+      }
+      break;
+    }
+    case QNN_DATATYPE_FLOAT_64: {
+      double *values = reinterpret_cast<double *>(buffer.data);
+      for (size_t idx = 0; idx < size / sizeof(double); idx++) {
+        values[idx] = 0.5 + static_cast<double>(splitMix64(seed) >> 12) / (1ull << 53);
+      }
+      break;
+    }
+    default:
+      for (size_t idx = 0; idx < size; idx += sizeof(uint64_t)) {
+        uint64_t value = splitMix64(seed);
+        memcpy(buffer.data + idx, &value, std::min(sizeof(value), size - idx));
+      }
+      break;
+  }
+}
+
+Clock::duration getDeviceTime(Backend *backend, size_t bytesMoved) {
+  const LatencyModel &model = backend->latencyModel;
+  double us                 = model.first;
+  switch (model.kind) {
+    case LatencyModel::Kind::FIXED:
+      break;
+    case LatencyModel::Kind::UNIFORM: {
+      std::lock_guard<std::mutex> lock(backend->mutex);
+      us = std::uniform_real_distribution<double>(model.first, model.second)(backend->random);
+      break;
+    }
+    case LatencyModel::Kind::NORMAL: {
+      std::lock_guard<std::mutex> lock(backend->mutex);
+      us = std::max(
+          0.0, std::normal_distribution<double>(model.first, model.second)(backend->random));
+      break;
+    }
+    case LatencyModel::Kind::COPY:
+      // MB/s is bytes per microsecond.
+      us = static_cast<double>(bytesMoved) / model.first;
+      break;
+  }
+  return std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double, std::micro>(us));
+}
+
+uint64_t toUs(Clock::duration duration) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
+Qnn_ErrorHandle_t executeGraph(Graph *graph,
+                               const Qnn_Tensor_t *inputs,
+                               uint32_t numInputs,
+                               Qnn_Tensor_t *outputs,
+                               uint32_t numOutputs,
+                               Profile *profile) {
+  Backend *backend = graph->context->backend;
+  if (!graph->finalized) {
+    return QNN_GRAPH_ERROR_GRAPH_NOT_FINALIZED;
+  }
+  if (numInputs != graph->numInputs || numOutputs != graph->numOutputs ||
+      (numInputs > 0 && nullptr == inputs) || (numOutputs > 0 && nullptr == outputs)) {
+    log(QNN_LOG_LEVEL_ERROR,
+        "Graph %s takes %u inputs and %u outputs, got %u and %u",
+        graph->name.c_str(),
+        graph->numInputs,
+        graph->numOutputs,
+        numInputs,
+        numOutputs);
+    return QNN_GRAPH_ERROR_INVALID_ARGUMENT;
+  }
+  auto startTime    = Clock::now();
+  uint64_t hash     = 0xcbf29ce484222325ull;
+  size_t bytesMoved = 0;
+  for (uint32_t idx = 0; idx < numInputs; idx++) {
+    Buffer buffer;
+    if (!getBuffer(backend, inputs[idx], buffer)) {
+      log(QNN_LOG_LEVEL_ERROR,
+          "Input %u of graph %s has no usable buffer",
+          idx,
+          graph->name.c_str());
+      return QNN_GRAPH_ERROR_INVALID_TENSOR;
+    }
+    size_t size = getTensorSize(inputs[idx]);
+    hash        = hashBytes(hash, buffer.data, size);
+    bytesMoved += size;
+  }
+  std::vector<Buffer> outputBuffers(numOutputs);
+  for (uint32_t idx = 0; idx < numOutputs; idx++) {
+    if (!getBuffer(backend, outputs[idx], outputBuffers[idx])) {
+      log(QNN_LOG_LEVEL_ERROR,
+          "Output %u of graph %s has no usable buffer",
+          idx,
+          graph->name.c_str());
+      return QNN_GRAPH_ERROR_INVALID_TENSOR;
+    }
+    bytesMoved += getTensorSize(outputs[idx]);
+  }
+  auto deviceStartTime = Clock::now();
+  waitUntil(deviceStartTime + getDeviceTime(backend, bytesMoved));
+  auto deviceEndTime = Clock::now();
+  for (uint32_t idx = 0; idx < numOutputs; idx++) {
+    fillOutput(outputs[idx], outputBuffers[idx], hash ^ idx);
+  }
+  auto endTime = Clock::now();
+
+  if (nullptr != profile) {
+    std::lock_guard<std::mutex> lock(profile->mutex);
+    profile->clear();
+    ProfileEvent &execute = profile->add(nullptr,
+                                         QNN_PROFILE_EVENTTYPE_EXECUTE,
+                                         QNN_PROFILE_EVENTUNIT_MICROSEC,
+                                         toUs(endTime - startTime),
+                                         "Execute");
+    profile->add(nullptr,
+                 QNN_PROFILE_EVENTTYPE_EXECUTE,
+                 QNN_PROFILE_EVENTUNIT_BYTES,
+                 bytesMoved,
+                 "Bytes moved");
+    if (QNN_PROFILE_LEVEL_DETAILED == profile->level) {
+      profile->add(&execute,
+                   QNN_PROFILE_EVENTTYPE_EXECUTE_PREPROCESS,
+                   QNN_PROFILE_EVENTUNIT_MICROSEC,
+                   toUs(deviceStartTime - startTime),
+                   "Input hash");
+      ProfileEvent &device = profile->add(&execute,
+                                          QNN_PROFILE_EVENTTYPE_EXECUTE_DEVICE,
+                                          QNN_PROFILE_EVENTUNIT_MICROSEC,
+                                          toUs(deviceEndTime - deviceStartTime),
+                                          "Device");
+      // Device time is split evenly between the nodes.
+      size_t numNodes = graph->nodeNames.size();
+      for (size_t idx = 0; idx < numNodes; idx++) {
+        profile->add(&device,
+                     QNN_PROFILE_EVENTTYPE_NODE,
+                     QNN_PROFILE_EVENTUNIT_MICROSEC,
+                     toUs(deviceEndTime - deviceStartTime) / numNodes,
+                     graph->nodeNames[idx]);
+      }
+      profile->add(&execute,
+                   QNN_PROFILE_EVENTTYPE_EXECUTE_POSTPROCESS,
+                   QNN_PROFILE_EVENTUNIT_MICROSEC,
+                   toUs(endTime - deviceEndTime),
+                   "Output fill");
+    }
+  }
+  return QNN_GRAPH_NO_ERROR;
+}
+
+void runAsyncExecutions(Backend *backend) {
+  std::unique_lock<std::mutex> lock(backend->mutex);
+  while (true) {
+    backend->asyncCondition.wait(
+        lock, [backend] { return backend->stopping || !backend->asyncQueue.empty(); });
+    // Queued executions are finished before stopping.
+    if (backend->asyncQueue.empty()) {
+      return;
+    }
+    AsyncExecution execution = std::move(backend->asyncQueue.front());
+    backend->asyncQueue.pop_front();
+    lock.unlock();
+    Qnn_NotifyStatus_t status;
+    status.error = executeGraph(execution.graph,
+                                execution.inputs.data(),
+                                static_cast<uint32_t>(execution.inputs.size()),
+                                execution.outputs.data(),
+                                static_cast<uint32_t>(execution.outputs.size()),
+                                execution.profile);
+    if (nullptr != execution.notifyFn) {
+      execution.notifyFn(execution.notifyParam, status);
+    }
+    lock.lock();
+  }
+}
+
+//------------------------------------------------------------------------------
+// QnnInterface
+//------------------------------------------------------------------------------
+
+Qnn_ErrorHandle_t propertyHasCapability(QnnProperty_Key_t key) {
+  switch (key) {
+    case QNN_PROPERTY_GROUP_DEVICE:
+    case QNN_PROPERTY_GROUP_PROFILE:
+    case QNN_PROPERTY_GROUP_MEMORY:
+    case QNN_PROPERTY_BACKEND_SUPPORT_OP_PACKAGE:
+    case QNN_PROPERTY_GRAPH_SUPPORT_ASYNC_EXECUTION:
+    case QNN_PROPERTY_TENSOR_SUPPORT_MEMHANDLE_TYPE:
+      return QNN_PROPERTY_SUPPORTED;
+    default:
+      return QNN_PROPERTY_NOT_SUPPORTED;
+  }
+}
+
+Qnn_ErrorHandle_t backendCreate(Qnn_LogHandle_t,
+                                const QnnBackend_Config_t **,
+                                Qnn_BackendHandle_t *backend) {
+  if (nullptr == backend) {
+    return QNN_BACKEND_ERROR_INVALID_ARGUMENT;
+  }
+  if (nullptr != g_backend) {
+    return QNN_BACKEND_ERROR_CANNOT_INITIALIZE;
+  }
+  LatencyModel latencyModel;
+  const char *latencySpec = getenv("QNN_STUB_LATENCY");
+  if (nullptr != latencySpec && !parseLatencyModel(latencySpec, latencyModel)) {
+    log(QNN_LOG_LEVEL_ERROR, "Invalid QNN_STUB_LATENCY: %s", latencySpec);
+    return QNN_BACKEND_ERROR_INVALID_CONFIG;
+  }
+  const char *seed        = getenv("QNN_STUB_SEED");
+  g_backend               = new Backend();
+  g_backend->latencyModel = latencyModel;
+  g_backend->random.seed(nullptr != seed ? strtoull(seed, nullptr, 10) : 1);
+  g_backend->asyncWorker = std::thread(runAsyncExecutions, g_backend);
+  log(QNN_LOG_LEVEL_INFO,
+      "Stub backend created, latency %s",
+      nullptr != latencySpec ? latencySpec : "fixed:0");
+  *backend = g_backend;
+  return QNN_BACKEND_NO_ERROR;
+}
+
+Qnn_ErrorHandle_t backendGetApiVersion(Qnn_ApiVersion_t *version) {
+  if (nullptr == version) {
+    return QNN_BACKEND_ERROR_INVALID_ARGUMENT;
+  }
+  version->coreApiVersion.major    = QNN_API_VERSION_MAJOR;
+  version->coreApiVersion.minor    = QNN_API_VERSION_MINOR;
+  version->coreApiVersion.patch    = QNN_API_VERSION_PATCH;
+  version->backendApiVersion.major = 1;
+  version->backendApiVersion.minor = 0;
+  version->backendApiVersion.patch = 0;
+  return QNN_BACKEND_NO_ERROR;
+}
+
+Qnn_ErrorHandle_t backendGetBuildId(const char **id) {
+  if (nullptr == id) {
+    return QNN_BACKEND_ERROR_INVALID_ARGUMENT;
+  }
+  *id = "stub";
+  return QNN_BACKEND_NO_ERROR;
+}
+
+// Op packages are accepted but never loaded, as no ops are computed.
+Qnn_ErrorHandle_t backendRegisterOpPackage(Qnn_BackendHandle_t backend,
+                                           const char *packagePath,
+                                           const char *interfaceProvider,
+                                           const char *) {
+  if (nullptr == getObject<Backend>(backend, g_backendMagic)) {
+    return QNN_BACKEND_ERROR_INVALID_HANDLE;
+  }
+  log(QNN_LOG_LEVEL_INFO,
+      "Ignoring op package %s (%s)",
+      nullptr != packagePath ? packagePath : "",
+      nullptr != interfaceProvider ? interfaceProvider : "");
+  return QNN_BACKEND_NO_ERROR;
+}
+
+Qnn_ErrorHandle_t backendValidateOpConfig(Qnn_BackendHandle_t backend, Qnn_OpConfig_t) {
+  if (nullptr == getObject<Backend>(backend, g_backendMagic)) {
+    return QNN_BACKEND_ERROR_INVALID_HANDLE;
+  }
+  return QNN_BACKEND_NO_ERROR;
+}
+
+Qnn_ErrorHandle_t backendFree(Qnn_BackendHandle_t handle) {
+  Backend *backend = getObject<Backend>(handle, g_backendMagic);
+  if (nullptr == backend) {
+    return QNN_BACKEND_ERROR_INVALID_HANDLE;
+  }
+  {
+    std::lock_guard<std::mutex> lock(backend->mutex);
+    backend->stopping = true;
+  }
+  backend->asyncCondition.notify_all();
+  backend->asyncWorker.join();
+  for (auto &memRegion : backend->memRegions) {
+    munmap(memRegion.second->data, memRegion.second->size);
+    delete memRegion.second;
+  }
+  backend->magic = 0;
+  delete backend;
+  g_backend = nullptr;
+  return QNN_BACKEND_NO_ERROR;
+}
+
+Qnn_ErrorHandle_t contextCreate(Qnn_BackendHandle_t backend,
+                                Qnn_DeviceHandle_t,
+                                const QnnContext_Config_t **,
+                                Qnn_ContextHandle_t *context) {
+  if (nullptr == getObject<Backend>(backend, g_backendMagic)) {
+    return QNN_CONTEXT_ERROR_INVALID_HANDLE;
+  }
+  if (nullptr == context) {
+    return QNN_CONTEXT_ERROR_INVALID_ARGUMENT;
+  }
+  Context *newContext = new Context();
+  newContext->backend = static_cast<Backend *>(backend);
+  *context            = newContext;
+  return QNN_CONTEXT_NO_ERROR;
+}
+
+Qnn_ErrorHandle_t contextFree(Qnn_ContextHandle_t handle, Qnn_ProfileHandle_t) {
+  Context *context = getObject<Context>(handle, g_contextMagic);
+  if (nullptr == context) {
+    return QNN_CONTEXT_ERROR_INVALID_HANDLE;
+  }
+  for (Graph *graph : context->graphs) {
+    graph->magic = 0;
+    delete graph;
+  }
+  context->magic = 0;
+  delete context;
+  return QNN_CONTEXT_NO_ERROR;
+}
+
+Qnn_ErrorHandle_t graphCreate(Qnn_ContextHandle_t handle,
+                              const char *graphName,
+                              const QnnGraph_Config_t **,
+                              Qnn_GraphHandle_t *graphHandle) {
+  Context *context = getObject<Context>(handle, g_contextMagic);
+  if (nullptr == context) {
+    return QNN_GRAPH_ERROR_INVALID_HANDLE;
+  }
+  if (nullptr == graphName || nullptr == graphHandle) {
+    return QNN_GRAPH_ERROR_INVALID_ARGUMENT;
+  }
+  for (Graph *graph : context->graphs) {
+    if (graph->name == graphName) {
+      return QNN_GRAPH_ERROR_INVALID_NAME;
+    }
+  }
+  Graph *graph   = new Graph();
+  graph->context = context;
+  graph->name    = graphName;
+  context->graphs.push_back(graph);
+  *graphHandle = graph;
+  return QNN_GRAPH_NO_ERROR;
+}
+
+Qnn_ErrorHandle_t graphAddNode(Qnn_GraphHandle_t handle, Qnn_OpConfig_t opConfig) {
+  Graph *graph = getObject<Graph>(handle, g_graphMagic);
+  if (nullptr == graph) {
+    return QNN_GRAPH_ERROR_INVALID_HANDLE;
+  }
+  if (graph->finalized) {
+    return QNN_GRAPH_ERROR_GRAPH_FINALIZED;
+  }
+  const char *name = QNN_OP_CFG_GET_NAME(opConfig);
+  graph->nodeNames.push_back(nullptr != name ? name : "");
+  return QNN_GRAPH_NO_ERROR;
+}
+
+Qnn_ErrorHandle_t graphFinalize(Qnn_GraphHandle_t handle,
+                                Qnn_ProfileHandle_t profileHandle,
+                                Qnn_SignalHandle_t) {
+  Graph *graph = getObject<Graph>(handle, g_graphMagic);
+  if (nullptr == graph) {
+    return QNN_GRAPH_ERROR_INVALID_HANDLE;
+  }
+  uint64_t startUs = nowUs();
+  graph->finalized = true;
+  log(QNN_LOG_LEVEL_INFO,
+      "Finalized graph %s: %zu nodes, %u inputs, %u outputs",
+      graph->name.c_str(),
+      graph->nodeNames.size(),
+      graph->numInputs,
+      graph->numOutputs);
+  Profile *profile = getObject<Profile>(profileHandle, g_profileMagic);
+  if (nullptr != profile) {
+    std::lock_guard<std::mutex> lock(profile->mutex);
+    profile->clear();
+    profile->add(nullptr,
+                 QNN_PROFILE_EVENTTYPE_FINALIZE,
+                 QNN_PROFILE_EVENTUNIT_MICROSEC,
+                 nowUs() - startUs,
+                 "Finalize");
+  }
+  return QNN_GRAPH_NO_ERROR;
+}
+
+Qnn_ErrorHandle_t graphRetrieve(Qnn_ContextHandle_t handle,
+                                const char *graphName,
+                                Qnn_GraphHandle_t *graphHandle) {
+  Context *context = getObject<Context>(handle, g_contextMagic);
+  if (nullptr == context) {
+    return QNN_GRAPH_ERROR_INVALID_HANDLE;
+  }
+  if (nullptr == graphName || nullptr == graphHandle) {
+    return QNN_GRAPH_ERROR_INVALID_ARGUMENT;
+  }
+  for (Graph *graph : context->graphs) {
+    if (graph->name == graphName) {
+      *graphHandle = graph;
+      return QNN_GRAPH_NO_ERROR;
+    }
+  }
+  return QNN_GRAPH_ERROR_GRAPH_DOES_NOT_EXIST;
+}
+
+Qnn_ErrorHandle_t graphExecute(Qnn_GraphHandle_t handle,
+                               const Qnn_Tensor_t *inputs,
+                               uint32_t numInputs,
+                               Qnn_Tensor_t *outputs,
+                               uint32_t numOutputs,
+                               Qnn_ProfileHandle_t profileHandle,
+                               Qnn_SignalHandle_t) {
+  Graph *graph = getObject<Graph>(handle, g_graphMagic);
+  if (nullptr == graph) {
+    return QNN_GRAPH_ERROR_INVALID_HANDLE;
+  }
+  return executeGraph(graph,
+                      inputs,
+                      numInputs,
+                      outputs,
+                      numOutputs,
+                      getObject<Profile>(profileHandle, g_profileMagic));
+}
+
+Qnn_ErrorHandle_t graphExecuteAsync(Qnn_GraphHandle_t handle,
+                                    const Qnn_Tensor_t *inputs,
+                                    uint32_t numInputs,
+                                    Qnn_Tensor_t *outputs,
+                                    uint32_t numOutputs,
+                                    Qnn_ProfileHandle_t profileHandle,
+                                    Qnn_SignalHandle_t,
+                                    Qnn_NotifyFn_t notifyFn,
+                                    void *notifyParam) {
+  Graph *graph = getObject<Graph>(handle, g_graphMagic);
+  if (nullptr == graph) {
+    return QNN_GRAPH_ERROR_INVALID_HANDLE;
+  }
+  if ((numInputs > 0 && nullptr == inputs) || (numOutputs > 0 && nullptr == outputs)) {
+    return QNN_GRAPH_ERROR_INVALID_ARGUMENT;
+  }
+  // The tensor structs are copied; their buffers must stay valid until
+  // notifyFn is called.
+  AsyncExecution execution;
+  execution.graph       = graph;
+  execution.inputs      = std::vector<Qnn_Tensor_t>(inputs, inputs + numInputs);
+  execution.outputs     = std::vector<Qnn_Tensor_t>(outputs, outputs + numOutputs);
+  execution.profile     = getObject<Profile>(profileHandle, g_profileMagic);
+  execution.notifyFn    = notifyFn;
+  execution.notifyParam = notifyParam;
+  Backend *backend      = graph->context->backend;
+  {
+    std::lock_guard<std::mutex> lock(backend->mutex);
+    backend->asyncQueue.push_back(std::move(execution));
+  }
+  backend->asyncCondition.notify_one();
+  return QNN_GRAPH_NO_ERROR;
+}
+
+Qnn_ErrorHandle_t tensorCreateGraphTensor(Qnn_GraphHandle_t handle, Qnn_Tensor_t *tensor) {
+  Graph *graph = getObject<Graph>(handle, g_graphMagic);
+  if (nullptr == graph) {
+    return QNN_TENSOR_ERROR_INVALID_HANDLE;
+  }
+  if (nullptr == tensor || nullptr == QNN_TENSOR_GET_NAME(tensor)) {
+    return QNN_TENSOR_ERROR_INVALID_TENSOR_PARAM;
+  }
+  uint32_t id = static_cast<uint32_t>(graph->tensorIds.size());
+  if (!graph->tensorIds.insert(std::make_pair(std::string(QNN_TENSOR_GET_NAME(tensor)), id))
+           .second) {
+    return QNN_TENSOR_ERROR_ALREADY_EXISTS;
+  }
+  QNN_TENSOR_SET_ID(tensor, id);
+  if (QNN_TENSOR_TYPE_APP_WRITE == QNN_TENSOR_GET_TYPE(tensor)) {
+    graph->numInputs++;
+  } else if (QNN_TENSOR_TYPE_APP_READ == QNN_TENSOR_GET_TYPE(tensor)) {
+    graph->numOutputs++;
+  }
+  return QNN_TENSOR_NO_ERROR;
+}
+
+Qnn_ErrorHandle_t logCreate(QnnLog_Callback_t callback,
+                            QnnLog_Level_t maxLogLevel,
+                            Qnn_LogHandle_t *logger) {
+  if (nullptr == logger) {
+    return QNN_LOG_ERROR_INVALID_ARGUMENT;
+  }
+  g_logCallback = callback;
+  g_logLevel    = maxLogLevel;
+  g_logEpoch    = Clock::now();
+  *logger       = &g_logCallback;
+  return QNN_LOG_NO_ERROR;
+}
+
+Qnn_ErrorHandle_t logSetLogLevel(Qnn_LogHandle_t logger, QnnLog_Level_t maxLogLevel) {
+  if (logger != &g_logCallback) {
+    return QNN_LOG_ERROR_INVALID_HANDLE;
+  }
+  g_logLevel = maxLogLevel;
+  return QNN_LOG_NO_ERROR;
+}
+
+Qnn_ErrorHandle_t logFree(Qnn_LogHandle_t logger) {
+  if (logger != &g_logCallback) {
+    return QNN_LOG_ERROR_INVALID_HANDLE;
+  }
+  g_logCallback = nullptr;
+  return QNN_LOG_NO_ERROR;
+}
+
+Qnn_ErrorHandle_t profileCreate(Qnn_BackendHandle_t backend,
+                                QnnProfile_Level_t level,
+                                Qnn_ProfileHandle_t *profile) {
+  if (nullptr == getObject<Backend>(backend, g_backendMagic)) {
+    return QNN_PROFILE_ERROR_INVALID_HANDLE;
+  }
+  if (nullptr == profile ||
+      (QNN_PROFILE_LEVEL_BASIC != level && QNN_PROFILE_LEVEL_DETAILED != level)) {
+    return QNN_PROFILE_ERROR_INVALID_ARGUMENT;
+  }
+  Profile *newProfile = new Profile();
+  newProfile->level   = level;
+  *profile            = newProfile;
+  return QNN_PROFILE_NO_ERROR;
+}
+
+Qnn_ErrorHandle_t profileGetEvents(Qnn_ProfileHandle_t handle,
+                                   const QnnProfile_EventId_t **eventIds,
+                                   uint32_t *numEvents) {
+  Profile *profile = getObject<Profile>(handle, g_profileMagic);
+  if (nullptr == profile) {
+    return QNN_PROFILE_ERROR_INVALID_HANDLE;
+  }
+  if (nullptr == eventIds || nullptr == numEvents) {
+    return QNN_PROFILE_ERROR_INVALID_ARGUMENT;
+  }
+  std::lock_guard<std::mutex> lock(profile->mutex);
+  *eventIds  = profile->topLevelIds.data();
+  *numEvents = static_cast<uint32_t>(profile->topLevelIds.size());
+  return QNN_PROFILE_NO_ERROR;
+}
+
+Qnn_ErrorHandle_t profileGetSubEvents(QnnProfile_EventId_t eventId,
+                                      const QnnProfile_EventId_t **subEventIds,
+                                      uint32_t *numSubEvents) {
+  if (0 == eventId) {
+    return QNN_PROFILE_ERROR_INVALID_HANDLE;
+  }
+  if (nullptr == subEventIds || nullptr == numSubEvents) {
+    return QNN_PROFILE_ERROR_INVALID_ARGUMENT;
+  }
+  const ProfileEvent *event = reinterpret_cast<const ProfileEvent *>(eventId);
+  *subEventIds              = event->subEventIds.data();
+  *numSubEvents             = static_cast<uint32_t>(event->subEventIds.size());
+  return QNN_PROFILE_NO_ERROR;
+}
+
+Qnn_ErrorHandle_t profileGetEventData(QnnProfile_EventId_t eventId,
+                                      QnnProfile_EventData_t *eventData) {
+  if (0 == eventId) {
+    return QNN_PROFILE_ERROR_INVALID_HANDLE;
+  }
+  if (nullptr == eventData) {
+    return QNN_PROFILE_ERROR_INVALID_ARGUMENT;
+  }
+  *eventData = reinterpret_cast<const ProfileEvent *>(eventId)->data;
+  return QNN_PROFILE_NO_ERROR;
+}
+
+Qnn_ErrorHandle_t profileFree(Qnn_ProfileHandle_t handle) {
+  Profile *profile = getObject<Profile>(handle, g_profileMagic);
+  if (nullptr == profile) {
+    return QNN_PROFILE_ERROR_INVALID_HANDLE;
+  }
+  profile->magic = 0;
+  delete profile;
+  return QNN_PROFILE_NO_ERROR;
+}
+
+// ION buffers are mapped from their file descriptor, which works for any
+// shareable fd on the host, e.g. one from memfd_create().
+Qnn_ErrorHandle_t memRegister(Qnn_ContextHandle_t handle,
+                              const Qnn_MemDescriptor_t *memDescriptors,
+                              uint32_t numDescriptors,
+                              Qnn_MemHandle_t *memHandles) {
+  Context *context = getObject<Context>(handle, g_contextMagic);
+  if (nullptr == context) {
+    return QNN_MEM_ERROR_INVALID_HANDLE;
+  }
+  if (nullptr == memDescriptors || nullptr == memHandles) {
+    return QNN_MEM_ERROR_INVALID_ARGUMENT;
+  }
+  for (uint32_t idx = 0; idx < numDescriptors; idx++) {
+    const Qnn_MemDescriptor_t &descriptor = memDescriptors[idx];
+    if (QNN_MEM_TYPE_ION != descriptor.memType) {
+      return QNN_MEM_ERROR_UNSUPPORTED_MEMTYPE;
+    }
+    size_t size = getDataTypeSize(descriptor.dataType);
+    for (uint32_t dim = 0; dim < descriptor.memShape.numDim; dim++) {
+      size *= descriptor.memShape.dimSize[dim];
+    }
+    if (0 == size) {
+      return QNN_MEM_ERROR_INVALID_SHAPE;
+    }
+    void *data =
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor.ionInfo.fd, 0);
+    if (MAP_FAILED == data) {
+      log(QNN_LOG_LEVEL_ERROR, "Failed to map fd %d", descriptor.ionInfo.fd);
+      return QNN_MEM_ERROR_MAPPING;
+    }
+    MemRegion *memRegion = new MemRegion();
+    memRegion->context   = context;
+    memRegion->data      = data;
+    memRegion->size      = size;
+    memHandles[idx]      = memRegion;
+    std::lock_guard<std::mutex> lock(context->backend->mutex);
+    context->backend->memRegions[memRegion] = memRegion;
+  }
+  return QNN_MEM_NO_ERROR;
+}
+
+Qnn_ErrorHandle_t memDeRegister(const Qnn_MemHandle_t *memHandles, uint32_t numHandles) {
+  if (nullptr == memHandles || nullptr == g_backend) {
+    return QNN_MEM_ERROR_INVALID_ARGUMENT;
+  }
+  std::lock_guard<std::mutex> lock(g_backend->mutex);
+  for (uint32_t idx = 0; idx < numHandles; idx++) {
+    auto found = g_backend->memRegions.find(memHandles[idx]);
+    if (found == g_backend->memRegions.end()) {
+      return QNN_MEM_ERROR_INVALID_HANDLE;
+    }
+    munmap(found->second->data, found->second->size);
+    delete found->second;
+    g_backend->memRegions.erase(found);
+  }
+  return QNN_MEM_NO_ERROR;
+}
+
+Qnn_ErrorHandle_t deviceCreate(Qnn_LogHandle_t,
+                               const QnnDevice_Config_t **,
+                               Qnn_DeviceHandle_t *device) {
+  if (nullptr == device) {
+    return QNN_DEVICE_ERROR_INVALID_CONFIG;
+  }
+  // There is nothing to a stub device; any non-null handle will do.
+  *device = &g_backend;
+  return QNN_DEVICE_NO_ERROR;
+}
+
+Qnn_ErrorHandle_t deviceFree(Qnn_DeviceHandle_t device) {
+  return &g_backend == device ? QNN_DEVICE_NO_ERROR : QNN_DEVICE_ERROR_INVALID_HANDLE;
+}
+
+QnnInterface_t makeInterface() {
+  QnnInterface_t qnnInterface            = QNN_INTERFACE_INIT;
+  qnnInterface.backendId                 = QNN_BACKEND_ID_NULL;
+  qnnInterface.providerName              = "QNN_STUB";
+  qnnInterface.apiVersion.coreApiVersion = {
+      QNN_API_VERSION_MAJOR, QNN_API_VERSION_MINOR, QNN_API_VERSION_PATCH};
+  qnnInterface.apiVersion.backendApiVersion = {1, 0, 0};
+
+  QNN_INTERFACE_VER_TYPE &functions         = qnnInterface.QNN_INTERFACE_VER_NAME;
+  functions.propertyHasCapability           = propertyHasCapability;
+  functions.backendCreate                   = backendCreate;
+  functions.backendGetApiVersion            = backendGetApiVersion;
+  functions.backendGetBuildId               = backendGetBuildId;
+  functions.backendRegisterOpPackage        = backendRegisterOpPackage;
+  functions.backendValidateOpConfig         = backendValidateOpConfig;
+  functions.backendFree                     = backendFree;
+  functions.contextCreate                   = contextCreate;
+  functions.contextFree                     = contextFree;
+  functions.graphCreate                     = graphCreate;
+  functions.graphAddNode                    = graphAddNode;
+  functions.graphFinalize                   = graphFinalize;
+  functions.graphRetrieve                   = graphRetrieve;
+  functions.graphExecute                    = graphExecute;
+  functions.graphExecuteAsync               = graphExecuteAsync;
+  functions.tensorCreateGraphTensor         = tensorCreateGraphTensor;
+  functions.logCreate                       = logCreate;
+  functions.logSetLogLevel                  = logSetLogLevel;
+  functions.logFree                         = logFree;
+  functions.profileCreate                   = profileCreate;
+  functions.profileGetEvents                = profileGetEvents;
+  functions.profileGetSubEvents             = profileGetSubEvents;
+  functions.profileGetEventData             = profileGetEventData;
+  functions.profileFree                     = profileFree;
+  functions.memRegister                     = memRegister;
+  functions.memDeRegister                   = memDeRegister;
+  functions.deviceCreate                    = deviceCreate;
+  functions.deviceFree                      = deviceFree;
+  return qnnInterface;
+}
+
+}  // namespace
+
+extern "C" Qnn_ErrorHandle_t QnnInterface_getProviders(const QnnInterface_t ***providerList,
+                                                       uint32_t *numProviders) {
+  if (nullptr == providerList || nullptr == numProviders) {
+    return QNN_INTERFACE_ERROR_INVALID_PARAMETER;
+  }
+  static const QnnInterface_t s_interface    = makeInterface();
+  static const QnnInterface_t *s_providers[] = {&s_interface};
+  *providerList = s_providers;
+  *numProviders = 1;
+  return QNN_INTERFACE_NO_ERROR;
+}
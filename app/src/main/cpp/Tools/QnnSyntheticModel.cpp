@@ -0,0 +1,189 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+
+// QnnModel_composeGraphs() and QnnModel_freeGraphsInfo() of the synthetic
+// model libraries built by qnn_add_synthetic_model(). Each graph gets its
+// tensors from g_modelSpec and a single node that takes all inputs and
+// produces all outputs. The node's op does not exist, so only a backend that
+// computes nothing, such as libQnnStub.so, can finalize these graphs.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "QnnInterface.h"
+#include "QnnSyntheticModel.hpp"
+#include "QnnWrapperUtils.hpp"
+
+#define QNN_MODEL_API extern "C" __attribute__((visibility("default")))
+
+using namespace qnn::tools;
+using namespace qnn_wrapper_api;
+
+namespace {
+
+Qnn_Tensor_t makeTensor(const synthetic::TensorSpec &spec) {
+  Qnn_Tensor_t tensor = QNN_TENSOR_INIT;
+  QNN_TENSOR_SET_NAME(tensor, spec.name);
+  QNN_TENSOR_SET_TYPE(tensor, spec.type);
+  QNN_TENSOR_SET_DATA_FORMAT(tensor, QNN_TENSOR_DATA_FORMAT_FLAT_BUFFER);
+  QNN_TENSOR_SET_DATA_TYPE(tensor, spec.dataType);
+  Qnn_QuantizeParams_t qParams = QNN_QUANTIZE_PARAMS_INIT;
+  if (QNN_QUANTIZATION_ENCODING_SCALE_OFFSET == spec.encoding) {
+    qParams.encodingDefinition   = QNN_DEFINITION_DEFINED;
+    qParams.quantizationEncoding = spec.encoding;
+    qParams.scaleOffsetEncoding  = spec.scaleOffset;
+  } else if (QNN_QUANTIZATION_ENCODING_AXIS_SCALE_OFFSET == spec.encoding) {
+    qParams.encodingDefinition                      = QNN_DEFINITION_DEFINED;
+    qParams.quantizationEncoding                    = spec.encoding;
+    qParams.axisScaleOffsetEncoding.axis            = spec.axis;
+    qParams.axisScaleOffsetEncoding.numScaleOffsets = spec.numScaleOffsets;
+    // Only ever read, by the backend and by the app's deep copies.
+    qParams.axisScaleOffsetEncoding.scaleOffset =
+        const_cast<Qnn_ScaleOffset_t *>(spec.scaleOffsets);
+  }
+  QNN_TENSOR_SET_QUANT_PARAMS(tensor, qParams);
+  QNN_TENSOR_SET_RANK(tensor, spec.rank);
+  QNN_TENSOR_SET_DIMENSIONS(tensor, const_cast<uint32_t *>(spec.dims));
+  QNN_TENSOR_SET_MEM_TYPE(tensor, QNN_TENSORMEMTYPE_RAW);
+  return tensor;
+}
+
+// Copies tensors into an array that freeQnnTensors() can free: the array,
+// names and dimensions are malloc'ed. Scale offsets stay in the library's
+// tables, as freeQnnTensors() does not free them.
+Qnn_Tensor_t *copyTensors(const std::vector<Qnn_Tensor_t> &tensors) {
+  size_t count        = tensors.size() > 0 ? tensors.size() : 1;
+  Qnn_Tensor_t *copies = static_cast<Qnn_Tensor_t *>(calloc(count, sizeof(Qnn_Tensor_t)));
+  if (nullptr == copies) {
+    return nullptr;
+  }
+  for (size_t idx = 0; idx < tensors.size(); idx++) {
+    copies[idx]    = tensors[idx];
+    uint32_t rank  = QNN_TENSOR_GET_RANK(tensors[idx]);
+    uint32_t *dims = static_cast<uint32_t *>(malloc(rank * sizeof(uint32_t)));
+    if (nullptr != dims) {
+      memcpy(dims, QNN_TENSOR_GET_DIMENSIONS(tensors[idx]), rank * sizeof(uint32_t));
+    }
+    QNN_TENSOR_SET_NAME(copies[idx], strdup(QNN_TENSOR_GET_NAME(tensors[idx])));
+    QNN_TENSOR_SET_DIMENSIONS(copies[idx], dims);
+  }
+  return copies;
+}
+
+const QnnGraph_Config_t **findGraphConfigs(const char *graphName,
+                                           const GraphConfigInfo_t **graphsConfigInfo,
+                                           uint32_t numGraphsConfigInfo) {
+  for (uint32_t idx = 0; nullptr != graphsConfigInfo && idx < numGraphsConfigInfo; idx++) {
+    if (nullptr != graphsConfigInfo[idx] && nullptr != graphsConfigInfo[idx]->graphName &&
+        0 == strcmp(graphName, graphsConfigInfo[idx]->graphName)) {
+      return graphsConfigInfo[idx]->graphConfigs;
+    }
+  }
+  return nullptr;
+}
+
+ModelError_t composeGraph(const synthetic::GraphSpec &spec,
+                          QNN_INTERFACE_VER_TYPE &qnnInterface,
+                          Qnn_ContextHandle_t contextHandle,
+                          const QnnGraph_Config_t **graphConfigs,
+                          GraphInfo_t &graphInfo) {
+  if (QNN_GRAPH_NO_ERROR !=
+      qnnInterface.graphCreate(contextHandle, spec.name, graphConfigs, &graphInfo.graph)) {
+    PRINT_ERROR("Failed to create graph %s\n", spec.name);
+    return MODEL_GRAPH_ERROR;
+  }
+  std::vector<Qnn_Tensor_t> inputs;
+  std::vector<Qnn_Tensor_t> outputs;
+  for (uint32_t idx = 0; idx < spec.numTensors; idx++) {
+    Qnn_Tensor_t tensor = makeTensor(spec.tensors[idx]);
+    if (QNN_TENSOR_NO_ERROR != qnnInterface.tensorCreateGraphTensor(graphInfo.graph, &tensor)) {
+      PRINT_ERROR("Failed to create tensor %s of graph %s\n", spec.tensors[idx].name, spec.name);
+      return MODEL_TENSOR_ERROR;
+    }
+    (QNN_TENSOR_TYPE_APP_WRITE == spec.tensors[idx].type ? inputs : outputs).push_back(tensor);
+  }
+
+  std::string nodeName      = std::string(spec.name) + "_synthetic";
+  Qnn_OpConfig_t opConfig   = QNN_OPCONFIG_INIT;
+  opConfig.v1.name          = nodeName.c_str();
+  opConfig.v1.packageName   = "qti.aisw";
+  opConfig.v1.typeName      = "Synthetic";
+  opConfig.v1.numOfInputs   = static_cast<uint32_t>(inputs.size());
+  opConfig.v1.inputTensors  = inputs.data();
+  opConfig.v1.numOfOutputs  = static_cast<uint32_t>(outputs.size());
+  opConfig.v1.outputTensors = outputs.data();
+  if (QNN_GRAPH_NO_ERROR != qnnInterface.graphAddNode(graphInfo.graph, opConfig)) {
+    PRINT_ERROR("Failed to add node %s\n", nodeName.c_str());
+    return MODEL_NODES_ERROR;
+  }
+
+  graphInfo.graphName        = strdup(spec.name);
+  graphInfo.inputTensors     = copyTensors(inputs);
+  graphInfo.numInputTensors  = static_cast<uint32_t>(inputs.size());
+  graphInfo.outputTensors    = copyTensors(outputs);
+  graphInfo.numOutputTensors = static_cast<uint32_t>(outputs.size());
+  if (nullptr == graphInfo.graphName || nullptr == graphInfo.inputTensors ||
+      nullptr == graphInfo.outputTensors) {
+    return MODEL_MEMORY_ALLOCATE_ERROR;
+  }
+  return MODEL_NO_ERROR;
+}
+
+}  // namespace
+
+QNN_MODEL_API ModelError_t QnnModel_composeGraphs(Qnn_BackendHandle_t,
+                                                  QNN_INTERFACE_VER_TYPE qnnInterface,
+                                                  Qnn_ContextHandle_t contextHandle,
+                                                  const GraphConfigInfo_t **graphsConfigInfo,
+                                                  const uint32_t numGraphsConfigInfo,
+                                                  GraphInfoPtr_t **graphsInfo,
+                                                  uint32_t *numGraphsInfo,
+                                                  bool,
+                                                  QnnLog_Callback_t,
+                                                  QnnLog_Level_t) {
+  if (nullptr == graphsInfo || nullptr == numGraphsInfo) {
+    return MODEL_INVALID_ARGUMENT_ERROR;
+  }
+  const synthetic::ModelSpec &model = synthetic::g_modelSpec;
+  // Laid out as freeGraphsInfo() expects: an array of pointers into one
+  // array of GraphInfo_t.
+  *graphsInfo = static_cast<GraphInfoPtr_t *>(malloc(model.numGraphs * sizeof(GraphInfoPtr_t)));
+  GraphInfo_t *graphs = static_cast<GraphInfo_t *>(calloc(model.numGraphs, sizeof(GraphInfo_t)));
+  if (nullptr == *graphsInfo || nullptr == graphs) {
+    free(*graphsInfo);
+    free(graphs);
+    *graphsInfo = nullptr;
+    return MODEL_MEMORY_ALLOCATE_ERROR;
+  }
+  for (uint32_t idx = 0; idx < model.numGraphs; idx++) {
+    (*graphsInfo)[idx] = &graphs[idx];
+  }
+  *numGraphsInfo = model.numGraphs;
+  for (uint32_t idx = 0; idx < model.numGraphs; idx++) {
+    ModelError_t status = composeGraph(
+        model.graphs[idx],
+        qnnInterface,
+        contextHandle,
+        findGraphConfigs(model.graphs[idx].name, graphsConfigInfo, numGraphsConfigInfo),
+        graphs[idx]);
+    if (MODEL_NO_ERROR != status) {
+      freeGraphsInfo(graphsInfo, model.numGraphs);
+      *numGraphsInfo = 0;
+      return status;
+    }
+  }
+  return MODEL_NO_ERROR;
+}
+
+QNN_MODEL_API ModelError_t QnnModel_freeGraphsInfo(GraphInfoPtr_t **graphsInfo,
+                                                   uint32_t numGraphsInfo) {
+  return freeGraphsInfo(graphsInfo, numGraphsInfo);
+}
@@ -0,0 +1,52 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+#pragma once
+
+#include <stdint.h>
+
+#include "QnnTypes.h"
+
+namespace qnn {
+namespace tools {
+namespace synthetic {
+
+struct TensorSpec {
+  const char *name;
+  // QNN_TENSOR_TYPE_APP_WRITE for graph inputs, QNN_TENSOR_TYPE_APP_READ
+  // for graph outputs.
+  Qnn_TensorType_t type;
+  Qnn_DataType_t dataType;
+  uint32_t rank;
+  const uint32_t *dims;
+  // QNN_QUANTIZATION_ENCODING_UNDEFINED for tensors that are not quantized.
+  Qnn_QuantizationEncoding_t encoding;
+  // For QNN_QUANTIZATION_ENCODING_SCALE_OFFSET.
+  Qnn_ScaleOffset_t scaleOffset;
+  // For QNN_QUANTIZATION_ENCODING_AXIS_SCALE_OFFSET, one per index of axis.
+  int32_t axis;
+  uint32_t numScaleOffsets;
+  const Qnn_ScaleOffset_t *scaleOffsets;
+};
+
+struct GraphSpec {
+  const char *name;
+  uint32_t numTensors;
+  const TensorSpec *tensors;
+};
+
+struct ModelSpec {
+  uint32_t numGraphs;
+  const GraphSpec *graphs;
+};
+
+// Defined in the source qnn-model-gen writes for each synthetic model.
+extern const ModelSpec g_modelSpec;
+
+}  // namespace synthetic
+}  // namespace tools
+}  // namespace qnn
@@ -0,0 +1,281 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+#include <stdio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+
+#include "ApiTiming.hpp"
+#include "SysUtil.hpp"
+
+using namespace qnn;
+using namespace qnn::tools;
+
+namespace {
+
+// Every member of QNN_INTERFACE_VER_TYPE.
+#define QNN_INTERFACE_APIS(X)          \
+  X(propertyHasCapability)             \
+  X(backendCreate)                     \
+  X(backendSetConfig)                  \
+  X(backendGetApiVersion)              \
+  X(backendGetBuildId)                 \
+  X(backendRegisterOpPackage)          \
+  X(backendGetSupportedOperations)     \
+  X(backendValidateOpConfig)           \
+  X(backendFree)                       \
+  X(contextCreate)                     \
+  X(contextSetConfig)                  \
+  X(contextGetBinarySize)              \
+  X(contextGetBinary)                  \
+  X(contextCreateFromBinary)           \
+  X(contextFree)                       \
+  X(graphCreate)                       \
+  X(graphCreateSubgraph)               \
+  X(graphSetConfig)                    \
+  X(graphAddNode)                      \
+  X(graphFinalize)                     \
+  X(graphRetrieve)                     \
+  X(graphExecute)                      \
+  X(graphExecuteAsync)                 \
+  X(tensorCreateContextTensor)         \
+  X(tensorCreateGraphTensor)           \
+  X(logCreate)                         \
+  X(logSetLogLevel)                    \
+  X(logFree)                           \
+  X(profileCreate)                     \
+  X(profileSetConfig)                  \
+  X(profileGetEvents)                  \
+  X(profileGetSubEvents)               \
+  X(profileGetEventData)               \
+  X(profileGetExtendedEventData)       \
+  X(profileFree)                       \
+  X(memRegister)                       \
+  X(memDeRegister)                     \
+  X(deviceGetPlatformInfo)             \
+  X(deviceFreePlatformInfo)            \
+  X(deviceGetInfrastructure)           \
+  X(deviceCreate)                      \
+  X(deviceSetConfig)                   \
+  X(deviceGetInfo)                     \
+  X(deviceFree)                        \
+  X(signalCreate)                      \
+  X(signalSetConfig)                   \
+  X(signalTrigger)                     \
+  X(signalFree)                        \
+  X(errorGetMessage)                   \
+  X(errorGetVerboseMessage)            \
+  X(errorFreeVerboseMessage)           \
+  X(graphPrepareExecutionEnvironment)  \
+  X(graphReleaseExecutionEnvironment)  \
+  X(graphGetProperty)
+
+enum Api : size_t {
+#define QNN_API_INDEX(name) API_##name,
+  QNN_INTERFACE_APIS(QNN_API_INDEX)
+#undef QNN_API_INDEX
+  API_composeGraphs,
+  API_freeGraphsInfo,
+  NUM_APIS,
+};
+
+const char *g_apiNames[NUM_APIS] = {
+#define QNN_API_NAME(name) #name,
+    QNN_INTERFACE_APIS(QNN_API_NAME)
+#undef QNN_API_NAME
+    "composeGraphs",
+    "freeGraphsInfo",
+};
+
+struct Slot {
+  std::atomic<uint64_t> calls{0};
+  std::atomic<uint64_t> totalNs{0};
+  std::atomic<uint64_t> minNs{UINT64_MAX};
+  std::atomic<uint64_t> maxNs{0};
+  std::atomic<uint64_t> bytes{0};
+};
+
+Slot g_slots[NUM_APIS];
+
+void record(size_t api, uint64_t ns, uint64_t bytes) {
+  Slot &slot = g_slots[api];
+  slot.calls.fetch_add(1, std::memory_order_relaxed);
+  slot.totalNs.fetch_add(ns, std::memory_order_relaxed);
+  slot.bytes.fetch_add(bytes, std::memory_order_relaxed);
+  uint64_t min = slot.minNs.load(std::memory_order_relaxed);
+  while (ns < min && !slot.minNs.compare_exchange_weak(min, ns, std::memory_order_relaxed)) {
+  }
+  uint64_t max = slot.maxNs.load(std::memory_order_relaxed);
+  while (ns > max && !slot.maxNs.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+  }
+}
+
+// Records the time from its construction to its destruction, so that the
+// shim can return the original's result directly.
+class CallTimer {
+ public:
+  CallTimer(size_t api, uint64_t bytes) : m_api(api), m_bytes(bytes), m_startNs(sysutil::nowNs()) {}
+
+  ~CallTimer() { record(m_api, sysutil::nowNs() - m_startNs, m_bytes); }
+
+  CallTimer(const CallTimer &) = delete;
+  CallTimer &operator=(const CallTimer &) = delete;
+
+ private:
+  size_t m_api;
+  uint64_t m_bytes;
+  uint64_t m_startNs;
+};
+
+uint64_t getClientBufBytes(const Qnn_Tensor_t *tensors, uint32_t numTensors) {
+  uint64_t bytes = 0;
+  for (uint32_t idx = 0; nullptr != tensors && idx < numTensors; idx++) {
+    bytes += QNN_TENSOR_GET_CLIENT_BUF(tensors[idx]).dataSize;
+  }
+  return bytes;
+}
+
+// Bytes an API call moves, from its arguments.
+template <size_t api>
+struct ArgBytes {
+  template <typename... Args>
+  static uint64_t get(Args...) {
+    return 0;
+  }
+};
+
+template <>
+struct ArgBytes<API_graphExecute> {
+  template <typename... Rest>
+  static uint64_t get(Qnn_GraphHandle_t,
+                      const Qnn_Tensor_t *inputs,
+                      uint32_t numInputs,
+                      const Qnn_Tensor_t *outputs,
+                      uint32_t numOutputs,
+                      Rest...) {
+    return getClientBufBytes(inputs, numInputs) + getClientBufBytes(outputs, numOutputs);
+  }
+};
+
+template <>
+struct ArgBytes<API_graphExecuteAsync> : ArgBytes<API_graphExecute> {};
+
+template <>
+struct ArgBytes<API_contextCreateFromBinary> {
+  template <typename... Rest>
+  static uint64_t get(Qnn_BackendHandle_t,
+                      Qnn_DeviceHandle_t,
+                      const QnnContext_Config_t **,
+                      const void *,
+                      Qnn_ContextBinarySize_t binaryBufferSize,
+                      Rest...) {
+    return binaryBufferSize;
+  }
+};
+
+template <>
+struct ArgBytes<API_contextGetBinary> {
+  static uint64_t get(Qnn_ContextHandle_t,
+                      void *,
+                      Qnn_ContextBinarySize_t binaryBufferSize,
+                      Qnn_ContextBinarySize_t *) {
+    return binaryBufferSize;
+  }
+};
+
+template <size_t api, typename Fn>
+struct Shim;
+
+template <size_t api, typename R, typename... Args>
+struct Shim<api, R (*)(Args...)> {
+  static R (*s_original)(Args...);
+
+  static R call(Args... args) {
+    CallTimer timer(api, ArgBytes<api>::get(args...));
+    return s_original(args...);
+  }
+
+  static void wrap(R (*&fn)(Args...)) {
+    if (nullptr == fn || &call == fn) {
+      return;
+    }
+    s_original = fn;
+    fn         = &call;
+  }
+};
+
+template <size_t api, typename R, typename... Args>
+R (*Shim<api, R (*)(Args...)>::s_original)(Args...) = nullptr;
+
+}  // namespace
+
+void apitiming::interpose(func::QnnFunctionPointers &qnnFunctionPointers) {
+  QNN_INTERFACE_VER_TYPE &qnnInterface = qnnFunctionPointers.qnnInterface;
+#define QNN_API_WRAP(name) \
+  Shim<API_##name, decltype(qnnInterface.name)>::wrap(qnnInterface.name);
+  QNN_INTERFACE_APIS(QNN_API_WRAP)
+#undef QNN_API_WRAP
+  Shim<API_composeGraphs, func::ComposeGraphsFnHandleType_t>::wrap(
+      qnnFunctionPointers.composeGraphsFnHandle);
+  Shim<API_freeGraphsInfo, func::FreeGraphInfoFnHandleType_t>::wrap(
+      qnnFunctionPointers.freeGraphInfoFnHandle);
+}
+
+std::vector<apitiming::ApiStats> apitiming::getStats() {
+  std::vector<ApiStats> stats;
+  for (size_t api = 0; api < NUM_APIS; api++) {
+    const Slot &slot = g_slots[api];
+    ApiStats apiStats;
+    apiStats.calls = slot.calls.load(std::memory_order_relaxed);
+    if (0 == apiStats.calls) {
+      continue;
+    }
+    apiStats.name    = g_apiNames[api];
+    apiStats.totalNs = slot.totalNs.load(std::memory_order_relaxed);
+    apiStats.minNs   = slot.minNs.load(std::memory_order_relaxed);
+    apiStats.maxNs   = slot.maxNs.load(std::memory_order_relaxed);
+    apiStats.bytes   = slot.bytes.load(std::memory_order_relaxed);
+    stats.push_back(apiStats);
+  }
+  std::sort(stats.begin(), stats.end(), [](const ApiStats &a, const ApiStats &b) {
+    return a.totalNs > b.totalNs;
+  });
+  return stats;
+}
+
+void apitiming::writeReport(int fd) {
+  // composeGraphs includes the calls the model library makes.
+  std::string report = "QNN API calls:\n";
+  char line[160];
+  snprintf(line,
+           sizeof(line),
+           "%-34s %8s %12s %10s %10s %10s %10s\n",
+           "api",
+           "calls",
+           "total ms",
+           "mean us",
+           "min us",
+           "max us",
+           "MiB");
+  report += line;
+  for (const ApiStats &stats : getStats()) {
+    snprintf(line,
+             sizeof(line),
+             "%-34s %8llu %12.3f %10.1f %10.1f %10.1f %10.1f\n",
+             stats.name.c_str(),
+             static_cast<unsigned long long>(stats.calls),
+             static_cast<double>(stats.totalNs) / 1e6,
+             static_cast<double>(stats.totalNs) / 1e3 / static_cast<double>(stats.calls),
+             static_cast<double>(stats.minNs) / 1e3,
+             static_cast<double>(stats.maxNs) / 1e3,
+             static_cast<double>(stats.bytes) / (1024.0 * 1024.0));
+    report += line;
+  }
+  sysutil::writeAll(fd, report.data(), report.size());
+}
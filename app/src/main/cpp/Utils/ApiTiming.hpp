@@ -0,0 +1,52 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "QnnWrapperFunc.hpp"
+
+namespace qnn {
+namespace tools {
+namespace apitiming {
+
+struct ApiStats {
+  std::string name;
+  uint64_t calls;
+  uint64_t totalNs;
+  uint64_t minNs;
+  uint64_t maxNs;
+  // Tensor bytes of graph executions and binary bytes of contexts; 0 for
+  // other APIs.
+  uint64_t bytes;
+};
+
+/*
+ * Replaces every function of qnnFunctionPointers' QNN interface, and the
+ * model's composeGraphs and freeGraphsInfo, with shims that time each call
+ * to the original. The model library calls the interface it is given, so
+ * its calls during composeGraphs are timed too. Functions the backend does
+ * not provide stay null.
+ *
+ * There is one set of originals per process, so only one backend can be
+ * interposed; interposing the same functions again does nothing.
+ */
+void interpose(func::QnnFunctionPointers &qnnFunctionPointers);
+
+// APIs called at least once, by total time spent in them.
+std::vector<ApiStats> getStats();
+
+// Writes getStats() as a table to fd.
+void writeReport(int fd);
+
+}  // namespace apitiming
+}  // namespace tools
+}  // namespace qnn
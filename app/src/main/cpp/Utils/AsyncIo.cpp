@@ -0,0 +1,500 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+#include <errno.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+// IORING_OP_READ/WRITE, which avoid building an iovec per request, arrived
+// together with IORING_FEAT_RW_CUR_POS.
+#if defined(__NR_io_uring_setup) && defined(IORING_FEAT_RW_CUR_POS)
+#define QNN_HAVE_IO_URING 1
+#endif
+#endif
+#endif
+
+#include "AsyncIo.hpp"
+#include "Logger.hpp"
+
+using namespace qnn;
+using namespace qnn::tools;
+
+namespace {
+
+// Largest transfer handed to the kernel at once; longer requests continue as
+// short transfers.
+const size_t g_maxTransferSize = 1 << 30;
+
+// Blocking transfer of a whole request, used by the thread pool and for
+// requests io_uring rejects.
+void transferSync(asyncio::Request& request) {
+  size_t done = 0;
+  while (done < request.length) {
+    size_t chunk  = std::min(request.length - done, g_maxTransferSize);
+    off_t offset  = static_cast<off_t>(request.offset + done);
+    ssize_t count = asyncio::Operation::READ == request.operation
+                        ? pread(request.fd, request.buffer + done, chunk, offset)
+                        : pwrite(request.fd, request.buffer + done, chunk, offset);
+    if (count < 0) {
+      if (EINTR == errno) {
+        continue;
+      }
+      request.result = -errno;
+      return;
+    }
+    if (0 == count) {
+      // Unexpected end of file.
+      request.result = -EIO;
+      return;
+    }
+    done += static_cast<size_t>(count);
+  }
+  request.transferred = done;
+  request.result      = static_cast<ssize_t>(request.length);
+}
+
+void resetRequest(asyncio::Request& request) {
+  request.result      = 0;
+  request.transferred = 0;
+  request.completed   = false;
+}
+
+class ThreadPoolEngine : public asyncio::Engine {
+ public:
+  explicit ThreadPoolEngine(unsigned numThreads) : m_stop(false) {
+    for (unsigned threadIdx = 0; threadIdx < numThreads; threadIdx++) {
+      m_threads.emplace_back(&ThreadPoolEngine::workerLoop, this);
+    }
+  }
+
+  ~ThreadPoolEngine() {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+    }
+    m_workCondition.notify_all();
+    for (auto& thread : m_threads) {
+      thread.join();
+    }
+  }
+
+  asyncio::Backend getBackend() const override { return asyncio::Backend::THREAD_POOL; }
+
+  void submit(const std::vector<asyncio::Request*>& requests) override {
+    if (requests.empty()) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      for (asyncio::Request* request : requests) {
+        resetRequest(*request);
+        m_queue.push_back(request);
+      }
+    }
+    m_workCondition.notify_all();
+  }
+
+  asyncio::StatusCode reap(asyncio::Request& request) override {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCondition.wait(lock, [&] { return request.completed; });
+    return request.result < 0 ? asyncio::StatusCode::FAILURE : asyncio::StatusCode::SUCCESS;
+  }
+
+ private:
+  void workerLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+      m_workCondition.wait(lock, [&] { return m_stop || !m_queue.empty(); });
+      if (m_stop) {
+        return;
+      }
+      asyncio::Request* request = m_queue.front();
+      m_queue.pop_front();
+      lock.unlock();
+      transferSync(*request);
+      lock.lock();
+      request->completed = true;
+      m_doneCondition.notify_all();
+    }
+  }
+
+  std::vector<std::thread> m_threads;
+  std::mutex m_mutex;
+  std::condition_variable m_workCondition;
+  std::condition_variable m_doneCondition;
+  // Submitted requests no worker has picked up yet, oldest first.
+  std::deque<asyncio::Request*> m_queue;
+  bool m_stop;
+};
+
+#ifdef QNN_HAVE_IO_URING
+// io_uring through the raw system calls, so there is no liburing dependency.
+// The engine is driven by a single thread. submit() pushes a batch to the
+// submission ring and hands it to the kernel with one io_uring_enter()
+// without waiting; reap() only enters the kernel again when the completion
+// it waits for is not already in the completion ring. Requests beyond the
+// ring size wait in a backlog until earlier ones complete.
+class IoUringEngine : public asyncio::Engine {
+ public:
+  IoUringEngine()
+      : m_ringFd(-1),
+        m_sqRing(MAP_FAILED),
+        m_sqRingSize(0),
+        m_cqRing(MAP_FAILED),
+        m_cqRingSize(0),
+        m_sqes(static_cast<io_uring_sqe*>(MAP_FAILED)),
+        m_sqesSize(0),
+        m_sqEntries(0) {}
+
+  ~IoUringEngine() {
+    if (m_sqes != MAP_FAILED) {
+      munmap(m_sqes, m_sqesSize);
+    }
+    if (m_cqRing != MAP_FAILED && m_cqRing != m_sqRing) {
+      munmap(m_cqRing, m_cqRingSize);
+    }
+    if (m_sqRing != MAP_FAILED) {
+      munmap(m_sqRing, m_sqRingSize);
+    }
+    if (m_ringFd >= 0) {
+      ::close(m_ringFd);
+    }
+  }
+
+  bool initialize(unsigned queueDepth) {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    m_ringFd = static_cast<int>(syscall(__NR_io_uring_setup, queueDepth, &params));
+    if (m_ringFd < 0) {
+      QNN_DEBUG("io_uring_setup failed: %s", strerror(errno));
+      return false;
+    }
+    if (!(params.features & IORING_FEAT_RW_CUR_POS)) {
+      QNN_DEBUG("Kernel io_uring lacks IORING_OP_READ/WRITE");
+      return false;
+    }
+    m_sqEntries  = params.sq_entries;
+    m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+      m_sqRingSize = m_cqRingSize = std::max(m_sqRingSize, m_cqRingSize);
+    }
+    m_sqRing = mmap(nullptr,
+                    m_sqRingSize,
+                    PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE,
+                    m_ringFd,
+                    IORING_OFF_SQ_RING);
+    if (MAP_FAILED == m_sqRing) {
+      return false;
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+      m_cqRing = m_sqRing;
+    } else {
+      m_cqRing = mmap(nullptr,
+                      m_cqRingSize,
+                      PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE,
+                      m_ringFd,
+                      IORING_OFF_CQ_RING);
+      if (MAP_FAILED == m_cqRing) {
+        return false;
+      }
+    }
+    m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    m_sqes     = static_cast<io_uring_sqe*>(mmap(nullptr,
+                                             m_sqesSize,
+                                             PROT_READ | PROT_WRITE,
+                                             MAP_SHARED | MAP_POPULATE,
+                                             m_ringFd,
+                                             IORING_OFF_SQES));
+    if (MAP_FAILED == m_sqes) {
+      return false;
+    }
+    uint8_t* sqRing = static_cast<uint8_t*>(m_sqRing);
+    uint8_t* cqRing = static_cast<uint8_t*>(m_cqRing);
+    m_sqTail        = reinterpret_cast<unsigned*>(sqRing + params.sq_off.tail);
+    m_sqMask        = *reinterpret_cast<unsigned*>(sqRing + params.sq_off.ring_mask);
+    m_sqArray       = reinterpret_cast<unsigned*>(sqRing + params.sq_off.array);
+    m_cqHead        = reinterpret_cast<unsigned*>(cqRing + params.cq_off.head);
+    m_cqTail        = reinterpret_cast<unsigned*>(cqRing + params.cq_off.tail);
+    m_cqMask        = *reinterpret_cast<unsigned*>(cqRing + params.cq_off.ring_mask);
+    m_cqes          = reinterpret_cast<io_uring_cqe*>(cqRing + params.cq_off.cqes);
+    return true;
+  }
+
+  asyncio::Backend getBackend() const override { return asyncio::Backend::IO_URING; }
+
+  void submit(const std::vector<asyncio::Request*>& requests) override {
+    for (asyncio::Request* request : requests) {
+      resetRequest(*request);
+      if (m_broken) {
+        request->result    = -EIO;
+        request->completed = true;
+      } else if (0 == request->length) {
+        request->completed = true;
+      } else {
+        m_backlog.push_back(request);
+      }
+    }
+    queueBacklog();
+    enter(0);
+  }
+
+  asyncio::StatusCode reap(asyncio::Request& request) override {
+    while (!request.completed) {
+      reapCompletions();
+      if (request.completed) {
+        break;
+      }
+      queueBacklog();
+      if (m_broken || (0 == m_inFlight && m_backlog.empty())) {
+        // The ring is unusable, or request was never submitted.
+        request.result    = m_broken ? -EIO : -EINVAL;
+        request.completed = true;
+        break;
+      }
+      enter(1);
+    }
+    // Get resubmitted short transfers going again before returning.
+    queueBacklog();
+    enter(0);
+    return request.result < 0 ? asyncio::StatusCode::FAILURE : asyncio::StatusCode::SUCCESS;
+  }
+
+  asyncio::StatusCode registerBuffers(
+      const std::vector<std::pair<uint8_t*, size_t>>& buffers) override {
+    unregisterBuffers();
+    if (buffers.empty()) {
+      return asyncio::StatusCode::SUCCESS;
+    }
+    std::vector<iovec> iovecs;
+    for (auto const& buffer : buffers) {
+      iovec vec;
+      vec.iov_base = buffer.first;
+      vec.iov_len  = buffer.second;
+      iovecs.push_back(vec);
+    }
+    if (syscall(__NR_io_uring_register,
+                m_ringFd,
+                IORING_REGISTER_BUFFERS,
+                iovecs.data(),
+                static_cast<unsigned>(iovecs.size())) < 0) {
+      // Typically RLIMIT_MEMLOCK; unregistered buffers still work.
+      QNN_DEBUG("io_uring buffer registration failed: %s", strerror(errno));
+      return asyncio::StatusCode::FAILURE;
+    }
+    m_registeredBuffers = buffers;
+    return asyncio::StatusCode::SUCCESS;
+  }
+
+  void unregisterBuffers() override {
+    if (!m_registeredBuffers.empty()) {
+      syscall(__NR_io_uring_register, m_ringFd, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+      m_registeredBuffers.clear();
+    }
+  }
+
+ private:
+  // Moves backlogged requests to the submission ring while it has room.
+  void queueBacklog() {
+    unsigned sqTail = *m_sqTail;
+    while (!m_backlog.empty() && m_inFlight < m_sqEntries) {
+      prepareEntry(sqTail & m_sqMask, *m_backlog.front());
+      m_backlog.pop_front();
+      sqTail++;
+      m_toSubmit++;
+      m_inFlight++;
+    }
+    __atomic_store_n(m_sqTail, sqTail, __ATOMIC_RELEASE);
+  }
+
+  // Hands queued entries to the kernel and, with minComplete, waits for that
+  // many completions.
+  void enter(unsigned minComplete) {
+    if (m_broken || (0 == m_toSubmit && 0 == minComplete)) {
+      return;
+    }
+    while (true) {
+      int submitted = static_cast<int>(syscall(__NR_io_uring_enter,
+                                               m_ringFd,
+                                               m_toSubmit,
+                                               minComplete,
+                                               minComplete > 0 ? IORING_ENTER_GETEVENTS : 0,
+                                               nullptr,
+                                               0));
+      if (submitted >= 0) {
+        m_toSubmit -= static_cast<unsigned>(submitted);
+        return;
+      }
+      if (EINTR == errno) {
+        continue;
+      }
+      if (EAGAIN == errno || EBUSY == errno) {
+        // Completions must be reaped first; the caller retries.
+        return;
+      }
+      QNN_ERROR("io_uring_enter failed: %s", strerror(errno));
+      m_broken = true;
+      return;
+    }
+  }
+
+  void reapCompletions() {
+    unsigned cqHead = *m_cqHead;
+    unsigned cqTail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+    for (; cqHead != cqTail; cqHead++) {
+      const io_uring_cqe& cqe   = m_cqes[cqHead & m_cqMask];
+      asyncio::Request& request = *reinterpret_cast<asyncio::Request*>(cqe.user_data);
+      m_inFlight--;
+      if (cqe.res > 0) {
+        request.transferred += static_cast<size_t>(cqe.res);
+        if (request.transferred < request.length) {
+          m_backlog.push_back(&request);
+        } else {
+          request.result    = static_cast<ssize_t>(request.length);
+          request.completed = true;
+        }
+      } else if (-EINTR == cqe.res || -EAGAIN == cqe.res) {
+        m_backlog.push_back(&request);
+      } else if (-EINVAL == cqe.res || -EOPNOTSUPP == cqe.res) {
+        // Some files, e.g. on FUSE or procfs, do not support io_uring.
+        transferSync(request);
+        request.completed = true;
+      } else {
+        request.result    = (0 == cqe.res) ? -EIO : cqe.res;
+        request.completed = true;
+      }
+    }
+    __atomic_store_n(m_cqHead, cqHead, __ATOMIC_RELEASE);
+  }
+
+  void prepareEntry(unsigned sqIndex, asyncio::Request& request) {
+    io_uring_sqe& sqe = m_sqes[sqIndex];
+    memset(&sqe, 0, sizeof(sqe));
+    uint8_t* buffer = request.buffer + request.transferred;
+    size_t length   = std::min(request.length - request.transferred, g_maxTransferSize);
+    bool isRead     = asyncio::Operation::READ == request.operation;
+    sqe.opcode      = isRead ? IORING_OP_READ : IORING_OP_WRITE;
+    for (size_t bufferIdx = 0; bufferIdx < m_registeredBuffers.size(); bufferIdx++) {
+      uint8_t* base = m_registeredBuffers[bufferIdx].first;
+      if (buffer >= base && buffer + length <= base + m_registeredBuffers[bufferIdx].second) {
+        sqe.opcode    = isRead ? IORING_OP_READ_FIXED : IORING_OP_WRITE_FIXED;
+        sqe.buf_index = static_cast<uint16_t>(bufferIdx);
+        break;
+      }
+    }
+    sqe.fd             = request.fd;
+    sqe.off            = request.offset + request.transferred;
+    sqe.addr           = reinterpret_cast<uint64_t>(buffer);
+    sqe.len            = static_cast<uint32_t>(length);
+    sqe.user_data      = reinterpret_cast<uint64_t>(&request);
+    m_sqArray[sqIndex] = sqIndex;
+  }
+
+  int m_ringFd;
+  void* m_sqRing;
+  size_t m_sqRingSize;
+  void* m_cqRing;
+  size_t m_cqRingSize;
+  io_uring_sqe* m_sqes;
+  size_t m_sqesSize;
+  unsigned m_sqEntries;
+  unsigned* m_sqTail   = nullptr;
+  unsigned m_sqMask    = 0;
+  unsigned* m_sqArray  = nullptr;
+  unsigned* m_cqHead   = nullptr;
+  unsigned* m_cqTail   = nullptr;
+  unsigned m_cqMask    = 0;
+  io_uring_cqe* m_cqes = nullptr;
+  std::vector<std::pair<uint8_t*, size_t>> m_registeredBuffers;
+  // Submitted requests not in the submission ring yet, including short
+  // transfers waiting to continue.
+  std::deque<asyncio::Request*> m_backlog;
+  unsigned m_inFlight = 0;
+  unsigned m_toSubmit = 0;
+  bool m_broken       = false;
+};
+#endif
+
+}  // namespace
+
+asyncio::StatusCode asyncio::Engine::submitAndWait(std::vector<Request>& requests) {
+  std::vector<Request*> batch;
+  for (auto& request : requests) {
+    batch.push_back(&request);
+  }
+  submit(batch);
+  bool failed = false;
+  for (auto& request : requests) {
+    failed = (StatusCode::SUCCESS != reap(request)) || failed;
+  }
+  return failed ? StatusCode::FAILURE : StatusCode::SUCCESS;
+}
+
+asyncio::Backend asyncio::parseBackend(std::string backendString) {
+  std::transform(backendString.begin(), backendString.end(), backendString.begin(), ::tolower);
+  Backend parsedBackend = Backend::INVALID;
+  if (0 == backendString.compare("none")) {
+    parsedBackend = Backend::NONE;
+  } else if (0 == backendString.compare("auto")) {
+    parsedBackend = Backend::AUTO;
+  } else if (0 == backendString.compare("io_uring")) {
+    parsedBackend = Backend::IO_URING;
+  } else if (0 == backendString.compare("thread_pool")) {
+    parsedBackend = Backend::THREAD_POOL;
+  }
+  return parsedBackend;
+}
+
+std::string asyncio::getBackendName(Backend backend) {
+  switch (backend) {
+    case Backend::NONE:
+      return "none";
+    case Backend::AUTO:
+      return "auto";
+    case Backend::IO_URING:
+      return "io_uring";
+    case Backend::THREAD_POOL:
+      return "thread_pool";
+    default:
+      return "invalid";
+  }
+}
+
+std::shared_ptr<asyncio::Engine> asyncio::createEngine(Backend backend, unsigned queueDepth) {
+  if (Backend::NONE == backend || Backend::INVALID == backend || 0 == queueDepth) {
+    return nullptr;
+  }
+  if (Backend::IO_URING == backend || Backend::AUTO == backend) {
+#ifdef QNN_HAVE_IO_URING
+    std::shared_ptr<IoUringEngine> engine = std::make_shared<IoUringEngine>();
+    if (engine->initialize(queueDepth)) {
+      return engine;
+    }
+#endif
+    if (Backend::IO_URING == backend) {
+      QNN_WARN("io_uring is not available, falling back to the thread pool I/O backend");
+    }
+  }
+  // Reads and writes block in the kernel, so a few more threads than cores
+  // still pay off on flash storage.
+  unsigned numThreads = std::min(queueDepth, 8u);
+  return std::make_shared<ThreadPoolEngine>(numThreads);
+}
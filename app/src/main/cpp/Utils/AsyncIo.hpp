@@ -0,0 +1,90 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+#pragma once
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace qnn {
+namespace tools {
+namespace asyncio {
+
+enum class StatusCode {
+  SUCCESS,
+  FAILURE,
+  NOT_SUPPORTED,
+};
+
+// NONE keeps the blocking stream based file I/O in DataUtil. AUTO picks
+// IO_URING when the kernel allows it and THREAD_POOL otherwise.
+enum class Backend { NONE, AUTO, IO_URING, THREAD_POOL, INVALID };
+
+Backend parseBackend(std::string backendString);
+
+std::string getBackendName(Backend backend);
+
+enum class Operation { READ, WRITE };
+
+// One positional read or write. An engine always transfers the full length,
+// resubmitting short transfers; result is then length, or -errno on failure.
+// transferred and completed are maintained by the engine.
+struct Request {
+  Operation operation = Operation::READ;
+  int fd              = -1;
+  uint8_t *buffer     = nullptr;
+  size_t length       = 0;
+  uint64_t offset     = 0;
+  ssize_t result      = 0;
+  size_t transferred  = 0;
+  bool completed      = false;
+};
+
+class Engine {
+ public:
+  virtual ~Engine() {}
+
+  virtual Backend getBackend() const = 0;
+
+  // Starts every request in one batch and returns without waiting for them.
+  // The requests, and their buffers, must stay alive until reaped. Engines
+  // are driven by a single thread, which submits and reaps.
+  virtual void submit(const std::vector<Request *> &requests) = 0;
+
+  // Waits until request, submitted earlier, has completed. Completions of
+  // other requests that arrive meanwhile are recorded on them, so reaping
+  // those later costs nothing. Returns FAILURE if request failed.
+  virtual StatusCode reap(Request &request) = 0;
+
+  // Submits every request in one batch and waits until all have completed.
+  // Returns FAILURE if any request failed; see Request::result for which.
+  StatusCode submitAndWait(std::vector<Request> &requests);
+
+  // Pins long lived buffers, such as tensor client buffers, so transfers to
+  // and from them skip per request page mapping. Requests whose buffer lies
+  // inside a registered range use it automatically. Registering replaces any
+  // previous registration.
+  virtual StatusCode registerBuffers(const std::vector<std::pair<uint8_t *, size_t>> &buffers) {
+    (void)buffers;
+    return StatusCode::NOT_SUPPORTED;
+  }
+
+  virtual void unregisterBuffers() {}
+};
+
+// Returns nullptr for Backend::NONE, or when no engine could be created.
+// An IO_URING request falls back to THREAD_POOL if io_uring is unavailable,
+// e.g. on older kernels or where seccomp filters it out.
+std::shared_ptr<Engine> createEngine(Backend backend, unsigned queueDepth = 64);
+
+}  // namespace asyncio
+}  // namespace tools
+}  // namespace qnn
@@ -5,17 +5,37 @@
 //  Confidential and Proprietary - Qualcomm Technologies, Inc.
 //
 //==============================================================================
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <numeric>
 #include <queue>
 
 #include "DataUtil.hpp"
+#include "MemoryAccounting.hpp"
+#include "Metrics.hpp"
+#include "SysUtil.hpp"
 
 using namespace qnn;
 using namespace qnn::tools;
 
+namespace {
+
+metrics::Counter& g_inputFileOpens = metrics::getRegistry().addCounter(
+    "qnn_input_file_opens_total", "Input files opened for reading or mapping.");
+metrics::Counter& g_outputFileOpens = metrics::getRegistry().addCounter(
+    "qnn_output_file_opens_total", "Output files opened for writing.");
+
+}  // namespace
+
 std::tuple<datautil::StatusCode, size_t> datautil::getDataTypeSizeInBytes(Qnn_DataType_t dataType) {
   if (g_dataTypeToSize.find(dataType) == g_dataTypeToSize.end()) {
     QNN_ERROR("Invalid qnn data type provided");
@@ -24,6 +44,26 @@ std::tuple<datautil::StatusCode, size_t> datautil::getDataTypeSizeInBytes(Qnn_Da
   return std::make_tuple(StatusCode::SUCCESS, g_dataTypeToSize.find(dataType)->second);
 }
 
+std::tuple<datautil::StatusCode, Qnn_DataType_t> datautil::parseDataType(
+    std::string dataTypeString) {
+  std::transform(dataTypeString.begin(), dataTypeString.end(), dataTypeString.begin(), ::tolower);
+  auto dataType = g_dataTypeNames.find(dataTypeString);
+  if (dataType == g_dataTypeNames.end()) {
+    QNN_ERROR("Invalid data type name provided: %s", dataTypeString.c_str());
+    return std::make_tuple(StatusCode::INVALID_DATA_TYPE, QNN_DATATYPE_UNDEFINED);
+  }
+  return std::make_tuple(StatusCode::SUCCESS, dataType->second);
+}
+
+std::string datautil::getDataTypeName(Qnn_DataType_t dataType) {
+  for (auto const& dataTypeName : g_dataTypeNames) {
+    if (dataTypeName.second == dataType) {
+      return dataTypeName.first;
+    }
+  }
+  return "undefined";
+}
+
 size_t datautil::calculateElementCount(std::vector<size_t> dims) {
   if (dims.size() == 0) {
     return 0;
@@ -47,6 +87,423 @@ std::tuple<datautil::StatusCode, size_t> datautil::calculateLength(std::vector<s
   return std::make_tuple(StatusCode::SUCCESS, length);
 }
 
+datautil::FileRange datautil::parseFileRange(const std::string& fileSpec) {
+  FileRange range;
+  range.path     = fileSpec;
+  auto rangeSign = fileSpec.rfind('@');
+  if (rangeSign == std::string::npos) {
+    return range;
+  }
+  auto lengthSign = fileSpec.find('+', rangeSign);
+  if (lengthSign == std::string::npos) {
+    return range;
+  }
+  std::string offset = fileSpec.substr(rangeSign + 1, lengthSign - rangeSign - 1);
+  std::string length = fileSpec.substr(lengthSign + 1);
+  if (offset.empty() || length.empty() ||
+      offset.find_first_not_of("0123456789") != std::string::npos ||
+      length.find_first_not_of("0123456789") != std::string::npos) {
+    return range;
+  }
+  range.path    = fileSpec.substr(0, rangeSign);
+  range.offset  = std::strtoull(offset.c_str(), nullptr, 10);
+  range.length  = std::strtoull(length.c_str(), nullptr, 10);
+  range.isRange = true;
+  return range;
+}
+
+datautil::InputFileCache::~InputFileCache() {
+  for (auto const& file : m_files) {
+    ::close(file.second);
+  }
+}
+
+int datautil::InputFileCache::acquire(const std::string& path) {
+  for (size_t idx = 0; idx < m_files.size(); idx++) {
+    if (m_files[idx].first == path) {
+      std::rotate(m_files.begin(), m_files.begin() + idx, m_files.begin() + idx + 1);
+      return m_files.front().second;
+    }
+  }
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC | m_openFlags);
+  if (fd < 0) {
+    return -1;
+  }
+  g_inputFileOpens.add();
+  if (m_files.size() >= g_maxCachedInputFiles) {
+    ::close(m_files.back().second);
+    m_files.pop_back();
+  }
+  m_files.insert(m_files.begin(), std::make_pair(path, fd));
+  return fd;
+}
+
+datautil::StatusCode datautil::readFileRange(const FileRange& range,
+                                             uint8_t* buffer,
+                                             InputFileCache* fileCache) {
+  if (nullptr == buffer) {
+    QNN_ERROR("buffer is nullptr");
+    return StatusCode::INVALID_BUFFER;
+  }
+  int fd = (nullptr != fileCache) ? fileCache->acquire(range.path)
+                                  : ::open(range.path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    QNN_ERROR("Failed to open input file: %s", range.path.c_str());
+    return StatusCode::FILE_OPEN_FAIL;
+  }
+  if (nullptr == fileCache) {
+    g_inputFileOpens.add();
+  }
+  StatusCode returnStatus = StatusCode::SUCCESS;
+  size_t done             = 0;
+  while (done < range.length) {
+    ssize_t count =
+        pread(fd, buffer + done, range.length - done, static_cast<off_t>(range.offset + done));
+    if (count < 0 && EINTR == errno) {
+      continue;
+    }
+    if (count <= 0) {
+      QNN_ERROR("Failed to read %llu bytes at offset %llu of: %s",
+                static_cast<unsigned long long>(range.length),
+                static_cast<unsigned long long>(range.offset),
+                range.path.c_str());
+      returnStatus = StatusCode::DATA_READ_FAIL;
+      break;
+    }
+    done += static_cast<size_t>(count);
+  }
+  if (nullptr == fileCache) {
+    ::close(fd);
+  }
+  return returnStatus;
+}
+
+datautil::DirectFileReader::DirectFileReader() : m_directFiles(O_DIRECT) {}
+
+datautil::DirectFileReader::~DirectFileReader() {
+  memaccount::getAccountant().release(m_staging);
+}
+
+int datautil::DirectFileReader::acquire(const std::string& path) {
+  if (isDirect(path)) {
+    int fd = m_directFiles.acquire(path);
+    if (fd >= 0 || EINVAL != errno) {
+      return fd;
+    }
+    QNN_WARN("O_DIRECT is not supported for %s, reading inputs through the page cache",
+             path.c_str());
+    m_directSupported = false;
+  }
+  return m_bufferedFiles.acquire(path);
+}
+
+datautil::StatusCode datautil::DirectFileReader::getLength(FileRange& range) {
+  if (range.isRange) {
+    return StatusCode::SUCCESS;
+  }
+  int fd = acquire(range.path);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0) {
+    QNN_ERROR("Failed to open input file: %s", range.path.c_str());
+    return StatusCode::FILE_OPEN_FAIL;
+  }
+  range.length = static_cast<uint64_t>(st.st_size);
+  return StatusCode::SUCCESS;
+}
+
+datautil::StatusCode datautil::DirectFileReader::read(const FileRange& range, uint8_t* buffer) {
+  if (nullptr == buffer) {
+    QNN_ERROR("buffer is nullptr");
+    return StatusCode::INVALID_BUFFER;
+  }
+  int fd = acquire(range.path);
+  if (fd < 0) {
+    QNN_ERROR("Failed to open input file: %s", range.path.c_str());
+    return StatusCode::FILE_OPEN_FAIL;
+  }
+  if (!isDirect(range.path)) {
+    return readFileRange(range, buffer, &m_bufferedFiles);
+  }
+  const uint64_t mask  = g_directIoAlignment - 1;
+  uint64_t offset      = range.offset & ~mask;
+  size_t head          = static_cast<size_t>(range.offset - offset);
+  size_t needed        = head + static_cast<size_t>(range.length);
+  size_t alignedLength = (needed + mask) & ~static_cast<size_t>(mask);
+  uint8_t* target      = buffer;
+  if (0 != head || 0 != range.length % g_directIoAlignment ||
+      0 != reinterpret_cast<uintptr_t>(buffer) % g_directIoAlignment) {
+    if (alignedLength > m_stagingSize) {
+      memaccount::Accountant& accountant = memaccount::getAccountant();
+      accountant.release(m_staging);
+      m_stagingSize = 0;
+      m_staging     = static_cast<uint8_t*>(accountant.allocateAligned(
+          g_directIoAlignment, alignedLength, memaccount::Category::SCRATCH));
+      if (nullptr == m_staging) {
+        QNN_ERROR("Failed to allocate %zu bytes for direct reads", alignedLength);
+        return StatusCode::INVALID_BUFFER;
+      }
+      m_stagingSize = alignedLength;
+    }
+    target = m_staging;
+  }
+  // Reads past the end of the file return short, so the tail block of a file
+  // whose size is not a block multiple is read whole and trimmed.
+  size_t done = 0;
+  while (done < needed) {
+    ssize_t count =
+        pread(fd, target + done, alignedLength - done, static_cast<off_t>(offset + done));
+    if (count < 0 && EINTR == errno) {
+      continue;
+    }
+    if (count < 0 && EINVAL == errno) {
+      // Some file systems accept O_DIRECT at open and reject the reads.
+      QNN_WARN("O_DIRECT reads are not supported for %s, reading it through the page cache",
+               range.path.c_str());
+      m_bufferedPaths.insert(range.path);
+      return readFileRange(range, buffer, &m_bufferedFiles);
+    }
+    if (count <= 0) {
+      QNN_ERROR("Failed to read %llu bytes at offset %llu of: %s",
+                static_cast<unsigned long long>(range.length),
+                static_cast<unsigned long long>(range.offset),
+                range.path.c_str());
+      return StatusCode::DATA_READ_FAIL;
+    }
+    done += static_cast<size_t>(count);
+  }
+  if (target != buffer) {
+    memcpy(buffer, target + head, static_cast<size_t>(range.length));
+  }
+  return StatusCode::SUCCESS;
+}
+
+datautil::AsyncInputReader::AsyncInputReader(std::shared_ptr<asyncio::Engine> engine)
+    : m_engine(engine) {}
+
+datautil::AsyncInputReader::~AsyncInputReader() { clear(); }
+
+void datautil::AsyncInputReader::addSample(const std::vector<std::string>& fileSpecs) {
+  for (auto const& fileSpec : fileSpecs) {
+    m_pending.push_back(std::make_pair(m_numSamplesQueued, fileSpec));
+  }
+  m_numSamplesQueued++;
+  fill();
+}
+
+void datautil::AsyncInputReader::prepare(Entry& entry) {
+  FileRange range = parseFileRange(entry.fileSpec);
+  if (range.isRange) {
+    // Cached descriptors are duplicated, because acquiring more files than
+    // the cache holds evicts and closes descriptors still queued for reading.
+    entry.fd = m_fileCache.acquire(range.path);
+    if (entry.fd >= 0) {
+      entry.fd = fcntl(entry.fd, F_DUPFD_CLOEXEC, 0);
+    }
+  } else {
+    entry.fd = ::open(range.path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (entry.fd >= 0) {
+      g_inputFileOpens.add();
+    }
+  }
+  struct stat st;
+  if (entry.fd < 0 || (!range.isRange && fstat(entry.fd, &st) != 0)) {
+    entry.status = StatusCode::FILE_OPEN_FAIL;
+    return;
+  }
+  const size_t length =
+      range.isRange ? static_cast<size_t>(range.length) : static_cast<size_t>(st.st_size);
+  entry.buffer = static_cast<uint8_t*>(
+      memaccount::getAccountant().allocate(length, memaccount::Category::SCRATCH));
+  if (nullptr == entry.buffer && length > 0) {
+    entry.status = StatusCode::DATA_READ_FAIL;
+    return;
+  }
+  entry.request.operation = asyncio::Operation::READ;
+  entry.request.fd        = entry.fd;
+  entry.request.buffer    = entry.buffer;
+  entry.request.length    = length;
+  entry.request.offset    = range.offset;
+}
+
+void datautil::AsyncInputReader::fill() {
+  std::vector<asyncio::Request*> batch;
+  while (!m_pending.empty() && m_inFlightBytes < g_maxAsyncReadAheadBytes &&
+         (m_inFlight.empty() ||
+          m_pending.front().first - m_inFlight.front().sampleIdx < g_asyncReadAheadSamples)) {
+    m_inFlight.emplace_back();
+    Entry& entry    = m_inFlight.back();
+    entry.sampleIdx = m_pending.front().first;
+    entry.fileSpec  = m_pending.front().second;
+    m_pending.pop_front();
+    // Failures are reported when the entry is taken.
+    prepare(entry);
+    if (StatusCode::SUCCESS == entry.status) {
+      m_inFlightBytes += entry.request.length;
+      batch.push_back(&entry.request);
+    }
+  }
+  m_engine->submit(batch);
+}
+
+void datautil::AsyncInputReader::release(Entry& entry) {
+  if (entry.fd >= 0) {
+    ::close(entry.fd);
+    entry.fd = -1;
+  }
+  memaccount::getAccountant().release(entry.buffer);
+  entry.buffer = nullptr;
+}
+
+datautil::StatusCode datautil::AsyncInputReader::take(const std::string& fileSpec,
+                                                      const uint8_t*& data,
+                                                      size_t& length) {
+  for (auto& entry : m_taken) {
+    release(entry);
+  }
+  m_taken.clear();
+  auto inFlight = std::find_if(m_inFlight.begin(), m_inFlight.end(), [&](const Entry& entry) {
+    return entry.fileSpec == fileSpec;
+  });
+  if (inFlight != m_inFlight.end()) {
+    m_taken.splice(m_taken.begin(), m_inFlight, inFlight);
+    if (StatusCode::SUCCESS == m_taken.front().status) {
+      m_inFlightBytes -= m_taken.front().request.length;
+    }
+    m_numReadAhead++;
+  } else {
+    auto pending = std::find_if(
+        m_pending.begin(), m_pending.end(), [&](const std::pair<size_t, std::string>& queued) {
+          return queued.second == fileSpec;
+        });
+    if (pending != m_pending.end()) {
+      m_pending.erase(pending);
+    }
+    m_taken.emplace_back();
+    m_taken.front().fileSpec = fileSpec;
+    prepare(m_taken.front());
+    if (StatusCode::SUCCESS == m_taken.front().status) {
+      m_engine->submit({&m_taken.front().request});
+    }
+    m_numReadOnDemand++;
+  }
+  Entry& entry = m_taken.front();
+  if (StatusCode::SUCCESS == entry.status &&
+      asyncio::StatusCode::SUCCESS != m_engine->reap(entry.request)) {
+    entry.status = StatusCode::DATA_READ_FAIL;
+  }
+  if (entry.fd >= 0) {
+    ::close(entry.fd);
+    entry.fd = -1;
+  }
+  // Keep the window full before the caller goes on to execute.
+  fill();
+  if (StatusCode::FILE_OPEN_FAIL == entry.status) {
+    QNN_ERROR("Failed to open input file: %s", fileSpec.c_str());
+  } else if (StatusCode::SUCCESS != entry.status) {
+    QNN_ERROR("Failed to read the contents of: %s", fileSpec.c_str());
+  }
+  data   = entry.buffer;
+  length = entry.request.length;
+  return entry.status;
+}
+
+void datautil::AsyncInputReader::clear() {
+  for (auto& entry : m_inFlight) {
+    if (StatusCode::SUCCESS == entry.status) {
+      m_engine->reap(entry.request);
+    }
+    release(entry);
+  }
+  for (auto& entry : m_taken) {
+    release(entry);
+  }
+  m_inFlight.clear();
+  m_taken.clear();
+  m_pending.clear();
+  m_inFlightBytes = 0;
+}
+
+void datautil::AsyncInputReader::logSummary() const {
+  QNN_INFO("Asynchronous input reads: %zu read ahead, %zu on demand",
+           m_numReadAhead,
+           m_numReadOnDemand);
+}
+
+datautil::AsyncOutputWriter::AsyncOutputWriter(std::shared_ptr<asyncio::Engine> engine)
+    : m_engine(engine) {}
+
+datautil::AsyncOutputWriter::~AsyncOutputWriter() { flush(); }
+
+datautil::StatusCode datautil::AsyncOutputWriter::write(int fd,
+                                                        const std::string& name,
+                                                        const uint8_t* data,
+                                                        size_t length) {
+  // The descriptor was opened by the caller, e.g. the output layout.
+  g_outputFileOpens.add();
+  m_pending.emplace_back();
+  Entry& entry            = m_pending.back();
+  entry.name              = name;
+  entry.fd                = fd;
+  entry.request.operation = asyncio::Operation::WRITE;
+  entry.request.fd        = fd;
+  entry.request.buffer    = const_cast<uint8_t*>(data);
+  entry.request.length    = length;
+  entry.request.offset    = 0;
+  m_numUnsubmitted++;
+  if (m_pending.size() > g_maxAsyncWriteBehindFiles) {
+    submit();
+    while (m_pending.size() > g_maxAsyncWriteBehindFiles) {
+      reapOldest();
+    }
+  }
+  return m_failed ? StatusCode::DATA_WRITE_FAIL : StatusCode::SUCCESS;
+}
+
+void datautil::AsyncOutputWriter::adopt(void* buffer) { m_adopted.push_back(buffer); }
+
+void datautil::AsyncOutputWriter::submit() {
+  if (0 == m_numUnsubmitted) {
+    return;
+  }
+  std::vector<asyncio::Request*> batch;
+  auto entry = m_pending.end();
+  std::advance(entry, -static_cast<std::ptrdiff_t>(m_numUnsubmitted));
+  for (; entry != m_pending.end(); ++entry) {
+    batch.push_back(&entry->request);
+  }
+  m_numUnsubmitted = 0;
+  m_engine->submit(batch);
+}
+
+void datautil::AsyncOutputWriter::reapOldest() {
+  Entry& entry = m_pending.front();
+  if (asyncio::StatusCode::SUCCESS != m_engine->reap(entry.request)) {
+    QNN_ERROR("Failed to write output file: %s: %s",
+              entry.name.c_str(),
+              strerror(static_cast<int>(-entry.request.result)));
+    m_failed = true;
+  }
+  if (0 != ::close(entry.fd)) {
+    QNN_ERROR("Failed to close output file: %s: %s", entry.name.c_str(), strerror(errno));
+    m_failed = true;
+  }
+  m_pending.pop_front();
+}
+
+datautil::StatusCode datautil::AsyncOutputWriter::flush() {
+  submit();
+  while (!m_pending.empty()) {
+    reapOldest();
+  }
+  for (void* buffer : m_adopted) {
+    memaccount::getAccountant().release(buffer);
+  }
+  m_adopted.clear();
+  bool failed = m_failed;
+  m_failed    = false;
+  return failed ? StatusCode::DATA_WRITE_FAIL : StatusCode::SUCCESS;
+}
+
 datautil::StatusCode datautil::readDataFromFile(std::string filePath,
                                                 std::vector<size_t> dims,
                                                 Qnn_DataType_t dataType,
@@ -60,6 +517,7 @@ datautil::StatusCode datautil::readDataFromFile(std::string filePath,
     QNN_ERROR("Failed to open input file: %s", filePath.c_str());
     return StatusCode::FILE_OPEN_FAIL;
   }
+  g_inputFileOpens.add();
   in.seekg(0, in.end);
   const size_t length = in.tellg();
   in.seekg(0, in.beg);
@@ -84,11 +542,168 @@ datautil::StatusCode datautil::readDataFromFile(std::string filePath,
   return StatusCode::SUCCESS;
 }
 
+datautil::ReadBatchDataRetType_t datautil::fillBatch(BatchSource& source,
+                                                    size_t length,
+                                                    uint8_t* buffer) {
+  size_t numInputsCopied = 0;
+  size_t totalLength     = 0;
+  while (totalLength < length && source.hasNext()) {
+    size_t inputLength = 0;
+    StatusCode status  = source.getLength(inputLength);
+    if (StatusCode::SUCCESS != status) {
+      return std::make_tuple(status, numInputsCopied, numInputsCopied);
+    }
+    if (inputLength == 0 || (length % inputLength) != 0 || inputLength > length - totalLength) {
+      QNN_ERROR("Input %s: size in bytes (%zu), should be multiples of: %zu",
+                source.getName().c_str(),
+                inputLength,
+                length);
+      return std::make_tuple(StatusCode::DATA_SIZE_MISMATCH, numInputsCopied, numInputsCopied);
+    }
+    status = source.read(buffer + totalLength);
+    if (StatusCode::SUCCESS != status) {
+      return std::make_tuple(status, numInputsCopied, numInputsCopied);
+    }
+    totalLength += inputLength;
+    numInputsCopied += 1;
+  }
+  if (0 == numInputsCopied) {
+    QNN_ERROR("No inputs left to fill a batch");
+    return std::make_tuple(StatusCode::DATA_READ_FAIL, 0, 0);
+  }
+  size_t numBatchSize = numInputsCopied;
+  if (totalLength < length) {
+    numBatchSize += (length - totalLength) / (totalLength / numInputsCopied);
+    // pad the vector with zeros
+    memset(buffer + totalLength, 0, (length - totalLength) * sizeof(char));
+  }
+  return std::make_tuple(StatusCode::SUCCESS, numInputsCopied, numBatchSize);
+}
+
+namespace {
+
+// Input list entries read with stream I/O, or through a file cache for
+// ranges.
+class QueueSource : public datautil::BatchSource {
+ public:
+  QueueSource(std::queue<std::string>& filePaths, datautil::InputFileCache* fileCache)
+      : m_filePaths(filePaths), m_fileCache(fileCache) {}
+
+  bool hasNext() const override { return !m_filePaths.empty(); }
+
+  std::string getName() const override { return m_filePaths.front(); }
+
+  datautil::StatusCode getLength(size_t& length) override {
+    m_range = datautil::parseFileRange(m_filePaths.front());
+    if (m_range.isRange) {
+      length = static_cast<size_t>(m_range.length);
+      return datautil::StatusCode::SUCCESS;
+    }
+    m_in.close();
+    m_in.clear();
+    m_in.open(m_filePaths.front(), std::ifstream::binary);
+    if (!m_in) {
+      QNN_ERROR("Failed to open input file: %s", m_filePaths.front().c_str());
+      return datautil::StatusCode::FILE_OPEN_FAIL;
+    }
+    g_inputFileOpens.add();
+    m_in.seekg(0, m_in.end);
+    length = m_in.tellg();
+    m_in.seekg(0, m_in.beg);
+    m_range.length = length;
+    return datautil::StatusCode::SUCCESS;
+  }
+
+  datautil::StatusCode read(uint8_t* buffer) override {
+    if (m_range.isRange) {
+      datautil::StatusCode status = datautil::readFileRange(m_range, buffer, m_fileCache);
+      if (datautil::StatusCode::SUCCESS != status) {
+        return status;
+      }
+    } else if (!m_in.read(reinterpret_cast<char*>(buffer),
+                          static_cast<std::streamsize>(m_range.length))) {
+      QNN_ERROR("Failed to read the contents of: %s", m_filePaths.front().c_str());
+      return datautil::StatusCode::DATA_READ_FAIL;
+    }
+    m_filePaths.pop();
+    return datautil::StatusCode::SUCCESS;
+  }
+
+ private:
+  std::queue<std::string>& m_filePaths;
+  datautil::InputFileCache* m_fileCache;
+  datautil::FileRange m_range;
+  std::ifstream m_in;
+};
+
+// Input list entries read with O_DIRECT.
+class DirectSource : public datautil::BatchSource {
+ public:
+  DirectSource(std::queue<std::string>& filePaths, datautil::DirectFileReader& directReader)
+      : m_filePaths(filePaths), m_directReader(directReader) {}
+
+  bool hasNext() const override { return !m_filePaths.empty(); }
+
+  std::string getName() const override { return m_filePaths.front(); }
+
+  datautil::StatusCode getLength(size_t& length) override {
+    m_range                     = datautil::parseFileRange(m_filePaths.front());
+    datautil::StatusCode status = m_directReader.getLength(m_range);
+    length                      = static_cast<size_t>(m_range.length);
+    return status;
+  }
+
+  datautil::StatusCode read(uint8_t* buffer) override {
+    datautil::StatusCode status = m_directReader.read(m_range, buffer);
+    if (datautil::StatusCode::SUCCESS == status) {
+      m_filePaths.pop();
+    }
+    return status;
+  }
+
+ private:
+  std::queue<std::string>& m_filePaths;
+  datautil::DirectFileReader& m_directReader;
+  datautil::FileRange m_range;
+};
+
+// Input list entries taken from an asynchronous reader.
+class AsyncSource : public datautil::BatchSource {
+ public:
+  AsyncSource(std::queue<std::string>& filePaths, datautil::AsyncInputReader& asyncReader)
+      : m_filePaths(filePaths), m_asyncReader(asyncReader) {}
+
+  bool hasNext() const override { return !m_filePaths.empty(); }
+
+  std::string getName() const override { return m_filePaths.front(); }
+
+  datautil::StatusCode getLength(size_t& length) override {
+    datautil::StatusCode status = m_asyncReader.take(m_filePaths.front(), m_data, m_length);
+    length                      = m_length;
+    return status;
+  }
+
+  datautil::StatusCode read(uint8_t* buffer) override {
+    memcpy(buffer, m_data, m_length);
+    m_filePaths.pop();
+    return datautil::StatusCode::SUCCESS;
+  }
+
+ private:
+  std::queue<std::string>& m_filePaths;
+  datautil::AsyncInputReader& m_asyncReader;
+  const uint8_t* m_data = nullptr;
+  size_t m_length       = 0;
+};
+
+}  // namespace
+
 datautil::ReadBatchDataRetType_t datautil::readBatchDataAndUpdateQueue(
     std::queue<std::string>& filePaths,
     std::vector<size_t> dims,
     Qnn_DataType_t dataType,
-    uint8_t* buffer) {
+    uint8_t* buffer,
+    InputFileCache* fileCache) {
   if (nullptr == buffer) {
     QNN_ERROR("buffer is nullptr");
     return std::make_tuple(StatusCode::INVALID_BUFFER, 0, 0);
@@ -99,51 +714,114 @@ datautil::ReadBatchDataRetType_t datautil::readBatchDataAndUpdateQueue(
   if (StatusCode::SUCCESS != err) {
     return std::make_tuple(err, 0, 0);
   }
-  size_t numInputsCopied = 0;
-  size_t numBatchSize    = 0;
-  size_t totalLength     = 0;
-  do {
-    if (filePaths.empty()) {
-      numBatchSize += (l - totalLength) / (totalLength / numBatchSize);
-      // pad the vector with zeros
-      memset(buffer + totalLength, 0, (l - totalLength) * sizeof(char));
-      totalLength = l;
-    } else {
-      std::ifstream in(filePaths.front(), std::ifstream::binary);
-      if (!in) {
-        QNN_ERROR("Failed to open input file: %s", filePaths.front().c_str());
-        return std::make_tuple(StatusCode::FILE_OPEN_FAIL, numInputsCopied, numBatchSize);
-      }
-      in.seekg(0, in.end);
-      const size_t length = in.tellg();
-      in.seekg(0, in.beg);
-      if ((l % length) != 0 || length > l || length == 0) {
-        QNN_ERROR("Input file %s: file size in bytes (%d), should be multiples of: %d",
-                  filePaths.front().c_str(),
-                  length,
-                  l);
-        return std::make_tuple(StatusCode::DATA_SIZE_MISMATCH, numInputsCopied, numBatchSize);
-      }
-      if (!in.read(reinterpret_cast<char*>(buffer + (numInputsCopied * length)), length)) {
-        QNN_ERROR("Failed to read the contents of: %s", filePaths.front().c_str());
-        return std::make_tuple(StatusCode::DATA_READ_FAIL, numInputsCopied, numBatchSize);
-      }
-      QNN_VERBOSE("Return from readDataFromFile()");
-      totalLength += length;
-      numInputsCopied += 1;
-      numBatchSize += 1;
-      filePaths.pop();
-    }
-  } while (totalLength < l);
-  return std::make_tuple(StatusCode::SUCCESS, numInputsCopied, numBatchSize);
+  QueueSource source(filePaths, fileCache);
+  return fillBatch(source, l, buffer);
+}
+
+datautil::ReadBatchDataRetType_t datautil::readBatchDataAndUpdateQueue(
+    std::queue<std::string>& filePaths,
+    std::vector<size_t> dims,
+    Qnn_DataType_t dataType,
+    uint8_t* buffer,
+    DirectFileReader& directReader) {
+  if (nullptr == buffer) {
+    QNN_ERROR("buffer is nullptr");
+    return std::make_tuple(StatusCode::INVALID_BUFFER, 0, 0);
+  }
+  StatusCode err{StatusCode::SUCCESS};
+  size_t l{0};
+  std::tie(err, l) = datautil::calculateLength(dims, dataType);
+  if (StatusCode::SUCCESS != err) {
+    return std::make_tuple(err, 0, 0);
+  }
+  DirectSource source(filePaths, directReader);
+  return fillBatch(source, l, buffer);
+}
+
+datautil::ReadBatchDataRetType_t datautil::readBatchDataAndUpdateQueue(
+    std::queue<std::string>& filePaths,
+    std::vector<size_t> dims,
+    Qnn_DataType_t dataType,
+    uint8_t* buffer,
+    AsyncInputReader& asyncReader) {
+  if (nullptr == buffer) {
+    QNN_ERROR("buffer is nullptr");
+    return std::make_tuple(StatusCode::INVALID_BUFFER, 0, 0);
+  }
+  StatusCode err{StatusCode::SUCCESS};
+  size_t l{0};
+  std::tie(err, l) = datautil::calculateLength(dims, dataType);
+  if (StatusCode::SUCCESS != err) {
+    return std::make_tuple(err, 0, 0);
+  }
+  AsyncSource source(filePaths, asyncReader);
+  return fillBatch(source, l, buffer);
+}
+
+datautil::ReadBatchDataRetType_t datautil::mapDataAndUpdateQueue(
+    std::queue<std::string>& filePaths,
+    std::vector<size_t> dims,
+    Qnn_DataType_t dataType,
+    pal::MappedFile::Advice advice,
+    pal::MappedFile& mappedFile) {
+  if (filePaths.empty()) {
+    return std::make_tuple(StatusCode::SUCCESS, 0, 0);
+  }
+  StatusCode err{StatusCode::SUCCESS};
+  size_t l{0};
+  std::tie(err, l) = datautil::calculateLength(dims, dataType);
+  if (StatusCode::SUCCESS != err) {
+    return std::make_tuple(err, 0, 0);
+  }
+  FileRange range = parseFileRange(filePaths.front());
+  struct stat st;
+  if (stat(range.path.c_str(), &st) != 0 ||
+      (range.isRange ? (range.length != l || range.offset + l > static_cast<uint64_t>(st.st_size))
+                     : static_cast<size_t>(st.st_size) != l)) {
+    // Missing files, partial batches and size mismatches are left to the
+    // copying path, which pads and reports errors.
+    return std::make_tuple(StatusCode::SUCCESS, 0, 0);
+  }
+  if (!mappedFile.open(range.path, static_cast<size_t>(range.offset), l)) {
+    QNN_DEBUG("Failed to map input file: %s, falling back to copy", filePaths.front().c_str());
+    return std::make_tuple(StatusCode::SUCCESS, 0, 0);
+  }
+  g_inputFileOpens.add();
+  size_t elementSize{0};
+  std::tie(err, elementSize) = getDataTypeSizeInBytes(dataType);
+  if (StatusCode::SUCCESS != err ||
+      reinterpret_cast<uintptr_t>(mappedFile.data()) % elementSize != 0) {
+    mappedFile.close();
+    return std::make_tuple(StatusCode::SUCCESS, 0, 0);
+  }
+  if (pal::MappedFile::Advice::NORMAL != advice && !mappedFile.advise(advice)) {
+    QNN_DEBUG("madvise failed for input file: %s", filePaths.front().c_str());
+  }
+  QNN_VERBOSE("Mapped input file: %s", filePaths.front().c_str());
+  filePaths.pop();
+  return std::make_tuple(StatusCode::SUCCESS, 1, 1);
 }
 
 std::tuple<datautil::StatusCode, size_t> datautil::getFileSize(std::string filePath) {
+  FileRange range = parseFileRange(filePath);
+  if (range.isRange) {
+    struct stat st;
+    if (stat(range.path.c_str(), &st) != 0) {
+      QNN_ERROR("Failed to open input file: %s", range.path.c_str());
+      return std::make_tuple(StatusCode::FILE_OPEN_FAIL, 0);
+    }
+    if (range.offset + range.length > static_cast<uint64_t>(st.st_size)) {
+      QNN_ERROR("Input range %s exceeds the file size", filePath.c_str());
+      return std::make_tuple(StatusCode::DATA_SIZE_MISMATCH, 0);
+    }
+    return std::make_tuple(StatusCode::SUCCESS, static_cast<size_t>(range.length));
+  }
   std::ifstream in(filePath, std::ifstream::binary);
   if (!in) {
     QNN_ERROR("Failed to open input file: %s", filePath.c_str());
     return std::make_tuple(StatusCode::FILE_OPEN_FAIL, 0);
   }
+  g_inputFileOpens.add();
   in.seekg(0, in.end);
   const size_t length = in.tellg();
   in.seekg(0, in.beg);
@@ -157,11 +835,21 @@ datautil::StatusCode datautil::readBinaryFromFile(std::string filePath,
     QNN_ERROR("buffer is nullptr");
     return StatusCode::INVALID_BUFFER;
   }
+  FileRange range = parseFileRange(filePath);
+  if (range.isRange) {
+    if (bufferSize > range.length) {
+      QNN_ERROR("Input range %s is smaller than %zu bytes", filePath.c_str(), bufferSize);
+      return StatusCode::DATA_SIZE_MISMATCH;
+    }
+    range.length = bufferSize;
+    return readFileRange(range, buffer, nullptr);
+  }
   std::ifstream in(filePath, std::ifstream::binary);
   if (!in) {
     QNN_ERROR("Failed to open input file: %s", filePath.c_str());
     return StatusCode::FILE_OPEN_FAIL;
   }
+  g_inputFileOpens.add();
   if (!in.read(reinterpret_cast<char*>(buffer), bufferSize)) {
     QNN_ERROR("Failed to read the contents of: %s", filePath.c_str());
     return StatusCode::DATA_READ_FAIL;
@@ -188,6 +876,7 @@ datautil::StatusCode datautil::writeDataToFile(std::string fileDir,
     QNN_ERROR("Failed to open output file for writing: %s", outputPath.c_str());
     return StatusCode::FILE_OPEN_FAIL;
   }
+  g_outputFileOpens.add();
   StatusCode err{StatusCode::SUCCESS};
   size_t length{0};
   std::tie(err, length) = datautil::calculateLength(dims, dataType);
@@ -229,6 +918,7 @@ datautil::StatusCode datautil::writeBatchDataToFile(std::vector<std::string> fil
       QNN_ERROR("Failed to open output file for writing: %s", outputPath.c_str());
       return StatusCode::FILE_OPEN_FAIL;
     }
+    g_outputFileOpens.add();
     for (size_t l = 0; l < outputSize; l++) {
       size_t bufferIndex = l + (batchIndex * outputSize);
       os.write(reinterpret_cast<char*>(&(*(buffer + bufferIndex))), 1);
@@ -237,6 +927,33 @@ datautil::StatusCode datautil::writeBatchDataToFile(std::vector<std::string> fil
   return StatusCode::SUCCESS;
 }
 
+datautil::StatusCode datautil::writeBatchDataToFiles(const std::vector<int>& fds,
+                                                     std::vector<size_t> dims,
+                                                     Qnn_DataType_t dataType,
+                                                     uint8_t* buffer,
+                                                     const size_t batchSize) {
+  if (nullptr == buffer) {
+    QNN_ERROR("buffer is nullptr");
+    return StatusCode::INVALID_BUFFER;
+  }
+  StatusCode err{StatusCode::SUCCESS};
+  size_t length{0};
+  std::tie(err, length) = datautil::calculateLength(dims, dataType);
+  if (StatusCode::SUCCESS != err) {
+    return err;
+  }
+  auto outputSize = (length / batchSize);
+  // The descriptors were opened by the caller, e.g. the output layout.
+  g_outputFileOpens.add(fds.size());
+  for (size_t batchIndex = 0; batchIndex < fds.size(); batchIndex++) {
+    if (!sysutil::writeAll(fds[batchIndex], buffer + (batchIndex * outputSize), outputSize)) {
+      QNN_ERROR("Failed to write output file: %s", strerror(errno));
+      return StatusCode::DATA_WRITE_FAIL;
+    }
+  }
+  return StatusCode::SUCCESS;
+}
+
 datautil::StatusCode datautil::writeBinaryToFile(std::string fileDir,
                                                  std::string fileName,
                                                  uint8_t* buffer,
@@ -255,6 +972,7 @@ datautil::StatusCode datautil::writeBinaryToFile(std::string fileDir,
     QNN_ERROR("Failed to open output file for writing: %s", outputPath.c_str());
     return StatusCode::FILE_OPEN_FAIL;
   }
+  g_outputFileOpens.add();
   os.write(reinterpret_cast<char*>(buffer), bufferSize);
   return StatusCode::SUCCESS;
 }
@@ -316,6 +1034,91 @@ template datautil::StatusCode datautil::tfNToFloat<uint8_t>(
 template datautil::StatusCode datautil::tfNToFloat<uint16_t>(
     float* out, uint16_t* in, int32_t offset, float scale, size_t numElements);
 
+template <typename T_QuantType>
+datautil::StatusCode datautil::floatToTfNPerAxis(T_QuantType* out,
+                                                 float* in,
+                                                 const Qnn_ScaleOffset_t* scaleOffsets,
+                                                 size_t numScaleOffsets,
+                                                 size_t innerSize,
+                                                 size_t numElements) {
+  if (nullptr == scaleOffsets || 0 == numScaleOffsets || 0 == innerSize) {
+    QNN_ERROR("Received an empty per axis encoding");
+    return StatusCode::INVALID_DATA_TYPE;
+  }
+  // Runs of innerSize elements share a scale and offset.
+  for (size_t start = 0, channel = 0; start < numElements; start += innerSize) {
+    size_t count      = std::min(innerSize, numElements - start);
+    StatusCode status = floatToTfN<T_QuantType>(out + start,
+                                                in + start,
+                                                scaleOffsets[channel].offset,
+                                                scaleOffsets[channel].scale,
+                                                count);
+    if (StatusCode::SUCCESS != status) {
+      return status;
+    }
+    channel = (channel + 1) % numScaleOffsets;
+  }
+  return StatusCode::SUCCESS;
+}
+
+template datautil::StatusCode datautil::floatToTfNPerAxis<uint8_t>(
+    uint8_t* out,
+    float* in,
+    const Qnn_ScaleOffset_t* scaleOffsets,
+    size_t numScaleOffsets,
+    size_t innerSize,
+    size_t numElements);
+
+template datautil::StatusCode datautil::floatToTfNPerAxis<uint16_t>(
+    uint16_t* out,
+    float* in,
+    const Qnn_ScaleOffset_t* scaleOffsets,
+    size_t numScaleOffsets,
+    size_t innerSize,
+    size_t numElements);
+
+template <typename T_QuantType>
+datautil::StatusCode datautil::tfNToFloatPerAxis(float* out,
+                                                 T_QuantType* in,
+                                                 const Qnn_ScaleOffset_t* scaleOffsets,
+                                                 size_t numScaleOffsets,
+                                                 size_t innerSize,
+                                                 size_t numElements) {
+  if (nullptr == scaleOffsets || 0 == numScaleOffsets || 0 == innerSize) {
+    QNN_ERROR("Received an empty per axis encoding");
+    return StatusCode::INVALID_DATA_TYPE;
+  }
+  for (size_t start = 0, channel = 0; start < numElements; start += innerSize) {
+    size_t count      = std::min(innerSize, numElements - start);
+    StatusCode status = tfNToFloat<T_QuantType>(out + start,
+                                                in + start,
+                                                scaleOffsets[channel].offset,
+                                                scaleOffsets[channel].scale,
+                                                count);
+    if (StatusCode::SUCCESS != status) {
+      return status;
+    }
+    channel = (channel + 1) % numScaleOffsets;
+  }
+  return StatusCode::SUCCESS;
+}
+
+template datautil::StatusCode datautil::tfNToFloatPerAxis<uint8_t>(
+    float* out,
+    uint8_t* in,
+    const Qnn_ScaleOffset_t* scaleOffsets,
+    size_t numScaleOffsets,
+    size_t innerSize,
+    size_t numElements);
+
+template datautil::StatusCode datautil::tfNToFloatPerAxis<uint16_t>(
+    float* out,
+    uint16_t* in,
+    const Qnn_ScaleOffset_t* scaleOffsets,
+    size_t numScaleOffsets,
+    size_t innerSize,
+    size_t numElements);
+
 template <typename T_QuantType>
 datautil::StatusCode datautil::castToFloat(float* out, T_QuantType* in, size_t numElements) {
   if (nullptr == out || nullptr == in) {
@@ -7,15 +7,22 @@
 //==============================================================================
 #pragma once
 
+#include <deque>
+#include <list>
 #include <map>
+#include <memory>
 #include <queue>
+#include <set>
+#include <string>
 #include <vector>
 
 #include "QnnTypes.h"
 
+#include "AsyncIo.hpp"
 #include "Logger.hpp"
 #include "PAL/Directory.hpp"
 #include "PAL/FileOp.hpp"
+#include "PAL/MappedFile.hpp"
 #include "PAL/Path.hpp"
 
 namespace qnn {
@@ -37,8 +44,217 @@ const size_t g_bitsPerByte = 8;
 
 using ReadBatchDataRetType_t = std::tuple<StatusCode, size_t, size_t>;
 
+const size_t g_maxCachedInputFiles = 64;
+
+/*
+ * An input list entry. Besides whole files, entries may select a byte range
+ * of a larger file as path@offset+length, e.g. dataset.bin@4096+602112, so
+ * many samples can share one file. A path that merely contains '@' without a
+ * valid offset+length suffix is taken as a whole file.
+ */
+struct FileRange {
+  std::string path;
+  uint64_t offset = 0;
+  uint64_t length = 0;
+  bool isRange    = false;
+};
+
+FileRange parseFileRange(const std::string& fileSpec);
+
+/*
+ * Keeps the most recently used input files open, so samples sliced out of the
+ * same large file do not pay an open() and close() each.
+ */
+class InputFileCache {
+ public:
+  // openFlags are added to O_RDONLY | O_CLOEXEC when opening files.
+  explicit InputFileCache(int openFlags = 0) : m_openFlags(openFlags) {}
+  ~InputFileCache();
+
+  InputFileCache(const InputFileCache&) = delete;
+  InputFileCache& operator=(const InputFileCache&) = delete;
+
+  // Returns a descriptor owned by the cache, or -1 if the file cannot be
+  // opened. It stays valid until g_maxCachedInputFiles other files are used.
+  int acquire(const std::string& path);
+
+ private:
+  int m_openFlags;
+  // Most recently used first.
+  std::vector<std::pair<std::string, int>> m_files;
+};
+
+// Alignment of buffers, file offsets and lengths for O_DIRECT reads. 4 KiB
+// covers the logical block size of the storage found on devices.
+const size_t g_directIoAlignment = 4096;
+
+/*
+ * Reads input files with O_DIRECT, bypassing the page cache, so sweeping a
+ * dataset larger than memory does not evict the model and context pages.
+ * Reads are widened to aligned blocks. They land in the destination directly
+ * when it, the offset and the length are all aligned, and otherwise go through
+ * an aligned staging buffer, which also covers file tails that are not a
+ * multiple of the block size. If the file system rejects O_DIRECT, files are
+ * read through the page cache instead. A file whose direct reads are rejected
+ * although it opened with O_DIRECT is read through the page cache from then on.
+ */
+class DirectFileReader {
+ public:
+  DirectFileReader();
+  ~DirectFileReader();
+
+  DirectFileReader(const DirectFileReader&) = delete;
+  DirectFileReader& operator=(const DirectFileReader&) = delete;
+
+  // Sets the length of a whole file entry to the file size; ranges are left
+  // as they are.
+  StatusCode getLength(FileRange& range);
+
+  StatusCode read(const FileRange& range, uint8_t* buffer);
+
+ private:
+  int acquire(const std::string& path);
+
+  bool isDirect(const std::string& path) const {
+    return m_directSupported && 0 == m_bufferedPaths.count(path);
+  }
+
+  InputFileCache m_directFiles;
+  InputFileCache m_bufferedFiles;
+  // Files opened with O_DIRECT whose reads were rejected.
+  std::set<std::string> m_bufferedPaths;
+  bool m_directSupported = true;
+  uint8_t* m_staging     = nullptr;
+  size_t m_stagingSize   = 0;
+};
+
+// Samples whose input files are kept in flight ahead of execution by
+// AsyncInputReader, and the most bytes those reads may hold.
+const size_t g_asyncReadAheadSamples    = 4;
+const uint64_t g_maxAsyncReadAheadBytes = 64ull << 20;
+
+/*
+ * Reads the input files of upcoming samples through an asynchronous I/O
+ * engine while earlier samples execute. Samples are queued as the input list
+ * is parsed; the reads of the next g_asyncReadAheadSamples of them are
+ * submitted into staging buffers, and each is only reaped when its entry is
+ * taken, by which time it has usually completed. Entries taken that were not
+ * queued, or whose read was not submitted yet, are read on demand.
+ */
+class AsyncInputReader {
+ public:
+  explicit AsyncInputReader(std::shared_ptr<asyncio::Engine> engine);
+  ~AsyncInputReader();
+
+  AsyncInputReader(const AsyncInputReader&) = delete;
+  AsyncInputReader& operator=(const AsyncInputReader&) = delete;
+
+  // Queues the input list entries of the next sample, in execution order.
+  void addSample(const std::vector<std::string>& fileSpecs);
+
+  // Waits for the read of fileSpec and returns its contents, which stay valid
+  // until the next call.
+  StatusCode take(const std::string& fileSpec, const uint8_t*& data, size_t& length);
+
+  // Waits for and drops every queued read, e.g. when execution of a graph
+  // stops before its samples are used.
+  void clear();
+
+  void logSummary() const;
+
+ private:
+  struct Entry {
+    std::string fileSpec;
+    size_t sampleIdx = 0;
+    int fd           = -1;
+    StatusCode status{StatusCode::SUCCESS};
+    uint8_t* buffer = nullptr;
+    asyncio::Request request;
+  };
+
+  // Opens the file of entry and sizes its buffer and read request.
+  void prepare(Entry& entry);
+
+  // Submits reads of pending entries until the window or byte budget is full.
+  void fill();
+
+  void release(Entry& entry);
+
+  std::shared_ptr<asyncio::Engine> m_engine;
+  InputFileCache m_fileCache;
+  // Queued entries whose reads are not submitted yet, oldest first.
+  std::deque<std::pair<size_t, std::string>> m_pending;
+  // Entries with reads submitted, oldest first.
+  std::list<Entry> m_inFlight;
+  // The entry last returned by take().
+  std::list<Entry> m_taken;
+  uint64_t m_inFlightBytes  = 0;
+  size_t m_numSamplesQueued = 0;
+  size_t m_numReadAhead     = 0;
+  size_t m_numReadOnDemand  = 0;
+};
+
+// Most output files AsyncOutputWriter holds open in writes that have not been
+// reaped.
+const size_t g_maxAsyncWriteBehindFiles = 128;
+
+/*
+ * Writes output files behind execution through an asynchronous I/O engine.
+ * Writes are made straight from the caller's buffers, e.g. the output tensor
+ * buffers, which must stay unchanged until flush(). The writes queued for a
+ * sample are submitted as one batch by submit(), and only reaped once
+ * g_maxAsyncWriteBehindFiles are pending, or on flush(). A failed write is
+ * reported by a later write() or by flush().
+ */
+class AsyncOutputWriter {
+ public:
+  explicit AsyncOutputWriter(std::shared_ptr<asyncio::Engine> engine);
+  ~AsyncOutputWriter();
+
+  AsyncOutputWriter(const AsyncOutputWriter&) = delete;
+  AsyncOutputWriter& operator=(const AsyncOutputWriter&) = delete;
+
+  // Queues a write of length bytes from data to fd, an output file opened by
+  // the caller, and takes ownership of fd. name is used in error messages.
+  StatusCode write(int fd, const std::string& name, const uint8_t* data, size_t length);
+
+  // Takes ownership of buffer, allocated through the memory accountant, e.g.
+  // a converted output that queued writes are made from. It is released on
+  // flush().
+  void adopt(void* buffer);
+
+  // Submits the writes queued since the last call as one batch.
+  void submit();
+
+  // Waits for every queued write and closes its file. Returns failure if any
+  // write since the last flush() failed.
+  StatusCode flush();
+
+ private:
+  struct Entry {
+    std::string name;
+    int fd = -1;
+    asyncio::Request request;
+  };
+
+  // Reaps the oldest write and closes its file.
+  void reapOldest();
+
+  std::shared_ptr<asyncio::Engine> m_engine;
+  // Queued writes, oldest first. The last m_numUnsubmitted are not submitted.
+  std::list<Entry> m_pending;
+  size_t m_numUnsubmitted = 0;
+  std::vector<void*> m_adopted;
+  bool m_failed           = false;
+};
+
 std::tuple<StatusCode, size_t> getDataTypeSizeInBytes(Qnn_DataType_t dataType);
 
+// Parses data type names such as "float32", "uint8" or "ufixed_point_8".
+std::tuple<StatusCode, Qnn_DataType_t> parseDataType(std::string dataTypeString);
+
+std::string getDataTypeName(Qnn_DataType_t dataType);
+
 std::tuple<StatusCode, size_t> calculateLength(std::vector<size_t> dims, Qnn_DataType_t dataType);
 
 size_t calculateElementCount(std::vector<size_t> dims);
@@ -50,6 +266,37 @@ StatusCode readDataFromFile(std::string filePath,
                             Qnn_DataType_t dataType,
                             uint8_t* buffer);
 
+/*
+ * The inputs that fillBatch() places one after another into a batch, e.g. the
+ * files of an input list queue or the records of a dataset.
+ */
+class BatchSource {
+ public:
+  virtual ~BatchSource() = default;
+
+  virtual bool hasNext() const = 0;
+
+  // Name of the next input, for error messages.
+  virtual std::string getName() const = 0;
+
+  // Returns the size in bytes of the next input.
+  virtual StatusCode getLength(size_t& length) = 0;
+
+  // Reads the next input, of the size returned by getLength(), to buffer and
+  // moves on to the input after it.
+  virtual StatusCode read(uint8_t* buffer) = 0;
+};
+
+/*
+ * Fills buffer, length bytes of a model input, with consecutive inputs from
+ * source. Each input must hold a whole number of batch elements; if source
+ * runs out first, the rest of the batch is padded with zeros.
+ *
+ * @return ReadBatchDataRetType_t returns the number of inputs copied and the
+ * batch size along with status
+ */
+ReadBatchDataRetType_t fillBatch(BatchSource& source, size_t length, uint8_t* buffer);
+
 /*
  * Read data in batches from Queue and try to matches the model input's
  * batches. If the queue is empty while matching the batch size of model,
@@ -58,6 +305,7 @@ StatusCode readDataFromFile(std::string filePath,
  * @param dims model input dimensions
  * @param dataType to create input buffer from file
  * @param buffer to fill the input image data
+ * @param fileCache keeps files of path@offset+length entries open, optional
  *
  * @return ReadBatchDataRetType_t returns numFilesCopied and batchSize along
  * with status
@@ -65,7 +313,54 @@ StatusCode readDataFromFile(std::string filePath,
 ReadBatchDataRetType_t readBatchDataAndUpdateQueue(std::queue<std::string>& filePaths,
                                                    std::vector<size_t> dims,
                                                    Qnn_DataType_t dataType,
-                                                   uint8_t* buffer);
+                                                   uint8_t* buffer,
+                                                   InputFileCache* fileCache = nullptr);
+
+/*
+ * Same as above, except that files and ranges are read with O_DIRECT through
+ * directReader.
+ */
+ReadBatchDataRetType_t readBatchDataAndUpdateQueue(std::queue<std::string>& filePaths,
+                                                   std::vector<size_t> dims,
+                                                   Qnn_DataType_t dataType,
+                                                   uint8_t* buffer,
+                                                   DirectFileReader& directReader);
+
+/*
+ * Same as above, except that files and ranges are taken from asyncReader,
+ * which has usually read them ahead.
+ */
+ReadBatchDataRetType_t readBatchDataAndUpdateQueue(std::queue<std::string>& filePaths,
+                                                   std::vector<size_t> dims,
+                                                   Qnn_DataType_t dataType,
+                                                   uint8_t* buffer,
+                                                   AsyncInputReader& asyncReader);
+
+/*
+ * Bind the next file in the queue to a read-only mapping instead of copying
+ * it. Direct binding is only possible when that single file holds the whole
+ * model input, i.e. the batch rules of readBatchDataAndUpdateQueue would copy
+ * exactly one file without padding, and the mapped data is aligned for the
+ * data type. Otherwise nothing is consumed from the queue and the caller is
+ * expected to fall back to readBatchDataAndUpdateQueue.
+ * @param filePathsQueue image paths queue
+ * @param dims model input dimensions
+ * @param dataType of the model input
+ * @param advice access pattern hint applied to the mapping
+ * @param mappedFile receives the mapping on success
+ *
+ * @return ReadBatchDataRetType_t returns numFilesCopied and batchSize along
+ * with status, both zero when the file could not be bound directly
+ */
+ReadBatchDataRetType_t mapDataAndUpdateQueue(std::queue<std::string>& filePaths,
+                                             std::vector<size_t> dims,
+                                             Qnn_DataType_t dataType,
+                                             pal::MappedFile::Advice advice,
+                                             pal::MappedFile& mappedFile);
+
+// Reads a file range through fileCache, or through a file opened for this
+// read alone when fileCache is nullptr.
+StatusCode readFileRange(const FileRange& range, uint8_t* buffer, InputFileCache* fileCache);
 
 StatusCode readBinaryFromFile(std::string filePath, uint8_t* buffer, size_t bufferSize);
 
@@ -82,6 +377,14 @@ StatusCode writeBatchDataToFile(std::vector<std::string> fileDirs,
                                 uint8_t* buffer,
                                 const size_t batchSize);
 
+// Writes sample i of the batch to fds[i], output files opened by the caller,
+// which keeps ownership of them.
+StatusCode writeBatchDataToFiles(const std::vector<int>& fds,
+                                 std::vector<size_t> dims,
+                                 Qnn_DataType_t dataType,
+                                 uint8_t* buffer,
+                                 const size_t batchSize);
+
 StatusCode writeBinaryToFile(std::string fileDir,
                              std::string fileName,
                              uint8_t* buffer,
@@ -95,6 +398,28 @@ template <typename T_QuantType>
 datautil::StatusCode tfNToFloat(
     float* out, T_QuantType* in, int32_t offset, float scale, size_t numElements);
 
+/*
+ * Per axis variants of floatToTfN and tfNToFloat. Element i uses
+ * scaleOffsets[(i / innerSize) % numScaleOffsets], where innerSize is the
+ * number of elements per index of the quantization axis, i.e. the product of
+ * the dimensions after it, and numScaleOffsets is the size of the axis.
+ */
+template <typename T_QuantType>
+datautil::StatusCode floatToTfNPerAxis(T_QuantType* out,
+                                       float* in,
+                                       const Qnn_ScaleOffset_t* scaleOffsets,
+                                       size_t numScaleOffsets,
+                                       size_t innerSize,
+                                       size_t numElements);
+
+template <typename T_QuantType>
+datautil::StatusCode tfNToFloatPerAxis(float* out,
+                                       T_QuantType* in,
+                                       const Qnn_ScaleOffset_t* scaleOffsets,
+                                       size_t numScaleOffsets,
+                                       size_t innerSize,
+                                       size_t numElements);
+
 template <typename T_QuantType>
 datautil::StatusCode castToFloat(float* out, T_QuantType* in, size_t numElements);
 
@@ -120,6 +445,26 @@ const std::map<Qnn_DataType_t, size_t> g_dataTypeToSize = {
     {QNN_DATATYPE_UFIXED_POINT_32, 4},
     {QNN_DATATYPE_BOOL_8, 1},
 };
+
+const std::map<std::string, Qnn_DataType_t> g_dataTypeNames = {
+    {"int8", QNN_DATATYPE_INT_8},
+    {"int16", QNN_DATATYPE_INT_16},
+    {"int32", QNN_DATATYPE_INT_32},
+    {"int64", QNN_DATATYPE_INT_64},
+    {"uint8", QNN_DATATYPE_UINT_8},
+    {"uint16", QNN_DATATYPE_UINT_16},
+    {"uint32", QNN_DATATYPE_UINT_32},
+    {"uint64", QNN_DATATYPE_UINT_64},
+    {"float16", QNN_DATATYPE_FLOAT_16},
+    {"float32", QNN_DATATYPE_FLOAT_32},
+    {"sfixed_point_8", QNN_DATATYPE_SFIXED_POINT_8},
+    {"sfixed_point_16", QNN_DATATYPE_SFIXED_POINT_16},
+    {"sfixed_point_32", QNN_DATATYPE_SFIXED_POINT_32},
+    {"ufixed_point_8", QNN_DATATYPE_UFIXED_POINT_8},
+    {"ufixed_point_16", QNN_DATATYPE_UFIXED_POINT_16},
+    {"ufixed_point_32", QNN_DATATYPE_UFIXED_POINT_32},
+    {"bool8", QNN_DATATYPE_BOOL_8},
+};
 }  // namespace datautil
 }  // namespace tools
 }  // namespace qnn
@@ -0,0 +1,143 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include "FlightRecorder.hpp"
+#include "Logger.hpp"
+
+using namespace qnn;
+using namespace qnn::tools;
+
+const char* flightrecorder::getPhaseName(Phase phase) {
+  switch (phase) {
+    case Phase::NONE:
+      return "NONE";
+    case Phase::INITIALIZE:
+      return "INITIALIZE";
+    case Phase::INITIALIZE_BACKEND:
+      return "INITIALIZE_BACKEND";
+    case Phase::CREATE_CONTEXT:
+      return "CREATE_CONTEXT";
+    case Phase::COMPOSE_GRAPHS:
+      return "COMPOSE_GRAPHS";
+    case Phase::FINALIZE_GRAPHS:
+      return "FINALIZE_GRAPHS";
+    case Phase::SETUP_TENSORS:
+      return "SETUP_TENSORS";
+    case Phase::SAMPLE:
+      return "SAMPLE";
+    case Phase::READ_INPUT_LIST:
+      return "READ_INPUT_LIST";
+    case Phase::POPULATE_INPUTS:
+      return "POPULATE_INPUTS";
+    case Phase::POPULATE_INPUT:
+      return "POPULATE_INPUT";
+    case Phase::MAP_OUTPUTS:
+      return "MAP_OUTPUTS";
+    case Phase::EXECUTE:
+      return "EXECUTE";
+    case Phase::WRITE_OUTPUTS:
+      return "WRITE_OUTPUTS";
+    case Phase::WRITE_OUTPUT:
+      return "WRITE_OUTPUT";
+    case Phase::TEAR_DOWN_TENSORS:
+      return "TEAR_DOWN_TENSORS";
+    case Phase::CREATE_DEVICE:
+      return "CREATE_DEVICE";
+    case Phase::REGISTER_OP_PACKAGES:
+      return "REGISTER_OP_PACKAGES";
+    case Phase::READ_INPUT:
+      return "READ_INPUT";
+    case Phase::CONVERT_INPUT:
+      return "CONVERT_INPUT";
+    case Phase::CONVERT_OUTPUT:
+      return "CONVERT_OUTPUT";
+  }
+  return "UNKNOWN";
+}
+
+flightrecorder::Recorder::Recorder()
+    : m_header(nullptr), m_records(nullptr), m_indexMask(0), m_graphIdx(0), m_sampleIdx(0) {}
+
+uint32_t flightrecorder::Recorder::getThreadId() {
+  static thread_local uint32_t s_threadId = static_cast<uint32_t>(syscall(SYS_gettid));
+  return s_threadId;
+}
+
+void flightrecorder::Recorder::addTraceEvent(Phase phase,
+                                             uint32_t graphIdx,
+                                             size_t sampleIdx,
+                                             uint64_t startNs,
+                                             uint64_t endNs,
+                                             uint16_t tensorIdx) {
+  traceevent::Event event;
+  event.name       = getPhaseName(phase);
+  event.category   = "app";
+  event.startNs    = startNs;
+  event.durationNs = endNs - startNs;
+  event.threadId   = getThreadId();
+  switch (phase) {
+    case Phase::INITIALIZE:
+    case Phase::INITIALIZE_BACKEND:
+    case Phase::CREATE_DEVICE:
+    case Phase::REGISTER_OP_PACKAGES:
+    case Phase::CREATE_CONTEXT:
+    case Phase::COMPOSE_GRAPHS:
+      break;
+    case Phase::FINALIZE_GRAPHS:
+    case Phase::SETUP_TENSORS:
+    case Phase::TEAR_DOWN_TENSORS:
+      event.graphIdx = graphIdx;
+      break;
+    default:
+      event.graphIdx  = graphIdx;
+      event.sampleIdx = static_cast<int64_t>(sampleIdx);
+      break;
+  }
+  if (g_noTensor != tensorIdx) {
+    event.tensorIdx = tensorIdx;
+  }
+  m_traceEvents->add(std::move(event));
+}
+
+flightrecorder::StatusCode flightrecorder::Recorder::open(const std::string& path,
+                                                          size_t numRecords) {
+  size_t capacity = 1;
+  while (capacity < numRecords) {
+    capacity <<= 1;
+  }
+  size_t fileSize = sizeof(FileHeader) + capacity * sizeof(Record);
+  m_header        = nullptr;
+  m_records       = nullptr;
+  if (!m_mappedFile.create(path, fileSize)) {
+    QNN_ERROR("Failed to create flight recorder trace: %s", path.c_str());
+    return StatusCode::FILE_CREATE_FAIL;
+  }
+  // Fault every page in now rather than on the first records.
+  memset(m_mappedFile.data(), 0, fileSize);
+  struct timespec realtime;
+  clock_gettime(CLOCK_REALTIME, &realtime);
+  int64_t realtimeNs = static_cast<int64_t>(realtime.tv_sec) * 1000000000ll + realtime.tv_nsec;
+
+  m_header = reinterpret_cast<FileHeader*>(m_mappedFile.data());
+  memcpy(m_header->magic, g_magic, sizeof(g_magic));
+  m_header->version          = g_version;
+  m_header->recordSize       = sizeof(Record);
+  m_header->numRecords       = capacity;
+  m_header->realtimeOffsetNs = realtimeNs - static_cast<int64_t>(now());
+  m_header->pid              = static_cast<uint32_t>(getpid());
+  m_header->writeIndex.store(0, std::memory_order_relaxed);
+  m_records   = reinterpret_cast<Record*>(m_mappedFile.data() + sizeof(FileHeader));
+  m_indexMask = capacity - 1;
+  QNN_INFO("Flight recorder: %zu records in %s", capacity, path.c_str());
+  return StatusCode::SUCCESS;
+}
@@ -0,0 +1,227 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "PAL/MappedFile.hpp"
+#include "SysUtil.hpp"
+#include "TraceEvent.hpp"
+
+namespace qnn {
+namespace tools {
+namespace flightrecorder {
+
+enum class StatusCode {
+  SUCCESS,
+  FILE_CREATE_FAIL,
+};
+
+// Stored in the trace file, so existing values must not change.
+enum class Phase : uint8_t {
+  NONE                 = 0,
+  INITIALIZE           = 1,
+  INITIALIZE_BACKEND   = 2,
+  CREATE_CONTEXT       = 3,
+  COMPOSE_GRAPHS       = 4,
+  FINALIZE_GRAPHS      = 5,
+  SETUP_TENSORS        = 6,
+  SAMPLE               = 7,
+  READ_INPUT_LIST      = 8,
+  POPULATE_INPUTS      = 9,
+  POPULATE_INPUT       = 10,
+  MAP_OUTPUTS          = 11,
+  EXECUTE              = 12,
+  WRITE_OUTPUTS        = 13,
+  WRITE_OUTPUT         = 14,
+  TEAR_DOWN_TENSORS    = 15,
+  CREATE_DEVICE        = 16,
+  REGISTER_OP_PACKAGES = 17,
+  READ_INPUT           = 18,
+  CONVERT_INPUT        = 19,
+  CONVERT_OUTPUT       = 20,
+};
+
+// Returns the name of phase, or "UNKNOWN".
+const char *getPhaseName(Phase phase);
+
+// tensorIdx of events that are not about a single tensor.
+const uint16_t g_noTensor = 0xffff;
+
+// Records kept by default: 2 MiB of trace, a few seconds of a busy run.
+const size_t g_defaultNumRecords = 65536;
+
+// Name of the trace qnn-mobile-app writes in its output directory unless
+// given another path or disabled.
+const char g_defaultTraceFileName[] = "flight_recorder.bin";
+
+const char g_magic[8]    = {'Q', 'N', 'N', 'F', 'R', 'E', 'C', '1'};
+const uint32_t g_version = 1;
+
+// Trace file layout: a FileHeader followed by numRecords Records, used as a
+// ring. Times are CLOCK_MONOTONIC nanoseconds.
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t recordSize;
+  uint64_t numRecords;
+  // Add to a record time to get CLOCK_REALTIME nanoseconds.
+  int64_t realtimeOffsetNs;
+  uint32_t pid;
+  uint32_t reserved;
+  // Records ever claimed; the next one goes to writeIndex % numRecords.
+  std::atomic<uint64_t> writeIndex;
+  uint8_t padding[16];
+};
+
+// phase is zeroed while the record is written and stored last, so a record
+// torn by a crash reads as NONE and is skipped.
+struct Record {
+  uint64_t startNs;
+  uint64_t endNs;
+  uint32_t sampleIdx;
+  uint32_t threadId;
+  uint16_t graphIdx;
+  uint16_t tensorIdx;
+  std::atomic<uint8_t> phase;
+  uint8_t reserved[3];
+};
+
+static_assert(sizeof(FileHeader) == 64, "FileHeader layout changed");
+static_assert(sizeof(Record) == 32, "Record layout changed");
+
+/*
+ * Always-on binary flight recorder, opened by qnn-mobile-app by default.
+ * Timed events are written as fixed-size records into a ring in a shared
+ * file mapping: recording is a clock read, an atomic increment and a few
+ * stores, with no system call and no formatting, so it can stay enabled
+ * without changing the timing it measures. The mapping is the file's page cache, so the last records
+ * survive a crash of the process and can be decoded afterwards with
+ * qnn-flight-decode.
+ *
+ * Events that do not name a graph and sample are attributed to the ones set
+ * with setSample(), which the executor updates before each sample.
+ *
+ * Events can also be forwarded to a trace event writer, with or without a
+ * trace file, to build a timeline of the whole run.
+ */
+class Recorder {
+ public:
+  Recorder();
+
+  Recorder(const Recorder &) = delete;
+  Recorder &operator=(const Recorder &) = delete;
+
+  // Creates, or truncates, the trace file at path with room for numRecords
+  // records, rounded up to a power of two.
+  StatusCode open(const std::string &path, size_t numRecords = g_defaultNumRecords);
+
+  bool isOpen() const { return nullptr != m_records; }
+
+  // Also add every event to traceEvents.
+  void setTraceEvents(std::shared_ptr<traceevent::Writer> traceEvents) {
+    m_traceEvents = traceEvents;
+  }
+
+  // Whether events are recorded anywhere.
+  bool isEnabled() const { return nullptr != m_records || nullptr != m_traceEvents; }
+
+  void setSample(uint32_t graphIdx, size_t sampleIdx) {
+    m_graphIdx  = static_cast<uint16_t>(graphIdx);
+    m_sampleIdx = static_cast<uint32_t>(sampleIdx);
+  }
+
+  void record(Phase phase,
+              uint32_t graphIdx,
+              size_t sampleIdx,
+              uint64_t startNs,
+              uint64_t endNs,
+              uint16_t tensorIdx = g_noTensor) {
+    if (nullptr != m_traceEvents) {
+      addTraceEvent(phase, graphIdx, sampleIdx, startNs, endNs, tensorIdx);
+    }
+    if (nullptr == m_records) {
+      return;
+    }
+    uint64_t index = m_header->writeIndex.fetch_add(1, std::memory_order_relaxed);
+    Record &record = m_records[index & m_indexMask];
+    // The trace is read after the fact, so only the compiler must keep the
+    // stores in order for a crash to leave the record marked torn.
+    record.phase.store(static_cast<uint8_t>(Phase::NONE), std::memory_order_relaxed);
+    std::atomic_signal_fence(std::memory_order_release);
+    record.startNs   = startNs;
+    record.endNs     = endNs;
+    record.sampleIdx = static_cast<uint32_t>(sampleIdx);
+    record.threadId  = getThreadId();
+    record.graphIdx  = static_cast<uint16_t>(graphIdx);
+    record.tensorIdx = tensorIdx;
+    record.phase.store(static_cast<uint8_t>(phase), std::memory_order_release);
+  }
+
+  // Records an event of the current graph and sample.
+  void record(Phase phase, uint64_t startNs, uint64_t endNs, uint16_t tensorIdx = g_noTensor) {
+    record(phase, m_graphIdx, m_sampleIdx, startNs, endNs, tensorIdx);
+  }
+
+  static uint64_t now() { return sysutil::nowNs(); }
+
+ private:
+  static uint32_t getThreadId();
+
+  void addTraceEvent(Phase phase,
+                     uint32_t graphIdx,
+                     size_t sampleIdx,
+                     uint64_t startNs,
+                     uint64_t endNs,
+                     uint16_t tensorIdx);
+
+  pal::MappedFile m_mappedFile;
+  FileHeader *m_header;
+  Record *m_records;
+  uint64_t m_indexMask;
+  uint16_t m_graphIdx;
+  uint32_t m_sampleIdx;
+  std::shared_ptr<traceevent::Writer> m_traceEvents;
+};
+
+/*
+ * Records the time between its construction and destruction as an event of
+ * the recorder's current sample. Does nothing, not even read the clock, when
+ * recorder is null or not enabled.
+ */
+class Scope {
+ public:
+  Scope(Recorder *recorder, Phase phase, uint16_t tensorIdx = g_noTensor)
+      : m_recorder(nullptr != recorder && recorder->isEnabled() ? recorder : nullptr),
+        m_phase(phase),
+        m_tensorIdx(tensorIdx),
+        m_startNs(nullptr != m_recorder ? Recorder::now() : 0) {}
+
+  ~Scope() {
+    if (nullptr != m_recorder) {
+      m_recorder->record(m_phase, m_startNs, Recorder::now(), m_tensorIdx);
+    }
+  }
+
+  Scope(const Scope &) = delete;
+  Scope &operator=(const Scope &) = delete;
+
+ private:
+  Recorder *m_recorder;
+  Phase m_phase;
+  uint16_t m_tensorIdx;
+  uint64_t m_startNs;
+};
+
+}  // namespace flightrecorder
+}  // namespace tools
+}  // namespace qnn
@@ -0,0 +1,207 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "FrameStream.hpp"
+#include "Logger.hpp"
+
+using namespace qnn;
+using namespace qnn::tools;
+
+const std::string framestream::g_standardStream = "-";
+
+namespace {
+
+// Pipe capacity requested for FIFOs, so a producer can stay a few frames
+// ahead without waking the reader for every 64 KiB.
+const int g_pipeSize = 1 << 20;
+
+void growPipe(int fd) {
+#ifdef F_SETPIPE_SZ
+  struct stat st;
+  if (fstat(fd, &st) == 0 && S_ISFIFO(st.st_mode) && fcntl(fd, F_SETPIPE_SZ, g_pipeSize) < 0) {
+    QNN_DEBUG("Could not grow pipe buffer: %s", strerror(errno));
+  }
+#else
+  (void)fd;
+#endif
+}
+
+}  // namespace
+
+framestream::Framing framestream::parseFraming(std::string framingString) {
+  std::transform(framingString.begin(), framingString.end(), framingString.begin(), ::tolower);
+  Framing parsedFraming = Framing::INVALID;
+  if (0 == framingString.compare("length")) {
+    parsedFraming = Framing::LENGTH_PREFIXED;
+  } else if (0 == framingString.compare("fixed")) {
+    parsedFraming = Framing::FIXED_SIZE;
+  }
+  return parsedFraming;
+}
+
+framestream::Reader::~Reader() {
+  if (m_ownsFd && m_fd >= 0) {
+    close(m_fd);
+  }
+}
+
+framestream::StatusCode framestream::Reader::open(const std::string& path, Framing framing) {
+  m_framing = framing;
+  if (path == g_standardStream) {
+    m_fd     = STDIN_FILENO;
+    m_ownsFd = false;
+  } else {
+    // Blocks until a writer opens the FIFO.
+    m_fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (m_fd < 0) {
+      QNN_ERROR("Failed to open input stream %s: %s", path.c_str(), strerror(errno));
+      return StatusCode::FAILURE;
+    }
+    m_ownsFd = true;
+  }
+  growPipe(m_fd);
+  return StatusCode::SUCCESS;
+}
+
+ssize_t framestream::Reader::readFully(uint8_t* buffer, size_t length) {
+  size_t done = 0;
+  while (done < length) {
+    ssize_t n = read(m_fd, buffer + done, length - done);
+    if (n < 0) {
+      if (EINTR == errno) {
+        continue;
+      }
+      QNN_ERROR("Failed to read input stream: %s", strerror(errno));
+      return -1;
+    }
+    if (0 == n) {
+      break;
+    }
+    done += static_cast<size_t>(n);
+  }
+  return static_cast<ssize_t>(done);
+}
+
+framestream::StatusCode framestream::Reader::readFrame(uint8_t* buffer, size_t length) {
+  bool started = false;
+  if (Framing::LENGTH_PREFIXED == m_framing) {
+    uint32_t frameLength = 0;
+    ssize_t n = readFully(reinterpret_cast<uint8_t*>(&frameLength), sizeof(frameLength));
+    if (n < 0) {
+      return StatusCode::FAILURE;
+    }
+    if (0 == n) {
+      return StatusCode::END_OF_STREAM;
+    }
+    if (static_cast<size_t>(n) < sizeof(frameLength)) {
+      QNN_ERROR("Input stream ended inside a frame header");
+      return StatusCode::FAILURE;
+    }
+    if (frameLength != length) {
+      QNN_ERROR("Input frame of %u bytes, expected %zu", frameLength, length);
+      return StatusCode::FAILURE;
+    }
+    started = true;
+  }
+  ssize_t n = readFully(buffer, length);
+  if (n < 0) {
+    return StatusCode::FAILURE;
+  }
+  if (0 == n && !started && length > 0) {
+    return StatusCode::END_OF_STREAM;
+  }
+  if (static_cast<size_t>(n) < length) {
+    QNN_ERROR("Input stream ended inside a frame: %zd of %zu bytes", n, length);
+    return StatusCode::FAILURE;
+  }
+  return StatusCode::SUCCESS;
+}
+
+framestream::Writer::~Writer() {
+  if (m_fd >= 0) {
+    close(m_fd);
+  }
+}
+
+framestream::StatusCode framestream::Writer::open(const std::string& path, Framing framing) {
+  m_framing = framing;
+  if (path == g_standardStream) {
+    // Queued log messages must not end up in the frame stream either.
+    log::flushLogging();
+    fflush(stdout);
+    m_fd = dup(STDOUT_FILENO);
+    if (m_fd < 0 || dup2(STDERR_FILENO, STDOUT_FILENO) < 0) {
+      QNN_ERROR("Failed to set up output stream on stdout: %s", strerror(errno));
+      return StatusCode::FAILURE;
+    }
+  } else {
+    // Blocks until a reader opens the FIFO. O_TRUNC drops the frames of an
+    // earlier run from a regular file and has no effect on FIFOs.
+    m_fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (m_fd < 0) {
+      QNN_ERROR("Failed to open output stream %s: %s", path.c_str(), strerror(errno));
+      return StatusCode::FAILURE;
+    }
+  }
+  // A consumer going away should fail the next write rather than kill the
+  // process.
+  signal(SIGPIPE, SIG_IGN);
+  growPipe(m_fd);
+  return StatusCode::SUCCESS;
+}
+
+framestream::StatusCode framestream::Writer::writeFrame(const uint8_t* data, size_t length) {
+  uint32_t frameLength = static_cast<uint32_t>(length);
+  struct iovec iov[2];
+  int iovCount = 0;
+  if (Framing::LENGTH_PREFIXED == m_framing) {
+    if (length > UINT32_MAX) {
+      QNN_ERROR("Output frame of %zu bytes does not fit a length prefix", length);
+      return StatusCode::FAILURE;
+    }
+    iov[iovCount].iov_base = &frameLength;
+    iov[iovCount].iov_len  = sizeof(frameLength);
+    iovCount++;
+  }
+  iov[iovCount].iov_base = const_cast<uint8_t*>(data);
+  iov[iovCount].iov_len  = length;
+  iovCount++;
+  // Header and payload go out in one call; resume after short writes.
+  struct iovec* pending = iov;
+  while (iovCount > 0) {
+    ssize_t n = writev(m_fd, pending, iovCount);
+    if (n < 0) {
+      if (EINTR == errno) {
+        continue;
+      }
+      QNN_ERROR("Failed to write output stream: %s", strerror(errno));
+      return StatusCode::FAILURE;
+    }
+    size_t written = static_cast<size_t>(n);
+    while (iovCount > 0 && written >= pending->iov_len) {
+      written -= pending->iov_len;
+      pending++;
+      iovCount--;
+    }
+    if (iovCount > 0) {
+      pending->iov_base = static_cast<uint8_t*>(pending->iov_base) + written;
+      pending->iov_len -= written;
+    }
+  }
+  return StatusCode::SUCCESS;
+}
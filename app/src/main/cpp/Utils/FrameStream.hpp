@@ -0,0 +1,93 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+#pragma once
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <string>
+
+namespace qnn {
+namespace tools {
+namespace framestream {
+
+enum class StatusCode {
+  SUCCESS,
+  END_OF_STREAM,
+  FAILURE,
+};
+
+// LENGTH_PREFIXED frames start with the payload length as a uint32_t in host
+// byte order, which is checked against the tensor size. FIXED_SIZE frames are
+// bare payloads of exactly the tensor size.
+enum class Framing { LENGTH_PREFIXED, FIXED_SIZE, INVALID };
+
+Framing parseFraming(std::string framingString);
+
+// Path of the standard input or output stream.
+extern const std::string g_standardStream;
+
+/*
+ * Reads tensor frames from stdin or a FIFO. Frames are read straight into
+ * the destination buffer with no intermediate copy.
+ */
+class Reader {
+ public:
+  Reader() = default;
+
+  ~Reader();
+
+  Reader(const Reader &) = delete;
+  Reader &operator=(const Reader &) = delete;
+
+  // path is a FIFO, a regular file or "-" for stdin.
+  StatusCode open(const std::string &path, Framing framing);
+
+  // Reads one frame of exactly length bytes into buffer. Returns
+  // END_OF_STREAM if the stream ended cleanly before the frame, FAILURE on a
+  // truncated or mis-sized frame.
+  StatusCode readFrame(uint8_t *buffer, size_t length);
+
+ private:
+  // Reads up to length bytes, fewer only at the end of the stream.
+  ssize_t readFully(uint8_t *buffer, size_t length);
+
+  int m_fd          = -1;
+  bool m_ownsFd     = false;
+  Framing m_framing = Framing::LENGTH_PREFIXED;
+};
+
+/*
+ * Writes tensor frames to stdout or a FIFO, using the same framing as
+ * Reader. Frames are written unbuffered so a consumer sees each result as
+ * soon as it is produced.
+ */
+class Writer {
+ public:
+  Writer() = default;
+
+  ~Writer();
+
+  Writer(const Writer &) = delete;
+  Writer &operator=(const Writer &) = delete;
+
+  // path is a FIFO, a regular file or "-" for stdout. When writing to stdout,
+  // stdout is redirected to stderr afterwards so log messages cannot end up
+  // in the frame stream.
+  StatusCode open(const std::string &path, Framing framing);
+
+  StatusCode writeFrame(const uint8_t *data, size_t length);
+
+ private:
+  int m_fd          = -1;
+  Framing m_framing = Framing::LENGTH_PREFIXED;
+};
+
+}  // namespace framestream
+}  // namespace tools
+}  // namespace qnn
@@ -0,0 +1,120 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+#include <cstring>
+
+#include "HashUtil.hpp"
+
+using namespace qnn;
+using namespace qnn::tools;
+
+namespace {
+
+const uint64_t g_prime1 = 11400714785074694791ULL;
+const uint64_t g_prime2 = 14029467366897019727ULL;
+const uint64_t g_prime3 = 1609587929392839161ULL;
+const uint64_t g_prime4 = 9650029242287828579ULL;
+const uint64_t g_prime5 = 2870177450012600261ULL;
+
+// Seed of the second lane of xxh64x2.
+const uint64_t g_secondSeed = 0x9E3779B97F4A7C15ULL;
+
+inline uint64_t rotateLeft(uint64_t value, int bits) {
+  return (value << bits) | (value >> (64 - bits));
+}
+
+// Unaligned little endian loads; memcpy compiles to a single load.
+inline uint64_t read64(const uint8_t *data) {
+  uint64_t value;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+inline uint32_t read32(const uint8_t *data) {
+  uint32_t value;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+inline uint64_t round(uint64_t accumulator, uint64_t input) {
+  accumulator += input * g_prime2;
+  accumulator = rotateLeft(accumulator, 31);
+  return accumulator * g_prime1;
+}
+
+inline uint64_t mergeRound(uint64_t hash, uint64_t accumulator) {
+  hash ^= round(0, accumulator);
+  return hash * g_prime1 + g_prime4;
+}
+
+}  // namespace
+
+uint64_t hashutil::xxh64(const void *data, size_t length, uint64_t seed) {
+  const uint8_t *cursor = static_cast<const uint8_t *>(data);
+  const uint8_t *end    = cursor + length;
+  uint64_t hash;
+  if (length >= 32) {
+    uint64_t v1               = seed + g_prime1 + g_prime2;
+    uint64_t v2               = seed + g_prime2;
+    uint64_t v3               = seed;
+    uint64_t v4               = seed - g_prime1;
+    const uint8_t *lastStripe = end - 32;
+    do {
+      v1 = round(v1, read64(cursor));
+      v2 = round(v2, read64(cursor + 8));
+      v3 = round(v3, read64(cursor + 16));
+      v4 = round(v4, read64(cursor + 24));
+      cursor += 32;
+    } while (cursor <= lastStripe);
+    hash = rotateLeft(v1, 1) + rotateLeft(v2, 7) + rotateLeft(v3, 12) + rotateLeft(v4, 18);
+    hash = mergeRound(hash, v1);
+    hash = mergeRound(hash, v2);
+    hash = mergeRound(hash, v3);
+    hash = mergeRound(hash, v4);
+  } else {
+    hash = seed + g_prime5;
+  }
+  hash += static_cast<uint64_t>(length);
+  for (; cursor + 8 <= end; cursor += 8) {
+    hash ^= round(0, read64(cursor));
+    hash = rotateLeft(hash, 27) * g_prime1 + g_prime4;
+  }
+  if (cursor + 4 <= end) {
+    hash ^= static_cast<uint64_t>(read32(cursor)) * g_prime1;
+    hash = rotateLeft(hash, 23) * g_prime2 + g_prime3;
+    cursor += 4;
+  }
+  for (; cursor < end; cursor++) {
+    hash ^= (*cursor) * g_prime5;
+    hash = rotateLeft(hash, 11) * g_prime1;
+  }
+  hash ^= hash >> 33;
+  hash *= g_prime2;
+  hash ^= hash >> 29;
+  hash *= g_prime3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+hashutil::Hash128 hashutil::xxh64x2(const void *data, size_t length) {
+  Hash128 hash;
+  hash.high = xxh64(data, length, g_secondSeed);
+  hash.low  = xxh64(data, length, 0);
+  return hash;
+}
+
+std::string hashutil::toHex(uint64_t hash) {
+  static const char s_digits[] = "0123456789abcdef";
+  std::string hex(16, '0');
+  for (int idx = 15; idx >= 0; idx--) {
+    hex[idx] = s_digits[hash & 0xF];
+    hash >>= 4;
+  }
+  return hex;
+}
+
+std::string hashutil::toHex(const Hash128 &hash) { return toHex(hash.high) + toHex(hash.low); }
@@ -0,0 +1,43 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+namespace qnn {
+namespace tools {
+namespace hashutil {
+
+struct Hash128 {
+  uint64_t high;
+  uint64_t low;
+};
+
+/*
+ * XXH64, bit compatible with the reference xxHash implementation. Input is
+ * consumed in 32 byte stripes by four independent accumulators, which keeps
+ * the multipliers of consecutive lanes in flight together.
+ */
+uint64_t xxh64(const void *data, size_t length, uint64_t seed = 0);
+
+// 128-bit digest made of two XXH64 lanes with different seeds. Not the XXH128
+// algorithm, but it makes accidental collisions across millions of outputs
+// practically impossible.
+Hash128 xxh64x2(const void *data, size_t length);
+
+// Lower case hex, 16 digits per 64 bits.
+std::string toHex(uint64_t hash);
+
+std::string toHex(const Hash128 &hash);
+
+}  // namespace hashutil
+}  // namespace tools
+}  // namespace qnn
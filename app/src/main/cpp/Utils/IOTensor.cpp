@@ -5,6 +5,8 @@
 //  Confidential and Proprietary - Qualcomm Technologies, Inc.
 //
 //==============================================================================
+#include <unistd.h>
+
 #include <algorithm>
 #include <cstring>
 #include <fstream>
@@ -15,6 +17,160 @@
 using namespace qnn;
 using namespace qnn::tools;
 
+namespace {
+
+metrics::Counter& g_inputBytes = metrics::getRegistry().addCounter(
+    "qnn_input_bytes_total",
+    "Bytes loaded into input tensors from files, mappings, datasets or streams.");
+metrics::Counter& g_outputBytes = metrics::getRegistry().addCounter(
+    "qnn_output_bytes_total", "Bytes of output written to files, containers or streams.");
+metrics::Histogram& g_inputConversionSeconds = metrics::getRegistry().addLatencyHistogram(
+    "qnn_input_conversion_seconds", "Time spent quantizing a float input into a tensor.");
+metrics::Histogram& g_outputConversionSeconds = metrics::getRegistry().addLatencyHistogram(
+    "qnn_output_conversion_seconds", "Time spent converting an output tensor to float.");
+
+// Elements per index of the quantization axis of a per axis encoded tensor.
+// Returns false if the encoding does not match the tensor's shape.
+bool getAxisInnerSize(const Qnn_AxisScaleOffset_t& encoding,
+                      const std::vector<size_t>& dims,
+                      size_t& innerSize) {
+  if (encoding.axis < 0 || static_cast<size_t>(encoding.axis) >= dims.size() ||
+      nullptr == encoding.scaleOffset || encoding.numScaleOffsets != dims[encoding.axis]) {
+    return false;
+  }
+  innerSize = 1;
+  for (size_t idx = static_cast<size_t>(encoding.axis) + 1; idx < dims.size(); idx++) {
+    innerSize *= dims[idx];
+  }
+  return true;
+}
+
+// Quantizes into a fixed point tensor with its per tensor or per axis
+// encoding.
+template <typename T_QuantType>
+datautil::StatusCode quantize(Qnn_Tensor_t* tensor,
+                              float* in,
+                              const std::vector<size_t>& dims) {
+  T_QuantType* out    = static_cast<T_QuantType*>(QNN_TENSOR_GET_CLIENT_BUF(tensor).data);
+  size_t elementCount = datautil::calculateElementCount(dims);
+  Qnn_QuantizeParams_t qParams = QNN_TENSOR_GET_QUANT_PARAMS(tensor);
+  if (QNN_QUANTIZATION_ENCODING_AXIS_SCALE_OFFSET != qParams.quantizationEncoding) {
+    return datautil::floatToTfN<T_QuantType>(out,
+                                             in,
+                                             qParams.scaleOffsetEncoding.offset,
+                                             qParams.scaleOffsetEncoding.scale,
+                                             elementCount);
+  }
+  size_t innerSize{0};
+  if (!getAxisInnerSize(qParams.axisScaleOffsetEncoding, dims, innerSize)) {
+    QNN_ERROR("Per axis encoding of %s does not match its shape", QNN_TENSOR_GET_NAME(tensor));
+    return datautil::StatusCode::INVALID_DIMENSIONS;
+  }
+  return datautil::floatToTfNPerAxis<T_QuantType>(
+      out,
+      in,
+      qParams.axisScaleOffsetEncoding.scaleOffset,
+      qParams.axisScaleOffsetEncoding.numScaleOffsets,
+      innerSize,
+      elementCount);
+}
+
+// Dequantizes a fixed point tensor with its per tensor or per axis encoding.
+template <typename T_QuantType>
+datautil::StatusCode dequantize(float* out,
+                                Qnn_Tensor_t* tensor,
+                                const std::vector<size_t>& dims) {
+  T_QuantType* in     = static_cast<T_QuantType*>(QNN_TENSOR_GET_CLIENT_BUF(tensor).data);
+  size_t elementCount = datautil::calculateElementCount(dims);
+  Qnn_QuantizeParams_t qParams = QNN_TENSOR_GET_QUANT_PARAMS(tensor);
+  if (QNN_QUANTIZATION_ENCODING_AXIS_SCALE_OFFSET != qParams.quantizationEncoding) {
+    return datautil::tfNToFloat<T_QuantType>(out,
+                                             in,
+                                             qParams.scaleOffsetEncoding.offset,
+                                             qParams.scaleOffsetEncoding.scale,
+                                             elementCount);
+  }
+  size_t innerSize{0};
+  if (!getAxisInnerSize(qParams.axisScaleOffsetEncoding, dims, innerSize)) {
+    QNN_ERROR("Per axis encoding of %s does not match its shape", QNN_TENSOR_GET_NAME(tensor));
+    return datautil::StatusCode::INVALID_DIMENSIONS;
+  }
+  return datautil::tfNToFloatPerAxis<T_QuantType>(
+      out,
+      in,
+      qParams.axisScaleOffsetEncoding.scaleOffset,
+      qParams.axisScaleOffsetEncoding.numScaleOffsets,
+      innerSize,
+      elementCount);
+}
+
+// The records of one tensor of a dataset, from recordCursor on, copied
+// straight from the container mapping.
+class DatasetSource : public datautil::BatchSource {
+ public:
+  DatasetSource(const packedcontainer::Reader& dataset,
+                uint32_t datasetTensorIdx,
+                size_t& recordCursor)
+      : m_dataset(dataset),
+        m_records(dataset.getTensorRecords(datasetTensorIdx)),
+        m_recordCursor(recordCursor) {}
+
+  bool hasNext() const override { return m_recordCursor < m_records.size(); }
+
+  std::string getName() const override {
+    return "dataset record " + std::to_string(m_records[m_recordCursor]);
+  }
+
+  datautil::StatusCode getLength(size_t& length) override {
+    length = static_cast<size_t>(m_dataset.getRecord(m_records[m_recordCursor]).length);
+    return datautil::StatusCode::SUCCESS;
+  }
+
+  datautil::StatusCode read(uint8_t* buffer) override {
+    uint64_t recordIdx = m_records[m_recordCursor];
+    memcpy(buffer,
+           m_dataset.getRecordData(recordIdx),
+           static_cast<size_t>(m_dataset.getRecord(recordIdx).length));
+    m_recordCursor += 1;
+    return datautil::StatusCode::SUCCESS;
+  }
+
+ private:
+  const packedcontainer::Reader& m_dataset;
+  const std::vector<uint64_t>& m_records;
+  size_t& m_recordCursor;
+};
+
+}  // namespace
+
+// Helper method to read one batch of files, with O_DIRECT or ahead of time
+// through the I/O engine if set.
+datautil::ReadBatchDataRetType_t iotensor::IOTensor::readBatchData(
+    std::queue<std::string>& filePaths,
+    std::vector<size_t> dims,
+    Qnn_DataType_t dataType,
+    uint8_t* buffer) {
+  flightrecorder::Scope traceScope(m_flightRecorder.get(), flightrecorder::Phase::READ_INPUT);
+  perfcounters::Scope perfScope(perfcounters::Stage::READ);
+  datautil::ReadBatchDataRetType_t result;
+  if (nullptr != m_directReader) {
+    result = datautil::readBatchDataAndUpdateQueue(
+        filePaths, dims, dataType, buffer, *m_directReader);
+  } else if (nullptr != m_asyncInputReader) {
+    result = datautil::readBatchDataAndUpdateQueue(
+        filePaths, dims, dataType, buffer, *m_asyncInputReader);
+  } else {
+    result = datautil::readBatchDataAndUpdateQueue(
+        filePaths, dims, dataType, buffer, &m_inputFileCache);
+  }
+  if (datautil::StatusCode::SUCCESS == std::get<0>(result)) {
+    size_t length = std::get<1>(datautil::calculateLength(dims, dataType));
+    g_inputBytes.add(length);
+    perfScope.addBytes(length);
+  }
+  return result;
+}
+
 // Helper method to read data from files to a buffer.
 iotensor::StatusCode iotensor::IOTensor::readDataAndAllocateBuffer(
     std::queue<std::string>& filePaths,
@@ -23,11 +179,11 @@ iotensor::StatusCode iotensor::IOTensor::readDataAndAllocateBuffer(
     uint8_t** bufferToCopy) {
   StatusCode returnStatus = StatusCode::SUCCESS;
   *bufferToCopy           = nullptr;
-  returnStatus            = allocateBuffer(bufferToCopy, dims, dataType);
+  returnStatus = allocateBuffer(bufferToCopy, dims, dataType, memaccount::Category::SCRATCH);
   if (StatusCode::SUCCESS == returnStatus) {
     datautil::StatusCode status;
-    std::tie(status, m_numFilesPopulated, m_batchSize) = datautil::readBatchDataAndUpdateQueue(
-        filePaths, dims, dataType, reinterpret_cast<uint8_t*>(*bufferToCopy));
+    std::tie(status, m_numFilesPopulated, m_batchSize) =
+        readBatchData(filePaths, dims, dataType, reinterpret_cast<uint8_t*>(*bufferToCopy));
     if (datautil::StatusCode::SUCCESS != status) {
       QNN_DEBUG("Failure in datautil::readBatchDataAndUpdateQueue");
       returnStatus = StatusCode::FAILURE;
@@ -35,7 +191,7 @@ iotensor::StatusCode iotensor::IOTensor::readDataAndAllocateBuffer(
   }
   if (StatusCode::SUCCESS != returnStatus) {
     if (nullptr != *bufferToCopy) {
-      free(*bufferToCopy);
+      memaccount::getAccountant().release(*bufferToCopy);
       *bufferToCopy = nullptr;
     }
   }
@@ -50,26 +206,28 @@ iotensor::StatusCode iotensor::IOTensor::copyFromFloatToNative(float* floatBuffe
     QNN_ERROR("copyFromFloatToNative(): received a nullptr");
     return StatusCode::FAILURE;
   }
+  metrics::ScopedTimer conversionTimer(g_inputConversionSeconds);
+  flightrecorder::Scope traceScope(m_flightRecorder.get(), flightrecorder::Phase::CONVERT_INPUT);
 
   StatusCode returnStatus = StatusCode::SUCCESS;
   std::vector<size_t> dims;
   fillDims(dims, QNN_TENSOR_GET_DIMENSIONS(tensor), QNN_TENSOR_GET_RANK(tensor));
+  perfcounters::Scope perfScope(perfcounters::Stage::QUANTIZE,
+                                datautil::calculateElementCount(dims) * sizeof(float));
 
   switch (QNN_TENSOR_GET_DATA_TYPE(tensor)) {
     case QNN_DATATYPE_UFIXED_POINT_8:
-      datautil::floatToTfN<uint8_t>(static_cast<uint8_t*>(QNN_TENSOR_GET_CLIENT_BUF(tensor).data),
-                                    floatBuffer,
-                                    QNN_TENSOR_GET_QUANT_PARAMS(tensor).scaleOffsetEncoding.offset,
-                                    QNN_TENSOR_GET_QUANT_PARAMS(tensor).scaleOffsetEncoding.scale,
-                                    datautil::calculateElementCount(dims));
+      if (datautil::StatusCode::SUCCESS != quantize<uint8_t>(tensor, floatBuffer, dims)) {
+        QNN_ERROR("failure in floatToTfN<uint8_t>");
+        returnStatus = StatusCode::FAILURE;
+      }
       break;
 
     case QNN_DATATYPE_UFIXED_POINT_16:
-      datautil::floatToTfN<uint16_t>(static_cast<uint16_t*>(QNN_TENSOR_GET_CLIENT_BUF(tensor).data),
-                                     floatBuffer,
-                                     QNN_TENSOR_GET_QUANT_PARAMS(tensor).scaleOffsetEncoding.offset,
-                                     QNN_TENSOR_GET_QUANT_PARAMS(tensor).scaleOffsetEncoding.scale,
-                                     datautil::calculateElementCount(dims));
+      if (datautil::StatusCode::SUCCESS != quantize<uint16_t>(tensor, floatBuffer, dims)) {
+        QNN_ERROR("failure in floatToTfN<uint16_t>");
+        returnStatus = StatusCode::FAILURE;
+      }
       break;
 
     case QNN_DATATYPE_UINT_8:
@@ -174,6 +332,7 @@ iotensor::StatusCode iotensor::IOTensor::populateInputTensor(
 
   if (inputDataType == InputDataType::FLOAT &&
       QNN_TENSOR_GET_DATA_TYPE(input) != QNN_DATATYPE_FLOAT_32) {
+    releaseMappedTensor(input);
     uint8_t* fileToBuffer = nullptr;
     returnStatus = readDataAndAllocateBuffer(filePaths, dims, QNN_DATATYPE_FLOAT_32, &fileToBuffer);
     if (StatusCode::SUCCESS == returnStatus) {
@@ -181,16 +340,24 @@ iotensor::StatusCode iotensor::IOTensor::populateInputTensor(
       returnStatus = copyFromFloatToNative(reinterpret_cast<float*>(fileToBuffer), input);
     }
     if (nullptr != fileToBuffer) {
-      free(fileToBuffer);
+      memaccount::getAccountant().release(fileToBuffer);
       fileToBuffer = nullptr;
     }
   } else {
+    if (InputMapping::NONE != m_inputMapping) {
+      bool mapped  = false;
+      returnStatus = mapInputTensor(filePaths, input, dims, mapped);
+      if (mapped || StatusCode::SUCCESS != returnStatus) {
+        return returnStatus;
+      }
+      releaseMappedTensor(input);
+    }
     datautil::StatusCode status;
-    std::tie(status, m_numFilesPopulated, m_batchSize) = datautil::readBatchDataAndUpdateQueue(
-        filePaths,
-        dims,
-        QNN_TENSOR_GET_DATA_TYPE(input),
-        static_cast<uint8_t*>(QNN_TENSOR_GET_CLIENT_BUF(input).data));
+    std::tie(status, m_numFilesPopulated, m_batchSize) =
+        readBatchData(filePaths,
+                      dims,
+                      QNN_TENSOR_GET_DATA_TYPE(input),
+                      static_cast<uint8_t*>(QNN_TENSOR_GET_CLIENT_BUF(input).data));
     if (datautil::StatusCode::SUCCESS != status) {
       QNN_DEBUG("Failure in datautil::readBatchDataAndUpdateQueue");
       returnStatus = StatusCode::FAILURE;
@@ -199,6 +366,80 @@ iotensor::StatusCode iotensor::IOTensor::populateInputTensor(
   return returnStatus;
 }
 
+// Helper method to point an input tensor at a mapping of its input file
+// instead of copying the file. mapped is left false when the batch or size
+// rules do not allow direct binding, in which case nothing is consumed.
+iotensor::StatusCode iotensor::IOTensor::mapInputTensor(std::queue<std::string>& filePaths,
+                                                        Qnn_Tensor_t* input,
+                                                        std::vector<size_t> dims,
+                                                        bool& mapped) {
+  mapped = false;
+  pal::MappedFile::Advice advice = pal::MappedFile::Advice::NORMAL;
+  switch (m_inputMapping) {
+    case InputMapping::SEQUENTIAL:
+      advice = pal::MappedFile::Advice::SEQUENTIAL;
+      break;
+    case InputMapping::RANDOM:
+      advice = pal::MappedFile::Advice::RANDOM;
+      break;
+    case InputMapping::WILLNEED:
+      advice = pal::MappedFile::Advice::WILLNEED;
+      break;
+    default:
+      break;
+  }
+  pal::MappedFile mappedFile;
+  datautil::StatusCode status;
+  size_t numFilesMapped{0};
+  size_t batchSize{0};
+  std::tie(status, numFilesMapped, batchSize) = datautil::mapDataAndUpdateQueue(
+      filePaths, dims, QNN_TENSOR_GET_DATA_TYPE(input), advice, mappedFile);
+  if (datautil::StatusCode::SUCCESS != status) {
+    QNN_DEBUG("Failure in datautil::mapDataAndUpdateQueue");
+    return StatusCode::FAILURE;
+  }
+  if (0 == numFilesMapped) {
+    return StatusCode::SUCCESS;
+  }
+  uint8_t* data = mappedFile.data();
+  g_inputBytes.add(mappedFile.size());
+  bindTensor(input, data, std::move(mappedFile));
+  m_numFilesPopulated = numFilesMapped;
+  m_batchSize         = batchSize;
+  mapped              = true;
+  return StatusCode::SUCCESS;
+}
+
+// Helper method to point a tensor's client buffer at data owned by someone
+// else. mappedFile, if open, is kept alive until the tensor is rebound or
+// released; replacing it unmaps the previous sample's file.
+void iotensor::IOTensor::bindTensor(Qnn_Tensor_t* tensor,
+                                    void* data,
+                                    pal::MappedFile mappedFile) {
+  auto mappedTensor = m_mappedTensors.find(tensor);
+  if (mappedTensor == m_mappedTensors.end()) {
+    mappedTensor = m_mappedTensors.insert(std::make_pair(tensor, MappedTensor())).first;
+    mappedTensor->second.ownedData = QNN_TENSOR_GET_CLIENT_BUF(tensor).data;
+  }
+  mappedTensor->second.mappedFile = std::move(mappedFile);
+  Qnn_ClientBuffer_t clientBuffer = QNN_TENSOR_GET_CLIENT_BUF(tensor);
+  clientBuffer.data               = data;
+  QNN_TENSOR_SET_CLIENT_BUF(tensor, clientBuffer);
+}
+
+// Helper method to detach a tensor from its file mapping, if any, and point
+// it back at the buffer allocated during setup.
+void iotensor::IOTensor::releaseMappedTensor(Qnn_Tensor_t* tensor) {
+  auto mappedTensor = m_mappedTensors.find(tensor);
+  if (mappedTensor == m_mappedTensors.end()) {
+    return;
+  }
+  Qnn_ClientBuffer_t clientBuffer = QNN_TENSOR_GET_CLIENT_BUF(tensor);
+  clientBuffer.data               = mappedTensor->second.ownedData;
+  QNN_TENSOR_SET_CLIENT_BUF(tensor, clientBuffer);
+  m_mappedTensors.erase(mappedTensor);
+}
+
 // Helper method to populate all input tensors during execution.
 iotensor::StatusCode iotensor::IOTensor::populateInputTensors(
     uint32_t graphIdx,
@@ -223,6 +464,8 @@ iotensor::StatusCode iotensor::IOTensor::populateInputTensors(
   }
 
   for (size_t inputIdx = 0; inputIdx < inputCount; inputIdx++) {
+    flightrecorder::Scope traceScope(
+        m_flightRecorder.get(), flightrecorder::Phase::POPULATE_INPUT, inputIdx);
     if (StatusCode::SUCCESS !=
         populateInputTensor(filePathsQueue[inputIdx], &(inputs[inputIdx]), inputDataType)) {
       QNN_DEBUG("populateInputTensor() failure for input: %d", inputIdx);
@@ -232,6 +475,157 @@ iotensor::StatusCode iotensor::IOTensor::populateInputTensors(
   return StatusCode::SUCCESS;
 }
 
+// Helper method to fill a buffer from consecutive dataset records, following
+// the same batch, size and padding rules as readBatchDataAndUpdateQueue, by
+// way of datautil::fillBatch().
+iotensor::StatusCode iotensor::IOTensor::readBatchDataFromDataset(
+    const packedcontainer::Reader& dataset,
+    uint32_t datasetTensorIdx,
+    size_t& recordCursor,
+    std::vector<size_t> dims,
+    Qnn_DataType_t dataType,
+    uint8_t* buffer) {
+  if (nullptr == buffer) {
+    QNN_ERROR("buffer is nullptr");
+    return StatusCode::FAILURE;
+  }
+  flightrecorder::Scope traceScope(m_flightRecorder.get(), flightrecorder::Phase::READ_INPUT);
+  perfcounters::Scope perfScope(perfcounters::Stage::READ);
+  datautil::StatusCode err{datautil::StatusCode::SUCCESS};
+  size_t l{0};
+  std::tie(err, l) = datautil::calculateLength(dims, dataType);
+  if (datautil::StatusCode::SUCCESS != err) {
+    return StatusCode::FAILURE;
+  }
+  perfScope.addBytes(l);
+  DatasetSource source(dataset, datasetTensorIdx, recordCursor);
+  size_t numInputsCopied = 0;
+  size_t numBatchSize    = 0;
+  std::tie(err, numInputsCopied, numBatchSize) = datautil::fillBatch(source, l, buffer);
+  if (datautil::StatusCode::SUCCESS != err) {
+    return StatusCode::FAILURE;
+  }
+  g_inputBytes.add(l);
+  m_numFilesPopulated = numInputsCopied;
+  m_batchSize         = numBatchSize;
+  return StatusCode::SUCCESS;
+}
+
+// Helper method to populate an input tensor from a packed dataset. Records
+// are read straight from the container mapping, so no file is opened per
+// sample. With input mapping enabled, a record holding exactly one native
+// tensor is bound in place instead of being copied.
+iotensor::StatusCode iotensor::IOTensor::populateInputTensor(
+    const packedcontainer::Reader& dataset,
+    uint32_t datasetTensorIdx,
+    size_t& recordCursor,
+    Qnn_Tensor_t* input,
+    iotensor::InputDataType inputDataType) {
+  if (nullptr == input) {
+    QNN_ERROR("input is nullptr");
+    return StatusCode::FAILURE;
+  }
+  auto returnStatus = StatusCode::SUCCESS;
+  std::vector<size_t> dims;
+  fillDims(dims, QNN_TENSOR_GET_DIMENSIONS(input), QNN_TENSOR_GET_RANK(input));
+
+  if (inputDataType == InputDataType::FLOAT &&
+      QNN_TENSOR_GET_DATA_TYPE(input) != QNN_DATATYPE_FLOAT_32) {
+    releaseMappedTensor(input);
+    uint8_t* fileToBuffer = nullptr;
+    returnStatus          = allocateBuffer(
+        &fileToBuffer, dims, QNN_DATATYPE_FLOAT_32, memaccount::Category::SCRATCH);
+    if (StatusCode::SUCCESS == returnStatus) {
+      returnStatus = readBatchDataFromDataset(
+          dataset, datasetTensorIdx, recordCursor, dims, QNN_DATATYPE_FLOAT_32, fileToBuffer);
+    }
+    if (StatusCode::SUCCESS == returnStatus) {
+      returnStatus = copyFromFloatToNative(reinterpret_cast<float*>(fileToBuffer), input);
+    }
+    if (nullptr != fileToBuffer) {
+      memaccount::getAccountant().release(fileToBuffer);
+      fileToBuffer = nullptr;
+    }
+    return returnStatus;
+  }
+
+  const std::vector<uint64_t>& records = dataset.getTensorRecords(datasetTensorIdx);
+  if (InputMapping::NONE != m_inputMapping && recordCursor < records.size()) {
+    size_t length{0};
+    size_t elementSize{0};
+    datautil::StatusCode err{datautil::StatusCode::SUCCESS};
+    std::tie(err, length) = datautil::calculateLength(dims, QNN_TENSOR_GET_DATA_TYPE(input));
+    if (datautil::StatusCode::SUCCESS == err) {
+      std::tie(err, elementSize) =
+          datautil::getDataTypeSizeInBytes(QNN_TENSOR_GET_DATA_TYPE(input));
+    }
+    const uint8_t* data = dataset.getRecordData(records[recordCursor]);
+    if (datautil::StatusCode::SUCCESS == err &&
+        dataset.getRecord(records[recordCursor]).length == length &&
+        reinterpret_cast<uintptr_t>(data) % elementSize == 0) {
+      bindTensor(input, const_cast<uint8_t*>(data), pal::MappedFile());
+      g_inputBytes.add(length);
+      recordCursor += 1;
+      m_numFilesPopulated = 1;
+      m_batchSize         = 1;
+      return StatusCode::SUCCESS;
+    }
+  }
+  releaseMappedTensor(input);
+  return readBatchDataFromDataset(dataset,
+                                  datasetTensorIdx,
+                                  recordCursor,
+                                  dims,
+                                  QNN_TENSOR_GET_DATA_TYPE(input),
+                                  static_cast<uint8_t*>(QNN_TENSOR_GET_CLIENT_BUF(input).data));
+}
+
+// Helper method to populate all input tensors from a packed dataset. Graph
+// inputs are matched to container tensors by name, or by position when the
+// container does not carry the graph's tensor names.
+iotensor::StatusCode iotensor::IOTensor::populateInputTensors(
+    uint32_t graphIdx,
+    const packedcontainer::Reader& dataset,
+    std::vector<size_t>& recordCursors,
+    Qnn_Tensor_t* inputs,
+    qnn_wrapper_api::GraphInfo_t graphInfo,
+    iotensor::InputDataType inputDataType) {
+  QNN_DEBUG("populateInputTensors() from dataset, graphIndx %d", graphIdx);
+  if (nullptr == inputs) {
+    QNN_ERROR("inputs is nullptr");
+    return StatusCode::FAILURE;
+  }
+  auto inputCount = graphInfo.numInputTensors;
+  if (dataset.getNumTensors() != inputCount) {
+    QNN_ERROR("Incorrect amount of dataset tensors for graphIdx: %d. Expected: %d, received: %d",
+              graphIdx,
+              inputCount,
+              dataset.getNumTensors());
+    return StatusCode::FAILURE;
+  }
+  recordCursors.resize(dataset.getNumTensors(), 0);
+  for (size_t inputIdx = 0; inputIdx < inputCount; inputIdx++) {
+    flightrecorder::Scope traceScope(
+        m_flightRecorder.get(), flightrecorder::Phase::POPULATE_INPUT, inputIdx);
+    uint32_t datasetTensorIdx = dataset.getNumTensors();
+    if (nullptr != QNN_TENSOR_GET_NAME(inputs[inputIdx])) {
+      datasetTensorIdx = dataset.findTensor(QNN_TENSOR_GET_NAME(inputs[inputIdx]));
+    }
+    if (datasetTensorIdx == dataset.getNumTensors()) {
+      datasetTensorIdx = static_cast<uint32_t>(inputIdx);
+    }
+    if (StatusCode::SUCCESS != populateInputTensor(dataset,
+                                                   datasetTensorIdx,
+                                                   recordCursors[datasetTensorIdx],
+                                                   &(inputs[inputIdx]),
+                                                   inputDataType)) {
+      QNN_DEBUG("populateInputTensor() failure for input: %d", inputIdx);
+      return StatusCode::FAILURE;
+    }
+  }
+  return StatusCode::SUCCESS;
+}
+
 // Helper method to populate an input tensor in the graph during execution.
 // It relies on reading data from buffer provided during executeGraph() call.
 iotensor::StatusCode iotensor::IOTensor::populateInputTensor(
@@ -240,6 +634,7 @@ iotensor::StatusCode iotensor::IOTensor::populateInputTensor(
     QNN_ERROR("input is nullptr");
     return StatusCode::FAILURE;
   }
+  releaseMappedTensor(input);
   std::vector<size_t> dims;
   fillDims(dims, QNN_TENSOR_GET_DIMENSIONS(input), QNN_TENSOR_GET_RANK(input));
   if (inputDataType == InputDataType::FLOAT &&
@@ -263,6 +658,64 @@ iotensor::StatusCode iotensor::IOTensor::populateInputTensor(
   return StatusCode::SUCCESS;
 }
 
+// Helper method to populate all input tensors from a frame stream. Native
+// frames are read straight into the client buffers; float frames for
+// non-float tensors go through a staging buffer and are quantized from there.
+iotensor::StatusCode iotensor::IOTensor::populateInputTensors(
+    uint32_t graphIdx,
+    framestream::Reader& inputStream,
+    Qnn_Tensor_t* inputs,
+    qnn_wrapper_api::GraphInfo_t graphInfo,
+    iotensor::InputDataType inputDataType,
+    bool& endOfStream) {
+  QNN_DEBUG("populateInputTensors() from stream, graphIndx %d", graphIdx);
+  endOfStream = false;
+  if (nullptr == inputs) {
+    QNN_ERROR("inputs is nullptr");
+    return StatusCode::FAILURE;
+  }
+  for (size_t inputIdx = 0; inputIdx < graphInfo.numInputTensors; inputIdx++) {
+    flightrecorder::Scope traceScope(
+        m_flightRecorder.get(), flightrecorder::Phase::POPULATE_INPUT, inputIdx);
+    Qnn_Tensor_t* input = &(inputs[inputIdx]);
+    releaseMappedTensor(input);
+    std::vector<size_t> dims;
+    fillDims(dims, QNN_TENSOR_GET_DIMENSIONS(input), QNN_TENSOR_GET_RANK(input));
+    bool fromFloat = inputDataType == InputDataType::FLOAT &&
+                     QNN_TENSOR_GET_DATA_TYPE(input) != QNN_DATATYPE_FLOAT_32;
+    datautil::StatusCode datautilStatus;
+    size_t length{0};
+    std::tie(datautilStatus, length) = datautil::calculateLength(
+        dims, fromFloat ? QNN_DATATYPE_FLOAT_32 : QNN_TENSOR_GET_DATA_TYPE(input));
+    if (datautil::StatusCode::SUCCESS != datautilStatus) {
+      return StatusCode::FAILURE;
+    }
+    uint8_t* buffer = static_cast<uint8_t*>(QNN_TENSOR_GET_CLIENT_BUF(input).data);
+    if (fromFloat) {
+      m_inputStreamBuffer.resize(length);
+      buffer = m_inputStreamBuffer.data();
+    }
+    framestream::StatusCode streamStatus = inputStream.readFrame(buffer, length);
+    if (framestream::StatusCode::END_OF_STREAM == streamStatus && 0 == inputIdx) {
+      endOfStream = true;
+      return StatusCode::SUCCESS;
+    }
+    if (framestream::StatusCode::SUCCESS != streamStatus) {
+      QNN_ERROR("Failed to read frame for input: %d", inputIdx);
+      return StatusCode::FAILURE;
+    }
+    g_inputBytes.add(length);
+    if (fromFloat &&
+        StatusCode::SUCCESS != copyFromFloatToNative(reinterpret_cast<float*>(buffer), input)) {
+      QNN_DEBUG("copyFromFloatToNative failure");
+      return StatusCode::FAILURE;
+    }
+  }
+  m_numFilesPopulated = 1;
+  m_batchSize         = 1;
+  return StatusCode::SUCCESS;
+}
+
 // Helper method to populate all input tensors.
 iotensor::StatusCode iotensor::IOTensor::populateInputTensors(
     uint32_t graphIdx,
@@ -283,6 +736,8 @@ iotensor::StatusCode iotensor::IOTensor::populateInputTensors(
     return StatusCode::FAILURE;
   }
   for (size_t inputIdx = 0; inputIdx < inputCount; inputIdx++) {
+    flightrecorder::Scope traceScope(
+        m_flightRecorder.get(), flightrecorder::Phase::POPULATE_INPUT, inputIdx);
     if (StatusCode::SUCCESS !=
         populateInputTensor(inputBuffers[inputIdx], &(inputs[inputIdx]), inputDataType)) {
       QNN_DEBUG("populateInputTensor() failure for input: %d", inputIdx);
@@ -490,11 +945,32 @@ bool iotensor::IOTensor::copyMetadataToGraphsInfo(const QnnSystemContext_BinaryI
   return true;
 }
 
+// deepCopyQnnTensorInfo also copies graph infos, which qnn_wrapper_api frees
+// with free(), so only tensors set up here are accounted.
+void iotensor::IOTensor::trackTensorInfo(Qnn_Tensor_t* tensor) {
+  memaccount::Accountant& accountant = memaccount::getAccountant();
+  const char* tensorName             = QNN_TENSOR_GET_NAME(tensor);
+  if (nullptr != tensorName) {
+    accountant.track(
+        const_cast<char*>(tensorName), strlen(tensorName) + 1, memaccount::Category::METADATA);
+  }
+  accountant.track(QNN_TENSOR_GET_DIMENSIONS(tensor),
+                   QNN_TENSOR_GET_RANK(tensor) * sizeof(uint32_t),
+                   memaccount::Category::METADATA);
+  Qnn_QuantizeParams_t qParams = QNN_TENSOR_GET_QUANT_PARAMS(tensor);
+  if (QNN_QUANTIZATION_ENCODING_AXIS_SCALE_OFFSET == qParams.quantizationEncoding) {
+    accountant.track(qParams.axisScaleOffsetEncoding.scaleOffset,
+                     qParams.axisScaleOffsetEncoding.numScaleOffsets * sizeof(Qnn_ScaleOffset_t),
+                     memaccount::Category::METADATA);
+  }
+}
+
 // Setup details for Qnn_Tensor_t for execution
 // based on information in Qnn_TensorWrapper_t provided by model.so.
 iotensor::StatusCode iotensor::IOTensor::setupTensors(Qnn_Tensor_t** tensors,
                                                       uint32_t tensorCount,
-                                                      Qnn_Tensor_t* tensorWrappers) {
+                                                      Qnn_Tensor_t* tensorWrappers,
+                                                      memaccount::Category category) {
   if (nullptr == tensorWrappers) {
     QNN_ERROR("tensorWrappers is nullptr");
     return StatusCode::FAILURE;
@@ -504,7 +980,8 @@ iotensor::StatusCode iotensor::IOTensor::setupTensors(Qnn_Tensor_t** tensors,
     return StatusCode::SUCCESS;
   }
   auto returnStatus = StatusCode::SUCCESS;
-  *tensors          = (Qnn_Tensor_t*)calloc(1, tensorCount * sizeof(Qnn_Tensor_t));
+  *tensors          = static_cast<Qnn_Tensor_t*>(memaccount::getAccountant().allocateZeroed(
+      tensorCount * sizeof(Qnn_Tensor_t), memaccount::Category::METADATA));
   if (nullptr == *tensors) {
     QNN_ERROR("mem alloc failed for *tensors");
     returnStatus = StatusCode::FAILURE;
@@ -524,12 +1001,14 @@ iotensor::StatusCode iotensor::IOTensor::setupTensors(Qnn_Tensor_t** tensors,
     }
     if (StatusCode::SUCCESS == returnStatus) {
       QNN_DEBUG("deepCopyQnnTensorInfo successful");
+      trackTensorInfo((*tensors) + tensorIdx);
       QNN_TENSOR_SET_MEM_TYPE(((*tensors) + tensorIdx), QNN_TENSORMEMTYPE_RAW);
     }
     Qnn_ClientBuffer_t clientBuffer = QNN_CLIENT_BUFFER_INIT;
     returnStatus = allocateBuffer(reinterpret_cast<uint8_t**>(&clientBuffer.data),
                                   dims,
-                                  QNN_TENSOR_GET_DATA_TYPE((*tensors) + tensorIdx));
+                                  QNN_TENSOR_GET_DATA_TYPE((*tensors) + tensorIdx),
+                                  category);
     datautil::StatusCode datautilStatus{datautil::StatusCode::SUCCESS};
     size_t length{0};
     std::tie(datautilStatus, length) =
@@ -542,7 +1021,7 @@ iotensor::StatusCode iotensor::IOTensor::setupTensors(Qnn_Tensor_t** tensors,
     if (StatusCode::SUCCESS != returnStatus) {
       QNN_ERROR("Failure in setupTensors, cleaning up resources");
       if (nullptr != (QNN_TENSOR_GET_CLIENT_BUF((*tensors) + tensorIdx)).data) {
-        free(QNN_TENSOR_GET_CLIENT_BUF((*tensors) + tensorIdx).data);
+        memaccount::getAccountant().release(QNN_TENSOR_GET_CLIENT_BUF((*tensors) + tensorIdx).data);
       }
       tearDownTensors(*tensors, tensorIdx);
       *tensors     = nullptr;
@@ -559,12 +1038,18 @@ iotensor::StatusCode iotensor::IOTensor::setupInputAndOutputTensors(
     Qnn_Tensor_t** inputs, Qnn_Tensor_t** outputs, qnn_wrapper_api::GraphInfo_t graphInfo) {
   auto returnStatus = StatusCode::SUCCESS;
   if (StatusCode::SUCCESS !=
-      setupTensors(inputs, graphInfo.numInputTensors, (graphInfo.inputTensors))) {
+      setupTensors(inputs,
+                   graphInfo.numInputTensors,
+                   (graphInfo.inputTensors),
+                   memaccount::Category::INPUT)) {
     QNN_ERROR("Failure in setting up input tensors");
     returnStatus = StatusCode::FAILURE;
   }
   if (StatusCode::SUCCESS !=
-      setupTensors(outputs, graphInfo.numOutputTensors, (graphInfo.outputTensors))) {
+      setupTensors(outputs,
+                   graphInfo.numOutputTensors,
+                   (graphInfo.outputTensors),
+                   memaccount::Category::OUTPUT)) {
     QNN_ERROR("Failure in setting up output tensors");
     returnStatus = StatusCode::FAILURE;
   }
@@ -581,25 +1066,52 @@ iotensor::StatusCode iotensor::IOTensor::setupInputAndOutputTensors(
       *outputs = nullptr;
     }
     QNN_ERROR("Failure in setupInputAndOutputTensors, done cleaning up resources");
+  } else if (nullptr != m_ioEngine) {
+    registerIoBuffers(*outputs, graphInfo);
   }
   return returnStatus;
 }
 
+// Register the output tensor client buffers with the I/O engine, so that
+// native outputs written behind execution straight from them use pinned
+// buffers. Inputs are read ahead into staging buffers, as their tensor
+// buffers are still in use by the sample executing.
+void iotensor::IOTensor::registerIoBuffers(Qnn_Tensor_t* outputs,
+                                           qnn_wrapper_api::GraphInfo_t& graphInfo) {
+  std::vector<std::pair<uint8_t*, size_t>> buffers;
+  for (size_t idx = 0; nullptr != outputs && idx < graphInfo.numOutputTensors; idx++) {
+    buffers.push_back(
+        std::make_pair(static_cast<uint8_t*>(QNN_TENSOR_GET_CLIENT_BUF(outputs[idx]).data),
+                       QNN_TENSOR_GET_CLIENT_BUF(outputs[idx]).dataSize));
+  }
+  if (asyncio::StatusCode::SUCCESS != m_ioEngine->registerBuffers(buffers)) {
+    QNN_DEBUG("Tensor buffers not registered with the I/O engine");
+  }
+}
+
 // Clean up all tensors related data after execution.
 iotensor::StatusCode iotensor::IOTensor::tearDownTensors(Qnn_Tensor_t* tensors,
                                                          uint32_t tensorCount) {
   for (size_t tensorIdx = 0; tensorIdx < tensorCount; tensorIdx++) {
     QNN_DEBUG("freeing resources for tensor: %d", tensorIdx);
+    releaseMappedTensor(&tensors[tensorIdx]);
+    memaccount::Accountant& accountant = memaccount::getAccountant();
+    accountant.release(const_cast<char*>(QNN_TENSOR_GET_NAME(tensors[tensorIdx])));
+    if (QNN_QUANTIZATION_ENCODING_AXIS_SCALE_OFFSET ==
+        QNN_TENSOR_GET_QUANT_PARAMS(tensors[tensorIdx]).quantizationEncoding) {
+      accountant.release(
+          QNN_TENSOR_GET_QUANT_PARAMS(tensors[tensorIdx]).axisScaleOffsetEncoding.scaleOffset);
+    }
     if (nullptr != QNN_TENSOR_GET_DIMENSIONS(tensors[tensorIdx])) {
       QNN_DEBUG("freeing dimensions");
-      free(QNN_TENSOR_GET_DIMENSIONS(tensors[tensorIdx]));
+      accountant.release(QNN_TENSOR_GET_DIMENSIONS(tensors[tensorIdx]));
     }
     if (nullptr != QNN_TENSOR_GET_CLIENT_BUF(tensors[tensorIdx]).data) {
       QNN_DEBUG("freeing clientBuf.data");
-      free(QNN_TENSOR_GET_CLIENT_BUF(tensors[tensorIdx]).data);
+      accountant.release(QNN_TENSOR_GET_CLIENT_BUF(tensors[tensorIdx]).data);
     }
   }
-  free(tensors);
+  memaccount::getAccountant().release(tensors);
   return StatusCode::SUCCESS;
 }
 
@@ -608,6 +1120,12 @@ iotensor::StatusCode iotensor::IOTensor::tearDownInputAndOutputTensors(Qnn_Tenso
                                                                        Qnn_Tensor_t* outputs,
                                                                        size_t numInputTensors,
                                                                        size_t numOutputTensors) {
+  if (nullptr != m_asyncInputReader) {
+    m_asyncInputReader->clear();
+  }
+  if (nullptr != m_ioEngine) {
+    m_ioEngine->unregisterBuffers();
+  }
   if (nullptr != inputs) {
     QNN_INFO("cleaning up resources for input tensors");
     tearDownTensors(inputs, numInputTensors);
@@ -624,50 +1142,59 @@ iotensor::StatusCode iotensor::IOTensor::tearDownInputAndOutputTensors(Qnn_Tenso
 // Helper method to allocate a buffer.
 iotensor::StatusCode iotensor::IOTensor::allocateBuffer(uint8_t** buffer,
                                                         std::vector<size_t> dims,
-                                                        Qnn_DataType_t dataType) {
+                                                        Qnn_DataType_t dataType,
+                                                        memaccount::Category category) {
   size_t elementCount = datautil::calculateElementCount(dims);
   auto returnStatus   = StatusCode::SUCCESS;
   switch (dataType) {
     case QNN_DATATYPE_FLOAT_32:
       QNN_DEBUG("allocating float buffer");
-      returnStatus = allocateBuffer<float>(reinterpret_cast<float**>(buffer), elementCount);
+      returnStatus =
+          allocateBuffer<float>(reinterpret_cast<float**>(buffer), elementCount, category);
       break;
 
     case QNN_DATATYPE_UINT_8:
     case QNN_DATATYPE_UFIXED_POINT_8:
       QNN_DEBUG("allocating uint8_t buffer");
-      returnStatus = allocateBuffer<uint8_t>(reinterpret_cast<uint8_t**>(buffer), elementCount);
+      returnStatus =
+          allocateBuffer<uint8_t>(reinterpret_cast<uint8_t**>(buffer), elementCount, category);
       break;
 
     case QNN_DATATYPE_UINT_16:
     case QNN_DATATYPE_UFIXED_POINT_16:
       QNN_DEBUG("allocating uint16_t buffer");
-      returnStatus = allocateBuffer<uint16_t>(reinterpret_cast<uint16_t**>(buffer), elementCount);
+      returnStatus =
+          allocateBuffer<uint16_t>(reinterpret_cast<uint16_t**>(buffer), elementCount, category);
       break;
 
     case QNN_DATATYPE_UINT_32:
       QNN_DEBUG("allocating uint32_t buffer");
-      returnStatus = allocateBuffer<uint32_t>(reinterpret_cast<uint32_t**>(buffer), elementCount);
+      returnStatus =
+          allocateBuffer<uint32_t>(reinterpret_cast<uint32_t**>(buffer), elementCount, category);
       break;
 
     case QNN_DATATYPE_INT_8:
       QNN_DEBUG("allocating int8_t buffer");
-      returnStatus = allocateBuffer<int8_t>(reinterpret_cast<int8_t**>(buffer), elementCount);
+      returnStatus =
+          allocateBuffer<int8_t>(reinterpret_cast<int8_t**>(buffer), elementCount, category);
       break;
 
     case QNN_DATATYPE_INT_16:
       QNN_DEBUG("allocating int16_t buffer");
-      returnStatus = allocateBuffer<int16_t>(reinterpret_cast<int16_t**>(buffer), elementCount);
+      returnStatus =
+          allocateBuffer<int16_t>(reinterpret_cast<int16_t**>(buffer), elementCount, category);
       break;
 
     case QNN_DATATYPE_INT_32:
       QNN_DEBUG("allocating int32_t buffer");
-      returnStatus = allocateBuffer<int32_t>(reinterpret_cast<int32_t**>(buffer), elementCount);
+      returnStatus =
+          allocateBuffer<int32_t>(reinterpret_cast<int32_t**>(buffer), elementCount, category);
       break;
 
     case QNN_DATATYPE_BOOL_8:
       QNN_DEBUG("allocating bool buffer");
-      returnStatus = allocateBuffer<uint8_t>(reinterpret_cast<uint8_t**>(buffer), elementCount);
+      returnStatus =
+          allocateBuffer<uint8_t>(reinterpret_cast<uint8_t**>(buffer), elementCount, category);
       break;
 
     default:
@@ -680,12 +1207,21 @@ iotensor::StatusCode iotensor::IOTensor::allocateBuffer(uint8_t** buffer,
 
 // Helper method to allocate a buffer.
 template <typename T>
-iotensor::StatusCode iotensor::IOTensor::allocateBuffer(T** buffer, size_t& elementCount) {
+iotensor::StatusCode iotensor::IOTensor::allocateBuffer(T** buffer,
+                                                        size_t& elementCount,
+                                                        memaccount::Category category) {
   QNN_DEBUG("ElementCount: %d, sizeof(T): %d, total size: %d",
             elementCount,
             sizeof(T),
             elementCount * sizeof(T));
-  *buffer = (T*)malloc(elementCount * sizeof(T));
+  memaccount::Accountant& accountant = memaccount::getAccountant();
+  if (nullptr != m_directReader) {
+    // Aligned so direct reads can land in the buffer without staging.
+    *buffer = static_cast<T*>(accountant.allocateAligned(
+        datautil::g_directIoAlignment, elementCount * sizeof(T), category));
+  } else {
+    *buffer = static_cast<T*>(accountant.allocate(elementCount * sizeof(T), category));
+  }
   if (nullptr == *buffer) {
     QNN_ERROR("mem alloc failed for *buffer");
     return StatusCode::FAILURE;
@@ -701,38 +1237,29 @@ iotensor::StatusCode iotensor::IOTensor::convertToFloat(float** out, Qnn_Tensor_
     QNN_ERROR("tensors is nullptr");
     return StatusCode::FAILURE;
   }
+  metrics::ScopedTimer conversionTimer(g_outputConversionSeconds);
+  flightrecorder::Scope traceScope(m_flightRecorder.get(), flightrecorder::Phase::CONVERT_OUTPUT);
   std::vector<size_t> dims;
   fillDims(dims, QNN_TENSOR_GET_DIMENSIONS(tensor), QNN_TENSOR_GET_RANK(tensor));
   auto returnStatus   = StatusCode::SUCCESS;
   size_t elementCount = datautil::calculateElementCount(dims);
-  returnStatus        = allocateBuffer<float>(out, elementCount);
+  perfcounters::Scope perfScope(perfcounters::Stage::DEQUANTIZE, elementCount * sizeof(float));
+  returnStatus        = allocateBuffer<float>(out, elementCount, memaccount::Category::SCRATCH);
   if (StatusCode::SUCCESS != returnStatus) {
     QNN_ERROR("failure in allocateBuffer<float>");
     return returnStatus;
   }
   switch (QNN_TENSOR_GET_DATA_TYPE(tensor)) {
     case QNN_DATATYPE_UFIXED_POINT_8:
-      if (datautil::StatusCode::SUCCESS !=
-          datautil::tfNToFloat<uint8_t>(
-              *out,
-              reinterpret_cast<uint8_t*>(QNN_TENSOR_GET_CLIENT_BUF(tensor).data),
-              QNN_TENSOR_GET_QUANT_PARAMS(tensor).scaleOffsetEncoding.offset,
-              QNN_TENSOR_GET_QUANT_PARAMS(tensor).scaleOffsetEncoding.scale,
-              elementCount)) {
+      if (datautil::StatusCode::SUCCESS != dequantize<uint8_t>(*out, tensor, dims)) {
         QNN_ERROR("failure in tfNToFloat<uint8_t>");
         returnStatus = StatusCode::FAILURE;
       }
       break;
 
     case QNN_DATATYPE_UFIXED_POINT_16:
-      if (datautil::StatusCode::SUCCESS !=
-          datautil::tfNToFloat<uint16_t>(
-              *out,
-              reinterpret_cast<uint16_t*>(QNN_TENSOR_GET_CLIENT_BUF(tensor).data),
-              QNN_TENSOR_GET_QUANT_PARAMS(tensor).scaleOffsetEncoding.offset,
-              QNN_TENSOR_GET_QUANT_PARAMS(tensor).scaleOffsetEncoding.scale,
-              elementCount)) {
-        QNN_ERROR("failure in tfNToFloat<uint8_t>");
+      if (datautil::StatusCode::SUCCESS != dequantize<uint16_t>(*out, tensor, dims)) {
+        QNN_ERROR("failure in tfNToFloat<uint16_t>");
         returnStatus = StatusCode::FAILURE;
       }
       break;
@@ -822,7 +1349,7 @@ iotensor::StatusCode iotensor::IOTensor::convertToFloat(float** out, Qnn_Tensor_
   if (StatusCode::SUCCESS != returnStatus) {
     QNN_DEBUG("freeing *out");
     if (*out != nullptr) {
-      free(*out);
+      memaccount::getAccountant().release(*out);
       *out = nullptr;
     }
   }
@@ -848,15 +1375,13 @@ iotensor::StatusCode iotensor::IOTensor::convertAndWriteOutputTensorInFloat(
     return StatusCode::FAILURE;
   }
   uint8_t* bufferToWrite = reinterpret_cast<uint8_t*>(floatBuffer);
-  if (datautil::StatusCode::SUCCESS !=
-      datautil::writeBatchDataToFile(
-          outputPaths, fileName, dims, QNN_DATATYPE_FLOAT_32, bufferToWrite, m_batchSize)) {
-    QNN_ERROR("failure in writeBatchDataToFile");
-    returnStatus = StatusCode::FAILURE;
-  }
-  if (nullptr != floatBuffer) {
+  returnStatus = writeBatchData(outputPaths, fileName, dims, QNN_DATATYPE_FLOAT_32, bufferToWrite);
+  if (isWritingBehind()) {
+    // Writes behind execution are made from floatBuffer until flushed.
+    m_asyncOutputWriter->adopt(floatBuffer);
+  } else if (nullptr != floatBuffer) {
     QNN_DEBUG("freeing floatBuffer");
-    free(floatBuffer);
+    memaccount::getAccountant().release(floatBuffer);
     floatBuffer = nullptr;
   }
   return returnStatus;
@@ -875,19 +1400,109 @@ iotensor::StatusCode iotensor::IOTensor::writeOutputTensor(Qnn_Tensor_t* output,
   std::vector<size_t> dims;
   fillDims(dims, QNN_TENSOR_GET_DIMENSIONS(output), QNN_TENSOR_GET_RANK(output));
   uint8_t* bufferToWrite = reinterpret_cast<uint8_t*>(QNN_TENSOR_GET_CLIENT_BUF(output).data);
-  if (datautil::StatusCode::SUCCESS !=
-      datautil::writeBatchDataToFile(outputPaths,
-                                     fileName,
-                                     dims,
-                                     QNN_TENSOR_GET_DATA_TYPE(output),
-                                     bufferToWrite,
-                                     m_batchSize)) {
-    QNN_ERROR("failure in writeBatchDataToFile");
-    returnStatus = StatusCode::FAILURE;
-  }
+  returnStatus =
+      writeBatchData(outputPaths, fileName, dims, QNN_TENSOR_GET_DATA_TYPE(output), bufferToWrite);
   return returnStatus;
 }
 
+// Helper method to write one batched output buffer, either as one file per
+// sample or as one container record per sample.
+iotensor::StatusCode iotensor::IOTensor::writeBatchData(std::vector<std::string>& outputPaths,
+                                                        std::string fileName,
+                                                        std::vector<size_t> dims,
+                                                        Qnn_DataType_t dataType,
+                                                        uint8_t* buffer) {
+  datautil::StatusCode datautilStatus;
+  size_t length{0};
+  std::tie(datautilStatus, length) = datautil::calculateLength(dims, dataType);
+  if (datautil::StatusCode::SUCCESS != datautilStatus || nullptr == buffer) {
+    return StatusCode::FAILURE;
+  }
+  size_t outputSize = length / m_batchSize;
+  if (isWritingBehind()) {
+    for (size_t batchIndex = 0; batchIndex < outputPaths.size(); batchIndex++) {
+      int fd =
+          m_outputLayout->openOutputFile(m_outputGraphDir, m_outputStartIdx + batchIndex, fileName);
+      if (fd < 0 ||
+          datautil::StatusCode::SUCCESS !=
+              m_asyncOutputWriter->write(fd,
+                                         outputPaths[batchIndex] + pal::Path::getSeparator() +
+                                             fileName,
+                                         buffer + batchIndex * outputSize,
+                                         outputSize)) {
+        return StatusCode::FAILURE;
+      }
+    }
+    g_outputBytes.add(outputPaths.size() * outputSize);
+    return StatusCode::SUCCESS;
+  }
+  if (nullptr == m_outputContainer && nullptr != m_outputLayout) {
+    std::vector<int> fds;
+    auto returnStatus = StatusCode::SUCCESS;
+    for (size_t batchIndex = 0; batchIndex < outputPaths.size(); batchIndex++) {
+      int fd =
+          m_outputLayout->openOutputFile(m_outputGraphDir, m_outputStartIdx + batchIndex, fileName);
+      if (fd < 0) {
+        returnStatus = StatusCode::FAILURE;
+        break;
+      }
+      fds.push_back(fd);
+    }
+    if (StatusCode::SUCCESS == returnStatus &&
+        datautil::StatusCode::SUCCESS !=
+            datautil::writeBatchDataToFiles(fds, dims, dataType, buffer, m_batchSize)) {
+      QNN_ERROR("failure in writeBatchDataToFiles");
+      returnStatus = StatusCode::FAILURE;
+    }
+    for (int fd : fds) {
+      if (0 != close(fd)) {
+        returnStatus = StatusCode::FAILURE;
+      }
+    }
+    if (StatusCode::SUCCESS == returnStatus) {
+      g_outputBytes.add(outputPaths.size() * outputSize);
+    }
+    return returnStatus;
+  }
+  if (nullptr == m_outputContainer) {
+    datautilStatus = datautil::writeBatchDataToFile(
+        outputPaths, fileName, dims, dataType, buffer, m_batchSize);
+    if (datautil::StatusCode::SUCCESS != datautilStatus) {
+      QNN_ERROR("failure in writeBatchDataToFile");
+      return StatusCode::FAILURE;
+    }
+    g_outputBytes.add(outputPaths.size() * outputSize);
+    return StatusCode::SUCCESS;
+  }
+  std::string tensorName =
+      m_outputGraphDir.empty() ? fileName : m_outputGraphDir + "/" + fileName;
+  auto tensorIt = m_outputContainerTensors.find(tensorName);
+  if (tensorIt == m_outputContainerTensors.end()) {
+    // Record the shape of a single sample.
+    if (!dims.empty() && dims[0] % m_batchSize == 0) {
+      dims[0] /= m_batchSize;
+    }
+    uint32_t tensorIdx{0};
+    if (packedcontainer::StatusCode::SUCCESS !=
+        m_outputContainer->addTensor(tensorName, dataType, dims, tensorIdx)) {
+      return StatusCode::FAILURE;
+    }
+    tensorIt = m_outputContainerTensors.insert(std::make_pair(tensorName, tensorIdx)).first;
+  }
+  for (size_t batchIndex = 0; batchIndex < outputPaths.size(); batchIndex++) {
+    if (packedcontainer::StatusCode::SUCCESS !=
+        m_outputContainer->appendRecord(tensorIt->second,
+                                        m_outputStartIdx + batchIndex,
+                                        buffer + batchIndex * outputSize,
+                                        outputSize)) {
+      QNN_ERROR("failure in appending %s to the output container", tensorName.c_str());
+      return StatusCode::FAILURE;
+    }
+  }
+  g_outputBytes.add(outputPaths.size() * outputSize);
+  return StatusCode::SUCCESS;
+}
+
 // Write out all output tensors to files. If output_data_type is float,
 // then all outputs will be raw floats regardless of what the model outputs.
 // If the output_data_type is native, then output is written as produced by the model.
@@ -906,12 +1521,19 @@ iotensor::StatusCode iotensor::IOTensor::writeOutputTensors(uint32_t graphIdx,
     QNN_ERROR("Received nullptr");
     return StatusCode::FAILURE;
   }
-  if (graphsCount > 1) {
-    if (nullptr != graphName && strlen(graphName) > 0) {
-      outputPath += (pal::Path::getSeparator() + std::string(graphName));
-    } else {
-      outputPath += (pal::Path::getSeparator() + std::string("Graph_") + std::to_string(graphIdx));
-    }
+  m_outputGraphDir = getOutputGraphDir(graphIdx, graphName, graphsCount);
+  m_outputStartIdx = startIdx;
+  if (!m_outputGraphDir.empty()) {
+    outputPath += (pal::Path::getSeparator() + m_outputGraphDir);
+  }
+  if (nullptr != m_outputComparator) {
+    return compareOutputTensors(outputs, numOutputs);
+  }
+  if (nullptr != m_outputStream) {
+    return writeOutputFrames(outputs, numOutputs, outputDatatype);
+  }
+  if (OutputHash::NONE != m_outputHash) {
+    return writeOutputHashes(outputs, numOutputs);
   }
   auto returnStatus = StatusCode::SUCCESS;
   std::vector<std::string> outputPaths;
@@ -921,6 +1543,11 @@ iotensor::StatusCode iotensor::IOTensor::writeOutputTensors(uint32_t graphIdx,
     outputPaths.push_back(output);
   }
   for (size_t outputIdx = 0; outputIdx < numOutputs; outputIdx++) {
+    flightrecorder::Scope traceScope(
+        m_flightRecorder.get(), flightrecorder::Phase::WRITE_OUTPUT, outputIdx);
+    // Counts the tensor's bytes; a float file of a quantized output is larger.
+    perfcounters::Scope perfScope(perfcounters::Stage::WRITE,
+                                  QNN_TENSOR_GET_CLIENT_BUF(outputs[outputIdx]).dataSize);
     QNN_DEBUG("Writing output for outputIdx: %d", outputIdx);
     std::string outputFilePrefix;
     if (nullptr != QNN_TENSOR_GET_NAME(outputs[outputIdx]) &&
@@ -931,28 +1558,408 @@ iotensor::StatusCode iotensor::IOTensor::writeOutputTensors(uint32_t graphIdx,
     }
     auto outputFile       = outputFilePrefix + std::string(".raw");
     auto outputFileNative = outputFilePrefix + std::string("_native.raw");
+    // A mapped output already is its native output file.
+    bool mapped = m_mappedTensors.find(&(outputs[outputIdx])) != m_mappedTensors.end();
     if (QNN_TENSOR_GET_DATA_TYPE(outputs[outputIdx]) == QNN_DATATYPE_FLOAT_32) {
       QNN_DEBUG("Writing in output->dataType == QNN_DATATYPE_FLOAT_32");
-      returnStatus = writeOutputTensor(&(outputs[outputIdx]), outputPaths, outputFile);
+      if (!mapped) {
+        returnStatus = writeOutputTensor(&(outputs[outputIdx]), outputPaths, outputFile);
+      }
     } else if (outputDatatype == OutputDataType::FLOAT_ONLY) {
       QNN_DEBUG("Writing in output->dataType == OutputDataType::FLOAT_ONLY");
       returnStatus =
           convertAndWriteOutputTensorInFloat(&(outputs[outputIdx]), outputPaths, outputFile);
     } else if (outputDatatype == OutputDataType::NATIVE_ONLY) {
       QNN_DEBUG("Writing in output->dataType == OutputDataType::NATIVE_ONLY");
-      returnStatus = writeOutputTensor(&(outputs[outputIdx]), outputPaths, outputFileNative);
+      if (!mapped) {
+        returnStatus = writeOutputTensor(&(outputs[outputIdx]), outputPaths, outputFileNative);
+      }
     } else if (outputDatatype == OutputDataType::FLOAT_AND_NATIVE) {
       QNN_DEBUG("Writing in output->dataType == OutputDataType::FLOAT_AND_NATIVE");
       returnStatus =
           convertAndWriteOutputTensorInFloat(&(outputs[outputIdx]), outputPaths, outputFile);
-      if (StatusCode::SUCCESS == returnStatus) {
+      if (StatusCode::SUCCESS == returnStatus && !mapped) {
         returnStatus = writeOutputTensor(&(outputs[outputIdx]), outputPaths, outputFileNative);
       }
     }
+    releaseMappedTensor(&(outputs[outputIdx]));
+  }
+  if (isWritingBehind()) {
+    m_asyncOutputWriter->submit();
+  }
+  return returnStatus;
+}
+
+// Output files of a graph go to a subdirectory when the model has more than
+// one graph. Returns its name, or an empty string.
+std::string iotensor::IOTensor::getOutputGraphDir(uint32_t graphIdx,
+                                                  char* graphName,
+                                                  uint32_t graphsCount) {
+  if (graphsCount <= 1) {
+    return std::string();
+  }
+  if (nullptr != graphName && strlen(graphName) > 0) {
+    return std::string(graphName);
+  }
+  return std::string("Graph_") + std::to_string(graphIdx);
+}
+
+iotensor::StatusCode iotensor::IOTensor::flushOutputs() {
+  if (nullptr != m_asyncOutputWriter &&
+      datautil::StatusCode::SUCCESS != m_asyncOutputWriter->flush()) {
+    QNN_ERROR("Failed to write output files");
+    return StatusCode::FAILURE;
+  }
+  return StatusCode::SUCCESS;
+}
+
+iotensor::StatusCode iotensor::IOTensor::prepareOutputDirs(uint32_t graphIdx,
+                                                           char* graphName,
+                                                           uint32_t graphsCount,
+                                                           size_t firstSample,
+                                                           size_t count) {
+  if (nullptr == m_outputLayout) {
+    return StatusCode::SUCCESS;
+  }
+  if (outputlayout::StatusCode::SUCCESS !=
+      m_outputLayout->prepare(
+          getOutputGraphDir(graphIdx, graphName, graphsCount), firstSample, count)) {
+    return StatusCode::FAILURE;
+  }
+  return StatusCode::SUCCESS;
+}
+
+iotensor::StatusCode iotensor::IOTensor::mapOutputTensors(uint32_t graphIdx,
+                                                          size_t startIdx,
+                                                          char* graphName,
+                                                          Qnn_Tensor_t* outputs,
+                                                          uint32_t numOutputs,
+                                                          OutputDataType outputDatatype,
+                                                          uint32_t graphsCount,
+                                                          std::string outputPath) {
+  if (!m_outputMapping || 1 != m_batchSize || 1 != m_numFilesPopulated ||
+      nullptr != m_outputComparator || nullptr != m_outputStream ||
+      OutputHash::NONE != m_outputHash || nullptr != m_outputContainer) {
+    return StatusCode::SUCCESS;
+  }
+  if (nullptr == outputs) {
+    QNN_ERROR("Received nullptr");
+    return StatusCode::FAILURE;
+  }
+  std::string graphDir = getOutputGraphDir(graphIdx, graphName, graphsCount);
+  if (!graphDir.empty()) {
+    outputPath += (pal::Path::getSeparator() + graphDir);
+  }
+  std::string resultDir = outputPath + (pal::Path::getSeparator() + std::string("Result_") +
+                                        std::to_string(startIdx));
+  if (nullptr != m_outputLayout) {
+    if (outputlayout::StatusCode::SUCCESS != m_outputLayout->prepare(graphDir, startIdx, 1)) {
+      return StatusCode::FAILURE;
+    }
+  } else if (!pal::Directory::makePath(resultDir)) {
+    QNN_ERROR("Could not create output directory: %s", resultDir.c_str());
+    return StatusCode::FAILURE;
+  }
+  for (size_t outputIdx = 0; outputIdx < numOutputs; outputIdx++) {
+    Qnn_Tensor_t* output = &(outputs[outputIdx]);
+    bool isFloat         = QNN_TENSOR_GET_DATA_TYPE(output) == QNN_DATATYPE_FLOAT_32;
+    if (!isFloat && OutputDataType::FLOAT_ONLY == outputDatatype) {
+      continue;
+    }
+    std::string outputFilePrefix;
+    if (nullptr != QNN_TENSOR_GET_NAME(output) && strlen(QNN_TENSOR_GET_NAME(output)) > 0) {
+      outputFilePrefix = std::string(QNN_TENSOR_GET_NAME(output));
+    } else {
+      outputFilePrefix = std::string("Output_") + std::to_string(outputIdx);
+    }
+    std::string outputFile = resultDir + pal::Path::getSeparator() + outputFilePrefix +
+                             (isFloat ? std::string(".raw") : std::string("_native.raw"));
+    std::vector<size_t> dims;
+    fillDims(dims, QNN_TENSOR_GET_DIMENSIONS(output), QNN_TENSOR_GET_RANK(output));
+    datautil::StatusCode datautilStatus;
+    size_t length{0};
+    std::tie(datautilStatus, length) =
+        datautil::calculateLength(dims, QNN_TENSOR_GET_DATA_TYPE(output));
+    if (datautil::StatusCode::SUCCESS != datautilStatus) {
+      return StatusCode::FAILURE;
+    }
+    pal::MappedFile mappedFile;
+    if (!mappedFile.create(outputFile, length)) {
+      QNN_WARN("Could not map output file %s, it will be written instead", outputFile.c_str());
+      continue;
+    }
+    uint8_t* data = mappedFile.data();
+    bindTensor(output, data, std::move(mappedFile));
+  }
+  return StatusCode::SUCCESS;
+}
+
+// Write one line per sample of the batch: "[graph/]Result_<N>" followed by
+// "<output>=<hash>" for each output, with ",min=<v>,max=<v>,mean=<v>" of the
+// float values appended when stats are enabled. Hashes cover the native
+// output bytes, so they catch any change regardless of output_data_type.
+iotensor::StatusCode iotensor::IOTensor::writeOutputHashes(Qnn_Tensor_t* outputs,
+                                                           uint32_t numOutputs) {
+  if (nullptr == m_outputHashStream) {
+    QNN_ERROR("No output hash stream set");
+    return StatusCode::FAILURE;
+  }
+  std::vector<std::string> lines;
+  for (size_t idx = 0; idx < m_numFilesPopulated; idx++) {
+    lines.push_back((m_outputGraphDir.empty() ? std::string() : m_outputGraphDir + "/") +
+                    "Result_" + std::to_string(m_outputStartIdx + idx));
+  }
+  for (size_t outputIdx = 0; outputIdx < numOutputs; outputIdx++) {
+    Qnn_Tensor_t* output = &(outputs[outputIdx]);
+    std::string outputName;
+    if (nullptr != QNN_TENSOR_GET_NAME(output) && strlen(QNN_TENSOR_GET_NAME(output)) > 0) {
+      outputName = std::string(QNN_TENSOR_GET_NAME(output));
+    } else {
+      outputName = std::string("Output_") + std::to_string(outputIdx);
+    }
+    std::vector<size_t> dims;
+    fillDims(dims, QNN_TENSOR_GET_DIMENSIONS(output), QNN_TENSOR_GET_RANK(output));
+    datautil::StatusCode datautilStatus;
+    size_t length{0};
+    std::tie(datautilStatus, length) =
+        datautil::calculateLength(dims, QNN_TENSOR_GET_DATA_TYPE(output));
+    if (datautil::StatusCode::SUCCESS != datautilStatus) {
+      return StatusCode::FAILURE;
+    }
+    float* floatBuffer = nullptr;
+    if (m_outputHashWithStats && QNN_DATATYPE_FLOAT_32 != QNN_TENSOR_GET_DATA_TYPE(output) &&
+        StatusCode::SUCCESS != convertToFloat(&floatBuffer, output)) {
+      QNN_ERROR("failure in convertToFloat");
+      return StatusCode::FAILURE;
+    }
+    const uint8_t* nativeBuffer =
+        static_cast<const uint8_t*>(QNN_TENSOR_GET_CLIENT_BUF(output).data);
+    const float* floatValues = (nullptr != floatBuffer)
+                                   ? floatBuffer
+                                   : reinterpret_cast<const float*>(nativeBuffer);
+    size_t sampleLength       = length / m_batchSize;
+    size_t sampleElementCount = datautil::calculateElementCount(dims) / m_batchSize;
+    for (size_t idx = 0; idx < lines.size(); idx++) {
+      const uint8_t* sample = nativeBuffer + idx * sampleLength;
+      lines[idx] += " " + outputName + "=" +
+                    (OutputHash::HASH128 == m_outputHash
+                         ? hashutil::toHex(hashutil::xxh64x2(sample, sampleLength))
+                         : hashutil::toHex(hashutil::xxh64(sample, sampleLength)));
+      if (m_outputHashWithStats && sampleElementCount > 0) {
+        const float* values = floatValues + idx * sampleElementCount;
+        float minValue      = values[0];
+        float maxValue      = values[0];
+        double sum          = 0.0;
+        for (size_t e = 0; e < sampleElementCount; e++) {
+          minValue = std::min(minValue, values[e]);
+          maxValue = std::max(maxValue, values[e]);
+          sum += values[e];
+        }
+        char stats[96];
+        snprintf(stats,
+                 sizeof(stats),
+                 ",min=%g,max=%g,mean=%g",
+                 minValue,
+                 maxValue,
+                 sum / sampleElementCount);
+        lines[idx] += stats;
+      }
+    }
+    if (nullptr != floatBuffer) {
+      memaccount::getAccountant().release(floatBuffer);
+    }
+  }
+  for (auto const& line : lines) {
+    *m_outputHashStream << line << '\n';
+  }
+  if (!*m_outputHashStream) {
+    QNN_ERROR("Failed to write output hashes");
+    return StatusCode::FAILURE;
+  }
+  return StatusCode::SUCCESS;
+}
+
+// Write each output of each sample as one frame, in graph output order. The
+// output data type selects float or native frames as it selects files;
+// FLOAT_AND_NATIVE writes the float frame of an output before its native one.
+iotensor::StatusCode iotensor::IOTensor::writeOutputFrames(Qnn_Tensor_t* outputs,
+                                                           uint32_t numOutputs,
+                                                           OutputDataType outputDatatype) {
+  std::vector<float*> floatBuffers(numOutputs, nullptr);
+  std::vector<size_t> nativeLengths(numOutputs, 0);
+  std::vector<size_t> elementCounts(numOutputs, 0);
+  auto returnStatus = StatusCode::SUCCESS;
+  for (size_t outputIdx = 0; outputIdx < numOutputs; outputIdx++) {
+    Qnn_Tensor_t* output = &(outputs[outputIdx]);
+    std::vector<size_t> dims;
+    fillDims(dims, QNN_TENSOR_GET_DIMENSIONS(output), QNN_TENSOR_GET_RANK(output));
+    datautil::StatusCode datautilStatus;
+    std::tie(datautilStatus, nativeLengths[outputIdx]) =
+        datautil::calculateLength(dims, QNN_TENSOR_GET_DATA_TYPE(output));
+    elementCounts[outputIdx] = datautil::calculateElementCount(dims);
+    if (datautil::StatusCode::SUCCESS != datautilStatus) {
+      returnStatus = StatusCode::FAILURE;
+      break;
+    }
+    if (QNN_DATATYPE_FLOAT_32 != QNN_TENSOR_GET_DATA_TYPE(output) &&
+        OutputDataType::NATIVE_ONLY != outputDatatype &&
+        StatusCode::SUCCESS != convertToFloat(&floatBuffers[outputIdx], output)) {
+      QNN_ERROR("failure in convertToFloat");
+      returnStatus = StatusCode::FAILURE;
+      break;
+    }
+  }
+  for (size_t idx = 0; idx < m_numFilesPopulated && StatusCode::SUCCESS == returnStatus; idx++) {
+    for (size_t outputIdx = 0; outputIdx < numOutputs; outputIdx++) {
+      const uint8_t* native =
+          static_cast<const uint8_t*>(QNN_TENSOR_GET_CLIENT_BUF(outputs[outputIdx]).data);
+      size_t nativeLength = nativeLengths[outputIdx] / m_batchSize;
+      size_t floatLength  = elementCounts[outputIdx] / m_batchSize * sizeof(float);
+      bool writeFloat     = nullptr != floatBuffers[outputIdx];
+      bool writeNative    = !writeFloat || OutputDataType::FLOAT_AND_NATIVE == outputDatatype;
+      if (writeFloat &&
+          framestream::StatusCode::SUCCESS !=
+              m_outputStream->writeFrame(
+                  reinterpret_cast<const uint8_t*>(floatBuffers[outputIdx]) + idx * floatLength,
+                  floatLength)) {
+        returnStatus = StatusCode::FAILURE;
+        break;
+      }
+      if (writeNative &&
+          framestream::StatusCode::SUCCESS !=
+              m_outputStream->writeFrame(native + idx * nativeLength, nativeLength)) {
+        returnStatus = StatusCode::FAILURE;
+        break;
+      }
+      g_outputBytes.add((writeFloat ? floatLength : 0) + (writeNative ? nativeLength : 0));
+    }
+  }
+  for (auto floatBuffer : floatBuffers) {
+    if (nullptr != floatBuffer) {
+      memaccount::getAccountant().release(floatBuffer);
+    }
   }
   return returnStatus;
 }
 
+// Compare each sample of each output against its reference. Float references
+// (<output>.raw) are preferred; native ones (<output>_native.raw) are
+// dequantized with the quantization parameters of the output itself. Fails
+// only on errors, or on the first output out of tolerance in fail fast mode;
+// otherwise failures are counted by the comparator.
+iotensor::StatusCode iotensor::IOTensor::compareOutputTensors(Qnn_Tensor_t* outputs,
+                                                              uint32_t numOutputs) {
+  const std::string graphPrefix =
+      m_outputGraphDir.empty() ? std::string() : m_outputGraphDir + "/";
+  for (size_t outputIdx = 0; outputIdx < numOutputs; outputIdx++) {
+    Qnn_Tensor_t* output = &(outputs[outputIdx]);
+    std::string outputName;
+    if (nullptr != QNN_TENSOR_GET_NAME(output) && strlen(QNN_TENSOR_GET_NAME(output)) > 0) {
+      outputName = std::string(QNN_TENSOR_GET_NAME(output));
+    } else {
+      outputName = std::string("Output_") + std::to_string(outputIdx);
+    }
+    std::vector<size_t> dims;
+    fillDims(dims, QNN_TENSOR_GET_DIMENSIONS(output), QNN_TENSOR_GET_RANK(output));
+    datautil::StatusCode datautilStatus;
+    size_t length{0};
+    std::tie(datautilStatus, length) =
+        datautil::calculateLength(dims, QNN_TENSOR_GET_DATA_TYPE(output));
+    if (datautil::StatusCode::SUCCESS != datautilStatus) {
+      return StatusCode::FAILURE;
+    }
+    float* floatBuffer = nullptr;
+    if (QNN_DATATYPE_FLOAT_32 != QNN_TENSOR_GET_DATA_TYPE(output) &&
+        StatusCode::SUCCESS != convertToFloat(&floatBuffer, output)) {
+      QNN_ERROR("failure in convertToFloat");
+      return StatusCode::FAILURE;
+    }
+    memaccount::ScopedRelease floatRelease(floatBuffer);
+    const float* actualValues = floatBuffer;
+    if (nullptr == actualValues) {
+      actualValues = static_cast<const float*>(QNN_TENSOR_GET_CLIENT_BUF(output).data);
+    }
+    size_t sampleLength       = length / m_batchSize;
+    size_t sampleElementCount = datautil::calculateElementCount(dims) / m_batchSize;
+    auto returnStatus         = StatusCode::SUCCESS;
+    for (size_t idx = 0; idx < m_numFilesPopulated; idx++) {
+      size_t sampleIdx  = m_outputStartIdx + idx;
+      std::string label = graphPrefix + "Result_" + std::to_string(sampleIdx) + "/" + outputName;
+      std::vector<float> referenceCopy;
+      // Holds a dequantized native reference until it has been compared.
+      memaccount::ScopedRelease referenceRelease;
+      const float* referenceValues = nullptr;
+      size_t referenceLength       = 0;
+      const uint8_t* reference     = m_outputComparator->findReference(
+          graphPrefix + outputName + ".raw", sampleIdx, referenceLength);
+      if (nullptr != reference) {
+        if (referenceLength != sampleElementCount * sizeof(float)) {
+          m_outputComparator->recordFailure(
+              label,
+              "float reference has " + std::to_string(referenceLength) + " bytes, expected " +
+                  std::to_string(sampleElementCount * sizeof(float)));
+        } else if (0 == reinterpret_cast<uintptr_t>(reference) % alignof(float)) {
+          referenceValues = reinterpret_cast<const float*>(reference);
+        } else {
+          referenceCopy.resize(sampleElementCount);
+          memcpy(referenceCopy.data(), reference, referenceLength);
+          referenceValues = referenceCopy.data();
+        }
+      } else if (QNN_DATATYPE_FLOAT_32 != QNN_TENSOR_GET_DATA_TYPE(output) &&
+                 nullptr != (reference = m_outputComparator->findReference(
+                                 graphPrefix + outputName + "_native.raw",
+                                 sampleIdx,
+                                 referenceLength))) {
+        if (referenceLength != sampleLength) {
+          m_outputComparator->recordFailure(
+              label, "native reference has " + std::to_string(referenceLength) +
+                         " bytes, expected " + std::to_string(sampleLength));
+        } else {
+          // Dequantize through a view of the output that holds one sample.
+          // It keeps the output's shape, which per axis encodings need,
+          // when the batch is its outermost dimension.
+          Qnn_Tensor_t referenceTensor = *output;
+          std::vector<uint32_t> referenceDims(dims.begin(), dims.end());
+          if (!referenceDims.empty() && 0 == referenceDims[0] % m_batchSize) {
+            referenceDims[0] /= static_cast<uint32_t>(m_batchSize);
+          } else {
+            referenceDims.assign(1, static_cast<uint32_t>(sampleElementCount));
+          }
+          QNN_TENSOR_SET_RANK(referenceTensor, static_cast<uint32_t>(referenceDims.size()));
+          QNN_TENSOR_SET_DIMENSIONS(referenceTensor, referenceDims.data());
+          Qnn_ClientBuffer_t referenceBuffer = {const_cast<uint8_t*>(reference),
+                                                static_cast<uint32_t>(referenceLength)};
+          QNN_TENSOR_SET_CLIENT_BUF(referenceTensor, referenceBuffer);
+          float* referenceFloat = nullptr;
+          if (StatusCode::SUCCESS != convertToFloat(&referenceFloat, &referenceTensor)) {
+            QNN_ERROR("failure in convertToFloat");
+            returnStatus = StatusCode::FAILURE;
+            break;
+          }
+          referenceRelease.reset(referenceFloat);
+          referenceValues = referenceFloat;
+        }
+      } else {
+        m_outputComparator->recordFailure(label, "no reference output found");
+      }
+      if (nullptr != referenceValues) {
+        m_outputComparator->check(
+            label,
+            outputcompare::compareFloat(
+                actualValues + idx * sampleElementCount, referenceValues, sampleElementCount));
+      }
+      if (m_outputComparator->isFailFast() && m_outputComparator->getNumFailed() > 0) {
+        returnStatus = StatusCode::FAILURE;
+        break;
+      }
+    }
+    if (StatusCode::SUCCESS != returnStatus) {
+      return returnStatus;
+    }
+  }
+  return StatusCode::SUCCESS;
+}
+
 // Helper method to allocate a buffer and copy data to it.
 iotensor::StatusCode iotensor::IOTensor::allocateAndCopyBuffer(uint8_t** buffer,
                                                                Qnn_Tensor_t* tensor) {
@@ -968,7 +1975,10 @@ iotensor::StatusCode iotensor::IOTensor::allocateAndCopyBuffer(uint8_t** buffer,
   if (datautilStatus != datautil::StatusCode::SUCCESS) {
     return StatusCode::FAILURE;
   }
-  if (StatusCode::SUCCESS != allocateBuffer(buffer, dims, QNN_TENSOR_GET_DATA_TYPE(tensor))) {
+  if (StatusCode::SUCCESS != allocateBuffer(buffer,
+                                            dims,
+                                            QNN_TENSOR_GET_DATA_TYPE(tensor),
+                                            memaccount::Category::SCRATCH)) {
     QNN_ERROR("failure in allocateBuffer");
     return StatusCode::FAILURE;
   }
@@ -1005,6 +2015,19 @@ iotensor::OutputDataType iotensor::parseOutputDataType(std::string dataTypeStrin
   return parsedDataType;
 }
 
+iotensor::OutputHash iotensor::parseOutputHash(std::string hashString) {
+  std::transform(hashString.begin(), hashString.end(), hashString.begin(), ::tolower);
+  OutputHash parsedHash = OutputHash::INVALID;
+  if (hashString == "none") {
+    parsedHash = OutputHash::NONE;
+  } else if (hashString == "64") {
+    parsedHash = OutputHash::HASH64;
+  } else if (hashString == "128") {
+    parsedHash = OutputHash::HASH128;
+  }
+  return parsedHash;
+}
+
 iotensor::InputDataType iotensor::parseInputDataType(std::string dataTypeString) {
   std::transform(dataTypeString.begin(), dataTypeString.end(), dataTypeString.begin(), ::tolower);
   InputDataType parsedDataType = InputDataType::INVALID;
@@ -1014,4 +2037,21 @@ iotensor::InputDataType iotensor::parseInputDataType(std::string dataTypeString)
     parsedDataType = InputDataType::NATIVE;
   }
   return parsedDataType;
-}
\ No newline at end of file
+}
+
+iotensor::InputMapping iotensor::parseInputMapping(std::string mappingString) {
+  std::transform(mappingString.begin(), mappingString.end(), mappingString.begin(), ::tolower);
+  InputMapping parsedMapping = InputMapping::INVALID;
+  if (mappingString == "none") {
+    parsedMapping = InputMapping::NONE;
+  } else if (mappingString == "normal") {
+    parsedMapping = InputMapping::NORMAL;
+  } else if (mappingString == "sequential") {
+    parsedMapping = InputMapping::SEQUENTIAL;
+  } else if (mappingString == "random") {
+    parsedMapping = InputMapping::RANDOM;
+  } else if (mappingString == "willneed") {
+    parsedMapping = InputMapping::WILLNEED;
+  }
+  return parsedMapping;
+}
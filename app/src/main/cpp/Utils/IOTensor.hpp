@@ -7,7 +7,9 @@
 //==============================================================================
 #pragma once
 
+#include <map>
 #include <memory>
+#include <ostream>
 #include <queue>
 
 #include "QnnBackend.h"
@@ -19,10 +21,21 @@
 #include "QnnTypes.h"
 #include "System/QnnSystemInterface.h"
 
+#include "AsyncIo.hpp"
 #include "DataUtil.hpp"
+#include "FlightRecorder.hpp"
+#include "FrameStream.hpp"
+#include "HashUtil.hpp"
 #include "Logger.hpp"
+#include "MemoryAccounting.hpp"
+#include "Metrics.hpp"
+#include "OutputCompare.hpp"
+#include "OutputLayout.hpp"
+#include "PackedContainer.hpp"
+#include "PerfCounters.hpp"
 #include "PAL/Directory.hpp"
 #include "PAL/FileOp.hpp"
+#include "PAL/MappedFile.hpp"
 #include "PAL/Path.hpp"
 #include "PAL/StringOp.hpp"
 #include "QnnTypeMacros.hpp"
@@ -35,13 +48,111 @@ namespace iotensor {
 enum class StatusCode { SUCCESS, FAILURE };
 enum class OutputDataType { FLOAT_ONLY, NATIVE_ONLY, FLOAT_AND_NATIVE, INVALID };
 enum class InputDataType { FLOAT, NATIVE, INVALID };
+// NONE copies every input file into the tensor buffer. The remaining values
+// bind native inputs directly to a file mapping, using the named madvise hint.
+enum class InputMapping { NONE, NORMAL, SEQUENTIAL, RANDOM, WILLNEED, INVALID };
+// Instead of writing outputs, write one line per sample with a hash of each
+// native output buffer.
+enum class OutputHash { NONE, HASH64, HASH128, INVALID };
 
 OutputDataType parseOutputDataType(std::string dataTypeString);
 InputDataType parseInputDataType(std::string dataTypeString);
+InputMapping parseInputMapping(std::string mappingString);
+OutputHash parseOutputHash(std::string hashString);
 
 class IOTensor {
  public:
-  IOTensor() : m_batchSize(1), m_numFilesPopulated(0) {}
+  IOTensor()
+      : m_batchSize(1),
+        m_numFilesPopulated(0),
+        m_inputMapping(InputMapping::NONE),
+        m_outputMapping(false),
+        m_outputHash(OutputHash::NONE),
+        m_outputHashWithStats(false),
+        m_outputStartIdx(0) {}
+
+  void setInputMapping(InputMapping inputMapping) { m_inputMapping = inputMapping; }
+
+  // When set, input files are read ahead and output files written behind
+  // execution through engine instead of with blocking stream I/O.
+  void setIoEngine(std::shared_ptr<asyncio::Engine> ioEngine) {
+    m_ioEngine = ioEngine;
+    m_asyncInputReader.reset(nullptr != ioEngine ? new datautil::AsyncInputReader(ioEngine)
+                                                 : nullptr);
+    m_asyncOutputWriter.reset(nullptr != ioEngine ? new datautil::AsyncOutputWriter(ioEngine)
+                                                  : nullptr);
+  }
+
+  // The reader to queue upcoming input list samples on so their files are
+  // read ahead, or nullptr when inputs are not read through the I/O engine.
+  datautil::AsyncInputReader *getAsyncInputReader() {
+    return (nullptr != m_directReader || InputMapping::NONE != m_inputMapping)
+               ? nullptr
+               : m_asyncInputReader.get();
+  }
+
+  // Waits for output files still being written behind execution, which are
+  // written straight from the output tensor buffers, so call it before they
+  // are reused. Returns FAILURE if any of them could not be written.
+  StatusCode flushOutputs();
+
+  // When enabled, input files are read with O_DIRECT, bypassing the page
+  // cache, and tensor buffers are allocated aligned for it. Takes precedence
+  // over the I/O engine for input reads. Call before setting up tensors.
+  void setInputDirectIo(bool inputDirectIo) {
+    m_directReader.reset(inputDirectIo ? new datautil::DirectFileReader() : nullptr);
+  }
+
+  // When enabled, writeOutputTensors() writes no output files; each sample
+  // becomes a line of output hashes, and optionally min/max/mean of the float
+  // values, on hashStream.
+  void setOutputHash(OutputHash outputHash,
+                     bool withStats,
+                     std::shared_ptr<std::ostream> hashStream) {
+    m_outputHash          = outputHash;
+    m_outputHashWithStats = withStats;
+    m_outputHashStream    = hashStream;
+  }
+
+  void setOutputMapping(bool outputMapping) { m_outputMapping = outputMapping; }
+
+  // When set, output files are created through this planner instead of by
+  // path, see prepareOutputDirs().
+  void setOutputLayout(std::shared_ptr<outputlayout::Planner> outputLayout) {
+    m_outputLayout = outputLayout;
+  }
+
+  // Creates the result directories of count samples from firstSample ahead of
+  // writeOutputTensors(), in one pass. Does nothing without an output layout.
+  StatusCode prepareOutputDirs(uint32_t graphIdx,
+                               char *graphName,
+                               uint32_t graphsCount,
+                               size_t firstSample,
+                               size_t count);
+
+  // When set, writeOutputTensors() compares outputs against the comparator's
+  // references instead of writing them. Takes precedence over output hashes.
+  void setOutputComparator(std::shared_ptr<outputcompare::Comparator> outputComparator) {
+    m_outputComparator = outputComparator;
+  }
+
+  // When set, writeOutputTensors() writes each output of each sample as a
+  // frame to this stream instead of to files.
+  void setOutputStream(std::shared_ptr<framestream::Writer> outputStream) {
+    m_outputStream = outputStream;
+  }
+
+  // When set, outputs are appended to this container instead of being written
+  // to one file per output per sample under Result_N directories.
+  void setOutputContainer(std::shared_ptr<packedcontainer::Writer> outputContainer) {
+    m_outputContainer = outputContainer;
+  }
+
+  // When set, populating each input and writing each output file are
+  // recorded as events of the recorder's current sample.
+  void setFlightRecorder(std::shared_ptr<flightrecorder::Recorder> flightRecorder) {
+    m_flightRecorder = flightRecorder;
+  }
 
   StatusCode setupInputAndOutputTensors(Qnn_Tensor_t **inputs,
                                         Qnn_Tensor_t **outputs,
@@ -56,12 +167,44 @@ class IOTensor {
                                 uint32_t graphsCount,
                                 std::string outputPath);
 
+  // With output mapping enabled, points the client buffer of every output
+  // written in its native type at a writable mapping of its output file, so
+  // graphExecute() produces the file in place and writeOutputTensors() only
+  // has to unmap it. Applies to single sample batches written to files;
+  // anything else is left to writeOutputTensors().
+  StatusCode mapOutputTensors(uint32_t graphIdx,
+                              size_t startIdx,
+                              char *graphName,
+                              Qnn_Tensor_t *outputs,
+                              uint32_t numOutputs,
+                              OutputDataType outputDatatype,
+                              uint32_t graphsCount,
+                              std::string outputPath);
+
   StatusCode populateInputTensors(uint32_t graphIdx,
                                   std::vector<std::queue<std::string>> &filePathsQueue,
                                   Qnn_Tensor_t *inputs,
                                   qnn_wrapper_api::GraphInfo_t graphInfo,
                                   iotensor::InputDataType inputDataType);
 
+  // Populate inputs from a packed dataset container. recordCursors holds, per
+  // container tensor, the index of the next record to consume.
+  StatusCode populateInputTensors(uint32_t graphIdx,
+                                  const packedcontainer::Reader &dataset,
+                                  std::vector<size_t> &recordCursors,
+                                  Qnn_Tensor_t *inputs,
+                                  qnn_wrapper_api::GraphInfo_t graphInfo,
+                                  InputDataType inputDataType);
+
+  // Populate inputs from the next frame of each input tensor, in graph input
+  // order. endOfStream is set, with nothing populated, once the stream ends.
+  StatusCode populateInputTensors(uint32_t graphIdx,
+                                  framestream::Reader &inputStream,
+                                  Qnn_Tensor_t *inputs,
+                                  qnn_wrapper_api::GraphInfo_t graphInfo,
+                                  InputDataType inputDataType,
+                                  bool &endOfStream);
+
   StatusCode populateInputTensors(uint32_t graphIdx,
                                   std::vector<uint8_t *> inputBuffers,
                                   Qnn_Tensor_t *inputs,
@@ -91,8 +234,63 @@ class IOTensor {
   bool deepCopyQnnTensorInfo(Qnn_Tensor_t *dst, const Qnn_Tensor_t *src);
 
  private:
+  // A tensor whose client buffer currently points into a file mapping: an
+  // input mapped from its input file, or an output mapped onto its output
+  // file. ownedData is the buffer allocated in setupTensors, restored before
+  // the tensor is copied into or freed.
+  struct MappedTensor {
+    void *ownedData = nullptr;
+    pal::MappedFile mappedFile;
+  };
+
   size_t m_batchSize;
   size_t m_numFilesPopulated;
+  InputMapping m_inputMapping;
+  bool m_outputMapping;
+  std::map<const Qnn_Tensor_t *, MappedTensor> m_mappedTensors;
+  std::shared_ptr<asyncio::Engine> m_ioEngine;
+  std::unique_ptr<datautil::AsyncInputReader> m_asyncInputReader;
+  std::unique_ptr<datautil::AsyncOutputWriter> m_asyncOutputWriter;
+  datautil::InputFileCache m_inputFileCache;
+  std::unique_ptr<datautil::DirectFileReader> m_directReader;
+  std::shared_ptr<packedcontainer::Writer> m_outputContainer;
+  OutputHash m_outputHash;
+  bool m_outputHashWithStats;
+  std::shared_ptr<std::ostream> m_outputHashStream;
+  std::shared_ptr<outputcompare::Comparator> m_outputComparator;
+  std::shared_ptr<framestream::Writer> m_outputStream;
+  std::shared_ptr<outputlayout::Planner> m_outputLayout;
+  std::shared_ptr<flightrecorder::Recorder> m_flightRecorder;
+  // Staging buffer for float input frames of non-float tensors.
+  std::vector<uint8_t> m_inputStreamBuffer;
+  // Container tensor index by "[graph/]file name".
+  std::map<std::string, uint32_t> m_outputContainerTensors;
+  // Graph directory and first sample index of the writeOutputTensors() call
+  // in progress, used to name container records.
+  std::string m_outputGraphDir;
+  size_t m_outputStartIdx;
+
+  StatusCode mapInputTensor(std::queue<std::string> &filePaths,
+                            Qnn_Tensor_t *input,
+                            std::vector<size_t> dims,
+                            bool &mapped);
+
+  void bindTensor(Qnn_Tensor_t *tensor, void *data, pal::MappedFile mappedFile);
+
+  void releaseMappedTensor(Qnn_Tensor_t *tensor);
+
+  StatusCode populateInputTensor(const packedcontainer::Reader &dataset,
+                                 uint32_t datasetTensorIdx,
+                                 size_t &recordCursor,
+                                 Qnn_Tensor_t *input,
+                                 InputDataType inputDataType);
+
+  StatusCode readBatchDataFromDataset(const packedcontainer::Reader &dataset,
+                                      uint32_t datasetTensorIdx,
+                                      size_t &recordCursor,
+                                      std::vector<size_t> dims,
+                                      Qnn_DataType_t dataType,
+                                      uint8_t *buffer);
 
   StatusCode populateInputTensor(std::queue<std::string> &filePaths,
                                  Qnn_Tensor_t *input,
@@ -100,13 +298,26 @@ class IOTensor {
 
   StatusCode populateInputTensor(uint8_t *buffer, Qnn_Tensor_t *input, InputDataType inputDataType);
 
+  datautil::ReadBatchDataRetType_t readBatchData(std::queue<std::string> &filePaths,
+                                                 std::vector<size_t> dims,
+                                                 Qnn_DataType_t dataType,
+                                                 uint8_t *buffer);
+
+  void registerIoBuffers(Qnn_Tensor_t *outputs, qnn_wrapper_api::GraphInfo_t &graphInfo);
+
+  // Whether output files are written behind execution by m_asyncOutputWriter.
+  bool isWritingBehind() const {
+    return nullptr == m_outputContainer && nullptr != m_outputLayout &&
+           nullptr != m_asyncOutputWriter;
+  }
+
   StatusCode readDataAndAllocateBuffer(std::queue<std::string> &filePaths,
                                        std::vector<size_t> dims,
                                        Qnn_DataType_t dataType,
                                        uint8_t **bufferToCopy);
 
   template <typename T>
-  StatusCode allocateBuffer(T **buffer, size_t &elementCount);
+  StatusCode allocateBuffer(T **buffer, size_t &elementCount, memaccount::Category category);
 
   StatusCode convertToFloat(float **out, Qnn_Tensor_t *output);
 
@@ -118,15 +329,41 @@ class IOTensor {
                                std::vector<std::string> outputPaths,
                                std::string fileName);
 
+  std::string getOutputGraphDir(uint32_t graphIdx, char *graphName, uint32_t graphsCount);
+
+  StatusCode writeOutputHashes(Qnn_Tensor_t *outputs, uint32_t numOutputs);
+
+  StatusCode compareOutputTensors(Qnn_Tensor_t *outputs, uint32_t numOutputs);
+
+  StatusCode writeOutputFrames(Qnn_Tensor_t *outputs,
+                               uint32_t numOutputs,
+                               OutputDataType outputDatatype);
+
+  StatusCode writeBatchData(std::vector<std::string> &outputPaths,
+                            std::string fileName,
+                            std::vector<size_t> dims,
+                            Qnn_DataType_t dataType,
+                            uint8_t *buffer);
+
   StatusCode allocateAndCopyBuffer(uint8_t **buffer, Qnn_Tensor_t *tensor);
 
   StatusCode tearDownTensors(Qnn_Tensor_t *tensors, uint32_t tensorCount);
 
-  StatusCode allocateBuffer(uint8_t **buffer, std::vector<size_t> dims, Qnn_DataType_t dataType);
+  StatusCode allocateBuffer(uint8_t **buffer,
+                            std::vector<size_t> dims,
+                            Qnn_DataType_t dataType,
+                            memaccount::Category category);
 
   StatusCode copyFromFloatToNative(float *floatBuffer, Qnn_Tensor_t *tensor);
 
-  StatusCode setupTensors(Qnn_Tensor_t **tensors, uint32_t tensorCount, Qnn_Tensor_t *tensorsInfo);
+  StatusCode setupTensors(Qnn_Tensor_t **tensors,
+                          uint32_t tensorCount,
+                          Qnn_Tensor_t *tensorsInfo,
+                          memaccount::Category category);
+
+  // Accounts the name, dimensions and quantization parameters that
+  // deepCopyQnnTensorInfo allocated for tensor as metadata.
+  void trackTensorInfo(Qnn_Tensor_t *tensor);
 
   StatusCode fillDims(std::vector<size_t> &dims, uint32_t *inDimensions, uint32_t rank);
 };
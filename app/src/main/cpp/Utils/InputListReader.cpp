@@ -0,0 +1,123 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "InputListReader.hpp"
+#include "Logger.hpp"
+
+using namespace qnn;
+using namespace qnn::tools;
+
+namespace {
+
+// Parsed pages are released in steps of this size.
+const size_t g_releaseStep = 1 << 20;
+
+const char g_nameSeparator[] = ":=";
+
+}  // namespace
+
+inputlist::Reader::Reader()
+    : m_cursor(0), m_releasedOffset(0), m_numSamplesRead(0), m_firstLine(true) {}
+
+inputlist::StatusCode inputlist::Reader::open(const std::string& path) {
+  m_cursor         = 0;
+  m_releasedOffset = 0;
+  m_numSamplesRead = 0;
+  m_firstLine      = true;
+  if (!m_mappedFile.open(path)) {
+    // An empty list cannot be mapped but is still a valid list.
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0 && 0 == st.st_size) {
+      return StatusCode::SUCCESS;
+    }
+    QNN_ERROR("Failed to open input file: %s", path.c_str());
+    return StatusCode::FILE_OPEN_FAIL;
+  }
+  m_mappedFile.advise(pal::MappedFile::Advice::SEQUENTIAL);
+  return StatusCode::SUCCESS;
+}
+
+bool inputlist::Reader::nextLine(const char*& begin, const char*& end) {
+  const char* data = reinterpret_cast<const char*>(m_mappedFile.data());
+  size_t size      = m_mappedFile.size();
+  while (m_cursor < size) {
+    begin               = data + m_cursor;
+    const char* newline = static_cast<const char*>(memchr(begin, '\n', size - m_cursor));
+    end                 = (nullptr != newline) ? newline : data + size;
+    m_cursor            = std::min(static_cast<size_t>(end - data) + 1, size);
+    if (end == begin) {
+      continue;
+    }
+    if (m_firstLine) {
+      m_firstLine = false;
+      if ('#' == *begin) {
+        continue;
+      }
+    }
+    return true;
+  }
+  return false;
+}
+
+size_t inputlist::Reader::readSamples(std::vector<std::queue<std::string>>& filePathsQueues,
+                                      size_t maxSamples,
+                                      readahead::Scheduler* readahead,
+                                      datautil::AsyncInputReader* asyncReader) {
+  size_t numSamples = 0;
+  bool queueSamples = nullptr != readahead || nullptr != asyncReader;
+  std::vector<std::string> sampleEntries;
+  const char* lineBegin;
+  const char* lineEnd;
+  while (numSamples < maxSamples && nextLine(lineBegin, lineEnd)) {
+    size_t idx = 0;
+    sampleEntries.clear();
+    for (const char* entry = lineBegin; entry < lineEnd;) {
+      const char* space =
+          static_cast<const char*>(memchr(entry, ' ', static_cast<size_t>(lineEnd - entry)));
+      const char* entryEnd = (nullptr != space) ? space : lineEnd;
+      if (entryEnd > entry) {
+        const char* path = entry;
+        for (const char* c = entry; c + 1 < entryEnd; c++) {
+          if (c[0] == g_nameSeparator[0] && c[1] == g_nameSeparator[1]) {
+            path = c + 2;
+            break;
+          }
+        }
+        if (idx >= filePathsQueues.size()) {
+          filePathsQueues.push_back(std::queue<std::string>());
+        }
+        filePathsQueues[idx].push(std::string(path, static_cast<size_t>(entryEnd - path)));
+        if (queueSamples) {
+          sampleEntries.push_back(filePathsQueues[idx].back());
+        }
+        idx++;
+      }
+      entry = entryEnd + 1;
+    }
+    if (idx > 0) {
+      numSamples++;
+      if (nullptr != readahead) {
+        readahead->addSample(sampleEntries);
+      }
+      if (nullptr != asyncReader) {
+        asyncReader->addSample(sampleEntries);
+      }
+    }
+  }
+  m_numSamplesRead += numSamples;
+  if (m_cursor - m_releasedOffset >= g_releaseStep || isExhausted()) {
+    m_mappedFile.advise(
+        pal::MappedFile::Advice::DONTNEED, m_releasedOffset, m_cursor - m_releasedOffset);
+    m_releasedOffset = m_cursor;
+  }
+  return numSamples;
+}
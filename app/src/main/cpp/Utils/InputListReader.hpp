@@ -0,0 +1,71 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+#pragma once
+
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "PAL/MappedFile.hpp"
+#include "Readahead.hpp"
+
+namespace qnn {
+namespace tools {
+namespace inputlist {
+
+enum class StatusCode {
+  SUCCESS,
+  FILE_OPEN_FAIL,
+};
+
+/*
+ * Streaming parser for input list text files. The list is mapped rather than
+ * read, lines are found with memchr, and samples are only turned into paths
+ * when the executor asks for them, so startup cost and memory do not depend
+ * on the length of the list. Pages that have been parsed are dropped from the
+ * mapping as the cursor moves on.
+ *
+ * Parsing rules are those of app::readInputList: empty lines are skipped, a
+ * first line starting with '#' is a comment, entries are separated by spaces
+ * and may be written as <tensor name>:=<path>. Paths may name a byte range of
+ * a file as path@offset+length, see datautil::FileRange.
+ */
+class Reader {
+ public:
+  Reader();
+
+  StatusCode open(const std::string &path);
+
+  // Parses up to maxSamples more lines, pushing each entry of a line onto the
+  // queue of the input tensor at the same position. Returns the number of
+  // samples parsed, zero once the list is exhausted. Each parsed sample is
+  // also queued on readahead and asyncReader, if set.
+  size_t readSamples(std::vector<std::queue<std::string>> &filePathsQueues,
+                     size_t maxSamples,
+                     readahead::Scheduler *readahead = nullptr,
+                     datautil::AsyncInputReader *asyncReader = nullptr);
+
+  bool isExhausted() const { return m_cursor >= m_mappedFile.size(); }
+
+  // Samples parsed so far. Lines without entries do not count.
+  size_t getNumSamplesRead() const { return m_numSamplesRead; }
+
+ private:
+  // Returns the next non-empty line as [begin, end), or false at the end.
+  bool nextLine(const char *&begin, const char *&end);
+
+  pal::MappedFile m_mappedFile;
+  size_t m_cursor;
+  size_t m_releasedOffset;
+  size_t m_numSamplesRead;
+  bool m_firstLine;
+};
+
+}  // namespace inputlist
+}  // namespace tools
+}  // namespace qnn
@@ -0,0 +1,209 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "MemoryAccounting.hpp"
+#include "SysUtil.hpp"
+
+using namespace qnn;
+using namespace qnn::tools;
+
+namespace {
+
+// Fixed size line for the report, formatted without allocating so that it
+// can be written from a signal handler.
+class ReportLine {
+ public:
+  ReportLine() : m_length(0) {}
+
+  // Left aligned in width.
+  void append(const char* text, size_t width = 0) {
+    size_t length = strlen(text);
+    copy(text, length);
+    pad(length, width);
+  }
+
+  // Right aligned in width.
+  void appendRight(const char* text, size_t width) {
+    size_t length = strlen(text);
+    pad(length, width);
+    copy(text, length);
+  }
+
+  // Right aligned in width.
+  void appendNumber(uint64_t value, size_t width) {
+    char digits[24];
+    size_t numDigits = 0;
+    do {
+      digits[numDigits++] = static_cast<char>('0' + value % 10);
+      value /= 10;
+    } while (0 != value);
+    pad(numDigits, width);
+    while (numDigits > 0 && m_length < sizeof(m_data)) {
+      m_data[m_length++] = digits[--numDigits];
+    }
+  }
+
+  void write(int fd) {
+    append("\n");
+    sysutil::writeAll(fd, m_data, m_length);
+    m_length = 0;
+  }
+
+ private:
+  void copy(const char* text, size_t length) {
+    for (size_t idx = 0; idx < length && m_length < sizeof(m_data); idx++) {
+      m_data[m_length++] = text[idx];
+    }
+  }
+
+  void pad(size_t length, size_t width) {
+    for (; length < width && m_length < sizeof(m_data); length++) {
+      m_data[m_length++] = ' ';
+    }
+  }
+
+  char m_data[128];
+  size_t m_length;
+};
+
+void writeReportOnSignal(int) { memaccount::getAccountant().writeReport(STDERR_FILENO); }
+
+}  // namespace
+
+const char* memaccount::getCategoryName(Category category) {
+  switch (category) {
+    case Category::INPUT:
+      return "input";
+    case Category::OUTPUT:
+      return "output";
+    case Category::SCRATCH:
+      return "scratch";
+    case Category::METADATA:
+      return "metadata";
+  }
+  return "unknown";
+}
+
+void memaccount::Accountant::Usage::add(uint64_t size) {
+  uint64_t newCurrent = current.fetch_add(size, std::memory_order_relaxed) + size;
+  uint64_t oldPeak    = peak.load(std::memory_order_relaxed);
+  while (oldPeak < newCurrent &&
+         !peak.compare_exchange_weak(oldPeak, newCurrent, std::memory_order_relaxed)) {
+  }
+}
+
+void* memaccount::Accountant::allocate(size_t size, Category category) {
+  void* ptr = malloc(size);
+  track(ptr, size, category);
+  return ptr;
+}
+
+void* memaccount::Accountant::allocateZeroed(size_t size, Category category) {
+  void* ptr = calloc(1, size);
+  track(ptr, size, category);
+  return ptr;
+}
+
+void* memaccount::Accountant::allocateAligned(size_t alignment, size_t size, Category category) {
+  void* ptr = nullptr;
+  if (0 != posix_memalign(&ptr, alignment, size)) {
+    return nullptr;
+  }
+  track(ptr, size, category);
+  return ptr;
+}
+
+void memaccount::Accountant::track(void* ptr, size_t size, Category category) {
+  if (nullptr == ptr || !isEnabled()) {
+    return;
+  }
+  Allocation allocation;
+  allocation.size     = size;
+  allocation.category = category;
+  allocation.graphIdx = m_graphIdx.load(std::memory_order_relaxed);
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_allocations[ptr] = allocation;
+  }
+  m_usage[allocation.graphIdx][static_cast<size_t>(category)].add(size);
+  m_total.add(size);
+}
+
+void memaccount::Accountant::release(void* ptr) {
+  if (nullptr == ptr) {
+    return;
+  }
+  Allocation allocation;
+  bool tracked = false;
+  if (isEnabled()) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto found = m_allocations.find(ptr);
+    if (found != m_allocations.end()) {
+      allocation = found->second;
+      tracked    = true;
+      m_allocations.erase(found);
+    }
+  }
+  if (tracked) {
+    m_usage[allocation.graphIdx][static_cast<size_t>(allocation.category)].subtract(
+        allocation.size);
+    m_total.subtract(allocation.size);
+  }
+  free(ptr);
+}
+
+void memaccount::Accountant::writeReport(int fd) const {
+  ReportLine line;
+  line.append("Tensor memory (bytes):");
+  line.write(fd);
+  line.append("graph", 8);
+  line.append("category", 10);
+  line.appendRight("current", 16);
+  line.appendRight("peak", 16);
+  line.write(fd);
+  for (size_t graphIdx = 0; graphIdx <= g_maxGraphs; graphIdx++) {
+    for (size_t categoryIdx = 0; categoryIdx < g_numCategories; categoryIdx++) {
+      const Usage& usage = m_usage[graphIdx][categoryIdx];
+      uint64_t peak      = usage.peak.load(std::memory_order_relaxed);
+      if (0 == peak) {
+        continue;
+      }
+      // The overflow bucket reads as "16+".
+      line.appendNumber(graphIdx, 5);
+      line.append(graphIdx < g_maxGraphs ? "" : "+", 3);
+      line.append(getCategoryName(static_cast<Category>(categoryIdx)), 10);
+      line.appendNumber(usage.current.load(std::memory_order_relaxed), 16);
+      line.appendNumber(peak, 16);
+      line.write(fd);
+    }
+  }
+  line.append("total", 18);
+  line.appendNumber(m_total.current.load(std::memory_order_relaxed), 16);
+  line.appendNumber(m_total.peak.load(std::memory_order_relaxed), 16);
+  line.write(fd);
+}
+
+memaccount::Accountant& memaccount::getAccountant() {
+  static Accountant s_accountant;
+  return s_accountant;
+}
+
+bool memaccount::installReportHandler(int signalNumber) {
+  // Construct the accountant before the handler can run.
+  getAccountant();
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = writeReportOnSignal;
+  action.sa_flags   = SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  return 0 == sigaction(signalNumber, &action, nullptr);
+}
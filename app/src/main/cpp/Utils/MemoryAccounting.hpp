@@ -0,0 +1,140 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+namespace qnn {
+namespace tools {
+namespace memaccount {
+
+enum class Category : uint8_t {
+  // Tensor client buffers of graph inputs.
+  INPUT,
+  // Tensor client buffers of graph outputs.
+  OUTPUT,
+  // Per sample buffers: files read before conversion, dequantized outputs
+  // and staging for direct reads.
+  SCRATCH,
+  // Tensor arrays, names, dimensions and quantization parameters.
+  METADATA,
+};
+
+const size_t g_numCategories = 4;
+
+// Graphs from this index on share one bucket, reported as g_maxGraphs+.
+const size_t g_maxGraphs = 16;
+
+const char *getCategoryName(Category category);
+
+/*
+ * Accounts host allocations of tensor memory to a category and to the graph
+ * set with setGraph(), keeping current and peak bytes of each and of their
+ * total. Memory allocated through the accountant, or tracked after the fact,
+ * must be freed with release(); release() of any other pointer just frees
+ * it. Nothing is accounted until enable() is called, so allocations cost no
+ * more than malloc() and free() when no report was asked for.
+ */
+class Accountant {
+ public:
+  Accountant() = default;
+
+  Accountant(const Accountant &) = delete;
+  Accountant &operator=(const Accountant &) = delete;
+
+  // Accounts allocations from now on. Cannot be undone, so every accounted
+  // pointer is found again by release().
+  void enable() { m_enabled.store(true, std::memory_order_relaxed); }
+
+  bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+  void *allocate(size_t size, Category category);
+
+  void *allocateZeroed(size_t size, Category category);
+
+  // Returns nullptr if posix_memalign fails.
+  void *allocateAligned(size_t alignment, size_t size, Category category);
+
+  // Accounts size bytes at ptr, allocated with malloc by someone else.
+  void track(void *ptr, size_t size, Category category);
+
+  void release(void *ptr);
+
+  // Graph that following allocations are accounted to.
+  void setGraph(uint32_t graphIdx) {
+    m_graphIdx.store(graphIdx < g_maxGraphs ? graphIdx : static_cast<uint32_t>(g_maxGraphs),
+                     std::memory_order_relaxed);
+  }
+
+  uint64_t getCurrentBytes() const { return m_total.current.load(std::memory_order_relaxed); }
+
+  uint64_t getPeakBytes() const { return m_total.peak.load(std::memory_order_relaxed); }
+
+  // Writes current and peak bytes per graph and category, and in total, to
+  // fd. Only reads atomics and calls write(), so it is safe in a signal
+  // handler.
+  void writeReport(int fd) const;
+
+ private:
+  struct Usage {
+    std::atomic<uint64_t> current{0};
+    std::atomic<uint64_t> peak{0};
+
+    void add(uint64_t size);
+
+    void subtract(uint64_t size) { current.fetch_sub(size, std::memory_order_relaxed); }
+  };
+
+  struct Allocation {
+    size_t size;
+    Category category;
+    uint32_t graphIdx;
+  };
+
+  std::atomic<bool> m_enabled{false};
+  std::mutex m_mutex;
+  std::unordered_map<void *, Allocation> m_allocations;
+  std::atomic<uint32_t> m_graphIdx{0};
+  // The last row is the bucket of graphs past g_maxGraphs.
+  Usage m_usage[g_maxGraphs + 1][g_numCategories];
+  Usage m_total;
+};
+
+Accountant &getAccountant();
+
+// Releases a pointer allocated through getAccountant() when it goes out of
+// scope.
+class ScopedRelease {
+ public:
+  explicit ScopedRelease(void *ptr = nullptr) : m_ptr(ptr) {}
+  ~ScopedRelease() { getAccountant().release(m_ptr); }
+
+  // Releases the pointer held so far and takes ptr instead.
+  void reset(void *ptr) {
+    getAccountant().release(m_ptr);
+    m_ptr = ptr;
+  }
+
+  ScopedRelease(const ScopedRelease &) = delete;
+  ScopedRelease &operator=(const ScopedRelease &) = delete;
+
+ private:
+  void *m_ptr;
+};
+
+// Writes the report of getAccountant() to stderr whenever signalNumber is
+// received.
+bool installReportHandler(int signalNumber);
+
+}  // namespace memaccount
+}  // namespace tools
+}  // namespace qnn
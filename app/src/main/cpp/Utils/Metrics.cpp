@@ -0,0 +1,199 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+#include <stdio.h>
+#include <unistd.h>
+
+#include <system_error>
+
+#include "Logger.hpp"
+#include "Metrics.hpp"
+
+using namespace qnn;
+using namespace qnn::tools;
+
+namespace {
+
+// Bounds of exported latency buckets, in nanoseconds.
+const uint64_t g_minExportedLatency = 1000ull;
+const uint64_t g_maxExportedLatency = 60000000000ull;
+
+std::string formatDouble(double value) {
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%.9g", value);
+  return std::string(buffer);
+}
+
+}  // namespace
+
+metrics::Histogram::Histogram(double unitScale, uint64_t minExported, uint64_t maxExported)
+    : m_unitScale(unitScale), m_minExported(minExported), m_maxExported(maxExported), m_sum(0) {
+  for (auto& bucket : m_buckets) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+}
+
+uint64_t metrics::Histogram::getUpperBound(size_t index) {
+  if (index < 2 * s_subBuckets) {
+    return index + 1;
+  }
+  size_t exponent  = index / s_subBuckets + s_subBucketBits - 1;
+  size_t subBucket = index % s_subBuckets;
+  if (exponent >= 63 && subBucket == s_subBuckets - 1) {
+    return UINT64_MAX;
+  }
+  return static_cast<uint64_t>(s_subBuckets + subBucket + 1) << (exponent - s_subBucketBits);
+}
+
+void metrics::Histogram::format(const std::string& name, std::string& out) const {
+  uint64_t count = 0;
+  for (size_t idx = 0; idx < s_numBuckets; idx++) {
+    count += m_buckets[idx].load(std::memory_order_relaxed);
+    uint64_t upperBound = getUpperBound(idx);
+    if (upperBound < m_minExported || upperBound > m_maxExported) {
+      continue;
+    }
+    out += name + "_bucket{le=\"" + formatDouble(static_cast<double>(upperBound) * m_unitScale) +
+           "\"} " + std::to_string(count) + "\n";
+  }
+  out += name + "_bucket{le=\"+Inf\"} " + std::to_string(count) + "\n";
+  out += name + "_sum " +
+         formatDouble(static_cast<double>(m_sum.load(std::memory_order_relaxed)) * m_unitScale) +
+         "\n";
+  out += name + "_count " + std::to_string(count) + "\n";
+}
+
+metrics::Registry::Entry& metrics::Registry::getEntry(const std::string& name,
+                                                      const std::string& help,
+                                                      Type type) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (auto& entry : m_entries) {
+    if (entry->name == name) {
+      return *entry;
+    }
+  }
+  std::unique_ptr<Entry> entry(new Entry());
+  entry->name = name;
+  entry->help = help;
+  entry->type = type;
+  switch (type) {
+    case Type::COUNTER:
+      entry->counter.reset(new Counter());
+      break;
+    case Type::GAUGE:
+      entry->gauge.reset(new Gauge());
+      break;
+    case Type::HISTOGRAM:
+      entry->histogram.reset(new Histogram(1e-9, g_minExportedLatency, g_maxExportedLatency));
+      break;
+  }
+  m_entries.push_back(std::move(entry));
+  return *m_entries.back();
+}
+
+metrics::Counter& metrics::Registry::addCounter(const std::string& name,
+                                                const std::string& help) {
+  return *getEntry(name, help, Type::COUNTER).counter;
+}
+
+metrics::Gauge& metrics::Registry::addGauge(const std::string& name, const std::string& help) {
+  return *getEntry(name, help, Type::GAUGE).gauge;
+}
+
+metrics::Histogram& metrics::Registry::addLatencyHistogram(const std::string& name,
+                                                           const std::string& help) {
+  return *getEntry(name, help, Type::HISTOGRAM).histogram;
+}
+
+std::string metrics::Registry::format() const {
+  std::string out;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (auto const& entry : m_entries) {
+    out += "# HELP " + entry->name + " " + entry->help + "\n";
+    switch (entry->type) {
+      case Type::COUNTER:
+        out += "# TYPE " + entry->name + " counter\n";
+        out += entry->name + " " + std::to_string(entry->counter->get()) + "\n";
+        break;
+      case Type::GAUGE:
+        out += "# TYPE " + entry->name + " gauge\n";
+        out += entry->name + " " + std::to_string(entry->gauge->get()) + "\n";
+        break;
+      case Type::HISTOGRAM:
+        out += "# TYPE " + entry->name + " histogram\n";
+        entry->histogram->format(entry->name, out);
+        break;
+    }
+  }
+  return out;
+}
+
+metrics::Registry& metrics::getRegistry() {
+  static Registry s_registry;
+  return s_registry;
+}
+
+metrics::Exporter::~Exporter() { stop(); }
+
+metrics::StatusCode metrics::Exporter::start(const std::string& path,
+                                             std::chrono::milliseconds interval) {
+  m_path          = path;
+  m_interval      = interval;
+  m_stopRequested = false;
+
+  StatusCode returnStatus = write();
+  if (StatusCode::SUCCESS != returnStatus) {
+    return returnStatus;
+  }
+  try {
+    m_thread = std::thread(&Exporter::run, this);
+  } catch (const std::system_error& e) {
+    QNN_ERROR("Failed to start the metrics exporter: %s", e.what());
+    return StatusCode::THREAD_START_FAIL;
+  }
+  return StatusCode::SUCCESS;
+}
+
+void metrics::Exporter::stop() {
+  if (!m_thread.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopRequested = true;
+  }
+  m_wake.notify_one();
+  m_thread.join();
+  write();
+}
+
+metrics::StatusCode metrics::Exporter::write() {
+  std::string text    = getRegistry().format();
+  std::string tmpPath = m_path + ".tmp";
+  FILE* file          = fopen(tmpPath.c_str(), "w");
+  if (nullptr == file) {
+    QNN_ERROR("Failed to create metrics file: %s", tmpPath.c_str());
+    return StatusCode::FILE_WRITE_FAIL;
+  }
+  bool written = fwrite(text.data(), 1, text.size(), file) == text.size();
+  written      = (0 == fclose(file)) && written;
+  if (!written || 0 != rename(tmpPath.c_str(), m_path.c_str())) {
+    QNN_ERROR("Failed to write metrics file: %s", m_path.c_str());
+    unlink(tmpPath.c_str());
+    return StatusCode::FILE_WRITE_FAIL;
+  }
+  return StatusCode::SUCCESS;
+}
+
+void metrics::Exporter::run() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (!m_wake.wait_for(lock, m_interval, [this]() { return m_stopRequested; })) {
+    lock.unlock();
+    write();
+    lock.lock();
+  }
+}
@@ -0,0 +1,206 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace qnn {
+namespace tools {
+namespace metrics {
+
+enum class StatusCode {
+  SUCCESS,
+  FILE_WRITE_FAIL,
+  THREAD_START_FAIL,
+};
+
+// Monotonically increasing count, e.g. of executions or bytes.
+class Counter {
+ public:
+  void add(uint64_t value = 1) { m_value.fetch_add(value, std::memory_order_relaxed); }
+
+  uint64_t get() const { return m_value.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<uint64_t> m_value{0};
+};
+
+// Value that can go up and down, e.g. a queue depth.
+class Gauge {
+ public:
+  void set(int64_t value) { m_value.store(value, std::memory_order_relaxed); }
+
+  void add(int64_t value) { m_value.fetch_add(value, std::memory_order_relaxed); }
+
+  int64_t get() const { return m_value.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<int64_t> m_value{0};
+};
+
+/*
+ * Log-linear histogram of integral values, e.g. nanoseconds. Every power of
+ * two is split into s_subBuckets linear buckets, so the relative error of a
+ * bucket bound is below 1/s_subBuckets at any magnitude, and observing a
+ * value is two relaxed atomic increments with no lock.
+ *
+ * Bucket i holds the values in (getUpperBound(i - 1), getUpperBound(i)].
+ */
+class Histogram {
+ public:
+  static const size_t s_subBucketBits = 2;
+  static const size_t s_subBuckets    = 1 << s_subBucketBits;
+  static const size_t s_numBuckets    = (64 - s_subBucketBits + 1) * s_subBuckets;
+
+  // Exported bucket bounds and sums are values times unitScale, e.g. 1e-9
+  // for nanoseconds exported as seconds. Only the buckets with bounds in
+  // [minExported, maxExported], in recorded units, are exported, so the
+  // exposition stays short.
+  Histogram(double unitScale, uint64_t minExported, uint64_t maxExported);
+
+  void observe(uint64_t value) {
+    m_buckets[getBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  static size_t getBucketIndex(uint64_t value) {
+    uint64_t bound = (value > 0) ? value - 1 : 0;
+    if (bound < 2 * s_subBuckets) {
+      return static_cast<size_t>(bound);
+    }
+    size_t exponent = 63 - static_cast<size_t>(__builtin_clzll(bound));
+    size_t subBucket =
+        static_cast<size_t>(bound >> (exponent - s_subBucketBits)) & (s_subBuckets - 1);
+    return (exponent - s_subBucketBits + 1) * s_subBuckets + subBucket;
+  }
+
+  static uint64_t getUpperBound(size_t index);
+
+  // Appends the histogram in Prometheus text format. Buckets are read one by
+  // one while observations may continue, so the count is taken as their sum.
+  void format(const std::string &name, std::string &out) const;
+
+ private:
+  double m_unitScale;
+  uint64_t m_minExported;
+  uint64_t m_maxExported;
+  std::atomic<uint64_t> m_buckets[s_numBuckets];
+  std::atomic<uint64_t> m_sum;
+};
+
+// Records the time from construction to destruction, in nanoseconds.
+class ScopedTimer {
+ public:
+  explicit ScopedTimer(Histogram &histogram)
+      : m_histogram(histogram), m_start(std::chrono::steady_clock::now()) {}
+
+  ~ScopedTimer() {
+    auto elapsed = std::chrono::steady_clock::now() - m_start;
+    m_histogram.observe(static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+  }
+
+  ScopedTimer(const ScopedTimer &) = delete;
+  ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+ private:
+  Histogram &m_histogram;
+  std::chrono::steady_clock::time_point m_start;
+};
+
+/*
+ * Process wide set of named metrics. Modules register their metrics once,
+ * typically at static initialization, and keep the returned reference;
+ * updating a metric never touches the registry. Registering a name again
+ * returns the existing metric.
+ */
+class Registry {
+ public:
+  Registry() = default;
+
+  Registry(const Registry &) = delete;
+  Registry &operator=(const Registry &) = delete;
+
+  Counter &addCounter(const std::string &name, const std::string &help);
+
+  Gauge &addGauge(const std::string &name, const std::string &help);
+
+  // A latency histogram in nanoseconds, exported in seconds from 1 us to
+  // about a minute.
+  Histogram &addLatencyHistogram(const std::string &name, const std::string &help);
+
+  // Returns every metric in Prometheus text exposition format.
+  std::string format() const;
+
+ private:
+  enum class Type { COUNTER, GAUGE, HISTOGRAM };
+
+  struct Entry {
+    std::string name;
+    std::string help;
+    Type type;
+    std::unique_ptr<Counter> counter;
+    std::unique_ptr<Gauge> gauge;
+    std::unique_ptr<Histogram> histogram;
+  };
+
+  // Returns the entry named name, adding it if needed.
+  Entry &getEntry(const std::string &name, const std::string &help, Type type);
+
+  mutable std::mutex m_mutex;
+  std::vector<std::unique_ptr<Entry>> m_entries;
+};
+
+Registry &getRegistry();
+
+/*
+ * Writes the registry to a Prometheus text file periodically and once more
+ * when stopped, for a textfile collector to scrape. Each snapshot is
+ * written to a temporary file and renamed over path, so readers never see a
+ * partial one.
+ */
+class Exporter {
+ public:
+  Exporter() = default;
+
+  ~Exporter();
+
+  Exporter(const Exporter &) = delete;
+  Exporter &operator=(const Exporter &) = delete;
+
+  // Writes a first snapshot, then one every interval until stop().
+  StatusCode start(const std::string &path, std::chrono::milliseconds interval);
+
+  // Writes the last snapshot and stops the thread. Safe to call twice.
+  void stop();
+
+  StatusCode write();
+
+ private:
+  void run();
+
+  std::string m_path;
+  std::chrono::milliseconds m_interval{0};
+  std::thread m_thread;
+  std::mutex m_mutex;
+  std::condition_variable m_wake;
+  bool m_stopRequested = false;
+};
+
+}  // namespace metrics
+}  // namespace tools
+}  // namespace qnn
@@ -0,0 +1,234 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+#include <algorithm>
+#include <cmath>
+
+#include "Logger.hpp"
+#include "OutputCompare.hpp"
+#include "PAL/FileOp.hpp"
+#include "PAL/Path.hpp"
+
+using namespace qnn;
+using namespace qnn::tools;
+
+namespace {
+
+const size_t g_lanes = 8;
+// Lane sums are folded into double precision totals after each block so
+// float accumulation error stays bounded on large outputs.
+const size_t g_blockSize = 1024;
+
+}  // namespace
+
+outputcompare::Metrics outputcompare::compareFloat(const float* actual,
+                                                   const float* reference,
+                                                   size_t count) {
+  double dot           = 0.0;
+  double actualNorm    = 0.0;
+  double referenceNorm = 0.0;
+  double errorNorm     = 0.0;
+  float maxAbsError    = 0.0f;
+  size_t numExact      = 0;
+  size_t i             = 0;
+  while (i < count) {
+    size_t blockEnd                  = std::min(count, i + g_blockSize);
+    size_t vectorEnd                 = i + (blockEnd - i) / g_lanes * g_lanes;
+    float laneDot[g_lanes]           = {};
+    float laneActualNorm[g_lanes]    = {};
+    float laneReferenceNorm[g_lanes] = {};
+    float laneErrorNorm[g_lanes]     = {};
+    float laneMaxAbs[g_lanes]        = {};
+    uint32_t laneExact[g_lanes]      = {};
+    for (; i < vectorEnd; i += g_lanes) {
+      for (size_t l = 0; l < g_lanes; l++) {
+        float a = actual[i + l];
+        float r = reference[i + l];
+        float e = a - r;
+        laneDot[l] += a * r;
+        laneActualNorm[l] += a * a;
+        laneReferenceNorm[l] += r * r;
+        laneErrorNorm[l] += e * e;
+        laneMaxAbs[l] = std::max(laneMaxAbs[l], std::fabs(e));
+        laneExact[l] += (a == r) ? 1 : 0;
+      }
+    }
+    for (; i < blockEnd; i++) {
+      float a = actual[i];
+      float r = reference[i];
+      float e = a - r;
+      laneDot[0] += a * r;
+      laneActualNorm[0] += a * a;
+      laneReferenceNorm[0] += r * r;
+      laneErrorNorm[0] += e * e;
+      laneMaxAbs[0] = std::max(laneMaxAbs[0], std::fabs(e));
+      laneExact[0] += (a == r) ? 1 : 0;
+    }
+    for (size_t l = 0; l < g_lanes; l++) {
+      dot += laneDot[l];
+      actualNorm += laneActualNorm[l];
+      referenceNorm += laneReferenceNorm[l];
+      errorNorm += laneErrorNorm[l];
+      maxAbsError = std::max(maxAbsError, laneMaxAbs[l]);
+      numExact += laneExact[l];
+    }
+  }
+
+  Metrics metrics;
+  metrics.numElements = count;
+  metrics.numExact    = numExact;
+  metrics.maxAbsError = maxAbsError;
+  if (0.0 == actualNorm && 0.0 == referenceNorm) {
+    metrics.cosine = 1.0;
+  } else if (0.0 == actualNorm || 0.0 == referenceNorm) {
+    metrics.cosine = 0.0;
+  } else {
+    metrics.cosine = dot / std::sqrt(actualNorm * referenceNorm);
+  }
+  if (0.0 != errorNorm) {
+    metrics.sqnr = 10.0 * std::log10(referenceNorm / errorNorm);
+  }
+  // NaNs are lost by std::max but always reach the error norm.
+  if (std::isnan(errorNorm)) {
+    metrics.maxAbsError = std::numeric_limits<float>::quiet_NaN();
+    metrics.sqnr        = std::numeric_limits<double>::quiet_NaN();
+  }
+  return metrics;
+}
+
+bool outputcompare::isWithinTolerance(const Metrics& metrics, const Tolerance& tolerance) {
+  // Written so that NaN metrics fail every bound.
+  return metrics.maxAbsError <= tolerance.maxAbsError && metrics.cosine >= tolerance.minCosine &&
+         metrics.sqnr >= tolerance.minSqnr;
+}
+
+outputcompare::StatusCode outputcompare::Comparator::open(const std::string& referencePath) {
+  if (packedcontainer::Reader::isContainer(referencePath)) {
+    if (packedcontainer::StatusCode::SUCCESS != m_container.open(referencePath)) {
+      return StatusCode::FAILURE;
+    }
+    if (packedcontainer::Kind::OUTPUT_RESULTS != m_container.getKind()) {
+      QNN_ERROR("Reference container does not hold output results: %s", referencePath.c_str());
+      return StatusCode::FAILURE;
+    }
+    m_isContainer = true;
+    m_sampleRecords.assign(m_container.getNumTensors(), std::vector<uint64_t>());
+    for (uint64_t recordIdx = 0; recordIdx < m_container.getNumRecords(); recordIdx++) {
+      const packedcontainer::RecordEntry& record = m_container.getRecord(recordIdx);
+      auto& sampleRecords                        = m_sampleRecords[record.tensorIdx];
+      // Each sample has at most one record per tensor, so a larger index
+      // can only come from a corrupt container.
+      if (record.sampleIdx >= m_container.getNumRecords()) {
+        QNN_ERROR("Reference container record %llu has an invalid sample index %llu: %s",
+                  static_cast<unsigned long long>(recordIdx),
+                  static_cast<unsigned long long>(record.sampleIdx),
+                  referencePath.c_str());
+        return StatusCode::FAILURE;
+      }
+      if (record.sampleIdx >= sampleRecords.size()) {
+        sampleRecords.resize(record.sampleIdx + 1, 0);
+      }
+      sampleRecords[record.sampleIdx] = recordIdx + 1;
+    }
+    // Outputs are compared in the order the container was written.
+    m_container.advise(pal::MappedFile::Advice::SEQUENTIAL);
+    return StatusCode::SUCCESS;
+  }
+  if (!pal::FileOp::checkFileExists(referencePath)) {
+    QNN_ERROR("Reference outputs not found: %s", referencePath.c_str());
+    return StatusCode::FAILURE;
+  }
+  m_referenceDir = referencePath;
+  return StatusCode::SUCCESS;
+}
+
+const uint8_t* outputcompare::Comparator::findReference(const std::string& name,
+                                                        uint64_t sampleIdx,
+                                                        size_t& length) {
+  if (m_isContainer) {
+    uint32_t tensorIdx = m_container.findTensor(name);
+    if (tensorIdx >= m_container.getNumTensors() ||
+        sampleIdx >= m_sampleRecords[tensorIdx].size() ||
+        0 == m_sampleRecords[tensorIdx][sampleIdx]) {
+      return nullptr;
+    }
+    uint64_t recordIdx = m_sampleRecords[tensorIdx][sampleIdx] - 1;
+    length             = static_cast<size_t>(m_container.getRecord(recordIdx).length);
+    return m_container.getRecordData(recordIdx);
+  }
+  const std::string separator(1, pal::Path::getSeparator());
+  std::string graphDir = m_referenceDir;
+  std::string fileName = name;
+  size_t slash         = name.rfind('/');
+  if (slash != std::string::npos) {
+    graphDir += separator + name.substr(0, slash);
+    fileName = name.substr(slash + 1);
+  }
+  std::string path = graphDir + separator + "Result_" + std::to_string(sampleIdx) + separator +
+                     fileName;
+  if (!m_mappedFile.open(path)) {
+    return nullptr;
+  }
+  m_mappedFile.advise(pal::MappedFile::Advice::SEQUENTIAL);
+  length = m_mappedFile.size();
+  return m_mappedFile.data();
+}
+
+bool outputcompare::Comparator::check(const std::string& label, const Metrics& metrics) {
+  m_numCompared++;
+  m_totalElements += metrics.numElements;
+  m_totalExact += metrics.numExact;
+  // std::max/min would let NaNs disappear from the summary.
+  if (!(metrics.maxAbsError <= m_worst.maxAbsError)) {
+    m_worst.maxAbsError = metrics.maxAbsError;
+  }
+  if (!(metrics.cosine >= m_worst.cosine)) {
+    m_worst.cosine = metrics.cosine;
+  }
+  if (!(metrics.sqnr >= m_worst.sqnr)) {
+    m_worst.sqnr = metrics.sqnr;
+  }
+  bool passed = isWithinTolerance(metrics, m_tolerance);
+  if (!passed) {
+    m_numFailed++;
+    QNN_ERROR("%s out of tolerance: max_abs=%g cosine=%.6f sqnr=%.2f dB exact=%zu/%zu",
+              label.c_str(),
+              metrics.maxAbsError,
+              metrics.cosine,
+              metrics.sqnr,
+              metrics.numExact,
+              metrics.numElements);
+  } else {
+    QNN_DEBUG("%s: max_abs=%g cosine=%.6f sqnr=%.2f dB exact=%zu/%zu",
+              label.c_str(),
+              metrics.maxAbsError,
+              metrics.cosine,
+              metrics.sqnr,
+              metrics.numExact,
+              metrics.numElements);
+  }
+  return passed;
+}
+
+void outputcompare::Comparator::recordFailure(const std::string& label,
+                                              const std::string& reason) {
+  m_numCompared++;
+  m_numFailed++;
+  QNN_ERROR("%s: %s", label.c_str(), reason.c_str());
+}
+
+void outputcompare::Comparator::logSummary() const {
+  QNN_INFO("Compared %zu outputs, %zu failed. Worst max_abs=%g cosine=%.6f sqnr=%.2f dB, "
+           "exact %zu/%zu elements",
+           m_numCompared,
+           m_numFailed,
+           m_worst.maxAbsError,
+           m_worst.cosine,
+           m_worst.sqnr,
+           m_totalExact,
+           m_totalElements);
+}
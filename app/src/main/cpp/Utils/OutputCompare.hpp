@@ -0,0 +1,109 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+#pragma once
+
+#include <stdint.h>
+
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "PAL/MappedFile.hpp"
+#include "PackedContainer.hpp"
+
+namespace qnn {
+namespace tools {
+namespace outputcompare {
+
+enum class StatusCode {
+  SUCCESS,
+  FAILURE,
+};
+
+// Accuracy metrics of one output of one sample against its reference.
+struct Metrics {
+  size_t numElements = 0;
+  size_t numExact    = 0;
+  float maxAbsError  = 0.0f;
+  double cosine      = 1.0;
+  // Signal to quantization noise ratio in dB, infinite when exact.
+  double sqnr = std::numeric_limits<double>::infinity();
+};
+
+// An output passes when all three bounds hold. NaN outputs never pass.
+struct Tolerance {
+  float maxAbsError = std::numeric_limits<float>::infinity();
+  double minCosine  = 0.99;
+  double minSqnr    = -std::numeric_limits<double>::infinity();
+};
+
+// Computes all metrics in a single pass over both buffers. The inner loop
+// keeps independent per lane accumulators so it vectorizes without relying
+// on floating point reassociation.
+Metrics compareFloat(const float *actual, const float *reference, size_t count);
+
+bool isWithinTolerance(const Metrics &metrics, const Tolerance &tolerance);
+
+/*
+ * Compares outputs against reference outputs in place of writing them out.
+ * References are either an output directory, <dir>/[graph/]Result_N/<file>,
+ * or an output container written with --output_container; both are mapped
+ * rather than read. Results are accumulated so a summary can be reported
+ * once execution is done.
+ */
+class Comparator {
+ public:
+  StatusCode open(const std::string &referencePath);
+
+  void setTolerance(const Tolerance &tolerance) { m_tolerance = tolerance; }
+
+  // Stop at the first output that is out of tolerance.
+  void setFailFast(bool failFast) { m_failFast = failFast; }
+
+  bool isFailFast() const { return m_failFast; }
+
+  // name is "[graph/]file", as used for output container tensors. Returns
+  // nullptr if there is no such reference. The data is valid until the next
+  // call.
+  const uint8_t *findReference(const std::string &name, uint64_t sampleIdx, size_t &length);
+
+  // Accumulates the metrics of one output and returns whether it is within
+  // tolerance. label names the output in the log.
+  bool check(const std::string &label, const Metrics &metrics);
+
+  // A missing or malformed reference counts as a failed output.
+  void recordFailure(const std::string &label, const std::string &reason);
+
+  size_t getNumCompared() const { return m_numCompared; }
+
+  size_t getNumFailed() const { return m_numFailed; }
+
+  void logSummary() const;
+
+ private:
+  std::string m_referenceDir;
+  packedcontainer::Reader m_container;
+  bool m_isContainer = false;
+  // Per container tensor, the record index of each sample plus one, zero
+  // when the sample has no record.
+  std::vector<std::vector<uint64_t>> m_sampleRecords;
+  pal::MappedFile m_mappedFile;
+
+  Tolerance m_tolerance;
+  bool m_failFast = false;
+
+  size_t m_numCompared = 0;
+  size_t m_numFailed   = 0;
+  Metrics m_worst;
+  size_t m_totalElements = 0;
+  size_t m_totalExact    = 0;
+};
+
+}  // namespace outputcompare
+}  // namespace tools
+}  // namespace qnn
@@ -0,0 +1,126 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include "Logger.hpp"
+#include "OutputLayout.hpp"
+
+using namespace qnn;
+using namespace qnn::tools;
+
+namespace {
+
+std::string getResultDirName(size_t sampleIdx) {
+  return std::string("Result_") + std::to_string(sampleIdx);
+}
+
+}  // namespace
+
+outputlayout::Planner::~Planner() {
+  for (auto& graphDir : m_graphDirs) {
+    if (graphDir.second.fd >= 0 && graphDir.second.fd != m_rootFd) {
+      close(graphDir.second.fd);
+    }
+  }
+  if (m_rootFd >= 0) {
+    close(m_rootFd);
+  }
+}
+
+outputlayout::StatusCode outputlayout::Planner::open(const std::string& outputDir) {
+  m_rootFd = ::open(outputDir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (m_rootFd < 0) {
+    QNN_ERROR("Failed to open output directory %s: %s", outputDir.c_str(), strerror(errno));
+    return StatusCode::FAILURE;
+  }
+  m_outputDir = outputDir;
+  return StatusCode::SUCCESS;
+}
+
+outputlayout::Planner::GraphDir* outputlayout::Planner::getGraphDir(const std::string& graphDir) {
+  auto it = m_graphDirs.find(graphDir);
+  if (it != m_graphDirs.end()) {
+    return &it->second;
+  }
+  int fd = m_rootFd;
+  if (!graphDir.empty()) {
+    if (mkdirat(m_rootFd, graphDir.c_str(), 0777) != 0 && EEXIST != errno) {
+      QNN_ERROR("Failed to create output directory %s/%s: %s",
+                m_outputDir.c_str(),
+                graphDir.c_str(),
+                strerror(errno));
+      return nullptr;
+    }
+    fd = openat(m_rootFd, graphDir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+      QNN_ERROR("Failed to open output directory %s/%s: %s",
+                m_outputDir.c_str(),
+                graphDir.c_str(),
+                strerror(errno));
+      return nullptr;
+    }
+  }
+  GraphDir& entry = m_graphDirs[graphDir];
+  entry.fd        = fd;
+  return &entry;
+}
+
+bool outputlayout::Planner::createResultDir(GraphDir& graphDir, size_t sampleIdx) {
+  if (sampleIdx < graphDir.created.size() && graphDir.created[sampleIdx]) {
+    return true;
+  }
+  std::string name = getResultDirName(sampleIdx);
+  // EEXIST covers reruns into an existing output directory.
+  if (mkdirat(graphDir.fd, name.c_str(), 0777) != 0 && EEXIST != errno) {
+    QNN_ERROR("Failed to create output directory %s: %s", name.c_str(), strerror(errno));
+    return false;
+  }
+  if (sampleIdx >= graphDir.created.size()) {
+    graphDir.created.resize(sampleIdx + 1, false);
+  }
+  graphDir.created[sampleIdx] = true;
+  return true;
+}
+
+outputlayout::StatusCode outputlayout::Planner::prepare(const std::string& graphDir,
+                                                        size_t firstSample,
+                                                        size_t count) {
+  GraphDir* entry = getGraphDir(graphDir);
+  if (nullptr == entry) {
+    return StatusCode::FAILURE;
+  }
+  if (firstSample + count > entry->created.size()) {
+    entry->created.resize(firstSample + count, false);
+  }
+  for (size_t sampleIdx = firstSample; sampleIdx < firstSample + count; sampleIdx++) {
+    if (!createResultDir(*entry, sampleIdx)) {
+      return StatusCode::FAILURE;
+    }
+  }
+  return StatusCode::SUCCESS;
+}
+
+int outputlayout::Planner::openOutputFile(const std::string& graphDir,
+                                          size_t sampleIdx,
+                                          const std::string& fileName) {
+  GraphDir* entry = getGraphDir(graphDir);
+  if (nullptr == entry || !createResultDir(*entry, sampleIdx)) {
+    return -1;
+  }
+  std::string path = getResultDirName(sampleIdx) + "/" + fileName;
+  int fd = openat(entry->fd, path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+  if (fd < 0) {
+    QNN_ERROR("Failed to open output file for writing: %s: %s", path.c_str(), strerror(errno));
+  }
+  return fd;
+}
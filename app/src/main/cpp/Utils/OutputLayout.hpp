@@ -0,0 +1,70 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace qnn {
+namespace tools {
+namespace outputlayout {
+
+enum class StatusCode {
+  SUCCESS,
+  FAILURE,
+};
+
+/*
+ * Creates the <output dir>/[graph/]Result_N tree and opens files in it
+ * relative to cached directory descriptors. Result directories are created
+ * with one mkdirat() each, in bulk once the samples to run are known, and
+ * output files are opened with openat(), so writing an output costs no
+ * stat() or path walk from the root.
+ */
+class Planner {
+ public:
+  Planner() = default;
+
+  ~Planner();
+
+  Planner(const Planner &) = delete;
+  Planner &operator=(const Planner &) = delete;
+
+  // outputDir must exist.
+  StatusCode open(const std::string &outputDir);
+
+  // Creates Result_<firstSample> to Result_<firstSample + count - 1> under
+  // graphDir, an empty string for the output directory itself. Directories
+  // created before are skipped without a syscall.
+  StatusCode prepare(const std::string &graphDir, size_t firstSample, size_t count);
+
+  // Opens <graphDir>/Result_<sampleIdx>/<fileName> for writing, creating the
+  // result directory if it was not prepared. Returns -1 on failure; the
+  // caller owns the descriptor.
+  int openOutputFile(const std::string &graphDir, size_t sampleIdx, const std::string &fileName);
+
+ private:
+  struct GraphDir {
+    int fd = -1;
+    // Indexed by sample, whether Result_<sample> is known to exist.
+    std::vector<bool> created;
+  };
+
+  GraphDir *getGraphDir(const std::string &graphDir);
+
+  bool createResultDir(GraphDir &graphDir, size_t sampleIdx);
+
+  std::string m_outputDir;
+  int m_rootFd = -1;
+  std::map<std::string, GraphDir> m_graphDirs;
+};
+
+}  // namespace outputlayout
+}  // namespace tools
+}  // namespace qnn
@@ -0,0 +1,396 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include "Logger.hpp"
+#include "PackedContainer.hpp"
+#include "SysUtil.hpp"
+
+using namespace qnn;
+using namespace qnn::tools;
+
+namespace {
+
+// Whether count entries of entrySize bytes at offset end by limit, without
+// overflowing on hostile headers.
+bool fitsWithin(uint64_t offset, uint64_t count, uint64_t entrySize, uint64_t limit) {
+  return offset <= limit && count <= (limit - offset) / entrySize;
+}
+
+}  // namespace
+
+packedcontainer::Writer::Writer()
+    : m_fd(-1),
+      m_kind(Kind::INPUT_DATASET),
+      m_alignment(g_defaultAlignment),
+      m_offset(0),
+      m_flushedOffset(0),
+      m_allocatedOffset(0),
+      m_syncedOffset(0),
+      m_preallocateBytes(0),
+      m_writeBehindBytes(0),
+      m_checkpointBytes(0),
+      m_checkpointOffset(0) {}
+
+packedcontainer::Writer::~Writer() {
+  if (m_fd >= 0) {
+    ::close(m_fd);
+  }
+}
+
+packedcontainer::StatusCode packedcontainer::Writer::create(const std::string& path,
+                                                            Kind kind,
+                                                            uint32_t alignment) {
+  if (alignment < sizeof(uint64_t) || (alignment & (alignment - 1)) != 0) {
+    QNN_ERROR("Container alignment must be a power of two >= 8, got: %u", alignment);
+    return StatusCode::INVALID_ARGUMENT;
+  }
+  m_fd = ::open(path.c_str(), O_CREAT | O_TRUNC | O_WRONLY | O_CLOEXEC, 0644);
+  if (m_fd < 0) {
+    QNN_ERROR("Failed to open container for writing: %s", path.c_str());
+    return StatusCode::FILE_OPEN_FAIL;
+  }
+  // Containers are written strictly front to back.
+  posix_fadvise(m_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+  m_kind            = kind;
+  m_alignment       = alignment;
+  m_offset          = 0;
+  m_flushedOffset   = 0;
+  m_allocatedOffset = 0;
+  m_syncedOffset    = 0;
+  m_writeBuffer.clear();
+  m_tensors.clear();
+  m_records.clear();
+  m_strings.clear();
+  // Reserve space for the header. It stays zeroed, and therefore invalid,
+  // until the first checkpoint or finalize() succeeds.
+  StatusCode status  = padToAlignment();
+  m_checkpointOffset = m_offset;
+  return status;
+}
+
+packedcontainer::StatusCode packedcontainer::Writer::addTensor(const std::string& name,
+                                                               Qnn_DataType_t dataType,
+                                                               const std::vector<size_t>& dims,
+                                                               uint32_t& tensorIdx) {
+  if (dims.size() > g_maxRank) {
+    QNN_ERROR("Tensor %s: rank %zu exceeds container maximum of %u",
+              name.c_str(),
+              dims.size(),
+              g_maxRank);
+    return StatusCode::INVALID_ARGUMENT;
+  }
+  TensorEntry entry;
+  memset(&entry, 0, sizeof(entry));
+  entry.nameOffset = addString(name);
+  entry.nameLength = static_cast<uint32_t>(name.size());
+  entry.dataType   = static_cast<uint32_t>(dataType);
+  entry.rank       = static_cast<uint32_t>(dims.size());
+  for (size_t r = 0; r < dims.size(); r++) {
+    entry.dims[r] = static_cast<uint32_t>(dims[r]);
+  }
+  tensorIdx = static_cast<uint32_t>(m_tensors.size());
+  m_tensors.push_back(entry);
+  return StatusCode::SUCCESS;
+}
+
+packedcontainer::StatusCode packedcontainer::Writer::appendRecord(uint32_t tensorIdx,
+                                                                  uint64_t sampleIdx,
+                                                                  const uint8_t* data,
+                                                                  size_t length,
+                                                                  const std::string& sourcePath) {
+  if (m_fd < 0 || tensorIdx >= m_tensors.size() || (nullptr == data && length > 0)) {
+    return StatusCode::INVALID_ARGUMENT;
+  }
+  RecordEntry record;
+  record.offset     = m_offset;
+  record.length     = length;
+  record.sampleIdx  = sampleIdx;
+  record.tensorIdx  = tensorIdx;
+  record.pathOffset = sourcePath.empty() ? g_noString : addString(sourcePath);
+  StatusCode status = writeAll(data, length);
+  if (StatusCode::SUCCESS == status) {
+    status = padToAlignment();
+  }
+  if (StatusCode::SUCCESS == status) {
+    m_records.push_back(record);
+  }
+  if (StatusCode::SUCCESS == status && m_checkpointBytes > 0) {
+    uint64_t tablesSize = m_tensors.size() * sizeof(TensorEntry) +
+                          m_records.size() * sizeof(RecordEntry) + m_strings.size();
+    uint64_t interval   = g_checkpointTableRatio * tablesSize;
+    if (interval < m_checkpointBytes) {
+      interval = m_checkpointBytes;
+    }
+    if (m_offset - m_checkpointOffset >= interval) {
+      status = checkpoint();
+    }
+  }
+  return status;
+}
+
+// The checkpoint's tables are written in line with the blobs and skipped by
+// the records appended after them, so the header always points at tables
+// that are never overwritten.
+packedcontainer::StatusCode packedcontainer::Writer::checkpoint() {
+  if (m_fd < 0) {
+    return StatusCode::INVALID_ARGUMENT;
+  }
+  FileHeader header;
+  StatusCode status = writeTables(header);
+  if (StatusCode::SUCCESS == status) {
+    status = padToAlignment();
+  }
+  if (StatusCode::SUCCESS == status) {
+    status = flush();
+  }
+  if (StatusCode::SUCCESS == status) {
+    status = writeHeader(header);
+  }
+  m_checkpointOffset = m_offset;
+  return status;
+}
+
+packedcontainer::StatusCode packedcontainer::Writer::finalize() {
+  if (m_fd < 0) {
+    return StatusCode::INVALID_ARGUMENT;
+  }
+  FileHeader header;
+  StatusCode status = writeTables(header);
+  if (StatusCode::SUCCESS == status) {
+    status = flush();
+  }
+  // Give back space reserved past the end of the data.
+  if (StatusCode::SUCCESS == status && m_allocatedOffset > m_offset &&
+      0 != ftruncate(m_fd, static_cast<off_t>(m_offset))) {
+    status = StatusCode::DATA_WRITE_FAIL;
+  }
+  if (StatusCode::SUCCESS == status) {
+    status = writeHeader(header);
+  }
+  if (0 != ::close(m_fd) && StatusCode::SUCCESS == status) {
+    status = StatusCode::DATA_WRITE_FAIL;
+  }
+  m_fd = -1;
+  return status;
+}
+
+// Small records and padding are coalesced in m_writeBuffer so the file is
+// written in large sequential chunks.
+packedcontainer::StatusCode packedcontainer::Writer::writeAll(const void* data, size_t length) {
+  const uint8_t* cursor = static_cast<const uint8_t*>(data);
+  m_offset += length;
+  if (m_writeBuffer.size() + length > g_writeBufferSize) {
+    StatusCode status = flush();
+    if (StatusCode::SUCCESS != status) {
+      return status;
+    }
+    // Blobs at least as large as the buffer go straight to the file.
+    if (length >= g_writeBufferSize) {
+      return writeToFile(cursor, length);
+    }
+  }
+  m_writeBuffer.insert(m_writeBuffer.end(), cursor, cursor + length);
+  return StatusCode::SUCCESS;
+}
+
+packedcontainer::StatusCode packedcontainer::Writer::flush() {
+  StatusCode status = writeToFile(m_writeBuffer.data(), m_writeBuffer.size());
+  m_writeBuffer.clear();
+  return status;
+}
+
+packedcontainer::StatusCode packedcontainer::Writer::writeToFile(const uint8_t* data,
+                                                                 size_t length) {
+  uint64_t writeEnd = m_flushedOffset + length;
+  if (m_preallocateBytes > 0 && writeEnd > m_allocatedOffset) {
+    uint64_t allocateEnd = writeEnd + m_preallocateBytes;
+    // Best effort: filesystems without fallocate support just skip it.
+    if (0 == fallocate(m_fd,
+                       FALLOC_FL_KEEP_SIZE,
+                       static_cast<off_t>(m_allocatedOffset),
+                       static_cast<off_t>(allocateEnd - m_allocatedOffset))) {
+      m_allocatedOffset = allocateEnd;
+    } else {
+      QNN_DEBUG("fallocate failed on container, disabling preallocation: %s", strerror(errno));
+      m_preallocateBytes = 0;
+    }
+  }
+  if (!sysutil::writeAll(m_fd, data, length)) {
+    QNN_ERROR("Failed to write to container: %s", strerror(errno));
+    return StatusCode::DATA_WRITE_FAIL;
+  }
+  m_flushedOffset = writeEnd;
+#if !defined(__ANDROID__) || __ANDROID_API__ >= 26
+  if (m_writeBehindBytes > 0 && m_flushedOffset - m_syncedOffset >= m_writeBehindBytes) {
+    // Start writeback of everything written so far without waiting for it.
+    sync_file_range(m_fd,
+                    static_cast<off_t>(m_syncedOffset),
+                    static_cast<off_t>(m_flushedOffset - m_syncedOffset),
+                    SYNC_FILE_RANGE_WRITE);
+    m_syncedOffset = m_flushedOffset;
+  }
+#endif
+  return StatusCode::SUCCESS;
+}
+
+packedcontainer::StatusCode packedcontainer::Writer::padToAlignment() {
+  static const uint8_t s_zeros[g_defaultAlignment] = {0};
+  size_t padding = (m_alignment - (m_offset % m_alignment)) % m_alignment;
+  if (0 == m_offset) {
+    padding = m_alignment;
+  }
+  while (padding > 0) {
+    size_t chunk      = padding < sizeof(s_zeros) ? padding : sizeof(s_zeros);
+    StatusCode status = writeAll(s_zeros, chunk);
+    if (StatusCode::SUCCESS != status) {
+      return status;
+    }
+    padding -= chunk;
+  }
+  return StatusCode::SUCCESS;
+}
+
+packedcontainer::StatusCode packedcontainer::Writer::writeTables(FileHeader& header) {
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, g_magic, sizeof(header.magic));
+  header.version           = g_version;
+  header.kind              = static_cast<uint32_t>(m_kind);
+  header.alignment         = m_alignment;
+  header.numTensors        = static_cast<uint32_t>(m_tensors.size());
+  header.numRecords        = m_records.size();
+  header.tensorTableOffset = m_offset;
+  header.recordTableOffset = header.tensorTableOffset + m_tensors.size() * sizeof(TensorEntry);
+  header.stringTableOffset = header.recordTableOffset + m_records.size() * sizeof(RecordEntry);
+  header.stringTableSize   = m_strings.size();
+  StatusCode status        = writeAll(m_tensors.data(), m_tensors.size() * sizeof(TensorEntry));
+  if (StatusCode::SUCCESS == status) {
+    status = writeAll(m_records.data(), m_records.size() * sizeof(RecordEntry));
+  }
+  if (StatusCode::SUCCESS == status) {
+    status = writeAll(m_strings.data(), m_strings.size());
+  }
+  return status;
+}
+
+// The header is written last, once everything it points at is in the file.
+packedcontainer::StatusCode packedcontainer::Writer::writeHeader(const FileHeader& header) {
+  if (pwrite(m_fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) {
+    QNN_ERROR("Failed to write container header");
+    return StatusCode::DATA_WRITE_FAIL;
+  }
+  return StatusCode::SUCCESS;
+}
+
+uint32_t packedcontainer::Writer::addString(const std::string& value) {
+  uint32_t offset = static_cast<uint32_t>(m_strings.size());
+  m_strings.append(value);
+  m_strings.push_back('\0');
+  return offset;
+}
+
+bool packedcontainer::Reader::isContainer(const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  char magic[sizeof(g_magic)];
+  bool isContainer = (pread(fd, magic, sizeof(magic), 0) == static_cast<ssize_t>(sizeof(magic)) &&
+                      memcmp(magic, g_magic, sizeof(magic)) == 0);
+  ::close(fd);
+  return isContainer;
+}
+
+packedcontainer::StatusCode packedcontainer::Reader::open(const std::string& path) {
+  m_tensors.clear();
+  m_tensorRecords.clear();
+  if (!m_mappedFile.open(path)) {
+    QNN_ERROR("Failed to map container: %s", path.c_str());
+    return StatusCode::FILE_OPEN_FAIL;
+  }
+  const uint8_t* base = m_mappedFile.data();
+  size_t fileSize     = m_mappedFile.size();
+  m_header            = reinterpret_cast<const FileHeader*>(base);
+  if (fileSize < sizeof(FileHeader) || memcmp(m_header->magic, g_magic, sizeof(g_magic)) != 0 ||
+      m_header->version != g_version) {
+    QNN_ERROR("Not a valid container (bad magic or version): %s", path.c_str());
+    return StatusCode::INVALID_CONTAINER;
+  }
+  if (!fitsWithin(m_header->tensorTableOffset,
+                  m_header->numTensors,
+                  sizeof(TensorEntry),
+                  m_header->recordTableOffset) ||
+      !fitsWithin(m_header->recordTableOffset,
+                  m_header->numRecords,
+                  sizeof(RecordEntry),
+                  m_header->stringTableOffset) ||
+      !fitsWithin(m_header->stringTableOffset, m_header->stringTableSize, 1, fileSize)) {
+    QNN_ERROR("Container tables are out of bounds: %s", path.c_str());
+    return StatusCode::INVALID_CONTAINER;
+  }
+  const TensorEntry* tensors =
+      reinterpret_cast<const TensorEntry*>(base + m_header->tensorTableOffset);
+  m_records = reinterpret_cast<const RecordEntry*>(base + m_header->recordTableOffset);
+  m_strings = reinterpret_cast<const char*>(base + m_header->stringTableOffset);
+  for (uint32_t tIdx = 0; tIdx < m_header->numTensors; tIdx++) {
+    if (tensors[tIdx].rank > g_maxRank ||
+        !fitsWithin(tensors[tIdx].nameOffset,
+                    tensors[tIdx].nameLength,
+                    1,
+                    m_header->stringTableSize)) {
+      QNN_ERROR("Container tensor entry %u is corrupt: %s", tIdx, path.c_str());
+      return StatusCode::INVALID_CONTAINER;
+    }
+    TensorInfo info;
+    info.name     = std::string(m_strings + tensors[tIdx].nameOffset, tensors[tIdx].nameLength);
+    info.dataType = static_cast<Qnn_DataType_t>(tensors[tIdx].dataType);
+    info.dims.assign(tensors[tIdx].dims, tensors[tIdx].dims + tensors[tIdx].rank);
+    m_tensors.push_back(info);
+  }
+  m_tensorRecords.resize(m_header->numTensors);
+  for (uint64_t rIdx = 0; rIdx < m_header->numRecords; rIdx++) {
+    const RecordEntry& record = m_records[rIdx];
+    // Source paths must end within the string table.
+    if (record.tensorIdx >= m_header->numTensors ||
+        !fitsWithin(record.offset, record.length, 1, m_header->tensorTableOffset) ||
+        (g_noString != record.pathOffset &&
+         (record.pathOffset >= m_header->stringTableSize ||
+          nullptr == memchr(m_strings + record.pathOffset,
+                            '\0',
+                            m_header->stringTableSize - record.pathOffset)))) {
+      QNN_ERROR("Container record %llu is corrupt: %s",
+                static_cast<unsigned long long>(rIdx),
+                path.c_str());
+      return StatusCode::INVALID_CONTAINER;
+    }
+    m_tensorRecords[record.tensorIdx].push_back(rIdx);
+  }
+  return StatusCode::SUCCESS;
+}
+
+uint32_t packedcontainer::Reader::findTensor(const std::string& name) const {
+  for (uint32_t tIdx = 0; tIdx < m_tensors.size(); tIdx++) {
+    if (m_tensors[tIdx].name == name) {
+      return tIdx;
+    }
+  }
+  return getNumTensors();
+}
+
+std::string packedcontainer::Reader::getRecordSourcePath(uint64_t recordIdx) const {
+  uint32_t pathOffset = m_records[recordIdx].pathOffset;
+  if (g_noString == pathOffset || pathOffset >= m_header->stringTableSize) {
+    return std::string();
+  }
+  return std::string(m_strings + pathOffset,
+                     strnlen(m_strings + pathOffset, m_header->stringTableSize - pathOffset));
+}
@@ -0,0 +1,221 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "QnnTypes.h"
+
+#include "PAL/MappedFile.hpp"
+
+namespace qnn {
+namespace tools {
+namespace packedcontainer {
+
+/*
+ * Single file container holding many tensor blobs, used both for packed input
+ * datasets and for packed outputs. Layout (little endian):
+ *
+ *   FileHeader                   offset 0, padded to the blob alignment
+ *   blob data                    every blob starts on an alignment boundary
+ *   TensorEntry[numTensors]      tensor name / data type / shape table
+ *   RecordEntry[numRecords]      offset index, in append order
+ *   string table                 tensor names and source paths
+ *
+ * Tables are written after the data so the file can be produced in one
+ * sequential pass. The header magic is only written once the tables it points
+ * at are complete, by Writer::finalize() or by a checkpoint. An interrupted
+ * write therefore either does not look like a container or reads as the
+ * records up to its last checkpoint, whose tables stay behind as dead space
+ * between blobs.
+ */
+enum class StatusCode {
+  SUCCESS,
+  FILE_OPEN_FAIL,
+  DATA_READ_FAIL,
+  DATA_WRITE_FAIL,
+  INVALID_CONTAINER,
+  INVALID_ARGUMENT,
+};
+
+enum class Kind : uint32_t { INPUT_DATASET = 0, OUTPUT_RESULTS = 1 };
+
+const char g_magic[8]             = {'Q', 'N', 'N', 'P', 'A', 'C', 'K', '\0'};
+const uint32_t g_version          = 1;
+const uint32_t g_defaultAlignment = 4096;
+// Output records are never mapped one by one, so cache line alignment is
+// enough and keeps small outputs from being padded out to a page.
+const uint32_t g_outputAlignment  = 64;
+const size_t g_writeBufferSize    = 1 << 20;
+const uint32_t g_maxRank          = 8;
+const uint32_t g_noString         = 0xFFFFFFFF;
+
+// Minimum ratio of data appended between checkpoints to the size of the
+// tables each checkpoint leaves behind.
+const uint64_t g_checkpointTableRatio = 8;
+
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t kind;
+  uint32_t alignment;
+  uint32_t numTensors;
+  uint64_t numRecords;
+  uint64_t tensorTableOffset;
+  uint64_t recordTableOffset;
+  uint64_t stringTableOffset;
+  uint64_t stringTableSize;
+};
+
+struct TensorEntry {
+  uint32_t nameOffset;
+  uint32_t nameLength;
+  uint32_t dataType;
+  uint32_t rank;
+  uint32_t dims[g_maxRank];
+};
+
+struct RecordEntry {
+  uint64_t offset;
+  uint64_t length;
+  uint64_t sampleIdx;
+  uint32_t tensorIdx;
+  // Offset in the string table of the file the blob came from, g_noString
+  // when not recorded.
+  uint32_t pathOffset;
+};
+
+struct TensorInfo {
+  std::string name;
+  Qnn_DataType_t dataType;
+  std::vector<size_t> dims;
+};
+
+class Writer {
+ public:
+  Writer();
+
+  // Closes the file without finalizing it if finalize() was not called.
+  ~Writer();
+
+  Writer(const Writer &) = delete;
+  Writer &operator=(const Writer &) = delete;
+
+  StatusCode create(const std::string &path,
+                    Kind kind,
+                    uint32_t alignment = g_defaultAlignment);
+
+  StatusCode addTensor(const std::string &name,
+                       Qnn_DataType_t dataType,
+                       const std::vector<size_t> &dims,
+                       uint32_t &tensorIdx);
+
+  StatusCode appendRecord(uint32_t tensorIdx,
+                          uint64_t sampleIdx,
+                          const uint8_t *data,
+                          size_t length,
+                          const std::string &sourcePath = std::string());
+
+  // Writes the tables and the header. No records can be appended afterwards.
+  StatusCode finalize();
+
+  bool isOpen() const { return m_fd >= 0; }
+
+  // Sequential write tuning. File space is reserved with fallocate() in
+  // chunks of preallocateBytes ahead of the write position, and written data
+  // is pushed to storage every writeBehindBytes so dirty pages do not pile up.
+  // Zero disables either behaviour.
+  void setPreallocation(size_t preallocateBytes) { m_preallocateBytes = preallocateBytes; }
+
+  void setWriteBehind(size_t writeBehindBytes) { m_writeBehindBytes = writeBehindBytes; }
+
+  // Checkpoints the container every checkpointBytes of appended data, or every
+  // g_checkpointTableRatio times the size of its tables if that is more, so
+  // dead space stays a small fraction of the file. Zero disables checkpoints.
+  void setCheckpointInterval(size_t checkpointBytes) { m_checkpointBytes = checkpointBytes; }
+
+  // Writes the tables of the records appended so far and a header pointing at
+  // them, so the container is readable up to here if finalize() is never
+  // reached.
+  StatusCode checkpoint();
+
+ private:
+  StatusCode writeAll(const void *data, size_t length);
+  StatusCode flush();
+  StatusCode writeToFile(const uint8_t *data, size_t length);
+  StatusCode padToAlignment();
+  // Appends the tables and fills in the header describing them.
+  StatusCode writeTables(FileHeader &header);
+  StatusCode writeHeader(const FileHeader &header);
+  uint32_t addString(const std::string &value);
+
+  int m_fd;
+  Kind m_kind;
+  uint32_t m_alignment;
+  // Logical end of the file, including data still in m_writeBuffer.
+  uint64_t m_offset;
+  uint64_t m_flushedOffset;
+  uint64_t m_allocatedOffset;
+  uint64_t m_syncedOffset;
+  size_t m_preallocateBytes;
+  size_t m_writeBehindBytes;
+  size_t m_checkpointBytes;
+  uint64_t m_checkpointOffset;
+  std::vector<uint8_t> m_writeBuffer;
+  std::vector<TensorEntry> m_tensors;
+  std::vector<RecordEntry> m_records;
+  std::string m_strings;
+};
+
+class Reader {
+ public:
+  // Returns true if path starts with a finalized or checkpointed container
+  // header.
+  static bool isContainer(const std::string &path);
+
+  StatusCode open(const std::string &path);
+
+  Kind getKind() const { return static_cast<Kind>(m_header->kind); }
+
+  uint32_t getNumTensors() const { return static_cast<uint32_t>(m_tensors.size()); }
+
+  const TensorInfo &getTensorInfo(uint32_t tensorIdx) const { return m_tensors[tensorIdx]; }
+
+  // Returns the tensor index for a name, or getNumTensors() if unknown.
+  uint32_t findTensor(const std::string &name) const;
+
+  uint64_t getNumRecords() const { return m_header->numRecords; }
+
+  const RecordEntry &getRecord(uint64_t recordIdx) const { return m_records[recordIdx]; }
+
+  const uint8_t *getRecordData(uint64_t recordIdx) const {
+    return m_mappedFile.data() + m_records[recordIdx].offset;
+  }
+
+  std::string getRecordSourcePath(uint64_t recordIdx) const;
+
+  // Record indices of one tensor, in append order.
+  const std::vector<uint64_t> &getTensorRecords(uint32_t tensorIdx) const {
+    return m_tensorRecords[tensorIdx];
+  }
+
+  void advise(pal::MappedFile::Advice advice) { m_mappedFile.advise(advice); }
+
+ private:
+  pal::MappedFile m_mappedFile;
+  const FileHeader *m_header   = nullptr;
+  const RecordEntry *m_records = nullptr;
+  const char *m_strings        = nullptr;
+  std::vector<TensorInfo> m_tensors;
+  std::vector<std::vector<uint64_t>> m_tensorRecords;
+};
+
+}  // namespace packedcontainer
+}  // namespace tools
+}  // namespace qnn
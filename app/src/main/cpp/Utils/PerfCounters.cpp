@@ -0,0 +1,351 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "PerfCounters.hpp"
+#include "SysUtil.hpp"
+
+using namespace qnn;
+using namespace qnn::tools;
+
+namespace {
+
+uint64_t cacheMissConfig(uint64_t cache) {
+  return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+// Returns the counter's fd for the calling thread, or -1 with errno set.
+int openCounter(perfcounters::Counter counter, bool excludeKernel) {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  switch (counter) {
+    case perfcounters::Counter::CYCLES:
+      attr.type   = PERF_TYPE_HARDWARE;
+      attr.config = PERF_COUNT_HW_CPU_CYCLES;
+      break;
+    case perfcounters::Counter::INSTRUCTIONS:
+      attr.type   = PERF_TYPE_HARDWARE;
+      attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+      break;
+    case perfcounters::Counter::L1D_MISSES:
+      attr.type   = PERF_TYPE_HW_CACHE;
+      attr.config = cacheMissConfig(PERF_COUNT_HW_CACHE_L1D);
+      break;
+    case perfcounters::Counter::LLC_MISSES:
+      attr.type   = PERF_TYPE_HW_CACHE;
+      attr.config = cacheMissConfig(PERF_COUNT_HW_CACHE_LL);
+      break;
+    case perfcounters::Counter::BRANCH_MISSES:
+      attr.type   = PERF_TYPE_HARDWARE;
+      attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+      break;
+    case perfcounters::Counter::CONTEXT_SWITCHES:
+      attr.type   = PERF_TYPE_SOFTWARE;
+      attr.config = PERF_COUNT_SW_CONTEXT_SWITCHES;
+      break;
+  }
+  attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  attr.exclude_kernel = excludeKernel ? 1 : 0;
+  attr.exclude_hv     = 1;
+  // Counters are not grouped, so that each one is scheduled on its own when
+  // the PMU has fewer counters than requested.
+  return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+}
+
+// Appends "<value>" formatted with format, or "-", right aligned in width.
+void appendColumn(std::string& line, bool valid, const char* format, double value, int width) {
+  char text[32];
+  if (valid) {
+    snprintf(text, sizeof(text), format, value);
+  } else {
+    snprintf(text, sizeof(text), "-");
+  }
+  char column[40];
+  snprintf(column, sizeof(column), " %*s", width, text);
+  line += column;
+}
+
+// The calling thread's Collector::ThreadCounters and the collector they
+// belong to; there is only the one returned by getCollector().
+thread_local void* t_collector      = nullptr;
+thread_local void* t_threadCounters = nullptr;
+
+}  // namespace
+
+struct perfcounters::Collector::ThreadCounters {
+  int fds[g_numCounters];
+  std::mutex mutex;
+  std::vector<Stage> stages;
+  Reading last;
+  StageTotals totals[g_numStages];
+
+  ThreadCounters() {
+    for (size_t idx = 0; idx < g_numCounters; idx++) {
+      fds[idx] = -1;
+    }
+  }
+
+  ~ThreadCounters() {
+    for (size_t idx = 0; idx < g_numCounters; idx++) {
+      if (fds[idx] >= 0) {
+        close(fds[idx]);
+      }
+    }
+  }
+
+  void add(Stage stage, const Reading& now) {
+    StageTotals& total = totals[static_cast<size_t>(stage)];
+    total.ns += now.ns - last.ns;
+    for (size_t idx = 0; idx < g_numCounters; idx++) {
+      total.counts[idx] += now.counts[idx] - last.counts[idx];
+    }
+  }
+};
+
+const char* perfcounters::getStageName(Stage stage) {
+  switch (stage) {
+    case Stage::READ:
+      return "read";
+    case Stage::QUANTIZE:
+      return "quantize";
+    case Stage::EXECUTE:
+      return "execute";
+    case Stage::DEQUANTIZE:
+      return "dequantize";
+    case Stage::WRITE:
+      return "write";
+  }
+  return "unknown";
+}
+
+const char* perfcounters::getCounterName(Counter counter) {
+  switch (counter) {
+    case Counter::CYCLES:
+      return "cycles";
+    case Counter::INSTRUCTIONS:
+      return "instructions";
+    case Counter::L1D_MISSES:
+      return "l1d_misses";
+    case Counter::LLC_MISSES:
+      return "llc_misses";
+    case Counter::BRANCH_MISSES:
+      return "branch_misses";
+    case Counter::CONTEXT_SWITCHES:
+      return "context_switches";
+  }
+  return "unknown";
+}
+
+perfcounters::Collector::Collector() : m_excludeKernel(false) {
+  for (size_t idx = 0; idx < g_numCounters; idx++) {
+    m_available[idx] = false;
+  }
+}
+
+perfcounters::Collector::~Collector() { m_enabled.store(false); }
+
+perfcounters::StatusCode perfcounters::Collector::enable() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (isEnabled()) {
+    return StatusCode::SUCCESS;
+  }
+  std::unique_ptr<ThreadCounters> counters(new ThreadCounters());
+  bool denied = false;
+  for (size_t idx = 0; idx < g_numCounters; idx++) {
+    counters->fds[idx] = openCounter(static_cast<Counter>(idx), false);
+    denied |= counters->fds[idx] < 0 && (EACCES == errno || EPERM == errno);
+  }
+  // perf_event_paranoid 2, the usual setting, only allows counting user
+  // space. Count it for every counter, so that they cover the same code.
+  if (denied) {
+    m_excludeKernel = true;
+    for (size_t idx = 0; idx < g_numCounters; idx++) {
+      if (counters->fds[idx] >= 0) {
+        close(counters->fds[idx]);
+      }
+      counters->fds[idx] = openCounter(static_cast<Counter>(idx), true);
+    }
+  }
+  bool anyAvailable = false;
+  for (size_t idx = 0; idx < g_numCounters; idx++) {
+    m_available[idx] = counters->fds[idx] >= 0;
+    anyAvailable |= m_available[idx];
+  }
+  if (!anyAvailable) {
+    return StatusCode::UNAVAILABLE;
+  }
+  t_collector      = this;
+  t_threadCounters = counters.get();
+  m_threads.push_back(std::move(counters));
+  m_enabled.store(true);
+  return StatusCode::SUCCESS;
+}
+
+perfcounters::Collector::ThreadCounters* perfcounters::Collector::getThreadCounters() {
+  if (this == t_collector) {
+    return static_cast<ThreadCounters*>(t_threadCounters);
+  }
+  std::unique_ptr<ThreadCounters> counters(new ThreadCounters());
+  for (size_t idx = 0; idx < g_numCounters; idx++) {
+    if (m_available[idx]) {
+      counters->fds[idx] = openCounter(static_cast<Counter>(idx), m_excludeKernel);
+    }
+  }
+  // Remembered even if nothing opened, to not retry on every stage.
+  t_collector      = this;
+  t_threadCounters = counters.get();
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_threads.push_back(std::move(counters));
+  return static_cast<ThreadCounters*>(t_threadCounters);
+}
+
+bool perfcounters::Collector::read(Reading& reading) {
+  ThreadCounters* counters = getThreadCounters();
+  reading.ns               = sysutil::nowNs();
+  bool anyOpen             = false;
+  for (size_t idx = 0; idx < g_numCounters; idx++) {
+    reading.counts[idx] = 0.0;
+    uint64_t values[3];
+    if (counters->fds[idx] < 0 || static_cast<ssize_t>(sizeof(values)) !=
+                                      ::read(counters->fds[idx], values, sizeof(values))) {
+      continue;
+    }
+    anyOpen = true;
+    // values are the count, the time enabled and the time running.
+    if (values[2] > 0) {
+      reading.counts[idx] =
+          static_cast<double>(values[0]) * static_cast<double>(values[1]) / values[2];
+    }
+  }
+  return anyOpen;
+}
+
+void perfcounters::Collector::enter(Stage stage) {
+  Reading now;
+  read(now);
+  ThreadCounters* counters = getThreadCounters();
+  std::lock_guard<std::mutex> lock(counters->mutex);
+  if (!counters->stages.empty()) {
+    counters->add(counters->stages.back(), now);
+  }
+  counters->stages.push_back(stage);
+  counters->totals[static_cast<size_t>(stage)].calls++;
+  counters->last = now;
+}
+
+void perfcounters::Collector::leave(uint64_t bytes) {
+  Reading now;
+  read(now);
+  ThreadCounters* counters = getThreadCounters();
+  std::lock_guard<std::mutex> lock(counters->mutex);
+  if (counters->stages.empty()) {
+    return;
+  }
+  counters->add(counters->stages.back(), now);
+  counters->totals[static_cast<size_t>(counters->stages.back())].bytes += bytes;
+  counters->stages.pop_back();
+  counters->last = now;
+}
+
+perfcounters::StageTotals perfcounters::Collector::getTotals(Stage stage) {
+  StageTotals sum;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (auto& counters : m_threads) {
+    std::lock_guard<std::mutex> threadLock(counters->mutex);
+    const StageTotals& total = counters->totals[static_cast<size_t>(stage)];
+    sum.calls += total.calls;
+    sum.bytes += total.bytes;
+    sum.ns += total.ns;
+    for (size_t idx = 0; idx < g_numCounters; idx++) {
+      sum.counts[idx] += total.counts[idx];
+    }
+  }
+  return sum;
+}
+
+void perfcounters::Collector::writeReport(int fd) {
+  if (!isEnabled()) {
+    return;
+  }
+  std::string report = m_excludeKernel ? "Performance counters, user space only:\n"
+                                       : "Performance counters:\n";
+  char line[160];
+  snprintf(line,
+           sizeof(line),
+           "%-10s %8s %10s %10s %6s %6s %10s %10s %10s %8s\n",
+           "stage",
+           "calls",
+           "MiB",
+           "ms",
+           "GHz",
+           "IPC",
+           "L1D/KiB",
+           "LLC/KiB",
+           "branch/KiB",
+           "cswitch");
+  report += line;
+  for (size_t stageIdx = 0; stageIdx < g_numStages; stageIdx++) {
+    StageTotals total = getTotals(static_cast<Stage>(stageIdx));
+    if (0 == total.calls) {
+      continue;
+    }
+    double cycles  = total.counts[static_cast<size_t>(Counter::CYCLES)];
+    double kib     = static_cast<double>(total.bytes) / 1024.0;
+    bool hasCycles = isAvailable(Counter::CYCLES) && cycles > 0.0;
+    bool hasBytes  = total.bytes > 0;
+    snprintf(line,
+             sizeof(line),
+             "%-10s %8llu %10.1f %10.1f",
+             getStageName(static_cast<Stage>(stageIdx)),
+             static_cast<unsigned long long>(total.calls),
+             kib / 1024.0,
+             static_cast<double>(total.ns) / 1e6);
+    std::string row = line;
+    appendColumn(row, hasCycles && total.ns > 0, "%.2f", cycles / total.ns, 6);
+    appendColumn(row,
+                 hasCycles && isAvailable(Counter::INSTRUCTIONS),
+                 "%.2f",
+                 total.counts[static_cast<size_t>(Counter::INSTRUCTIONS)] / cycles,
+                 6);
+    appendColumn(row,
+                 hasBytes && isAvailable(Counter::L1D_MISSES),
+                 "%.1f",
+                 total.counts[static_cast<size_t>(Counter::L1D_MISSES)] / kib,
+                 10);
+    appendColumn(row,
+                 hasBytes && isAvailable(Counter::LLC_MISSES),
+                 "%.1f",
+                 total.counts[static_cast<size_t>(Counter::LLC_MISSES)] / kib,
+                 10);
+    appendColumn(row,
+                 hasBytes && isAvailable(Counter::BRANCH_MISSES),
+                 "%.1f",
+                 total.counts[static_cast<size_t>(Counter::BRANCH_MISSES)] / kib,
+                 10);
+    appendColumn(row,
+                 isAvailable(Counter::CONTEXT_SWITCHES),
+                 "%.0f",
+                 total.counts[static_cast<size_t>(Counter::CONTEXT_SWITCHES)],
+                 8);
+    report += row + "\n";
+  }
+  sysutil::writeAll(fd, report.data(), report.size());
+}
+
+perfcounters::Collector& perfcounters::getCollector() {
+  static Collector collector;
+  return collector;
+}
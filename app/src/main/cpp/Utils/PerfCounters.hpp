@@ -0,0 +1,157 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace qnn {
+namespace tools {
+namespace perfcounters {
+
+enum class StatusCode {
+  SUCCESS,
+  // Not even cycles could be counted, e.g. because perf_event_paranoid
+  // forbids it or the kernel has no perf events.
+  UNAVAILABLE,
+};
+
+enum class Stage : uint8_t {
+  READ,
+  QUANTIZE,
+  EXECUTE,
+  DEQUANTIZE,
+  WRITE,
+};
+
+const size_t g_numStages = 5;
+
+const char *getStageName(Stage stage);
+
+enum class Counter : uint8_t {
+  CYCLES,
+  INSTRUCTIONS,
+  L1D_MISSES,
+  LLC_MISSES,
+  BRANCH_MISSES,
+  CONTEXT_SWITCHES,
+};
+
+const size_t g_numCounters = 6;
+
+const char *getCounterName(Counter counter);
+
+// Counts of the calling thread since its counters were opened, scaled up for
+// the time the kernel multiplexed them out.
+struct Reading {
+  uint64_t ns = 0;
+  double counts[g_numCounters] = {};
+};
+
+struct StageTotals {
+  uint64_t calls = 0;
+  uint64_t bytes = 0;
+  uint64_t ns    = 0;
+  double counts[g_numCounters] = {};
+};
+
+/*
+ * Counts cycles, instructions, L1 data and last level cache read misses,
+ * branch misses and context switches with perf_event_open, per thread, and
+ * attributes them to the stage the thread is in. Stages nest: a stage
+ * entered inside another one pauses it, so every count goes to exactly one
+ * stage. A thread's counters are opened the first time it enters a stage.
+ *
+ * Each boundary reads every counter with a system call, so this is for
+ * diagnosing where time goes, not for timing.
+ */
+class Collector {
+ public:
+  Collector();
+
+  ~Collector();
+
+  Collector(const Collector &) = delete;
+  Collector &operator=(const Collector &) = delete;
+
+  // Probes which counters can be opened by the calling thread and starts
+  // collecting. Counters that cannot be opened, often the cache ones in a
+  // virtual machine, read as 0 and are reported as unavailable.
+  StatusCode enable();
+
+  bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+  bool isAvailable(Counter counter) const { return m_available[static_cast<size_t>(counter)]; }
+
+  void enter(Stage stage);
+
+  // Leaves the innermost stage of the calling thread, which processed bytes.
+  void leave(uint64_t bytes);
+
+  // Returns false if the calling thread's counters could not be opened.
+  bool read(Reading &reading);
+
+  // Sum over all threads.
+  StageTotals getTotals(Stage stage);
+
+  // Writes per stage calls, bytes, time, clock rate, instructions per cycle
+  // and misses per KiB processed to fd.
+  void writeReport(int fd);
+
+ private:
+  struct ThreadCounters;
+
+  ThreadCounters *getThreadCounters();
+
+  std::atomic<bool> m_enabled{false};
+  bool m_available[g_numCounters];
+  bool m_excludeKernel;
+  std::mutex m_mutex;
+  std::vector<std::unique_ptr<ThreadCounters>> m_threads;
+};
+
+Collector &getCollector();
+
+/*
+ * Attributes the counts between its construction and destruction to stage.
+ * Does nothing when the collector is not enabled.
+ */
+class Scope {
+ public:
+  explicit Scope(Stage stage, uint64_t bytes = 0)
+      : m_active(getCollector().isEnabled()), m_bytes(bytes) {
+    if (m_active) {
+      getCollector().enter(stage);
+    }
+  }
+
+  ~Scope() {
+    if (m_active) {
+      getCollector().leave(m_bytes);
+    }
+  }
+
+  Scope(const Scope &) = delete;
+  Scope &operator=(const Scope &) = delete;
+
+  bool isActive() const { return m_active; }
+
+  void addBytes(uint64_t bytes) { m_bytes += bytes; }
+
+ private:
+  bool m_active;
+  uint64_t m_bytes;
+};
+
+}  // namespace perfcounters
+}  // namespace tools
+}  // namespace qnn
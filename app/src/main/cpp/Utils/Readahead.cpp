@@ -0,0 +1,133 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "Logger.hpp"
+#include "Readahead.hpp"
+
+using namespace qnn;
+using namespace qnn::tools;
+
+namespace {
+
+// Weight of the latest measurement in the time per sample average.
+const double g_smoothing = 0.125;
+
+}  // namespace
+
+void readahead::Scheduler::addSample(const std::vector<std::string>& fileSpecs) {
+  Sample sample;
+  sample.ranges.reserve(fileSpecs.size());
+  for (auto const& fileSpec : fileSpecs) {
+    sample.ranges.push_back(datautil::parseFileRange(fileSpec));
+  }
+  m_samples.push_back(std::move(sample));
+}
+
+bool readahead::Scheduler::adviseRange(datautil::FileRange& range, int advice, uint64_t& bytes) {
+  int fd = m_fileCache.acquire(range.path);
+  if (fd < 0) {
+    return false;
+  }
+  if (!range.isRange) {
+    // A zero length advises to the end of the file; the size is only needed
+    // for the byte budget.
+    struct stat st;
+    if (0 == range.length && fstat(fd, &st) == 0) {
+      range.length = static_cast<uint64_t>(st.st_size);
+    }
+    bytes += range.length;
+    return 0 == posix_fadvise(fd, 0, 0, advice);
+  }
+  bytes += range.length;
+  return 0 == posix_fadvise(
+                  fd, static_cast<off_t>(range.offset), static_cast<off_t>(range.length), advice);
+}
+
+bool readahead::Scheduler::isAdvisedAhead(const datautil::FileRange& range) const {
+  for (size_t idx = 0; idx < m_numAdvised; idx++) {
+    for (auto const& advised : m_samples[idx].ranges) {
+      if (advised.path != range.path) {
+        continue;
+      }
+      // Whole files overlap everything in them.
+      if (!advised.isRange || !range.isRange ||
+          (advised.offset < range.offset + range.length &&
+           range.offset < advised.offset + advised.length)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void readahead::Scheduler::advise() {
+  while (m_numAdvised < m_samples.size() && m_numAdvised < m_window &&
+         (0 == m_numAdvised || m_advisedBytes < g_maxAdvisedBytes)) {
+    Sample& sample = m_samples[m_numAdvised];
+    for (auto& range : sample.ranges) {
+      adviseRange(range, POSIX_FADV_WILLNEED, sample.advisedBytes);
+    }
+    m_advisedBytes += sample.advisedBytes;
+    m_totalAdvisedBytes += sample.advisedBytes;
+    m_numAdvised++;
+    m_numSamplesAdvised++;
+  }
+}
+
+void readahead::Scheduler::updateWindow(size_t numSamples) {
+  auto now = std::chrono::steady_clock::now();
+  if (m_hasLastConsume && numSamples > 0) {
+    double seconds = std::chrono::duration<double>(now - m_lastConsume).count() / numSamples;
+    if (m_secondsPerSample > 0.0) {
+      m_secondsPerSample += g_smoothing * (seconds - m_secondsPerSample);
+    } else {
+      m_secondsPerSample = seconds;
+    }
+    if (m_secondsPerSample > 0.0) {
+      double window = std::ceil(g_leadSeconds / m_secondsPerSample);
+      m_window      = static_cast<size_t>(std::min(
+          std::max(window, static_cast<double>(g_minWindow)), static_cast<double>(g_maxWindow)));
+    }
+  }
+  m_lastConsume    = now;
+  m_hasLastConsume = true;
+}
+
+void readahead::Scheduler::consume(size_t numSamples) {
+  numSamples = std::min(numSamples, m_samples.size());
+  for (size_t idx = 0; idx < numSamples; idx++) {
+    Sample sample = std::move(m_samples.front());
+    m_samples.pop_front();
+    if (m_numAdvised > 0) {
+      m_advisedBytes -= sample.advisedBytes;
+      m_numAdvised--;
+    }
+    uint64_t bytes = 0;
+    for (auto& range : sample.ranges) {
+      if (!isAdvisedAhead(range)) {
+        adviseRange(range, POSIX_FADV_DONTNEED, bytes);
+      }
+    }
+    m_numSamplesDropped++;
+  }
+  updateWindow(numSamples);
+  advise();
+}
+
+void readahead::Scheduler::logSummary() const {
+  QNN_INFO("Input readahead: %zu samples advised (%llu bytes), %zu dropped, window %zu samples",
+           m_numSamplesAdvised,
+           static_cast<unsigned long long>(m_totalAdvisedBytes),
+           m_numSamplesDropped,
+           m_window);
+}
@@ -0,0 +1,104 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+#pragma once
+
+#include <stdint.h>
+
+#include <chrono>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "DataUtil.hpp"
+
+namespace qnn {
+namespace tools {
+namespace readahead {
+
+// Samples kept advised ahead of execution, before and after adapting.
+const size_t g_minWindow     = 2;
+const size_t g_initialWindow = 8;
+const size_t g_maxWindow     = 256;
+
+// Upper bound on the bytes advised but not yet consumed, so readahead never
+// costs more page cache than this however fast samples are executed.
+const uint64_t g_maxAdvisedBytes = 64ull << 20;
+
+// How far ahead of execution, in time, the window aims to stay.
+const double g_leadSeconds = 0.05;
+
+/*
+ * Prefetches the input files of upcoming samples into the page cache. The
+ * input list is known ahead of execution, so once a sample is parsed its
+ * files can be advised with POSIX_FADV_WILLNEED, which starts the reads in
+ * the background, and dropped with POSIX_FADV_DONTNEED once the sample has
+ * been executed so dead inputs do not crowd the page cache.
+ *
+ * The window of samples advised ahead adapts to the measured time per sample
+ * so it covers g_leadSeconds of execution, within [g_minWindow, g_maxWindow]
+ * and g_maxAdvisedBytes. Inputs also read by an advised upcoming sample are
+ * not dropped, and only whole pages inside a path@offset+length range are,
+ * so neighbouring samples in the same file are not evicted.
+ */
+class Scheduler {
+ public:
+  Scheduler() = default;
+
+  Scheduler(const Scheduler &) = delete;
+  Scheduler &operator=(const Scheduler &) = delete;
+
+  // Queues the input list entries of the next sample, in execution order.
+  void addSample(const std::vector<std::string> &fileSpecs);
+
+  // Marks the oldest numSamples samples as executed: drops their pages,
+  // updates the window from the time since the last call and advises the
+  // samples that entered the window. Call with zero to advise the initial
+  // window.
+  void consume(size_t numSamples);
+
+  size_t getWindow() const { return m_window; }
+
+  void logSummary() const;
+
+ private:
+  struct Sample {
+    std::vector<datautil::FileRange> ranges;
+    uint64_t advisedBytes = 0;
+  };
+
+  // Advises samples until the window or the byte budget is full.
+  void advise();
+
+  void updateWindow(size_t numSamples);
+
+  // Whether an advised upcoming sample reads any part of range, which must
+  // then stay cached.
+  bool isAdvisedAhead(const datautil::FileRange &range) const;
+
+  // Returns false if the file could not be opened; the sample is then just
+  // read cold.
+  bool adviseRange(datautil::FileRange &range, int advice, uint64_t &bytes);
+
+  // Samples not yet executed, oldest first; the first m_numAdvised of them
+  // have been advised.
+  std::deque<Sample> m_samples;
+  size_t m_numAdvised       = 0;
+  uint64_t m_advisedBytes   = 0;
+  size_t m_window           = g_initialWindow;
+  double m_secondsPerSample = 0.0;
+  bool m_hasLastConsume     = false;
+  std::chrono::steady_clock::time_point m_lastConsume;
+  datautil::InputFileCache m_fileCache;
+  size_t m_numSamplesAdvised   = 0;
+  size_t m_numSamplesDropped   = 0;
+  uint64_t m_totalAdvisedBytes = 0;
+};
+
+}  // namespace readahead
+}  // namespace tools
+}  // namespace qnn
@@ -0,0 +1,52 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+#pragma once
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+
+// Header only, so that the stand-in backend and the tools share it without
+// linking anything else. Both are safe to call from a signal handler.
+namespace qnn {
+namespace tools {
+namespace sysutil {
+
+// CLOCK_MONOTONIC in nanoseconds, the time base of every recorded timestamp.
+inline uint64_t nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// Writes all length bytes of data to fd, resuming after short writes and
+// signals. Returns false, with errno set, if a write failed.
+inline bool writeAll(int fd, const void *data, size_t length) {
+  const char *bytes = static_cast<const char *>(data);
+  while (length > 0) {
+    ssize_t written = ::write(fd, bytes, length);
+    if (written < 0 && EINTR == errno) {
+      continue;
+    }
+    if (written <= 0) {
+      if (0 == written) {
+        errno = EIO;
+      }
+      return false;
+    }
+    bytes += written;
+    length -= static_cast<size_t>(written);
+  }
+  return true;
+}
+
+}  // namespace sysutil
+}  // namespace tools
+}  // namespace qnn
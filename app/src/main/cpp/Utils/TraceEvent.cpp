@@ -0,0 +1,143 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+#include <stdio.h>
+#include <unistd.h>
+
+#include "Logger.hpp"
+#include "TraceEvent.hpp"
+
+using namespace qnn;
+using namespace qnn::tools;
+
+namespace {
+
+// Trace event times are microseconds.
+std::string formatMicroseconds(uint64_t timeNs) {
+  char buffer[32];
+  snprintf(buffer,
+           sizeof(buffer),
+           "%llu.%03u",
+           static_cast<unsigned long long>(timeNs / 1000),
+           static_cast<unsigned>(timeNs % 1000));
+  return std::string(buffer);
+}
+
+std::string formatEvent(const std::string& pid, const traceevent::Event& event) {
+  std::string line = ",\n{\"ph\":\"X\",\"pid\":" + pid + ",\"tid\":" +
+                     std::to_string(event.threadId) +
+                     ",\"ts\":" + formatMicroseconds(event.startNs) +
+                     ",\"dur\":" + formatMicroseconds(event.durationNs) +
+                     ",\"name\":" + traceevent::quote(event.name) +
+                     ",\"cat\":" + traceevent::quote(event.category) + ",\"args\":{";
+  bool firstArg = true;
+  const std::pair<const char*, int64_t> indices[] = {
+      {"graph", event.graphIdx}, {"sample", event.sampleIdx}, {"tensor", event.tensorIdx}};
+  for (auto const& index : indices) {
+    if (index.second >= 0) {
+      line += (firstArg ? "\"" : ",\"") + std::string(index.first) +
+              "\":" + std::to_string(index.second);
+      firstArg = false;
+    }
+  }
+  for (auto const& arg : event.args) {
+    line += (firstArg ? "" : ",") + traceevent::quote(arg.first) + ":" + arg.second;
+    firstArg = false;
+  }
+  return line + "}}";
+}
+
+std::string formatThreadName(const std::string& pid, uint32_t threadId, const std::string& name) {
+  return ",\n{\"ph\":\"M\",\"pid\":" + pid + ",\"tid\":" + std::to_string(threadId) +
+         ",\"name\":\"thread_name\",\"args\":{\"name\":" + traceevent::quote(name) + "}}";
+}
+
+}  // namespace
+
+std::string traceevent::quote(const std::string& text) {
+  std::string quoted = "\"";
+  for (char c : text) {
+    switch (c) {
+      case '"':
+        quoted += "\\\"";
+        break;
+      case '\\':
+        quoted += "\\\\";
+        break;
+      case '\n':
+        quoted += "\\n";
+        break;
+      case '\t':
+        quoted += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char escaped[8];
+          snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(c));
+          quoted += escaped;
+        } else {
+          quoted += c;
+        }
+    }
+  }
+  return quoted + "\"";
+}
+
+traceevent::Writer::~Writer() { close(); }
+
+traceevent::StatusCode traceevent::Writer::open(const std::string& path) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_file = fopen(path.c_str(), "w");
+  if (nullptr == m_file) {
+    QNN_ERROR("Failed to create trace file: %s", path.c_str());
+    return StatusCode::FILE_WRITE_FAIL;
+  }
+  m_path      = path;
+  m_pid       = std::to_string(getpid());
+  m_numEvents = 0;
+  m_failed    = false;
+  // The main thread's id is the process id.
+  std::string metadata = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n{\"ph\":\"M\",\"pid\":" +
+                         m_pid + ",\"tid\":0,\"name\":\"process_name\"," +
+                         "\"args\":{\"name\":\"qnn-mobile-app\"}}" +
+                         formatThreadName(m_pid, static_cast<uint32_t>(getpid()), "main");
+  m_failed = EOF == fputs(metadata.c_str(), m_file);
+  return StatusCode::SUCCESS;
+}
+
+void traceevent::Writer::add(Event&& event) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (nullptr == m_file) {
+    return;
+  }
+  m_failed |= EOF == fputs(formatEvent(m_pid, event).c_str(), m_file);
+  m_numEvents++;
+}
+
+void traceevent::Writer::setThreadName(uint32_t threadId, const std::string& name) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (nullptr == m_file) {
+    return;
+  }
+  m_failed |= EOF == fputs(formatThreadName(m_pid, threadId, name).c_str(), m_file);
+}
+
+traceevent::StatusCode traceevent::Writer::close() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (nullptr == m_file) {
+    return StatusCode::SUCCESS;
+  }
+  m_failed |= EOF == fputs("\n]}\n", m_file);
+  m_failed |= 0 != fclose(m_file);
+  m_file = nullptr;
+  if (m_failed) {
+    QNN_ERROR("Failed to write trace file: %s", m_path.c_str());
+    return StatusCode::FILE_WRITE_FAIL;
+  }
+  QNN_INFO("Wrote %zu trace events to %s", m_numEvents, m_path.c_str());
+  return StatusCode::SUCCESS;
+}
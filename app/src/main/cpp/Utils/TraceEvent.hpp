@@ -0,0 +1,89 @@
+//==============================================================================
+//
+//  Copyright (c) 2023 Qualcomm Technologies, Inc.
+//  All Rights Reserved.
+//  Confidential and Proprietary - Qualcomm Technologies, Inc.
+//
+//==============================================================================
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace qnn {
+namespace tools {
+namespace traceevent {
+
+enum class StatusCode {
+  SUCCESS,
+  FILE_WRITE_FAIL,
+};
+
+// Thread id of the track QNN profile events are placed on. Never a real
+// thread id.
+const uint32_t g_profileThreadId = 0;
+
+// A complete ("X") event. Times are CLOCK_MONOTONIC nanoseconds.
+struct Event {
+  std::string name;
+  const char *category = "";
+  uint64_t startNs     = 0;
+  uint64_t durationNs  = 0;
+  uint32_t threadId    = 0;
+  // Written as args when not negative.
+  int64_t graphIdx  = -1;
+  int64_t sampleIdx = -1;
+  int64_t tensorIdx = -1;
+  // Further args, as names and JSON encoded values.
+  std::vector<std::pair<std::string, std::string>> args;
+};
+
+// Returns text as a JSON string literal, quotes included.
+std::string quote(const std::string &text);
+
+/*
+ * Writes events in the Chrome trace event JSON format, which chrome://tracing
+ * and ui.perfetto.dev open, with one track per thread. Events are streamed to
+ * the file as they are added, so memory use does not grow with the length of
+ * the run. Meant for runs that are being looked at rather than for
+ * production: adding an event takes a lock and formats it.
+ */
+class Writer {
+ public:
+  Writer() = default;
+
+  // Closes the file if close() was not called.
+  ~Writer();
+
+  Writer(const Writer &) = delete;
+  Writer &operator=(const Writer &) = delete;
+
+  // Creates path and writes the trace metadata. Events added before are
+  // dropped.
+  StatusCode open(const std::string &path);
+
+  void add(Event &&event);
+
+  // Name shown for the track of threadId instead of its id.
+  void setThreadName(uint32_t threadId, const std::string &name);
+
+  // Terminates the JSON and closes the file. Fails if any write failed.
+  StatusCode close();
+
+ private:
+  std::mutex m_mutex;
+  FILE *m_file = nullptr;
+  std::string m_path;
+  std::string m_pid;
+  size_t m_numEvents = 0;
+  bool m_failed      = false;
+};
+
+}  // namespace traceevent
+}  // namespace tools
+}  // namespace qnn
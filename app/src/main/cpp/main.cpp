@@ -6,6 +6,12 @@
 //
 //==============================================================================
 
+#include <errno.h>
+#include <stdint.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -17,6 +23,40 @@
 //#include "AppUtils.hpp"
 #include "App.hpp"
 
+namespace {
+
+// Parses the value of a floating point option, exiting on anything that is
+// not a number.
+double parseDoubleOption(const char* option, const char* value) {
+    char* end     = nullptr;
+    errno         = 0;
+    double parsed = std::strtod(value, &end);
+    if (end == value || '\0' != *end || ERANGE == errno || std::isnan(parsed)) {
+        std::cerr << "ERROR: Invalid value passed to --" << option << ": " << value << "\n";
+        std::exit(EXIT_FAILURE);
+    }
+    return parsed;
+}
+
+// Parses the value of a non-negative integer option, exiting on anything
+// else, including negative values that strtoull would wrap, and values
+// above maxValue.
+unsigned long long parseUnsignedOption(const char* option,
+                                       const char* value,
+                                       unsigned long long maxValue) {
+    char* end                 = nullptr;
+    errno                     = 0;
+    unsigned long long parsed = std::strtoull(value, &end, 10);
+    if (end == value || '\0' != *end || ERANGE == errno || nullptr != std::strchr(value, '-') ||
+        parsed > maxValue) {
+        std::cerr << "ERROR: Invalid value passed to --" << option << ": " << value << "\n";
+        std::exit(EXIT_FAILURE);
+    }
+    return parsed;
+}
+
+}  // namespace
+
 int main(int argc, char** argv) {
     void* sg_backendHandle{nullptr};
     void* sg_modelHandle{nullptr};
@@ -24,10 +64,37 @@ int main(int argc, char** argv) {
     using namespace qnn::tools;
 
     enum OPTIONS {
-        OPT_MODEL           = 0,
-        OPT_BACKEND         = 1,
-        OPT_INPUT_LIST      = 2,
-        OPT_OUTPUT_DIR      = 3,
+        OPT_MODEL                 = 0,
+        OPT_BACKEND               = 1,
+        OPT_INPUT_LIST            = 2,
+        OPT_OUTPUT_DIR            = 3,
+        OPT_INPUT_DATA_TYPE       = 4,
+        OPT_INPUT_MMAP            = 5,
+        OPT_OUTPUT_CONTAINER      = 6,
+        OPT_OUTPUT_PREALLOCATE_MB = 7,
+        OPT_IO_BACKEND            = 8,
+        OPT_OUTPUT_HASH           = 9,
+        OPT_OUTPUT_HASH_STATS     = 10,
+        OPT_COMPARE_WITH          = 11,
+        OPT_COMPARE_MAX_ABS       = 12,
+        OPT_COMPARE_MIN_COSINE    = 13,
+        OPT_COMPARE_MIN_SQNR      = 14,
+        OPT_COMPARE_FAIL_FAST     = 15,
+        OPT_INPUT_STREAM          = 16,
+        OPT_OUTPUT_STREAM         = 17,
+        OPT_STREAM_FRAMING        = 18,
+        OPT_OUTPUT_MMAP           = 19,
+        OPT_INPUT_READAHEAD       = 20,
+        OPT_INPUT_DIRECT_IO       = 21,
+        OPT_FLIGHT_RECORDER       = 22,
+        OPT_METRICS_FILE          = 23,
+        OPT_METRICS_INTERVAL_MS   = 24,
+        OPT_TRACE_JSON            = 25,
+        OPT_PROFILING_LEVEL       = 26,
+        OPT_MEMORY_REPORT         = 27,
+        OPT_PERF_COUNTERS         = 28,
+        OPT_API_TIMING            = 29,
+        OPT_NO_FLIGHT_RECORDER    = 30,
     };
 
     // Create the command line options
@@ -36,6 +103,33 @@ int main(int argc, char** argv) {
             {"backend", pal::required_argument, NULL, OPT_BACKEND},
             {"input_list", pal::required_argument, NULL, OPT_INPUT_LIST},
             {"output_dir", pal::required_argument, NULL, OPT_OUTPUT_DIR},
+            {"input_data_type", pal::required_argument, NULL, OPT_INPUT_DATA_TYPE},
+            {"input_mmap", pal::required_argument, NULL, OPT_INPUT_MMAP},
+            {"output_container", pal::required_argument, NULL, OPT_OUTPUT_CONTAINER},
+            {"output_preallocate_mb", pal::required_argument, NULL, OPT_OUTPUT_PREALLOCATE_MB},
+            {"io_backend", pal::required_argument, NULL, OPT_IO_BACKEND},
+            {"output_hash", pal::required_argument, NULL, OPT_OUTPUT_HASH},
+            {"output_hash_stats", pal::no_argument, NULL, OPT_OUTPUT_HASH_STATS},
+            {"compare_with", pal::required_argument, NULL, OPT_COMPARE_WITH},
+            {"compare_max_abs", pal::required_argument, NULL, OPT_COMPARE_MAX_ABS},
+            {"compare_min_cosine", pal::required_argument, NULL, OPT_COMPARE_MIN_COSINE},
+            {"compare_min_sqnr", pal::required_argument, NULL, OPT_COMPARE_MIN_SQNR},
+            {"compare_fail_fast", pal::no_argument, NULL, OPT_COMPARE_FAIL_FAST},
+            {"input_stream", pal::required_argument, NULL, OPT_INPUT_STREAM},
+            {"output_stream", pal::required_argument, NULL, OPT_OUTPUT_STREAM},
+            {"stream_framing", pal::required_argument, NULL, OPT_STREAM_FRAMING},
+            {"output_mmap", pal::no_argument, NULL, OPT_OUTPUT_MMAP},
+            {"input_readahead", pal::no_argument, NULL, OPT_INPUT_READAHEAD},
+            {"input_direct_io", pal::no_argument, NULL, OPT_INPUT_DIRECT_IO},
+            {"flight_recorder", pal::required_argument, NULL, OPT_FLIGHT_RECORDER},
+            {"no_flight_recorder", pal::no_argument, NULL, OPT_NO_FLIGHT_RECORDER},
+            {"metrics_file", pal::required_argument, NULL, OPT_METRICS_FILE},
+            {"metrics_interval_ms", pal::required_argument, NULL, OPT_METRICS_INTERVAL_MS},
+            {"trace_json", pal::required_argument, NULL, OPT_TRACE_JSON},
+            {"profiling_level", pal::required_argument, NULL, OPT_PROFILING_LEVEL},
+            {"memory_report", pal::no_argument, NULL, OPT_MEMORY_REPORT},
+            {"perf_counters", pal::no_argument, NULL, OPT_PERF_COUNTERS},
+            {"api_timing", pal::no_argument, NULL, OPT_API_TIMING},
             {NULL, 0, NULL, 0}};
 
     // Command line parsing loop
@@ -48,6 +142,30 @@ int main(int argc, char** argv) {
     std::string opPackagePaths;
     iotensor::OutputDataType parsedOutputDataType   = iotensor::OutputDataType::FLOAT_ONLY;
     iotensor::InputDataType parsedInputDataType     = iotensor::InputDataType::FLOAT;
+    iotensor::InputMapping parsedInputMapping       = iotensor::InputMapping::NONE;
+    std::string outputContainerPath;
+    size_t outputPreallocateMb            = 64;
+    asyncio::Backend parsedIoBackend      = asyncio::Backend::NONE;
+    iotensor::OutputHash parsedOutputHash = iotensor::OutputHash::NONE;
+    bool outputHashStats                  = false;
+    std::string compareWithPath;
+    outputcompare::Tolerance compareTolerance;
+    bool compareFailFast = false;
+    std::string inputStreamPath;
+    std::string outputStreamPath;
+    framestream::Framing parsedStreamFraming = framestream::Framing::LENGTH_PREFIXED;
+    bool outputMapping                       = false;
+    bool inputReadahead                      = false;
+    bool inputDirectIo                       = false;
+    std::string flightRecorderPath;
+    bool flightRecorder = true;
+    std::string metricsPath;
+    size_t metricsIntervalMs = 10000;
+    std::string traceJsonPath;
+    app::ProfilingLevel parsedProfilingLevel = app::ProfilingLevel::OFF;
+    bool memoryReport                        = false;
+    bool perfCounters                        = false;
+    bool apiTiming                           = false;
 
     while ((opt = pal::getOptLongOnly(argc, argv, "", s_longOptions, &longIndex)) != -1) {
         switch (opt) {
@@ -63,6 +181,124 @@ int main(int argc, char** argv) {
             case OPT_OUTPUT_DIR:
                 outputPath = pal::g_optArg;
                 break;
+            case OPT_INPUT_DATA_TYPE:
+                parsedInputDataType = iotensor::parseInputDataType(pal::g_optArg);
+                if (parsedInputDataType == iotensor::InputDataType::INVALID) {
+                    std::cerr << "ERROR: Invalid value passed to --input_data_type: " << pal::g_optArg
+                              << "\nSupported values: float, native\n";
+                    std::exit(EXIT_FAILURE);
+                }
+                break;
+            case OPT_INPUT_MMAP:
+                parsedInputMapping = iotensor::parseInputMapping(pal::g_optArg);
+                if (parsedInputMapping == iotensor::InputMapping::INVALID) {
+                    std::cerr << "ERROR: Invalid value passed to --input_mmap: " << pal::g_optArg
+                              << "\nSupported values: none, normal, sequential, random, willneed\n";
+                    std::exit(EXIT_FAILURE);
+                }
+                break;
+            case OPT_OUTPUT_CONTAINER:
+                outputContainerPath = pal::g_optArg;
+                break;
+            case OPT_OUTPUT_PREALLOCATE_MB:
+                outputPreallocateMb = static_cast<size_t>(parseUnsignedOption(
+                    "output_preallocate_mb", pal::g_optArg, SIZE_MAX / (1024 * 1024)));
+                break;
+            case OPT_IO_BACKEND:
+                parsedIoBackend = asyncio::parseBackend(pal::g_optArg);
+                if (parsedIoBackend == asyncio::Backend::INVALID) {
+                    std::cerr << "ERROR: Invalid value passed to --io_backend: " << pal::g_optArg
+                              << "\nSupported values: none, auto, io_uring, thread_pool\n";
+                    std::exit(EXIT_FAILURE);
+                }
+                break;
+            case OPT_OUTPUT_HASH:
+                parsedOutputHash = iotensor::parseOutputHash(pal::g_optArg);
+                if (parsedOutputHash == iotensor::OutputHash::INVALID) {
+                    std::cerr << "ERROR: Invalid value passed to --output_hash: " << pal::g_optArg
+                              << "\nSupported values: none, 64, 128\n";
+                    std::exit(EXIT_FAILURE);
+                }
+                break;
+            case OPT_OUTPUT_HASH_STATS:
+                outputHashStats = true;
+                break;
+            case OPT_COMPARE_WITH:
+                compareWithPath = pal::g_optArg;
+                break;
+            case OPT_COMPARE_MAX_ABS:
+                compareTolerance.maxAbsError =
+                    static_cast<float>(parseDoubleOption("compare_max_abs", pal::g_optArg));
+                break;
+            case OPT_COMPARE_MIN_COSINE:
+                compareTolerance.minCosine = parseDoubleOption("compare_min_cosine", pal::g_optArg);
+                break;
+            case OPT_COMPARE_MIN_SQNR:
+                compareTolerance.minSqnr = parseDoubleOption("compare_min_sqnr", pal::g_optArg);
+                break;
+            case OPT_COMPARE_FAIL_FAST:
+                compareFailFast = true;
+                break;
+            case OPT_INPUT_STREAM:
+                inputStreamPath = pal::g_optArg;
+                break;
+            case OPT_OUTPUT_STREAM:
+                outputStreamPath = pal::g_optArg;
+                break;
+            case OPT_STREAM_FRAMING:
+                parsedStreamFraming = framestream::parseFraming(pal::g_optArg);
+                if (parsedStreamFraming == framestream::Framing::INVALID) {
+                    std::cerr << "ERROR: Invalid value passed to --stream_framing: " << pal::g_optArg
+                              << "\nSupported values: length, fixed\n";
+                    std::exit(EXIT_FAILURE);
+                }
+                break;
+            case OPT_OUTPUT_MMAP:
+                outputMapping = true;
+                break;
+            case OPT_INPUT_READAHEAD:
+                inputReadahead = true;
+                break;
+            case OPT_INPUT_DIRECT_IO:
+                inputDirectIo = true;
+                break;
+            case OPT_FLIGHT_RECORDER:
+                flightRecorderPath = pal::g_optArg;
+                break;
+            case OPT_NO_FLIGHT_RECORDER:
+                flightRecorder = false;
+                break;
+            case OPT_METRICS_FILE:
+                metricsPath = pal::g_optArg;
+                break;
+            case OPT_METRICS_INTERVAL_MS:
+                metricsIntervalMs = static_cast<size_t>(
+                    parseUnsignedOption("metrics_interval_ms", pal::g_optArg, UINT32_MAX));
+                if (0 == metricsIntervalMs) {
+                    std::cerr << "ERROR: --metrics_interval_ms must be positive\n";
+                    std::exit(EXIT_FAILURE);
+                }
+                break;
+            case OPT_TRACE_JSON:
+                traceJsonPath = pal::g_optArg;
+                break;
+            case OPT_PROFILING_LEVEL:
+                parsedProfilingLevel = app::parseProfilingLevel(pal::g_optArg);
+                if (parsedProfilingLevel == app::ProfilingLevel::INVALID) {
+                    std::cerr << "ERROR: Invalid value passed to --profiling_level: " << pal::g_optArg
+                              << "\nSupported values: off, basic, detailed\n";
+                    std::exit(EXIT_FAILURE);
+                }
+                break;
+            case OPT_MEMORY_REPORT:
+                memoryReport = true;
+                break;
+            case OPT_PERF_COUNTERS:
+                perfCounters = true;
+                break;
+            case OPT_API_TIMING:
+                apiTiming = true;
+                break;
             default:
                 std::cerr << "ERROR: Invalid argument passed: " << argv[pal::g_optInd - 1]
                           << "\nPlease check the Arguments section in the description below.\n";
@@ -78,8 +314,8 @@ int main(int argc, char** argv) {
         std::cerr << "Missing option: --backend\n" << "\n";
     }
 
-    if (inputListPaths.empty()) {
-        std::cerr << "Missing option: --input_list\n" << "\n";
+    if (inputListPaths.empty() && inputStreamPath.empty()) {
+        std::cerr << "Missing option: --input_list or --input_stream\n" << "\n";
     }
 
     QNN_INFO("Model: %s", modelPath.c_str());
@@ -124,6 +360,23 @@ int main(int argc, char** argv) {
             return EXIT_FAILURE;
         }
 
+        app->setInputMapping(parsedInputMapping);
+        app->setOutputContainer(outputContainerPath, outputPreallocateMb * 1024 * 1024);
+        app->setIoBackend(parsedIoBackend);
+        app->setOutputHash(parsedOutputHash, outputHashStats);
+        app->setCompareWith(compareWithPath, compareTolerance, compareFailFast);
+        app->setFrameStreams(inputStreamPath, outputStreamPath, parsedStreamFraming);
+        app->setOutputMapping(outputMapping);
+        app->setInputReadahead(inputReadahead);
+        app->setInputDirectIo(inputDirectIo);
+        app->setFlightRecorder(flightRecorder, flightRecorderPath);
+        app->setMetricsExport(metricsPath, std::chrono::milliseconds(metricsIntervalMs));
+        app->setTraceJson(traceJsonPath);
+        app->setProfilingLevel(parsedProfilingLevel);
+        app->setMemoryReport(memoryReport);
+        app->setPerfCounters(perfCounters);
+        app->setApiTiming(apiTiming);
+
         if (app::StatusCode::SUCCESS != app->initialize()) {
             return app->reportError("Initialization failure");
         }